@@ -0,0 +1,30 @@
+#ifndef AUDIOPLAYBACK_BENCHMARKUTILS_H
+#define AUDIOPLAYBACK_BENCHMARKUTILS_H
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+/**
+ * Time run over repetitions calls and return the fastest in seconds. The fastest run is the one
+ * least disturbed by the rest of the machine, which makes results comparable between runs.
+ */
+template<typename Function>
+double measureFastestSeconds(Function &&run, int repetitions = 5) {
+    double fastest = std::numeric_limits<double>::max();
+    for (int i = 0; i < repetitions; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        run();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        fastest = std::min(fastest, elapsed.count());
+    }
+    return fastest;
+}
+
+// Keep the compiler from dropping a computation whose result is otherwise unused
+template<typename T>
+void doNotOptimize(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+#endif //AUDIOPLAYBACK_BENCHMARKUTILS_H
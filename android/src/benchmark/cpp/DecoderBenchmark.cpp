@@ -0,0 +1,129 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "audio/MappedWavDataSource.h"
+#include "audio/WavDecoder.h"
+
+#include "BenchmarkUtils.h"
+
+/**
+ * Time each decoding backend that runs off the device takes to load a WAV file: mapping it with
+ * MappedWavDataSource, which decodes nothing, and WavDecoder decoding it to float and to int16.
+ * Covers a short mono effect and a long stereo track in 16 bit, 24 bit and float. MediaCodec, the
+ * backend for everything else, needs a device and isn't part of this. Neither are Ogg Vorbis and
+ * MP3, which have no software decoder.
+ */
+
+namespace {
+    constexpr int32_t kSampleRate = 48000;
+
+    struct Encoding {
+        const char *name;
+        uint16_t formatTag;
+        uint16_t bitsPerSample;
+    };
+
+    void appendLittleEndian(std::vector<char> &bytes, uint32_t value, int size) {
+        for (int i = 0; i < size; ++i) bytes.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+
+    // A canonical 44 byte header followed by a 440 Hz sine
+    std::string writeWavFile(const Encoding &encoding, int32_t channelCount, int64_t frameCount) {
+        const int bytesPerSample = encoding.bitsPerSample / 8;
+        const auto dataSize = static_cast<uint32_t>(frameCount * channelCount * bytesPerSample);
+        std::vector<char> bytes;
+        bytes.insert(bytes.end(), {'R', 'I', 'F', 'F'});
+        appendLittleEndian(bytes, 36 + dataSize, 4);
+        bytes.insert(bytes.end(), {'W', 'A', 'V', 'E', 'f', 'm', 't', ' '});
+        appendLittleEndian(bytes, 16, 4);
+        appendLittleEndian(bytes, encoding.formatTag, 2);
+        appendLittleEndian(bytes, channelCount, 2);
+        appendLittleEndian(bytes, kSampleRate, 4);
+        appendLittleEndian(bytes, kSampleRate * channelCount * bytesPerSample, 4);
+        appendLittleEndian(bytes, channelCount * bytesPerSample, 2);
+        appendLittleEndian(bytes, encoding.bitsPerSample, 2);
+        bytes.insert(bytes.end(), {'d', 'a', 't', 'a'});
+        appendLittleEndian(bytes, dataSize, 4);
+
+        for (int64_t frame = 0; frame < frameCount; ++frame) {
+            const double value = 0.5 * std::sin(2 * M_PI * 440 * static_cast<double>(frame) / kSampleRate);
+            for (int32_t channel = 0; channel < channelCount; ++channel) {
+                if (encoding.formatTag == 3) {
+                    const auto sample = static_cast<float>(value);
+                    uint32_t bits;
+                    std::memcpy(&bits, &sample, sizeof(bits));
+                    appendLittleEndian(bytes, bits, 4);
+                } else {
+                    const auto scale = static_cast<double>(1u << (encoding.bitsPerSample - 1));
+                    appendLittleEndian(bytes, static_cast<uint32_t>(static_cast<int32_t>(std::lround(value * scale))), bytesPerSample);
+                }
+            }
+        }
+
+        const auto path = (std::filesystem::temp_directory_path()
+                           / ("DecoderBenchmark-" + std::string(encoding.name) + "-" + std::to_string(frameCount) + ".wav")).string();
+        std::ofstream(path, std::ios::binary).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        return path;
+    }
+}
+
+int main() {
+    const Encoding encodings[] = {
+        {"pcm16", 1, 16},
+        {"pcm24", 1, 24},
+        {"float", 3, 32},
+    };
+    struct Clip {
+        const char *name;
+        int32_t channelCount;
+        int64_t frameCount;
+    };
+    const Clip clips[] = {
+        {"0.25 s mono", 1, kSampleRate / 4},
+        {"30 s stereo", 2, kSampleRate * 30},
+    };
+
+    std::printf("%-12s %-8s %-18s %12s %10s\n", "clip", "file", "backend", "us/load", "realtime");
+    for (const auto &[clipName, channelCount, frameCount]: clips) {
+        for (const auto &encoding: encodings) {
+            const std::string path = writeWavFile(encoding, channelCount, frameCount);
+            const int fd = open(path.c_str(), O_RDONLY);
+            const auto length = static_cast<int>(std::filesystem::file_size(path));
+            const AudioProperties properties = {.channelCount = channelCount, .sampleRate = kSampleRate};
+            const double clipSeconds = static_cast<double>(frameCount) / kSampleRate;
+
+            const auto report = [&](const char *backend, double seconds) {
+                std::printf("%-12s %-8s %-18s %12.1f %9.0fx\n", clipName, encoding.name, backend, seconds * 1e6, clipSeconds / seconds);
+            };
+
+            // 24 bit files can't be played from the mapping
+            if (encoding.bitsPerSample != 24) {
+                report("mapped", measureFastestSeconds([&] {
+                    const auto result = MappedWavDataSource::newFromFileDescriptor(fd, 0, length, properties);
+                    doNotOptimize(result.dataSource->getSamples());
+                    delete result.dataSource;
+                }, 20));
+            }
+            for (const SampleFormat format: {SampleFormat::float32, SampleFormat::int16}) {
+                report(format == SampleFormat::float32 ? "WavDecoder, float" : "WavDecoder, int16", measureFastestSeconds([&] {
+                    auto opened = WavDecoder::open(fd, 0, length);
+                    const auto result = opened.decoder->decodeToEnd(format);
+                    doNotOptimize(result.data->data());
+                }, 20));
+            }
+
+            close(fd);
+            std::filesystem::remove(path);
+        }
+    }
+    return 0;
+}
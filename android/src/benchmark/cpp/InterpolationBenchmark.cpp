@@ -0,0 +1,78 @@
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "OfflineRenderer.h"
+#include "audio/MemoryDataSource.h"
+
+#include "BenchmarkUtils.h"
+
+/**
+ * Time Player takes per voice and output frame on each of its read paths: the plain copy at unit
+ * rate, the interpolated path a pan puts a unit rate voice on, and linear and cubic interpolation
+ * at a rate other than 1, for mono and stereo sounds. 32 looping voices of the same one second
+ * sound render one second of stereo output with the limiter off.
+ */
+
+namespace {
+    constexpr AudioProperties kOutputProperties = {.channelCount = 2, .sampleRate = 48000};
+    constexpr int32_t kFramesPerBuffer = 192;
+    constexpr int32_t kVoiceCount = 32;
+
+    std::shared_ptr<DataSource> makeSource(int32_t channelCount) {
+        const AudioProperties properties = {.channelCount = channelCount, .sampleRate = kOutputProperties.sampleRate};
+        std::vector<float> samples(static_cast<size_t>(properties.sampleRate * channelCount));
+        for (size_t i = 0; i < samples.size(); ++i) {
+            samples[i] = static_cast<float>(0.5 * std::sin(2 * M_PI * 440 * static_cast<double>(i / channelCount) / properties.sampleRate));
+        }
+        return std::make_shared<MemoryDataSource>(std::move(samples), properties);
+    }
+
+    double measureNanosecondsPerVoiceFrame(const std::shared_ptr<DataSource> &source, Interpolation interpolation, float playbackRate, float pan) {
+        OfflineRenderer renderer(kOutputProperties, kFramesPerBuffer);
+        renderer.postCommand({.type = AudioCommandType::setLimiterEnabled, .boolValue = false});
+        for (int32_t i = 0; i < kVoiceCount; ++i) {
+            Player *player = renderer.addPlayer(std::make_unique<Player>(source, kOutputProperties.channelCount, 1,
+                                                                         VoiceStealingPolicy::oldest, interpolation));
+            // Set before playing, so neither ramps and every voice stays on one path
+            renderer.postCommand({.type = AudioCommandType::setPlaybackRate, .player = player, .floatValue = playbackRate});
+            renderer.postCommand({.type = AudioCommandType::setPan, .player = player, .floatValue = pan});
+            renderer.postCommand({.type = AudioCommandType::setLooping, .player = player, .boolValue = true});
+            renderer.postCommand({.type = AudioCommandType::setPlaying, .player = player, .boolValue = true});
+        }
+        std::vector<float> output(static_cast<size_t>(kOutputProperties.sampleRate * kOutputProperties.channelCount));
+
+        const double seconds = measureFastestSeconds([&] {
+            renderer.render(output.data(), kOutputProperties.sampleRate);
+            doNotOptimize(output.data());
+        });
+        return seconds * 1e9 / (static_cast<double>(kOutputProperties.sampleRate) * kVoiceCount);
+    }
+}
+
+int main() {
+    const auto monoSource = makeSource(1);
+    const auto stereoSource = makeSource(2);
+    struct Case {
+        const char *name;
+        const std::shared_ptr<DataSource> &source;
+        Interpolation interpolation;
+        float playbackRate;
+        float pan;
+    };
+    const Case cases[] = {
+        {"unit rate, centered", stereoSource, Interpolation::linear, 1.0f, 0.0f},
+        {"unit rate, panned", stereoSource, Interpolation::linear, 1.0f, 0.3f},
+        {"linear, rate 1.1, stereo source", stereoSource, Interpolation::linear, 1.1f, 0.0f},
+        {"cubic, rate 1.1, stereo source", stereoSource, Interpolation::cubic, 1.1f, 0.0f},
+        {"linear, rate 1.1, mono source", monoSource, Interpolation::linear, 1.1f, 0.0f},
+        {"cubic, rate 1.1, mono source", monoSource, Interpolation::cubic, 1.1f, 0.0f},
+    };
+
+    std::printf("%-34s %18s\n", "path", "ns/voice frame");
+    for (const auto &[name, source, interpolation, playbackRate, pan]: cases) {
+        std::printf("%-34s %18.2f\n", name, measureNanosecondsPerVoiceFrame(source, interpolation, playbackRate, pan));
+    }
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "audio/Limiter.h"
+
+#include "BenchmarkUtils.h"
+
+/**
+ * Time the master limiter takes for one second of stereo output in 192 frame buffers, for a mix
+ * that stays under its threshold, one that goes over now and then and one that is limited all
+ * along, enabled and disabled.
+ */
+
+namespace {
+    constexpr AudioProperties kProperties = {.channelCount = 2, .sampleRate = 48000};
+    constexpr int32_t kFramesPerBuffer = 192;
+
+    // Noise at level, raised to overLevel for the first tenth of every overPeriod frames
+    std::vector<float> makeSignal(float level, float overLevel, int32_t overPeriod) {
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> distribution(-1, 1);
+        std::vector<float> samples(static_cast<size_t>(kProperties.sampleRate * kProperties.channelCount));
+        for (size_t i = 0; i < samples.size(); ++i) {
+            const auto frame = static_cast<int32_t>(i / kProperties.channelCount);
+            samples[i] = distribution(random) * (frame % overPeriod < overPeriod / 10 ? overLevel : level);
+        }
+        return samples;
+    }
+}
+
+int main() {
+    struct Case {
+        const char *name;
+        std::vector<float> signal;
+    };
+    const Case cases[] = {
+        {"under threshold", makeSignal(0.5f, 0.5f, kProperties.sampleRate)},
+        {"occasional peaks", makeSignal(0.5f, 2.0f, kProperties.sampleRate / 4)},
+        {"always limited", makeSignal(2.0f, 2.0f, kProperties.sampleRate)},
+    };
+
+    std::printf("%-18s %-9s %10s %10s\n", "signal", "limiter", "us/buffer", "realtime");
+    for (const auto &[name, signal]: cases) {
+        for (const bool isEnabled: {true, false}) {
+            Limiter limiter;
+            limiter.configure(kProperties);
+            limiter.setEnabled(isEnabled);
+            std::vector<float> buffer(kFramesPerBuffer * kProperties.channelCount);
+
+            const double seconds = measureFastestSeconds([&] {
+                for (int32_t frame = 0; frame + kFramesPerBuffer <= kProperties.sampleRate; frame += kFramesPerBuffer) {
+                    std::copy_n(signal.begin() + frame * kProperties.channelCount, buffer.size(), buffer.begin());
+                    limiter.process(buffer.data(), kFramesPerBuffer);
+                    doNotOptimize(buffer.data());
+                }
+            });
+            std::printf("%-18s %-9s %10.2f %9.0fx\n", name, isEnabled ? "enabled" : "disabled",
+                        seconds * 1e6 / (kProperties.sampleRate / kFramesPerBuffer), 1 / seconds);
+        }
+    }
+    return 0;
+}
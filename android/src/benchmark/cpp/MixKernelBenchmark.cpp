@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "audio/MixKernels.h"
+
+#include "BenchmarkUtils.h"
+
+/**
+ * Time to mix one second of stereo output from 1, 16 and 64 players with the kernels of
+ * MixKernels.cpp, against the plain loops they replaced. The loops are measured twice: as the
+ * compiler builds them, which is usually auto-vectorized, and with vectorization turned off.
+ */
+
+namespace {
+    constexpr int32_t kSampleRate = 48000;
+    constexpr int32_t kOutputChannelCount = 2;
+    constexpr int32_t kFramesPerBuffer = 192;
+    constexpr float kGain = 0.5f;
+
+#if defined(__clang__)
+#define SCALAR_LOOP _Pragma("clang loop vectorize(disable) interleave(disable)")
+#define SCALAR_FUNCTION
+#elif defined(__GNUC__)
+#define SCALAR_LOOP
+#define SCALAR_FUNCTION __attribute__((optimize("no-tree-vectorize")))
+#else
+#define SCALAR_LOOP
+#define SCALAR_FUNCTION
+#endif
+
+    constexpr float getScale(float) { return 1; }
+    constexpr float getScale(int16_t) { return 1.0f / 32768.0f; }
+
+    template<typename Sample>
+    void mixLoop(float *output, const Sample *input, int32_t numSamples, float gain) {
+        const float scaledGain = gain * getScale(Sample());
+        for (int32_t i = 0; i < numSamples; ++i) {
+            output[i] += scaledGain * static_cast<float>(input[i]);
+        }
+    }
+
+    template<typename Sample>
+    void mixMonoLoop(float *output, const Sample *input, int32_t numFrames, float gain) {
+        const float scaledGain = gain * getScale(Sample());
+        for (int32_t i = 0; i < numFrames; ++i) {
+            const float sample = scaledGain * static_cast<float>(input[i]);
+            output[i * 2] += sample;
+            output[i * 2 + 1] += sample;
+        }
+    }
+
+    template<typename Sample>
+    SCALAR_FUNCTION void mixScalar(float *output, const Sample *input, int32_t numSamples, float gain) {
+        const float scaledGain = gain * getScale(Sample());
+        SCALAR_LOOP
+        for (int32_t i = 0; i < numSamples; ++i) {
+            output[i] += scaledGain * static_cast<float>(input[i]);
+        }
+    }
+
+    template<typename Sample>
+    SCALAR_FUNCTION void mixMonoScalar(float *output, const Sample *input, int32_t numFrames, float gain) {
+        const float scaledGain = gain * getScale(Sample());
+        SCALAR_LOOP
+        for (int32_t i = 0; i < numFrames; ++i) {
+            const float sample = scaledGain * static_cast<float>(input[i]);
+            output[i * 2] += sample;
+            output[i * 2 + 1] += sample;
+        }
+    }
+
+    enum class Path { kernel, loop, scalar };
+
+    const char *getPathName(Path path) {
+        switch (path) {
+            case Path::kernel: return "kernel";
+            case Path::loop: return "loop";
+            case Path::scalar: return "scalar";
+        }
+        return "";
+    }
+
+    // Every player has its own second of audio, so the inputs come from memory like they do in the app
+    template<typename Sample>
+    double measureMixSeconds(Path path, int32_t playerCount, int32_t sourceChannelCount) {
+        std::vector<std::vector<Sample>> sources(static_cast<size_t>(playerCount));
+        for (auto &source: sources) {
+            source.resize(static_cast<size_t>(kSampleRate * sourceChannelCount));
+            for (size_t i = 0; i < source.size(); ++i) {
+                source[i] = static_cast<Sample>(i % 100);
+            }
+        }
+        std::vector<float> output(kFramesPerBuffer * kOutputChannelCount);
+        const bool isMono = sourceChannelCount == 1;
+
+        return measureFastestSeconds([&] {
+            for (int32_t frame = 0; frame + kFramesPerBuffer <= kSampleRate; frame += kFramesPerBuffer) {
+                std::fill(output.begin(), output.end(), 0.0f);
+                for (const auto &source: sources) {
+                    const Sample *input = source.data() + frame * sourceChannelCount;
+                    switch (path) {
+                        case Path::kernel:
+                            if (isMono) mixMonoWithGain(output.data(), kOutputChannelCount, input, kFramesPerBuffer, kGain);
+                            else mixWithGain(output.data(), input, kFramesPerBuffer * kOutputChannelCount, kGain);
+                            break;
+                        case Path::loop:
+                            if (isMono) mixMonoLoop(output.data(), input, kFramesPerBuffer, kGain);
+                            else mixLoop(output.data(), input, kFramesPerBuffer * kOutputChannelCount, kGain);
+                            break;
+                        case Path::scalar:
+                            if (isMono) mixMonoScalar(output.data(), input, kFramesPerBuffer, kGain);
+                            else mixScalar(output.data(), input, kFramesPerBuffer * kOutputChannelCount, kGain);
+                            break;
+                    }
+                }
+                doNotOptimize(output.data());
+            }
+        });
+    }
+
+    template<typename Sample>
+    void runCase(const char *name, int32_t sourceChannelCount) {
+        for (const int32_t playerCount: {1, 16, 64}) {
+            const double scalarSeconds = measureMixSeconds<Sample>(Path::scalar, playerCount, sourceChannelCount);
+            for (const auto path: {Path::kernel, Path::loop, Path::scalar}) {
+                const double seconds = path == Path::scalar ? scalarSeconds : measureMixSeconds<Sample>(path, playerCount, sourceChannelCount);
+                std::printf("%-14s %8d %-7s %12.2f %10.0fx %9.2fx\n", name, playerCount, getPathName(path),
+                            seconds * 1e6 / (kSampleRate / kFramesPerBuffer), 1 / seconds, scalarSeconds / seconds);
+            }
+        }
+    }
+}
+
+int main() {
+    std::printf("%-14s %8s %-7s %12s %11s %10s\n", "source", "players", "path", "us/buffer", "realtime", "vs scalar");
+    runCase<float>("stereo float", 2);
+    runCase<float>("mono float", 1);
+    runCase<int16_t>("stereo int16", 2);
+    runCase<int16_t>("mono int16", 1);
+    return 0;
+}
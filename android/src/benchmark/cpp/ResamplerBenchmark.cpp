@@ -0,0 +1,83 @@
+#include <cmath>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+#include "audio/Resampler.h"
+
+#include "BenchmarkUtils.h"
+
+/**
+ * Throughput of each Resampler quality tier for the conversions sounds typically need at load
+ * time, along with the signal to noise ratio a 1 kHz sine comes out with.
+ */
+
+namespace {
+    constexpr int32_t kChannelCount = 2;
+    constexpr double kSineFrequency = 1000;
+    constexpr double kSineAmplitude = 0.5;
+
+    const char *getQualityName(ResamplerQuality quality) {
+        switch (quality) {
+            case ResamplerQuality::low: return "low";
+            case ResamplerQuality::medium: return "medium";
+            case ResamplerQuality::high: return "high";
+        }
+        return "";
+    }
+
+    std::vector<float> makeSine(int32_t sampleRate, int64_t frameCount) {
+        std::vector<float> samples(static_cast<size_t>(frameCount * kChannelCount));
+        for (int64_t i = 0; i < frameCount; ++i) {
+            const auto value = static_cast<float>(kSineAmplitude * std::sin(2 * M_PI * kSineFrequency * static_cast<double>(i) / sampleRate));
+            for (int32_t channel = 0; channel < kChannelCount; ++channel) {
+                samples[static_cast<size_t>(i * kChannelCount + channel)] = value;
+            }
+        }
+        return samples;
+    }
+
+    // Measured over the middle half, away from the filter's edges
+    double getSignalToNoiseDb(const std::vector<float> &output, int32_t sampleRate) {
+        const int64_t frameCount = static_cast<int64_t>(output.size()) / kChannelCount;
+        double signal = 0;
+        double noise = 0;
+        for (int64_t i = frameCount / 4; i < frameCount * 3 / 4; ++i) {
+            const double expected = kSineAmplitude * std::sin(2 * M_PI * kSineFrequency * static_cast<double>(i) / sampleRate);
+            const double error = output[static_cast<size_t>(i * kChannelCount)] - expected;
+            signal += expected * expected;
+            noise += error * error;
+        }
+        return 10 * std::log10(signal / noise);
+    }
+}
+
+int main() {
+    const std::pair<int32_t, int32_t> conversions[] = {{44100, 48000}, {48000, 44100}, {22050, 48000}, {11025, 48000}};
+
+    std::printf("%-16s %-8s %14s %10s %9s\n", "conversion", "quality", "Mframes/s out", "realtime", "SNR dB");
+    for (const auto &[inputRate, outputRate]: conversions) {
+        // Two seconds of input, about as long as a typical sound effect
+        const int64_t inputFrameCount = inputRate * 2;
+        const std::vector<float> input = makeSine(inputRate, inputFrameCount);
+
+        for (const auto quality: {ResamplerQuality::low, ResamplerQuality::medium, ResamplerQuality::high}) {
+            const Resampler resampler(inputRate, outputRate, kChannelCount, quality);
+            const int64_t outputFrameCount = resampler.getOutputFrameCount(inputFrameCount);
+            std::vector<float> output(static_cast<size_t>(outputFrameCount * kChannelCount));
+
+            const double seconds = measureFastestSeconds([&] {
+                resampler.process(input.data(), inputFrameCount, output.data());
+                doNotOptimize(output.data());
+            });
+
+            char conversion[32];
+            std::snprintf(conversion, sizeof(conversion), "%d->%d", inputRate, outputRate);
+            std::printf("%-16s %-8s %14.2f %9.0fx %9.1f\n", conversion, getQualityName(quality),
+                        static_cast<double>(outputFrameCount) / seconds / 1e6,
+                        static_cast<double>(outputFrameCount) / outputRate / seconds,
+                        getSignalToNoiseDb(output, outputRate));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <type_traits>
+#include <vector>
+
+#include "audio/MixKernels.h"
+
+#include "BenchmarkUtils.h"
+
+/**
+ * What each storage format of a decoded sound costs: the memory a second of stereo audio stays
+ * resident in, the time to mix one second of output from many such sounds with the mixWithGain
+ * kernel for the format, and the signal to noise ratio the conversion leaves a full scale sine with.
+ */
+
+namespace {
+    constexpr int32_t kSampleRate = 48000;
+    constexpr int32_t kChannelCount = 2;
+    constexpr int32_t kFramesPerBuffer = 192;
+    constexpr float kGain = 0.5f;
+
+    const char *getFormatName(float) { return "float"; }
+    const char *getFormatName(int16_t) { return "int16"; }
+    const char *getFormatName(int8_t) { return "int8"; }
+
+    // The same rounding the loaders use
+    template<typename Sample>
+    Sample convert(float value) {
+        if constexpr (std::is_same_v<Sample, float>) {
+            return value;
+        } else {
+            constexpr float scale = std::is_same_v<Sample, int16_t> ? 32768.0f : 128.0f;
+            return static_cast<Sample>(std::clamp(std::lround(value * scale), -static_cast<long>(scale), static_cast<long>(scale) - 1));
+        }
+    }
+
+    template<typename Sample>
+    float toFloat(Sample sample) {
+        if constexpr (std::is_same_v<Sample, float>) {
+            return sample;
+        } else {
+            return static_cast<float>(sample) / (std::is_same_v<Sample, int16_t> ? 32768.0f : 128.0f);
+        }
+    }
+
+    float sineSample(size_t sampleIndex) {
+        return static_cast<float>(std::sin(2 * M_PI * 1000 * static_cast<double>(sampleIndex / kChannelCount) / kSampleRate));
+    }
+
+    template<typename Sample>
+    double getSignalToNoiseDb(const std::vector<Sample> &samples) {
+        double signal = 0;
+        double noise = 0;
+        for (size_t i = 0; i < samples.size(); ++i) {
+            const double expected = sineSample(i);
+            const double error = toFloat(samples[i]) - expected;
+            signal += expected * expected;
+            noise += error * error;
+        }
+        return noise == 0 ? INFINITY : 10 * std::log10(signal / noise);
+    }
+
+    template<typename Sample>
+    void runFormat() {
+        std::vector<Sample> sound(static_cast<size_t>(kSampleRate * kChannelCount));
+        for (size_t i = 0; i < sound.size(); ++i) {
+            sound[i] = convert<Sample>(sineSample(i));
+        }
+        const double residentKb = static_cast<double>(sound.size() * sizeof(Sample)) / 1024;
+        const double signalToNoiseDb = getSignalToNoiseDb(sound);
+
+        for (const int32_t playerCount: {1, 16, 64, 256}) {
+            // Every player has a sound of its own, so the larger counts no longer fit in the caches
+            const std::vector<std::vector<Sample>> sounds(static_cast<size_t>(playerCount), sound);
+            std::vector<float> output(kFramesPerBuffer * kChannelCount);
+
+            const double seconds = measureFastestSeconds([&] {
+                for (int32_t frame = 0; frame + kFramesPerBuffer <= kSampleRate; frame += kFramesPerBuffer) {
+                    std::fill(output.begin(), output.end(), 0.0f);
+                    for (const auto &player: sounds) {
+                        mixWithGain(output.data(), player.data() + frame * kChannelCount, kFramesPerBuffer * kChannelCount, kGain);
+                    }
+                    doNotOptimize(output.data());
+                }
+            });
+
+            std::printf("%-7s %8d %14.0f %15.1f %12.2f %10.0fx %8.1f\n", getFormatName(Sample()), playerCount, residentKb,
+                        residentKb * playerCount / 1024, seconds * 1e6 / (kSampleRate / kFramesPerBuffer), 1 / seconds, signalToNoiseDb);
+        }
+    }
+}
+
+int main() {
+    std::printf("%-7s %8s %14s %15s %12s %11s %8s\n", "format", "players", "KB per second", "MB all players", "us/buffer", "realtime", "SNR dB");
+    runFormat<float>();
+    runFormat<int16_t>();
+    runFormat<int8_t>();
+    return 0;
+}
@@ -0,0 +1,44 @@
+#ifndef AUDIOPLAYBACK_AUDIOCOMMAND_H
+#define AUDIOPLAYBACK_AUDIOCOMMAND_H
+
+#include <cstdint>
+
+class Player;
+
+enum class AudioCommandType {
+    addPlayer, removePlayer, removeAllPlayers, setPlaying, setLooping, seekTo, setVolume, trigger,
+    // Plays or pauses at the frame in intValue, see Player::schedulePlaying
+    schedulePlaying,
+    // Fade to floatValue over intValue milliseconds, stopping at the end with boolValue
+    fadeLinear, fadeExponential,
+    // Move the player to the bus in intValue
+    setPlayerBus,
+    // Gain in floatValue or mute in boolValue for the bus in intValue
+    setBusGain, setBusMuted,
+    setLimiterEnabled,
+    // Pan or playback rate of the primary voice in floatValue
+    setPan, setPlaybackRate,
+    // Remove every marker of the player, or add one at the time in milliseconds in intValue
+    clearMarkers, addMarker,
+    // Swap player for replacement, which continues where player left off, see Player::takeStateFrom
+    replacePlayer
+};
+
+/**
+ * A request from a control thread that is applied by the audio thread at the start of the next
+ * buffer. Commands are trivially copyable so they can live inside a preallocated SpscQueue.
+ */
+struct AudioCommand {
+    AudioCommandType type;
+    Player *player;
+    bool boolValue;
+    float floatValue;
+    int64_t intValue;
+    // Only used by trigger, which takes the volume in floatValue
+    float pan;
+    float playbackRate;
+    // Only used by replacePlayer
+    Player *replacement;
+};
+
+#endif //AUDIOPLAYBACK_AUDIOCOMMAND_H
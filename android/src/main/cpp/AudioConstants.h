@@ -8,6 +8,10 @@
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <vector>
+
+// Handle of a loaded sound, see HandleTable. Always positive.
+using SoundId = int32_t;
 
 struct AudioProperties {
     int32_t channelCount;
@@ -30,9 +34,73 @@ struct CloseAudioStreamResult {
     std::optional<std::string> error;
 };
 
+struct ReconfigureStreamResult {
+    std::optional<std::string> error;
+    // Streamed sounds that can't play on the new stream, they were unloaded
+    std::vector<SoundId> unloadedSoundIds;
+};
+
+struct LoadSoundOptions {
+    // Decode on a background thread while playing instead of keeping the whole sound in memory
+    bool streaming;
+    int32_t readAheadMs;
+    // Used when the sample rate of the sound doesn't match the stream's, see ResamplerQuality. The
+    // lowest quality also plays sounds at other playback rates with linear instead of cubic
+    // interpolation.
+    int resamplerQuality;
+    // How many instances of the sound can overlap, see VoiceStealingPolicy
+    int32_t maxVoices;
+    int voiceStealingPolicy;
+    // How the decoded samples are kept in memory, see SampleFormat. Ignored when streaming.
+    int storageFormat;
+};
+
+struct LoadSoundRequest {
+    int fd;
+    int offset;
+    int length;
+    LoadSoundOptions options;
+};
+
 struct LoadSoundResult {
-    std::optional<std::string> id;
+    std::optional<SoundId> id;
     std::optional<std::string> error;
 };
 
+struct ScheduleSoundRequest {
+    SoundId id;
+    // Start playing, or pause when false
+    bool isPlaying;
+    // A frame of the renderer's timeline, see StreamPosition. Takes precedence over hostTimeNs.
+    std::optional<int64_t> frame;
+    // A CLOCK_MONOTONIC time, converted to a frame with the stream's presentation timestamp
+    std::optional<int64_t> hostTimeNs;
+};
+
+struct TriggerSoundRequest {
+    SoundId id;
+    float volume;
+    // -1 (left) to 1 (right)
+    float pan;
+    // 1 is the original speed and pitch
+    float playbackRate;
+};
+
+struct FadeSoundRequest {
+    SoundId id;
+    float targetVolume;
+    int32_t durationMs;
+    // Stop and rewind the sound once it reaches targetVolume
+    bool stopAtEnd;
+    // 0 is linear, 1 exponential, see GainCurve
+    int curve;
+};
+
+struct StreamPosition {
+    // The next frame that will be rendered
+    int64_t framePosition;
+    // CLOCK_MONOTONIC when framePosition was read
+    int64_t hostTimeNs;
+};
+
 #endif //AUDIOPLAYBACK_AUDIOCONSTANTS_H
@@ -4,21 +4,62 @@
 
 #include "AudioEngine.h"
 #include "utils/logging.h"
-#include "utils/uuid.h"
 
 #include "audio/AAssetDataSource.h"
+#include "audio/MappedWavDataSource.h"
+#include "audio/StreamingDataSource.h"
+#include "audio/WavFile.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
+
+
+AudioEngine::~AudioEngine() {
+    {
+        std::lock_guard<std::mutex> lock(mEventMutex);
+        mIsStoppingEvents = true;
+    }
+    mEventCondition.notify_all();
+    if(mEventThread.joinable()) {
+        mEventThread.join();
+    }
+}
 
 SetupAudioStreamResult AudioEngine::setupAudioStream(
         double sampleRate,
         double channelCount,
         int usage) {
+    std::lock_guard<std::mutex> streamLock(mStreamMutex);
+    std::lock_guard<std::mutex> lock(mControlMutex);
     if(mAudioStream) {
         return { .error =  "Setting up an audio stream while one is already available"};
     }
 
     mDesiredSampleRate = static_cast<int32_t>(sampleRate);
     mDesiredChannelCount = static_cast<int>(channelCount);
+    mUsage = usage;
+
+    oboe::Result result = openStream({.channelCount = mDesiredChannelCount, .sampleRate = mDesiredSampleRate}, usage, mAudioStream);
+
+    if( result != oboe::Result::OK) {
+        auto error = "Failed to open stream:" + std::string (convertToText(result));
+        return { .error = error};
+    } else {
+        // The callback is not running before the stream is started
+        mRenderer.configure({.channelCount = mDesiredChannelCount, .sampleRate = mAudioStream->getSampleRate()});
+        mBufferSizeTuner.configure(mAudioStream->getFramesPerBurst(), mAudioStream->getBufferCapacityInFrames(),
+                                   mAudioStream->getSampleRate());
+        return {.error = std::nullopt};
+    }
+}
 
+oboe::Result AudioEngine::openStream(AudioProperties properties, int usage, std::shared_ptr<oboe::AudioStream> &stream) {
     oboe::AudioStreamBuilder builder {};
 
     builder.setUsage(getUsageFromInt(usage));
@@ -26,24 +67,23 @@ SetupAudioStreamResult AudioEngine::setupAudioStream(
     builder.setFormatConversionAllowed(true);
     builder.setPerformanceMode(oboe::PerformanceMode::LowLatency);
     builder.setSharingMode(oboe::SharingMode::Exclusive);
-    builder.setSampleRate(mDesiredSampleRate);
+    builder.setSampleRate(properties.sampleRate);
     builder.setSampleRateConversionQuality(
             oboe::SampleRateConversionQuality::Medium
     );
-    builder.setChannelCount(mDesiredChannelCount);
+    builder.setChannelCount(properties.channelCount);
     builder.setDataCallback(this);
-    oboe::Result result = builder.openStream(mAudioStream);
-
-    if( result != oboe::Result::OK) {
-        auto error = "Failed to open stream:" + std::string (convertToText(result));
-        return { .error = error};
-    } else {
-        return {.error = std::nullopt};
+    oboe::Result result = builder.openStream(stream);
+    if(result == oboe::Result::OK && stream->getSharingMode() != oboe::SharingMode::Exclusive) {
+        // Plays fine, through the system mixer and with its extra latency
+        LOGW("Asked for an exclusive audio stream but got a shared one");
     }
+    return result;
 }
 
-
 OpenAudioStreamResult AudioEngine::openAudioStream() {
+    std::lock_guard<std::mutex> streamLock(mStreamMutex);
+    std::lock_guard<std::mutex> lock(mControlMutex);
     if(!mAudioStream) {
         return {.error = "There is no audio stream to start" };
     }
@@ -63,6 +103,8 @@ OpenAudioStreamResult AudioEngine::openAudioStream() {
 }
 
 PauseAudioStreamResult AudioEngine::pauseAudioStream() {
+    std::lock_guard<std::mutex> streamLock(mStreamMutex);
+    std::lock_guard<std::mutex> lock(mControlMutex);
     if(!mAudioStream) {
         return {.error = "There is no audio stream to pause" };
     }
@@ -87,6 +129,8 @@ PauseAudioStreamResult AudioEngine::pauseAudioStream() {
 
 
 CloseAudioStreamResult AudioEngine::closeAudioStream() {
+    std::lock_guard<std::mutex> streamLock(mStreamMutex);
+    std::lock_guard<std::mutex> lock(mControlMutex);
     if(!mAudioStream) {
         return { .error = "There is no audio stream to close" };
     }
@@ -102,91 +146,1191 @@ CloseAudioStreamResult AudioEngine::closeAudioStream() {
         return {.error = error};
     }
     mAudioStream = nullptr;
+
+    // Nothing will drain the queue until a new stream starts, so apply what is pending now
+    drainCommandsIfIdle();
     return {.error = std::nullopt};
 }
 
+ReconfigureStreamResult AudioEngine::reconfigureStream(double sampleRate, double channelCount) {
+    std::lock_guard<std::mutex> reconfigureLock(mReconfigureMutex);
+    const AudioProperties targetProperties {
+            .channelCount = static_cast<int>(channelCount),
+            .sampleRate = static_cast<int32_t>(sampleRate)
+    };
+
+    struct Conversion {
+        // Generation tagged, so a slot reused by another sound meanwhile doesn't match
+        SoundId id;
+        // Keeps the samples alive while converting, even if the sound is unloaded meanwhile
+        std::shared_ptr<DataSource> source;
+        LoadSoundOptions options;
+        ConvertPlayerResult result;
+    };
+    // Every sound that doesn't fit the target and has no conversion yet, needs mControlMutex
+    const auto collectConversions = [this, targetProperties](const std::map<SoundId, ConvertPlayerResult> &converted) {
+        std::vector<Conversion> conversions;
+        mSounds.forEach([&](SoundId id, LoadedSound &sound) {
+            if(sound.player && !fitsStream(*sound.player, targetProperties) && converted.count(id) == 0) {
+                conversions.push_back({.id = id, .source = sound.player->getSharedSource(), .options = sound.options});
+            }
+        });
+        return conversions;
+    };
+
+    // Results by sound. A sound evicted and loaded again meanwhile still matches, its samples are
+    // the same.
+    std::map<SoundId, ConvertPlayerResult> converted;
+    std::vector<Conversion> conversions;
+    int usage;
+    {
+        std::lock_guard<std::mutex> lock(mControlMutex);
+        if(!mAudioStream) {
+            return {.error = "There is no audio stream to reconfigure"};
+        }
+        usage = mUsage;
+        conversions = collectConversions(converted);
+    }
+
+    // The old stream stays open until the swap, if it holds the device's only exclusive path the
+    // new one is shared
+    std::shared_ptr<oboe::AudioStream> stream;
+    oboe::Result result = openStream(targetProperties, usage, stream);
+    if(result != oboe::Result::OK) {
+        return {.error = "Failed to open stream:" + std::string(convertToText(result))};
+    }
+
+    // The old stream keeps playing while the decoding threads convert every sound
+    std::mutex conversionMutex;
+    std::condition_variable conversionCondition;
+    size_t remainingConversions = conversions.size();
+    for (auto &conversion: conversions) {
+        mDecodePool.submit([&conversion, &conversionMutex, &conversionCondition, &remainingConversions, targetProperties] {
+            conversion.result = convertPlayer(conversion.source, conversion.options, targetProperties);
+            conversion.source.reset();
+            // Notify while holding the lock, the waiter destroys the condition once it sees zero
+            std::lock_guard<std::mutex> lock(conversionMutex);
+            remainingConversions--;
+            conversionCondition.notify_all();
+        });
+    }
+    {
+        std::unique_lock<std::mutex> lock(conversionMutex);
+        conversionCondition.wait(lock, [&remainingConversions] { return remainingConversions == 0; });
+    }
+    for (auto &conversion: conversions) {
+        converted[conversion.id] = std::move(conversion.result);
+    }
+
+    // Starting, pausing and closing wait until the new stream has taken over
+    std::lock_guard<std::mutex> streamLock(mStreamMutex);
+    std::shared_ptr<oboe::AudioStream> oldStream;
+    {
+        std::lock_guard<std::mutex> lock(mControlMutex);
+        oldStream = mAudioStream;
+    }
+    if(!oldStream) {
+        stream->close();
+        return {.error = "The audio stream was closed while it was being reconfigured"};
+    }
+    const auto streamState = oldStream->getState();
+    const bool wasRunning = streamState == oboe::StreamState::Starting || streamState == oboe::StreamState::Started;
+
+    // Sounds loaded for the old stream while converting are converted unlocked too, until nothing
+    // is left and the results can be swapped in with the lock held only briefly
+    std::unique_lock<std::mutex> lock(mControlMutex);
+    const auto convertLoadedMeanwhile = [&] {
+        while(true) {
+            conversions = collectConversions(converted);
+            if(conversions.empty()) break;
+
+            lock.unlock();
+            for (auto &conversion: conversions) {
+                converted[conversion.id] = convertPlayer(conversion.source, conversion.options, targetProperties);
+            }
+            conversions.clear();
+            lock.lock();
+        }
+    };
+    // The old stream keeps playing through this
+    convertLoadedMeanwhile();
+
+    // Stopped right before the swap, nothing renders until the new stream starts. Stopping waits
+    // for the callback to return, which is no reason to keep the other control calls waiting too,
+    // and anything they loaded meanwhile is converted after.
+    lock.unlock();
+    oldStream->stop();
+    lock.lock();
+    convertLoadedMeanwhile();
+
+    std::vector<AudioCommand> commands;
+    std::vector<SoundId> unloadedSoundIds;
+
+    // Every player on the audio thread is retired at once, which needs room in the reaper
+    const int64_t pendingPlayerCount = mRenderer.getReclamationStats().pendingCount;
+    if(pendingPlayerCount + static_cast<int64_t>(mResidentPlayerCount) > static_cast<int64_t>(kMaxPlayers)) {
+        lock.unlock();
+        stream->close();
+        if(wasRunning) {
+            oldStream->requestStart();
+        }
+        return {.error = "Failed to reconfigure the stream: too many players are still waiting to be freed"};
+    }
+
+    mAudioStream = stream;
+    mDesiredSampleRate = targetProperties.sampleRate;
+    mDesiredChannelCount = targetProperties.channelCount;
+    mStreamGeneration++;
+    mRenderer.configure({.channelCount = mDesiredChannelCount, .sampleRate = mAudioStream->getSampleRate()});
+    mBufferSizeTuner.configure(mAudioStream->getFramesPerBurst(), mAudioStream->getBufferCapacityInFrames(),
+                               mAudioStream->getSampleRate());
+
+    // Every replacement is applied in the same buffer, before the new stream renders anything
+    mSounds.forEach([&](SoundId id, LoadedSound &sound) {
+        auto it = converted.find(id);
+        if(!sound.player || it == converted.end()) return;
+
+        if(it->second.error) {
+            LOGW("Unloading sound %d, it can't play on the new stream: %s", id, it->second.error->c_str());
+            unloadedSoundIds.push_back(id);
+            return;
+        }
+
+        Player *replacement = it->second.player.get();
+        replacement->setSoundId(id);
+        commands.push_back({.type = AudioCommandType::replacePlayer, .player = sound.player.release(), .replacement = replacement});
+        sound.player = std::move(it->second.player);
+        publishSound(id, sound);
+        mResidentBytes -= sound.residentBytes;
+        sound.residentBytes = getResidentBytes(*sound.player);
+        mResidentBytes += sound.residentBytes;
+    });
+
+    for (const auto id: unloadedSoundIds) {
+        auto sound = mSounds.remove(id);
+        unpublishSound(id);
+        commands.push_back({.type = AudioCommandType::removePlayer, .player = sound->player.release()});
+        mResidentBytes -= sound->residentBytes;
+        mResidentPlayerCount--;
+    }
+
+    mRenderer.expectRemovedPlayers(static_cast<int64_t>(commands.size()));
+    mRenderer.postCommands(commands.data(), commands.size());
+    enforceMemoryBudget(0);
+    drainCommandsIfIdle();
+    lock.unlock();
+
+    if(wasRunning) {
+        result = stream->requestStart();
+        if(result != oboe::Result::OK) {
+            LOGE("Failed to start the reconfigured stream: %s", convertToText(result));
+        }
+    }
+    oldStream->close();
+    return {.error = std::nullopt, .unloadedSoundIds = unloadedSoundIds};
+}
+
 oboe::DataCallbackResult
 AudioEngine::onAudioReady(oboe::AudioStream *oboeStream, void *audioData, int32_t numFrames) {
-    memset(audioData, 0, sizeof(float) * numFrames * mDesiredChannelCount);
+    const auto start = std::chrono::steady_clock::now();
+    // The stream only counts frames since it was opened while the renderer outlives it
+    mStreamFrameOffset.store(mRenderer.getFramePosition() - oboeStream->getFramesWritten(), std::memory_order_relaxed);
+    mRenderer.render(static_cast<float *>(audioData), numFrames, mDesiredChannelCount);
+    const auto duration = std::chrono::steady_clock::now() - start;
 
-    for (const auto& player: mPlayers) {
-        player.second->renderAudio(static_cast<float *>(audioData), numFrames);
-    }
+    mCallbackMonitor.record(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(),
+            numFrames,
+            oboeStream->getSampleRate(),
+            mRenderer.getActivePlayerCount());
 
+    // Changing the buffer size from the callback is how Oboe's own LatencyTuner does it, AAudio
+    // applies it without blocking
+    const int32_t xRunCount = getXRunCount(oboeStream);
+    const int32_t bufferSize = oboeStream->getBufferSizeInFrames();
+    const int32_t targetBufferSize = mBufferSizeTuner.update(xRunCount, numFrames, bufferSize);
+    if(targetBufferSize != bufferSize) {
+        auto result = oboeStream->setBufferSizeInFrames(targetBufferSize);
+        if(result) {
+            mBufferSizeTuner.recordChange(result.value(), mRenderer.getFramePosition(), xRunCount);
+        }
+    }
     return oboe::DataCallbackResult::Continue;
 }
 
-void AudioEngine::playSounds(const std::vector<std::pair<std::string, bool>>& pairs) {
+int32_t AudioEngine::getXRunCount(oboe::AudioStream *stream) {
+    if(!stream->isXRunCountSupported()) return -1;
+
+    auto result = stream->getXRunCount();
+    return result ? result.value() : -1;
+}
+
+void AudioEngine::playSounds(const std::vector<std::pair<SoundId, bool>>& pairs) {
+    std::lock_guard<std::mutex> lock(mControlMutex);
     for (const auto& pair: pairs) {
-        auto it = mPlayers.find(pair.first);
-        if(it != mPlayers.end()) {
-            it->second->setPlaying(pair.second);
+        LoadedSound *sound = mSounds.get(pair.first);
+        if(!sound) continue;
+
+        if(sound->player) {
+            postSoundCommand(*sound, {.type = AudioCommandType::setPlaying, .player = sound->player.get(), .boolValue = pair.second}, true);
+        } else {
+            sound->playWhenReloaded = pair.second;
+            if(pair.second) reloadSound(pair.first, *sound);
         }
     }
+    drainCommandsIfIdle();
 }
 
-void AudioEngine::loopSounds(const std::vector<std::pair<std::string, bool>>& pairs) {
+void AudioEngine::loopSounds(const std::vector<std::pair<SoundId, bool>>& pairs) {
+    std::lock_guard<std::mutex> lock(mControlMutex);
     for (const auto& pair: pairs) {
-        auto it = mPlayers.find(pair.first);
-        if(it != mPlayers.end()) {
-            it->second->setLooping(pair.second);
+        LoadedSound *sound = mSounds.get(pair.first);
+        if(!sound) continue;
+
+        sound->isLooping = pair.second;
+        if(sound->player) {
+            postSoundCommand(*sound, {.type = AudioCommandType::setLooping, .player = sound->player.get(), .boolValue = pair.second}, false);
         }
     }
+    drainCommandsIfIdle();
 }
 
-void AudioEngine::seekSoundsTo(const std::vector<std::pair<std::string, double>> & pairs) {
+void AudioEngine::seekSoundsTo(const std::vector<std::pair<SoundId, double>> & pairs) {
+    std::lock_guard<std::mutex> lock(mControlMutex);
     for (const auto& pair: pairs) {
-        auto it = mPlayers.find(pair.first);
-        if(it != mPlayers.end()) {
-            it->second->seekTo(static_cast<int64_t>(pair.second));
+        LoadedSound *sound = mSounds.get(pair.first);
+        if(!sound) continue;
+
+        if(sound->player) {
+            postSoundCommand(*sound, {.type = AudioCommandType::seekTo, .player = sound->player.get(), .intValue = static_cast<int64_t>(pair.second)}, true);
+        } else {
+            sound->seekWhenReloaded = static_cast<int64_t>(pair.second);
+            publishSound(pair.first, *sound);
         }
     }
+    drainCommandsIfIdle();
 }
 
-void AudioEngine::setSoundsVolume(const std::vector<std::pair<std::string, double>> & pairs) {
+void AudioEngine::setSoundsVolume(const std::vector<std::pair<SoundId, double>> & pairs) {
+    std::lock_guard<std::mutex> lock(mControlMutex);
     for (const auto& pair: pairs) {
-        auto it = mPlayers.find(pair.first);
-        if(it != mPlayers.end()) {
-            it->second->setVolume(static_cast<float >(pair.second));
+        LoadedSound *sound = mSounds.get(pair.first);
+        if(!sound) continue;
+
+        sound->volume = static_cast<float>(pair.second);
+        if(sound->player) {
+            postSoundCommand(*sound, {.type = AudioCommandType::setVolume, .player = sound->player.get(), .floatValue = sound->volume}, false);
         }
     }
+    drainCommandsIfIdle();
 }
 
+void AudioEngine::triggerSounds(const std::vector<TriggerSoundRequest> &requests) {
+    std::lock_guard<std::mutex> lock(mControlMutex);
+    for (const auto &request: requests) {
+        LoadedSound *sound = mSounds.get(request.id);
+        if(!sound) continue;
+
+        // With a single voice, triggering restarts the primary voice with the new parameters
+        if(sound->options.streaming || sound->options.maxVoices <= 1) {
+            sound->volume = request.volume;
+            sound->pan = request.pan;
+            sound->playbackRate = request.playbackRate;
+        }
 
-LoadSoundResult AudioEngine::loadSound(int fd, int offset, int length) {
-    auto playersSize = mPlayers.size();
+        if(sound->player) {
+            postSoundCommand(*sound, {.type = AudioCommandType::trigger, .player = sound->player.get(), .floatValue = request.volume,
+                                      .pan = request.pan, .playbackRate = request.playbackRate}, true);
+        } else {
+            sound->triggerWhenReloaded = request;
+            reloadSound(request.id, *sound);
+        }
+    }
+    drainCommandsIfIdle();
+}
 
-    LOGD("Loading audio with already %d sounds loaded", playersSize);
+void AudioEngine::setSoundsPan(const std::vector<std::pair<SoundId, double>> &pairs) {
+    std::lock_guard<std::mutex> lock(mControlMutex);
+    for (const auto &pair: pairs) {
+        LoadedSound *sound = mSounds.get(pair.first);
+        if(!sound) continue;
 
-    AudioProperties targetProperties {
-            .channelCount = mDesiredChannelCount,
-            .sampleRate = mDesiredSampleRate
+        sound->pan = static_cast<float>(pair.second);
+        if(sound->player) {
+            postSoundCommand(*sound, {.type = AudioCommandType::setPan, .player = sound->player.get(), .floatValue = sound->pan}, false);
+        }
+    }
+    drainCommandsIfIdle();
+}
+
+void AudioEngine::setSoundsPlaybackRate(const std::vector<std::pair<SoundId, double>> &pairs) {
+    std::lock_guard<std::mutex> lock(mControlMutex);
+    for (const auto &pair: pairs) {
+        LoadedSound *sound = mSounds.get(pair.first);
+        if(!sound) continue;
+
+        sound->playbackRate = static_cast<float>(pair.second);
+        if(sound->player) {
+            postSoundCommand(*sound, {.type = AudioCommandType::setPlaybackRate, .player = sound->player.get(), .floatValue = sound->playbackRate}, false);
+        }
+    }
+    drainCommandsIfIdle();
+}
+
+void AudioEngine::scheduleSounds(const std::vector<ScheduleSoundRequest> &requests) {
+    std::lock_guard<std::mutex> lock(mControlMutex);
+    for (const auto &request: requests) {
+        LoadedSound *sound = mSounds.get(request.id);
+        if(!sound) continue;
+
+        const int64_t framePosition = mRenderer.getFramePosition();
+        int64_t frame = framePosition;
+        if(request.frame) {
+            frame = *request.frame;
+        } else if(request.hostTimeNs) {
+            frame = getFrameForHostTime(*request.hostTimeNs);
+        }
+
+        // Events before the next buffer were applied by the buffers already rendered
+        auto &pending = sound->scheduledFrames;
+        pending.erase(std::remove_if(pending.begin(), pending.end(), [framePosition](int64_t pendingFrame) {
+            return pendingFrame < framePosition;
+        }), pending.end());
+        if(pending.size() >= Player::kMaxScheduledEvents) {
+            LOGW("Not scheduling sound %d at frame %lld, it already has %zu scheduled events pending",
+                 request.id, static_cast<long long>(frame), Player::kMaxScheduledEvents);
+            continue;
+        }
+        // Past frames apply with the next buffer
+        pending.push_back(std::max(frame, framePosition));
+
+        if(sound->player) {
+            postSoundCommand(*sound, {.type = AudioCommandType::schedulePlaying, .player = sound->player.get(), .boolValue = request.isPlaying, .intValue = frame}, true);
+        } else {
+            // The reload may finish after the frame, the sound then starts late rather than never
+            sound->scheduleWhenReloaded.emplace_back(frame, request.isPlaying);
+            if(request.isPlaying) reloadSound(request.id, *sound);
+        }
+    }
+    drainCommandsIfIdle();
+}
+
+void AudioEngine::fadeSounds(const std::vector<FadeSoundRequest> &requests) {
+    std::lock_guard<std::mutex> lock(mControlMutex);
+    for (const auto &request: requests) {
+        LoadedSound *sound = mSounds.get(request.id);
+        if(!sound) continue;
+
+        sound->volume = request.targetVolume;
+        if(sound->player) {
+            const auto type = request.curve == 1 ? AudioCommandType::fadeExponential : AudioCommandType::fadeLinear;
+            postSoundCommand(*sound, {.type = type, .player = sound->player.get(), .boolValue = request.stopAtEnd, .floatValue = request.targetVolume, .intValue = request.durationMs}, true);
+        } else if(request.stopAtEnd) {
+            // Nothing is audible yet, stopping just means not starting once reloaded
+            sound->playWhenReloaded = false;
+            sound->triggerWhenReloaded.reset();
+        }
+    }
+    drainCommandsIfIdle();
+}
+
+void AudioEngine::setSoundsBus(const std::vector<std::pair<SoundId, std::string>> &pairs) {
+    std::lock_guard<std::mutex> lock(mControlMutex);
+    for (const auto &pair: pairs) {
+        LoadedSound *sound = mSounds.get(pair.first);
+        if(!sound) continue;
+
+        auto bus = getOrAddBus(pair.second);
+        if(!bus) {
+            LOGW("Can't add the bus %s, there are already %d buses", pair.second.c_str(), AudioRenderer::kMaxBuses);
+            continue;
+        }
+        sound->bus = *bus;
+        if(sound->player) {
+            postSoundCommand(*sound, {.type = AudioCommandType::setPlayerBus, .player = sound->player.get(), .intValue = sound->bus}, false);
+        }
+    }
+    drainCommandsIfIdle();
+}
+
+void AudioEngine::setBusesGain(const std::vector<std::pair<std::string, double>> &pairs) {
+    std::lock_guard<std::mutex> lock(mControlMutex);
+    for (const auto &pair: pairs) {
+        auto bus = getOrAddBus(pair.first);
+        if(!bus) continue;
+        postCommand({.type = AudioCommandType::setBusGain, .floatValue = static_cast<float>(pair.second), .intValue = *bus});
+    }
+    drainCommandsIfIdle();
+}
+
+void AudioEngine::setBusesMuted(const std::vector<std::pair<std::string, bool>> &pairs) {
+    std::lock_guard<std::mutex> lock(mControlMutex);
+    for (const auto &pair: pairs) {
+        auto bus = getOrAddBus(pair.first);
+        if(!bus) continue;
+        postCommand({.type = AudioCommandType::setBusMuted, .boolValue = pair.second, .intValue = *bus});
+    }
+    drainCommandsIfIdle();
+}
+
+void AudioEngine::setLimiterEnabled(bool enabled) {
+    std::lock_guard<std::mutex> lock(mControlMutex);
+    postCommand({.type = AudioCommandType::setLimiterEnabled, .boolValue = enabled});
+    drainCommandsIfIdle();
+}
+
+void AudioEngine::setLatencyTuning(const BufferSizeTunerOptions &options) {
+    // Read by the audio thread on its next callback
+    mBufferSizeTuner.setOptions(options);
+}
+
+std::optional<int32_t> AudioEngine::getOrAddBus(const std::string &name) {
+    auto it = std::find(mBusNames.begin(), mBusNames.end(), name);
+    if(it != mBusNames.end()) {
+        return static_cast<int32_t>(it - mBusNames.begin());
+    }
+    if(mBusNames.size() >= AudioRenderer::kMaxBuses) {
+        return std::nullopt;
+    }
+    mBusNames.push_back(name);
+    return static_cast<int32_t>(mBusNames.size() - 1);
+}
+
+StreamPosition AudioEngine::getStreamPosition() {
+    timespec now {};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return {
+        .framePosition = mRenderer.getFramePosition(),
+        .hostTimeNs = static_cast<int64_t>(now.tv_sec) * kNanosPerSecond + now.tv_nsec
     };
+}
+
+std::vector<double> AudioEngine::getSoundsPosition(const std::vector<SoundId> &ids) {
+    // Polled every frame by the UI, so it reads what was published instead of waiting for the
+    // control lock behind loads and stream changes
+    const auto guard = mRenderer.guardPlayerReads();
+    const int32_t latencyFrames = mRenderer.getLatencyFrames();
+    std::vector<double> positions;
+    positions.reserve(ids.size());
+    for (const auto id: ids) {
+        const size_t index = HandleTable<LoadedSound>::getIndex(id);
+        if(id <= 0 || index >= mPublishedSounds.size() || mPublishedSounds[index].id.load() != id) {
+            positions.push_back(-1);
+            continue;
+        }
+
+        const PublishedSound &published = mPublishedSounds[index];
+        const Player *player = published.player.load();
+        const int64_t evictedPositionMs = published.evictedPositionMs.load();
+        // Unloaded while reading, the player may belong to whatever took the slot
+        if(published.id.load() != id) {
+            positions.push_back(-1);
+        } else if(player) {
+            positions.push_back(player->getPositionMs(latencyFrames));
+        } else {
+            // Only rewound sounds are evicted
+            positions.push_back(static_cast<double>(evictedPositionMs));
+        }
+    }
+    return positions;
+}
+
+void AudioEngine::publishSound(SoundId id, const LoadedSound &sound) {
+    PublishedSound &published = mPublishedSounds[HandleTable<LoadedSound>::getIndex(id)];
+    published.player.store(sound.player.get());
+    published.evictedPositionMs.store(sound.seekWhenReloaded.value_or(0));
+    published.id.store(id);
+}
+
+void AudioEngine::unpublishSound(SoundId id) {
+    PublishedSound &published = mPublishedSounds[HandleTable<LoadedSound>::getIndex(id)];
+    published.id.store(0);
+    published.player.store(nullptr);
+}
+
+void AudioEngine::setSoundsMarkers(const std::vector<std::pair<SoundId, std::vector<double>>> &pairs) {
+    std::lock_guard<std::mutex> lock(mControlMutex);
+    for (const auto &[id, times]: pairs) {
+        LoadedSound *sound = mSounds.get(id);
+        if(!sound) continue;
+
+        sound->markers.clear();
+        for (const auto time: times) {
+            sound->markers.push_back(static_cast<int64_t>(time));
+        }
+        if(sound->player) {
+            postMarkerCommands(sound->player.get(), sound->markers);
+        }
+    }
+    drainCommandsIfIdle();
+}
+
+void AudioEngine::postMarkerCommands(Player *player, const std::vector<int64_t> &markers) {
+    // All at once so that no buffer is rendered with only part of the markers
+    std::vector<AudioCommand> commands;
+    commands.reserve(markers.size() + 1);
+    commands.push_back({.type = AudioCommandType::clearMarkers, .player = player});
+    for (const auto time: markers) {
+        commands.push_back({.type = AudioCommandType::addMarker, .player = player, .intValue = time});
+    }
+    mRenderer.postCommands(commands.data(), commands.size());
+}
+
+void AudioEngine::setPlaybackEventsCallback(std::function<void(const std::vector<PlaybackEvent>&)> callback) {
+    auto sharedCallback = callback
+            ? std::make_shared<const std::function<void(const std::vector<PlaybackEvent>&)>>(std::move(callback))
+            : nullptr;
+    std::lock_guard<std::mutex> lock(mEventMutex);
+    // The old callback is released after the lock, or by the batch that is still using it
+    mEventCallback.swap(sharedCallback);
+    if(!mEventThread.joinable()) {
+        mEventThread = std::thread(&AudioEngine::dispatchEvents, this);
+    }
+}
+
+void AudioEngine::dispatchEvents() {
+    std::vector<PlaybackEvent> buffer(kEventQueueCapacity);
+    std::vector<PlaybackEvent> events;
+    events.reserve(kEventQueueCapacity);
+    int64_t droppedEventCount = 0;
+
+    while (true) {
+        std::shared_ptr<const std::function<void(const std::vector<PlaybackEvent>&)>> callback;
+        {
+            std::unique_lock<std::mutex> lock(mEventMutex);
+            // The audio thread can't wake us without risking a blocking call, so check on a timer
+            mEventCondition.wait_for(lock, kEventDispatchInterval, [this] { return mIsStoppingEvents; });
+            if(mIsStoppingEvents) return;
+            callback = mEventCallback;
+        }
+
+        // Only this thread takes events, and the callback runs unlocked so that a slow listener
+        // never holds up setPlaybackEventsCallback or the destructor
+        events.clear();
+        size_t taken;
+        while ((taken = mRenderer.takeEvents(buffer.data(), buffer.size())) > 0) {
+            events.insert(events.end(), buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(taken));
+        }
+
+        const int64_t dropped = mRenderer.getDroppedEventCount();
+        if(callback && dropped != droppedEventCount) {
+            LOGW("Dropped %lld playback events, the event queue was full", static_cast<long long>(dropped - droppedEventCount));
+        }
+        droppedEventCount = dropped;
+
+        if(events.empty() || !callback) continue;
+        (*callback)(events);
+    }
+}
+
+int64_t AudioEngine::getFrameForHostTime(int64_t hostTimeNs) {
+    if(!mAudioStream) return mRenderer.getFramePosition();
+
+    // The frame at the timestamp was being presented at that time, so frames rendered later in the
+    // same stream are presented at the same rate after it
+    auto timestamp = mAudioStream->getTimestamp(CLOCK_MONOTONIC);
+    if(!timestamp) return mRenderer.getFramePosition();
+
+    const int64_t framesAfterTimestamp = static_cast<int64_t>(
+            static_cast<double>(hostTimeNs - timestamp.value().timestamp) * mAudioStream->getSampleRate() / kNanosPerSecond);
+    // The limiter holds every rendered frame back before it reaches the stream, render it that much earlier
+    return timestamp.value().position + framesAfterTimestamp + mStreamFrameOffset.load(std::memory_order_relaxed)
+           - mRenderer.getLatencyFrames();
+}
 
+LoadSoundResult AudioEngine::loadSound(int fd, int offset, int length, LoadSoundOptions options) {
+    {
+        std::lock_guard<std::mutex> lock(mControlMutex);
+        if(!canAddPlayers(1)) {
+            return {.id = std::nullopt, .error = "Failed to load sound: the maximum number of loaded sounds has been reached"};
+        }
+    }
 
-    auto compressedAssetResult = AAssetDataSource::newFromCompressedAsset(fd, offset, length, targetProperties);
+    auto decoded = decodeSound(fd, offset, length, options, nullptr);
+    if(decoded.error) {
+        return {.id = std::nullopt, .error = decoded.error};
+    }
 
-    if(compressedAssetResult.error) {
-        return {.id = std::nullopt, .error = compressedAssetResult.error};
-    } else if(compressedAssetResult.dataSource == nullptr) {
-        return {.id = std::nullopt, .error = "An unknown error occurred while loading the audio file. Please create an issue with a reproducible"};
+    // Decoding happens outside of the lock, so check the limit again before publishing
+    std::lock_guard<std::mutex> lock(mControlMutex);
+    adaptToStream(decoded, options);
+    if(decoded.error) {
+        return {.id = std::nullopt, .error = decoded.error};
+    }
+    if(!canAddPlayers(1)) {
+        return {.id = std::nullopt, .error = "Failed to load sound: the maximum number of loaded sounds has been reached"};
     }
 
-    std::string id = uuid::generate_uuid_v4();
-    mPlayers[id] = std::make_unique<Player>(compressedAssetResult.dataSource);
+    std::vector<AudioCommand> commands;
+    SoundId id = addSound(std::move(decoded), offset, length, options, commands);
+    mRenderer.postCommands(commands.data(), commands.size());
+    enforceMemoryBudget(id);
+    drainCommandsIfIdle();
     return {.id = id, .error = std::nullopt};
 }
 
-void AudioEngine::unloadSounds(const std::optional<std::vector<std::string>> &ids)  {
+void AudioEngine::loadSounds(int32_t requestId, std::vector<LoadSoundRequest> requests, LoadSoundsCallbacks callbacks) {
+    if(requests.empty()) {
+        callbacks.onComplete({});
+        return;
+    }
+
+    auto batch = std::make_shared<LoadSoundsBatch>();
+    batch->requestId = requestId;
+    batch->requests = std::move(requests);
+    batch->callbacks = std::move(callbacks);
+    batch->decoded.resize(batch->requests.size());
+    batch->remaining.store(batch->requests.size());
+
+    {
+        std::lock_guard<std::mutex> lock(mLoadMutex);
+        mLoadBatches[requestId] = batch;
+    }
+
+    for (size_t i = 0; i < batch->requests.size(); ++i) {
+        mDecodePool.submit([this, batch, i] { decodeBatchSound(batch, i); });
+    }
+}
+
+void AudioEngine::cancelLoadSounds(int32_t requestId) {
+    std::lock_guard<std::mutex> lock(mLoadMutex);
+    auto it = mLoadBatches.find(requestId);
+    if(it != mLoadBatches.end()) {
+        if(auto batch = it->second.lock()) {
+            batch->cancelled.store(true);
+        }
+    }
+}
+
+void AudioEngine::decodeBatchSound(const std::shared_ptr<LoadSoundsBatch> &batch, size_t index) {
+    const LoadSoundRequest &request = batch->requests[index];
+    DecodeSoundResult &decoded = batch->decoded[index];
+
+    bool hasRoom;
+    {
+        std::lock_guard<std::mutex> lock(mControlMutex);
+        hasRoom = canAddPlayers(1);
+    }
+
+    if(batch->cancelled.load()) {
+        decoded.error = "Loading the sound was cancelled";
+    } else if(!hasRoom) {
+        decoded.error = "Failed to load sound: the maximum number of loaded sounds has been reached";
+    } else if(request.fd < 0) {
+        decoded.error = "Failed to load sound file";
+    } else {
+        decoded = decodeSound(request.fd, request.offset, request.length, request.options, &batch->cancelled);
+    }
+
+    if(request.fd >= 0 && close(request.fd) == -1) {
+        LOGE("Error closing file descriptor: %s", strerror(errno));
+    }
+
+    batch->callbacks.onProgress(index, decoded.error);
+
+    if(batch->remaining.fetch_sub(1) == 1) {
+        finishLoadSounds(batch);
+    }
+}
+
+void AudioEngine::finishLoadSounds(const std::shared_ptr<LoadSoundsBatch> &batch) {
+    {
+        std::lock_guard<std::mutex> lock(mLoadMutex);
+        auto it = mLoadBatches.find(batch->requestId);
+        if(it != mLoadBatches.end() && it->second.lock() == batch) {
+            mLoadBatches.erase(it);
+        }
+    }
+
+    std::vector<LoadSoundResult> results(batch->decoded.size());
+    if(batch->cancelled.load()) {
+        for (auto &result: results) {
+            result.error = "Loading the sound was cancelled";
+        }
+        batch->callbacks.onComplete(results);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mControlMutex);
+        size_t playerCount = 0;
+        for (size_t i = 0; i < batch->decoded.size(); ++i) {
+            adaptToStream(batch->decoded[i], batch->requests[i].options);
+            if(batch->decoded[i].player) playerCount++;
+        }
+
+        if(!canAddPlayers(playerCount)) {
+            for (size_t i = 0; i < results.size(); ++i) {
+                results[i].error = batch->decoded[i].error.value_or(
+                        "Failed to load sound: the maximum number of loaded sounds has been reached");
+            }
+        } else {
+            // Hand every player to the audio thread in one go, so they all start being rendered
+            // in the same buffer
+            std::vector<AudioCommand> commands;
+            commands.reserve(playerCount);
+            for (size_t i = 0; i < results.size(); ++i) {
+                auto &decoded = batch->decoded[i];
+                if(decoded.player) {
+                    const auto &request = batch->requests[i];
+                    results[i].id = addSound(std::move(decoded), request.offset, request.length, request.options, commands);
+                } else {
+                    results[i].error = decoded.error;
+                }
+            }
+            mRenderer.postCommands(commands.data(), commands.size());
+            enforceMemoryBudget(0);
+            drainCommandsIfIdle();
+        }
+    }
+
+    batch->callbacks.onComplete(results);
+}
+
+AudioEngine::DecodeSoundResult AudioEngine::decodeSound(int fd, int offset, int length, const LoadSoundOptions &options,
+                                                        const std::atomic<bool> *cancelled) {
+    AudioProperties targetProperties {};
+    std::shared_ptr<PcmCache> pcmCache;
+    bool pcmCacheStoresFloat;
+    bool keepFileForReload;
+    uint32_t streamGeneration;
+    {
+        std::lock_guard<std::mutex> lock(mControlMutex);
+        LOGD("Loading audio with already %zu sounds loaded", mSounds.size());
+
+        targetProperties = {
+                .channelCount = mDesiredChannelCount,
+                .sampleRate = mDesiredSampleRate
+        };
+        streamGeneration = mStreamGeneration;
+        pcmCache = mPcmCache;
+        pcmCacheStoresFloat = mPcmCacheStoresFloat;
+        // Streamed sounds hold next to nothing in memory and are never evicted
+        keepFileForReload = mMemoryBudget > 0 && !options.streaming;
+    }
+
+
+    DataSource *dataSource = nullptr;
+    std::optional<std::string> error;
+    const bool isWav = !options.streaming && isWavFile(fd, offset, length);
+    if(options.streaming) {
+        auto streamingResult = StreamingDataSource::newFromCompressedAsset(fd, offset, length, targetProperties, options.readAheadMs);
+        dataSource = streamingResult.dataSource;
+        error = streamingResult.error;
+    } else if(isWav) {
+        // Uncompressed files that already match the stream are played from the file itself
+        auto wavResult = MappedWavDataSource::newFromFileDescriptor(fd, offset, length, targetProperties);
+        if(wavResult.error) {
+            LOGD("Decoding WAV file instead of mapping it: %s", wavResult.error->c_str());
+        }
+        dataSource = wavResult.dataSource;
+    }
+
+    if(dataSource == nullptr && !options.streaming) {
+        const SampleFormat storageFormat = getSampleFormatFromInt(options.storageFormat);
+        // Half the disk space, and converting back on a hit still beats decoding
+        const SampleFormat cacheFormat = storageFormat == SampleFormat::float32 && !pcmCacheStoresFloat
+                ? SampleFormat::int16
+                : storageFormat;
+        std::optional<PcmCacheKey> cacheKey;
+        // WAV files decode about as fast as a cache entry is read, caching them only takes space
+        if(pcmCache && !isWav) {
+            cacheKey = PcmCache::makeKey(fd, offset, length, targetProperties, options.resamplerQuality, cacheFormat);
+            if(cacheKey) {
+                if(auto cachedPcm = pcmCache->lookup(*cacheKey)) {
+                    dataSource = AAssetDataSource::newFromCachedPcm(std::move(*cachedPcm), storageFormat);
+                }
+            }
+        }
+
+        if(dataSource == nullptr) {
+            auto compressedAssetResult = AAssetDataSource::newFromCompressedAsset(
+                    fd, offset, length, targetProperties,
+                    Resampler::getQualityFromInt(options.resamplerQuality),
+                    storageFormat,
+                    cancelled);
+            dataSource = compressedAssetResult.dataSource;
+            error = compressedAssetResult.error;
+
+            if(!error && dataSource && cacheKey) {
+                pcmCache->store(*cacheKey, dataSource->getSamples(), dataSource->getSampleFormat(), dataSource->getSize(),
+                                dataSource->getProperties());
+            }
+        }
+    }
+
+    if(error) {
+        return {.player = nullptr, .error = error};
+    } else if(dataSource == nullptr) {
+        return {.player = nullptr, .error = "An unknown error occurred while loading the audio file. Please create an issue with a reproducible"};
+    }
+
+    auto player = std::make_unique<Player>(
+            dataSource,
+            targetProperties.channelCount,
+            options.maxVoices,
+            getVoiceStealingPolicyFromInt(options.voiceStealingPolicy),
+            getInterpolationFromResamplerQuality(options.resamplerQuality));
+
+    UniqueFd reloadFd;
+    if(keepFileForReload) {
+        reloadFd.reset(dup(fd));
+        if(!reloadFd.isValid()) {
+            LOGW("Failed to keep the sound file open, the sound won't be evicted: %s", strerror(errno));
+        }
+    }
+    return {.player = std::move(player), .error = std::nullopt, .reloadFd = std::move(reloadFd), .streamGeneration = streamGeneration};
+}
+
+AudioEngine::ConvertPlayerResult AudioEngine::convertPlayer(const std::shared_ptr<DataSource> &source, const LoadSoundOptions &options,
+                                                            AudioProperties targetProperties) {
+    const AudioProperties sourceProperties = source->getProperties();
+    std::shared_ptr<DataSource> convertedSource = source;
+    // Mono sources fit any channel count, the player expands them while mixing
+    if(sourceProperties.sampleRate != targetProperties.sampleRate ||
+       (sourceProperties.channelCount != targetProperties.channelCount && sourceProperties.channelCount != 1)) {
+        auto converted = AAssetDataSource::newFromDataSource(
+                *source, targetProperties,
+                Resampler::getQualityFromInt(options.resamplerQuality),
+                getSampleFormatFromInt(options.storageFormat));
+        if(converted.error) {
+            return {.player = nullptr, .error = converted.error};
+        }
+        convertedSource.reset(converted.dataSource);
+    }
+
+    return {
+        .player = std::make_unique<Player>(
+                std::move(convertedSource),
+                targetProperties.channelCount,
+                options.maxVoices,
+                getVoiceStealingPolicyFromInt(options.voiceStealingPolicy),
+                getInterpolationFromResamplerQuality(options.resamplerQuality)),
+        .error = std::nullopt
+    };
+}
+
+bool AudioEngine::fitsStream(const Player &player, AudioProperties properties) {
+    return player.getOutputChannelCount() == properties.channelCount &&
+           player.getSource()->getProperties().sampleRate == properties.sampleRate;
+}
+
+void AudioEngine::adaptToStream(DecodeSoundResult &decoded, const LoadSoundOptions &options) {
+    if(!decoded.player || decoded.streamGeneration == mStreamGeneration) return;
+
+    const AudioProperties properties {.channelCount = mDesiredChannelCount, .sampleRate = mDesiredSampleRate};
+    decoded.streamGeneration = mStreamGeneration;
+    if(fitsStream(*decoded.player, properties)) return;
+
+    auto converted = convertPlayer(decoded.player->getSharedSource(), options, properties);
+    decoded.player = std::move(converted.player);
+    decoded.error = converted.error;
+}
+
+void AudioEngine::unloadSounds(const std::optional<std::vector<SoundId>> &ids)  {
+    std::lock_guard<std::mutex> lock(mControlMutex);
     if(ids.has_value()) {
-        for (const auto & id: ids.value()) {
-            auto player = mPlayers.find(id);
-            if(player != mPlayers.end()) {
-                mPlayers.erase(player);
+        for (const auto id: ids.value()) {
+            auto sound = mSounds.remove(id);
+            if(sound) {
+                unpublishSound(id);
+            }
+            if(sound && sound->player) {
+                // The audio thread owns the player from here on and retires it once removed
+                mRenderer.expectRemovedPlayers(1);
+                postCommand({.type = AudioCommandType::removePlayer, .player = sound->player.release()});
+                mResidentBytes -= sound->residentBytes;
+                mResidentPlayerCount--;
             }
         }
     } else {
-        mPlayers.clear();
+        int64_t removedPlayerCount = 0;
+        mSounds.removeAll([&removedPlayerCount](std::unique_ptr<LoadedSound> sound) {
+            if(sound->player) {
+                sound->player.release();
+                removedPlayerCount++;
+            }
+        });
+        for (auto &published: mPublishedSounds) {
+            published.id.store(0);
+            published.player.store(nullptr);
+        }
+        mRenderer.expectRemovedPlayers(removedPlayerCount);
+        postCommand({.type = AudioCommandType::removeAllPlayers});
+        mResidentBytes = 0;
+        mResidentPlayerCount = 0;
+    }
+    drainCommandsIfIdle();
+}
+
+void AudioEngine::setDecodedCacheDirectory(const std::string &directory) {
+    std::lock_guard<std::mutex> lock(mControlMutex);
+    mPcmCache = std::make_shared<PcmCache>(directory, mPcmCacheMaxBytes);
+}
+
+void AudioEngine::setDecodedCacheOptions(int64_t maxBytes, bool storeFloat) {
+    std::lock_guard<std::mutex> lock(mControlMutex);
+    mPcmCacheMaxBytes = maxBytes;
+    mPcmCacheStoresFloat = storeFloat;
+    if(mPcmCache) {
+        mPcmCache->setMaxBytes(maxBytes);
+    }
+}
+
+EngineStats AudioEngine::getEngineStats() {
+    std::lock_guard<std::mutex> lock(mControlMutex);
+    const int32_t xRunCount = mAudioStream ? getXRunCount(mAudioStream.get()) : -1;
+
+    MemoryBudgetStats memoryBudget = mMemoryBudgetStats;
+    memoryBudget.budgetBytes = mMemoryBudget;
+    memoryBudget.residentBytes = mResidentBytes;
+    memoryBudget.evictedSoundCount = static_cast<int32_t>(mSounds.size() - mResidentPlayerCount);
+
+    return {
+        .callback = mCallbackMonitor.getStats(),
+        .xRunCount = xRunCount,
+        .reclamation = mRenderer.getReclamationStats(),
+        .pcmCache = mPcmCache ? mPcmCache->getStats() : PcmCacheStats {},
+        .memory = getSoundMemoryStats(),
+        .memoryBudget = memoryBudget,
+        .limiterGainReductionDb = std::max(0.0, -20.0 * std::log10(mRenderer.takeLimiterMinGain())),
+        .latency = getLatencyStats()
+    };
+}
+
+LatencyStats AudioEngine::getLatencyStats() {
+    std::array<BufferSizeChange, kBufferSizeHistoryLength> changes {};
+    const size_t changeCount = mBufferSizeTuner.takeHistory(changes.data(), changes.size());
+    mBufferSizeHistory.insert(mBufferSizeHistory.end(), changes.begin(), changes.begin() + changeCount);
+    while(mBufferSizeHistory.size() > kBufferSizeHistoryLength) {
+        mBufferSizeHistory.pop_front();
+    }
+
+    LatencyStats stats {
+        .outputLatencyMs = -1,
+        .limiterLatencyMs = 0,
+        .bufferSizeIncreaseCount = mBufferSizeTuner.getIncreaseCount(),
+        .bufferSizeDecreaseCount = mBufferSizeTuner.getDecreaseCount(),
+        .bufferSizeHistory = {mBufferSizeHistory.begin(), mBufferSizeHistory.end()}
+    };
+    if(mAudioStream) {
+        stats.bufferSizeFrames = mAudioStream->getBufferSizeInFrames();
+        stats.framesPerBurst = mAudioStream->getFramesPerBurst();
+        stats.bufferCapacityFrames = mAudioStream->getBufferCapacityInFrames();
+        stats.bufferLatencyMs = 1000.0 * stats.bufferSizeFrames / mAudioStream->getSampleRate();
+        stats.limiterLatencyMs = 1000.0 * mRenderer.getLatencyFrames() / mAudioStream->getSampleRate();
+        auto latencyResult = mAudioStream->calculateLatencyMillis();
+        if(latencyResult) {
+            stats.outputLatencyMs = latencyResult.value();
+        }
+    }
+    return stats;
+}
+
+SoundMemoryStats AudioEngine::getSoundMemoryStats() {
+    SoundMemoryStats stats {};
+    mSounds.forEach([&stats](SoundId, LoadedSound &sound) {
+        if(!sound.player) return;
+
+        const int64_t bytes = getResidentBytes(*sound.player);
+        if(sound.player->getSource()->isMemoryMapped()) {
+            stats.mappedBytes += bytes;
+        } else {
+            stats.heapBytes += bytes;
+        }
+    });
+    return stats;
+}
+
+bool AudioEngine::canAddPlayers(size_t count) const {
+    // Players waiting to be freed still occupy a slot in the reaper's queue
+    return mSounds.size() + mRenderer.getReclamationStats().pendingCount + count <= kMaxPlayers;
+}
+
+void AudioEngine::setMemoryBudget(int64_t bytes) {
+    std::lock_guard<std::mutex> lock(mControlMutex);
+    mMemoryBudget = std::max<int64_t>(bytes, 0);
+    enforceMemoryBudget(0);
+    drainCommandsIfIdle();
+}
+
+void AudioEngine::prefetchSounds(const std::vector<SoundId> &ids) {
+    std::lock_guard<std::mutex> lock(mControlMutex);
+    for (const auto id: ids) {
+        LoadedSound *sound = mSounds.get(id);
+        if(sound && !sound->player) {
+            reloadSound(id, *sound);
+        }
+    }
+}
+
+SoundId AudioEngine::addSound(DecodeSoundResult decoded, int offset, int length, const LoadSoundOptions &options,
+                              std::vector<AudioCommand> &commands) {
+    auto sound = std::make_unique<LoadedSound>();
+    sound->player = std::move(decoded.player);
+    sound->fd = std::move(decoded.reloadFd);
+    sound->offset = offset;
+    sound->length = length;
+    sound->options = options;
+    sound->residentBytes = getResidentBytes(*sound->player);
+    sound->lastUsed = ++mUseClock;
+
+    Player *player = sound->player.get();
+    commands.push_back({.type = AudioCommandType::addPlayer, .player = player});
+    mResidentBytes += sound->residentBytes;
+    mResidentPlayerCount++;
+    const LoadedSound &loaded = *sound;
+    const SoundId id = mSounds.insert(std::move(sound));
+    // Set before the audio thread sees the player, the add command publishes it
+    player->setSoundId(id);
+    if(id > 0) {
+        publishSound(id, loaded);
+    }
+    return id;
+}
+
+void AudioEngine::postSoundCommand(LoadedSound &sound, const AudioCommand &command, bool isPlaybackCommand) {
+    postCommand(command);
+    if(isPlaybackCommand) {
+        sound.lastUsed = ++mUseClock;
+        sound.lastPlaybackCommand = mRenderer.getPostedCommandCount();
+    }
+}
+
+void AudioEngine::enforceMemoryBudget(SoundId soundToKeep) {
+    if(mMemoryBudget <= 0) return;
+
+    const uint64_t appliedCommandCount = mRenderer.getAppliedCommandCount();
+    while (mResidentBytes > mMemoryBudget) {
+        LoadedSound *leastRecentlyUsed = nullptr;
+        mSounds.forEach([&](SoundId id, LoadedSound &sound) {
+            // A sound is only known to be idle once the audio thread applied every command that
+            // could have started it, otherwise it may be about to play
+            if(id == soundToKeep || !sound.player || !sound.fd.isValid() || sound.residentBytes == 0
+               || sound.lastPlaybackCommand > appliedCommandCount || !sound.player->isIdle()) {
+                return;
+            }
+            if(!leastRecentlyUsed || sound.lastUsed < leastRecentlyUsed->lastUsed) {
+                leastRecentlyUsed = &sound;
+            }
+        });
+
+        // Everything left is playing, paused part way through or can't be loaded again
+        if(!leastRecentlyUsed) return;
+        evictSound(*leastRecentlyUsed);
+    }
+}
+
+void AudioEngine::evictSound(LoadedSound &sound) {
+    const SoundId id = sound.player->getSoundId();
+    Player *player = sound.player.release();
+    publishSound(id, sound);
+    mRenderer.expectRemovedPlayers(1);
+    postCommand({.type = AudioCommandType::removePlayer, .player = player});
+    mResidentBytes -= sound.residentBytes;
+    mResidentPlayerCount--;
+    sound.residentBytes = 0;
+    mMemoryBudgetStats.evictionCount++;
+}
+
+void AudioEngine::reloadSound(SoundId id, LoadedSound &sound) {
+    if(sound.isReloading) return;
+
+    // The job gets its own descriptor so that unloading the sound meanwhile doesn't close it
+    int fd = dup(sound.fd.get());
+    if(fd == -1) {
+        LOGE("Failed to load an evicted sound again: %s", strerror(errno));
+        return;
+    }
+
+    sound.isReloading = true;
+    sound.reloadStart = std::chrono::steady_clock::now();
+    mDecodePool.submit([this, id, fd, offset = sound.offset, length = sound.length, options = sound.options] {
+        auto decoded = decodeSound(fd, offset, length, options, nullptr);
+        close(fd);
+        finishReloadSound(id, std::move(decoded));
+    });
+}
+
+void AudioEngine::finishReloadSound(SoundId id, DecodeSoundResult decoded) {
+    std::lock_guard<std::mutex> lock(mControlMutex);
+    LoadedSound *sound = mSounds.get(id);
+    // Unloaded while it was loading
+    if(!sound) return;
+
+    sound->isReloading = false;
+    adaptToStream(decoded, sound->options);
+    // Evicted players still waiting to be freed take up room in the reaper
+    if(!decoded.error && static_cast<int64_t>(mResidentPlayerCount) + mRenderer.getReclamationStats().pendingCount + 1 > static_cast<int64_t>(kMaxPlayers)) {
+        decoded.error = "too many players are still waiting to be freed";
+    }
+    if(decoded.error) {
+        LOGE("Failed to load an evicted sound again: %s", decoded.error->c_str());
+        sound->playWhenReloaded = false;
+        sound->triggerWhenReloaded.reset();
+        sound->scheduleWhenReloaded.clear();
+        sound->scheduledFrames.clear();
+        return;
+    }
+
+    sound->player = std::move(decoded.player);
+    sound->residentBytes = getResidentBytes(*sound->player);
+    mResidentBytes += sound->residentBytes;
+    mResidentPlayerCount++;
+
+    Player *player = sound->player.get();
+    player->setSoundId(id);
+    postCommand({.type = AudioCommandType::addPlayer, .player = player});
+    postCommand({.type = AudioCommandType::setVolume, .player = player, .floatValue = sound->volume});
+    postCommand({.type = AudioCommandType::setPan, .player = player, .floatValue = sound->pan});
+    postCommand({.type = AudioCommandType::setPlaybackRate, .player = player, .floatValue = sound->playbackRate});
+    postCommand({.type = AudioCommandType::setLooping, .player = player, .boolValue = sound->isLooping});
+    postCommand({.type = AudioCommandType::setPlayerBus, .player = player, .intValue = sound->bus});
+    if(!sound->markers.empty()) {
+        postMarkerCommands(player, sound->markers);
+    }
+    if(sound->seekWhenReloaded) {
+        postSoundCommand(*sound, {.type = AudioCommandType::seekTo, .player = player, .intValue = *sound->seekWhenReloaded}, true);
+    }
+    if(sound->triggerWhenReloaded) {
+        postSoundCommand(*sound, {.type = AudioCommandType::trigger, .player = player, .floatValue = sound->triggerWhenReloaded->volume,
+                                  .pan = sound->triggerWhenReloaded->pan, .playbackRate = sound->triggerWhenReloaded->playbackRate}, true);
+    }
+    if(sound->playWhenReloaded) {
+        postSoundCommand(*sound, {.type = AudioCommandType::setPlaying, .player = player, .boolValue = true}, true);
+    }
+    for (const auto &[frame, isPlaying]: sound->scheduleWhenReloaded) {
+        postSoundCommand(*sound, {.type = AudioCommandType::schedulePlaying, .player = player, .boolValue = isPlaying, .intValue = frame}, true);
+    }
+    sound->scheduleWhenReloaded.clear();
+    sound->seekWhenReloaded.reset();
+    sound->triggerWhenReloaded.reset();
+    sound->playWhenReloaded = false;
+    publishSound(id, *sound);
+
+    const std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - sound->reloadStart;
+    mMemoryBudgetStats.reloadCount++;
+    mMemoryBudgetStats.lastReloadDurationMs = duration.count();
+    mMemoryBudgetStats.maxReloadDurationMs = std::max(mMemoryBudgetStats.maxReloadDurationMs, duration.count());
+
+    enforceMemoryBudget(id);
+    drainCommandsIfIdle();
+}
+
+int64_t AudioEngine::getResidentBytes(const Player &player) {
+    const DataSource *source = player.getSource();
+    // Streamed sounds only hold a small read ahead buffer, their size is the whole track
+    if(source->getSamples() == nullptr) return 0;
+    return source->getSize() * getBytesPerSample(source->getSampleFormat());
+}
+
+void AudioEngine::drainCommandsIfIdle() {
+    const bool isStreamRunning = mAudioStream &&
+            (mAudioStream->getState() == oboe::StreamState::Starting ||
+             mAudioStream->getState() == oboe::StreamState::Started);
+
+    if(!isStreamRunning) {
+        mRenderer.drainCommands();
     }
 }
 
@@ -208,7 +1352,29 @@ oboe::Usage AudioEngine::getUsageFromInt(int usage) {
     }
 }
 
+VoiceStealingPolicy AudioEngine::getVoiceStealingPolicyFromInt(int voiceStealingPolicy) {
+    switch(voiceStealingPolicy) {
+        case 0: return VoiceStealingPolicy::oldest;
+        case 1: return VoiceStealingPolicy::quietest;
+        default: return VoiceStealingPolicy::oldest;
+    }
+}
+
+Interpolation AudioEngine::getInterpolationFromResamplerQuality(int resamplerQuality) {
+    return Resampler::getQualityFromInt(resamplerQuality) == ResamplerQuality::low ? Interpolation::linear : Interpolation::cubic;
+}
+
+SampleFormat AudioEngine::getSampleFormatFromInt(int sampleFormat) {
+    switch(sampleFormat) {
+        case 0: return SampleFormat::float32;
+        case 1: return SampleFormat::int16;
+        case 2: return SampleFormat::int8;
+        default: return SampleFormat::float32;
+    }
+}
+
 StreamState AudioEngine::getStreamState() {
+    std::lock_guard<std::mutex> lock(mControlMutex);
     if(!mAudioStream) {
         return StreamState::closed;
     }
@@ -5,42 +5,385 @@
 #ifndef AUDIOPLAYBACK_AUDIOENGINE_H
 #define AUDIOPLAYBACK_AUDIOENGINE_H
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <optional>
+#include <thread>
+#include <vector>
 
 #include <oboe/Oboe.h>
 #include "audio/Player.h"
+#include "AudioCommand.h"
 #include "AudioConstants.h"
+#include "AudioRenderer.h"
+#include "audio/PcmCache.h"
+#include "utils/BufferSizeTuner.h"
+#include "utils/HandleTable.h"
+#include "utils/UniqueFd.h"
+#include "utils/WorkerPool.h"
+#include "utils/CallbackMonitor.h"
 #include <android/asset_manager.h>
 
 enum class StreamState {
     closed, initialized, open, paused
 };
 
+struct SoundMemoryStats {
+    // Samples of loaded sounds held on the heap
+    int64_t heapBytes;
+    // Samples of loaded sounds mapped from files, which the system can page out and share
+    int64_t mappedBytes;
+};
+
+struct MemoryBudgetStats {
+    // 0 when there is no budget
+    int64_t budgetBytes;
+    // Counted against the budget, the same as heapBytes + mappedBytes
+    int64_t residentBytes;
+    // Sounds whose samples were dropped to stay within the budget and that are not reloaded yet
+    int32_t evictedSoundCount;
+    int64_t evictionCount;
+    int64_t reloadCount;
+    // Time from the first request that needed an evicted sound to it being playable again
+    double lastReloadDurationMs;
+    double maxReloadDurationMs;
+};
+
+struct LatencyStats {
+    // All zero while there is no stream
+    int32_t bufferSizeFrames;
+    int32_t framesPerBurst;
+    int32_t bufferCapacityFrames;
+    // What the buffer size adds to the latency
+    double bufferLatencyMs;
+    // From the stream's timestamps to the speaker, -1 when the stream can't tell
+    double outputLatencyMs;
+    // The master limiter's lookahead, which delays the mix whether the limiter is enabled or not
+    double limiterLatencyMs;
+    int64_t bufferSizeIncreaseCount;
+    int64_t bufferSizeDecreaseCount;
+    // The latest changes made by the buffer size tuner, oldest first
+    std::vector<BufferSizeChange> bufferSizeHistory;
+};
+
+struct EngineStats {
+    CallbackStats callback;
+    // Underruns and overruns reported by the stream, -1 when there is no stream or the device
+    // can't report them
+    int32_t xRunCount;
+    ReclamationStats reclamation;
+    // All zero while no cache directory is set
+    PcmCacheStats pcmCache;
+    SoundMemoryStats memory;
+    MemoryBudgetStats memoryBudget;
+    // Deepest gain reduction of the master limiter since the last call, 0 when it didn't limit
+    double limiterGainReductionDb;
+    LatencyStats latency;
+};
+
+struct LoadSoundsCallbacks {
+    // Called from a decoding thread whenever one of the sounds is done, successfully or not
+    std::function<void(size_t index, const std::optional<std::string> &error)> onProgress;
+    // Called once with a result per request, in order, after the players have been published
+    std::function<void(const std::vector<LoadSoundResult> &results)> onComplete;
+};
+
 class AudioEngine : public oboe::AudioStreamDataCallback{
 public:
+    ~AudioEngine() override;
+
     SetupAudioStreamResult setupAudioStream(double sampleRate, double channelCount, int usage);
     OpenAudioStreamResult openAudioStream();
     PauseAudioStreamResult pauseAudioStream();
     CloseAudioStreamResult closeAudioStream();
-    void playSounds(const std::vector<std::pair<std::string, bool>>&);
-    void loopSounds(const std::vector<std::pair<std::string, bool>>&);
-    void seekSoundsTo(const std::vector<std::pair<std::string, double>>&);
-    void setSoundsVolume(const std::vector<std::pair<std::string, double>>&);
-    LoadSoundResult loadSound(int fd, int offset, int length);
-    void unloadSounds(const std::optional<std::vector<std::string>>&);
+    /**
+     * Move to a stream with another sample rate or channel count without reloading any sound. The
+     * new stream is opened and the samples of the loaded sounds are converted for it in parallel
+     * on the decoding threads, while the current stream keeps playing. Then the old stream is
+     * stopped and everything is swapped in one go: every sound continues on the new stream where
+     * it was, with the same state, and the new stream starts if the old one was running. Other
+     * calls only wait for the swap, not for the conversions or the stream changes. Streamed
+     * sounds can only follow when the sample rate doesn't change, see StreamingDataSource, the
+     * others are unloaded. Blocks until done.
+     */
+    ReconfigureStreamResult reconfigureStream(double sampleRate, double channelCount);
+    void playSounds(const std::vector<std::pair<SoundId, bool>>&);
+    void loopSounds(const std::vector<std::pair<SoundId, bool>>&);
+    void seekSoundsTo(const std::vector<std::pair<SoundId, double>>&);
+    void setSoundsVolume(const std::vector<std::pair<SoundId, double>>&);
+    void triggerSounds(const std::vector<TriggerSoundRequest>&);
+    void setSoundsPan(const std::vector<std::pair<SoundId, double>>&);
+    void setSoundsPlaybackRate(const std::vector<std::pair<SoundId, double>>&);
+    /**
+     * Play or pause sounds at an exact frame instead of at the start of the next buffer. Requests
+     * for times in the past, or host times while the stream can't report a timestamp, apply as
+     * soon as possible.
+     */
+    void scheduleSounds(const std::vector<ScheduleSoundRequest>&);
+    // Ramp the volume of sounds on the audio thread, optionally stopping them at the end
+    void fadeSounds(const std::vector<FadeSoundRequest>&);
+    StreamPosition getStreamPosition();
+    /**
+     * Where the sounds are in milliseconds, as of the last rendered buffer less the limiter's delay
+     * for playing sounds. Reading it doesn't wait for the audio thread. -1 for sounds that aren't loaded.
+     */
+    std::vector<double> getSoundsPosition(const std::vector<SoundId>&);
+    /**
+     * Replace the markers of sounds, times in milliseconds that produce a markerReached event when
+     * playback passes them. Markers are numbered in the order given, at most Player::kMaxMarkers.
+     */
+    void setSoundsMarkers(const std::vector<std::pair<SoundId, std::vector<double>>>&);
+    /**
+     * Receive the ended, looped and markerReached events of every sound. The audio thread only
+     * queues them, a dedicated thread started by the first call delivers them in batches every
+     * few milliseconds. Events that happen while no callback is set are dropped. A replaced
+     * callback may still be finishing a batch, it is destroyed once it has.
+     */
+    void setPlaybackEventsCallback(std::function<void(const std::vector<PlaybackEvent>&)> callback);
+    /**
+     * Route sounds to a mix bus, creating it if needed. Every sound starts on the "default" bus.
+     * There can be at most AudioRenderer::kMaxBuses buses, requests for more are ignored.
+     */
+    void setSoundsBus(const std::vector<std::pair<SoundId, std::string>>&);
+    // Gain changes are ramped over a few milliseconds on the audio thread
+    void setBusesGain(const std::vector<std::pair<std::string, double>>&);
+    void setBusesMuted(const std::vector<std::pair<std::string, bool>>&);
+    // The master limiter keeps the mix below full scale, it is enabled by default
+    void setLimiterEnabled(bool enabled);
+    /**
+     * Let the engine pick the stream's buffer size from the underruns it reports, see
+     * BufferSizeTuner. Enabled by default. When disabled, the buffer keeps its current size.
+     * Devices that can't report underruns keep the size the stream was opened with.
+     */
+    void setLatencyTuning(const BufferSizeTunerOptions &options);
+    LoadSoundResult loadSound(int fd, int offset, int length, LoadSoundOptions options);
+    /**
+     * Decode the requested sounds in parallel on background threads and publish all of the ones
+     * that succeeded at once. Takes ownership of the file descriptors and returns immediately.
+     */
+    void loadSounds(int32_t requestId, std::vector<LoadSoundRequest> requests, LoadSoundsCallbacks callbacks);
+    // Sounds that are not decoded yet stop decoding, nothing from the request is published
+    void cancelLoadSounds(int32_t requestId);
+    void unloadSounds(const std::optional<std::vector<SoundId>>&);
+    /**
+     * Keep decoded sounds in this directory so that loading the same file again skips decoding.
+     * Only applies to sounds loaded after the call, and to sounds that are not streamed.
+     */
+    void setDecodedCacheDirectory(const std::string &directory);
+    /**
+     * Keep the decoded sound cache within maxBytes on disk, removing the least recently used
+     * entries. Sounds kept in memory as float are cached as int16 unless storeFloat is set, which
+     * keeps them bit exact at twice the size.
+     */
+    void setDecodedCacheOptions(int64_t maxBytes, bool storeFloat);
+    /**
+     * Limit the memory taken by the samples of loaded sounds. When over budget, sounds that are not
+     * playing and rewound are evicted, least recently used first, and transparently loaded again
+     * the next time they are played or triggered. Only sounds loaded while a budget is set can be
+     * evicted, since the engine keeps their file open for that. 0 removes the budget.
+     */
+    void setMemoryBudget(int64_t bytes);
+    // Start loading evicted sounds again so that playing them later doesn't wait for it
+    void prefetchSounds(const std::vector<SoundId>&);
     StreamState getStreamState();
+    EngineStats getEngineStats();
 
     oboe::DataCallbackResult onAudioReady(oboe::AudioStream *oboeStream, void *audioData, int32_t numFrames) override;
 
 private:
+    static constexpr size_t kMaxPlayers = 1024;
+    static constexpr size_t kCommandQueueCapacity = 1024;
+    static constexpr size_t kMaxDecodeThreads = 4;
+    static constexpr int64_t kNanosPerSecond = 1000000000;
+    static constexpr size_t kEventQueueCapacity = 1024;
+    // How long events wait at most before they are delivered
+    static constexpr std::chrono::milliseconds kEventDispatchInterval { 10 };
+    // Buffer size changes kept for the stats
+    static constexpr size_t kBufferSizeHistoryLength = 32;
+
+    struct DecodeSoundResult {
+        std::unique_ptr<Player> player;
+        std::optional<std::string> error;
+        // A duplicate of the file the sound was loaded from, only kept when there is a memory budget
+        UniqueFd reloadFd;
+        // mStreamGeneration the player was decoded for
+        uint32_t streamGeneration = 0;
+    };
+
+    struct ConvertPlayerResult {
+        std::unique_ptr<Player> player;
+        std::optional<std::string> error;
+    };
+
+    struct LoadedSound {
+        // nullptr while evicted
+        std::unique_ptr<Player> player;
+
+        // What is needed to load the sound again after it was evicted
+        UniqueFd fd;
+        int offset;
+        int length;
+        LoadSoundOptions options;
+
+        // Player state that has to survive an eviction
+        float volume = 1;
+        float pan = 0;
+        float playbackRate = 1;
+        bool isLooping = false;
+        int32_t bus = 0;
+        std::vector<int64_t> markers;
+
+        // Samples held by the player while it is loaded
+        int64_t residentBytes = 0;
+        // Compared with other sounds to find the least recently used one
+        uint64_t lastUsed = 0;
+        // Posted command count right after the last command that may have started or moved playback
+        uint64_t lastPlaybackCommand = 0;
+
+        // What was requested while the sound was evicted, applied once it is loaded again
+        bool isReloading = false;
+        bool playWhenReloaded = false;
+        std::optional<TriggerSoundRequest> triggerWhenReloaded;
+        std::optional<int64_t> seekWhenReloaded;
+        std::vector<std::pair<int64_t, bool>> scheduleWhenReloaded;
+        // Frames of the scheduled events that may still be pending, at most kMaxScheduledEvents
+        std::vector<int64_t> scheduledFrames;
+        std::chrono::steady_clock::time_point reloadStart;
+    };
+
+    /**
+     * What getSoundsPosition reads of a sound without mControlMutex, one for every slot of mSounds.
+     * Written under mControlMutex, player before id when publishing and id before player when
+     * unpublishing, so that an id read before and after the player vouches for it.
+     */
+    struct PublishedSound {
+        std::atomic<SoundId> id { 0 };
+        // Cleared before the player is removed, read under AudioRenderer::guardPlayerReads
+        std::atomic<const Player *> player { nullptr };
+        // Position in milliseconds while evicted
+        std::atomic<int64_t> evictedPositionMs { 0 };
+    };
+
+    struct LoadSoundsBatch {
+        int32_t requestId;
+        std::vector<LoadSoundRequest> requests;
+        LoadSoundsCallbacks callbacks;
+        // One per request, each only written by the job decoding it
+        std::vector<DecodeSoundResult> decoded;
+        std::atomic<size_t> remaining;
+        std::atomic<bool> cancelled { false };
+    };
+
     std::shared_ptr<oboe::AudioStream> mAudioStream;
-    std::map<std::string, std::unique_ptr<Player>> mPlayers;
     int32_t mDesiredSampleRate{};
     int mDesiredChannelCount{};
+    int mUsage{};
+    // Guarded by mControlMutex, increases whenever the stream changes its properties
+    uint32_t mStreamGeneration = 0;
+    // Held for the whole of reconfigureStream, which releases mControlMutex while converting
+    std::mutex mReconfigureMutex;
+    // Serializes starting, pausing, stopping and closing streams, so that reconfigureStream can
+    // stop the old stream without mControlMutex. Taken before mControlMutex.
+    std::mutex mStreamMutex;
+
+    // Control thread state, guarded by mControlMutex. The players are owned here but only ever
+    // touched by whoever is currently consuming the command queue. Once unloaded or evicted,
+    // ownership moves to the renderer which frees them when it no longer references them.
+    std::mutex mControlMutex;
+    HandleTable<LoadedSound> mSounds { kMaxPlayers };
+    std::vector<PublishedSound> mPublishedSounds = std::vector<PublishedSound>(kMaxPlayers);
+    int64_t mMemoryBudget = 0;
+    int64_t mResidentBytes = 0;
+    size_t mResidentPlayerCount = 0;
+    uint64_t mUseClock = 0;
+    MemoryBudgetStats mMemoryBudgetStats {};
+    // Indexed by bus
+    std::vector<std::string> mBusNames { "default" };
+    // Shared with the decodes that are running when it is replaced
+    std::shared_ptr<PcmCache> mPcmCache;
+    int64_t mPcmCacheMaxBytes = PcmCache::kDefaultMaxBytes;
+    bool mPcmCacheStoresFloat = false;
+
+    AudioRenderer mRenderer { kMaxPlayers, kCommandQueueCapacity, kEventQueueCapacity };
+    CallbackMonitor mCallbackMonitor;
+    BufferSizeTuner mBufferSizeTuner { kBufferSizeHistoryLength };
+    // Guarded by mControlMutex, filled from the tuner whenever the stats are read
+    std::deque<BufferSizeChange> mBufferSizeHistory;
+
+    // Requests that are still decoding, so that they can be cancelled
+    std::mutex mLoadMutex;
+    std::map<int32_t, std::weak_ptr<LoadSoundsBatch>> mLoadBatches;
+
+    // Renderer frame position minus stream frame position, updated by every callback
+    std::atomic<int64_t> mStreamFrameOffset { 0 };
+
+    // Delivers the events the renderer queued, see setPlaybackEventsCallback
+    std::mutex mEventMutex;
+    std::condition_variable mEventCondition;
+    // Shared with the batch being delivered, which calls it without holding mEventMutex
+    std::shared_ptr<const std::function<void(const std::vector<PlaybackEvent>&)>> mEventCallback;
+    bool mIsStoppingEvents = false;
+    std::thread mEventThread;
+
+    // Declared last so that its threads are joined before anything they use is destroyed
+    WorkerPool mDecodePool { kMaxDecodeThreads };
+
+    void postCommand(const AudioCommand &command) { mRenderer.postCommand(command); }
+    oboe::Result openStream(AudioProperties properties, int usage, std::shared_ptr<oboe::AudioStream> &stream);
+    /**
+     * A player for the same sound on a stream with targetProperties, using source as is when it
+     * still fits and a converted copy otherwise. Doesn't touch any engine state.
+     */
+    static ConvertPlayerResult convertPlayer(const std::shared_ptr<DataSource> &source, const LoadSoundOptions &options,
+                                             AudioProperties targetProperties);
+    static bool fitsStream(const Player &player, AudioProperties properties);
+    // Needs mControlMutex, converts a player decoded before the stream was reconfigured
+    void adaptToStream(DecodeSoundResult &decoded, const LoadSoundOptions &options);
+    // Needs mControlMutex, nullopt when the bus doesn't exist and there is no room for it
+    std::optional<int32_t> getOrAddBus(const std::string &name);
+    void drainCommandsIfIdle();
+    bool canAddPlayers(size_t count) const;
+    // Needs mControlMutex
+    int64_t getFrameForHostTime(int64_t hostTimeNs);
+    // Take ownership of a decoded sound and hand its player to the audio thread with commands
+    SoundId addSound(DecodeSoundResult decoded, int offset, int length, const LoadSoundOptions &options,
+                     std::vector<AudioCommand> &commands);
+    // Post a command for the sound's player, marking the sound as used if it may start playback
+    void postSoundCommand(LoadedSound &sound, const AudioCommand &command, bool isPlaybackCommand);
+    void enforceMemoryBudget(SoundId soundToKeep);
+    void evictSound(LoadedSound &sound);
+    void reloadSound(SoundId id, LoadedSound &sound);
+    void finishReloadSound(SoundId id, DecodeSoundResult decoded);
+    void postMarkerCommands(Player *player, const std::vector<int64_t> &markers);
+    // Needs mControlMutex, call whenever the sound's player or evicted position changes
+    void publishSound(SoundId id, const LoadedSound &sound);
+    // Needs mControlMutex, call before the sound's player is removed
+    void unpublishSound(SoundId id);
+    void dispatchEvents();
+
+    DecodeSoundResult decodeSound(int fd, int offset, int length, const LoadSoundOptions &options,
+                                  const std::atomic<bool> *cancelled);
+    void decodeBatchSound(const std::shared_ptr<LoadSoundsBatch> &batch, size_t index);
+    void finishLoadSounds(const std::shared_ptr<LoadSoundsBatch> &batch);
 
     static oboe::Usage getUsageFromInt(int usage);
+    static VoiceStealingPolicy getVoiceStealingPolicyFromInt(int voiceStealingPolicy);
+    static Interpolation getInterpolationFromResamplerQuality(int resamplerQuality);
+    static SampleFormat getSampleFormatFromInt(int sampleFormat);
+    static int64_t getResidentBytes(const Player &player);
+    // Needs mControlMutex
+    SoundMemoryStats getSoundMemoryStats();
+    // Needs mControlMutex
+    LatencyStats getLatencyStats();
+    // -1 when the stream can't report underruns
+    static int32_t getXRunCount(oboe::AudioStream *stream);
 };
 
 #endif //AUDIOPLAYBACK_AUDIOENGINE_H
@@ -0,0 +1,312 @@
+#include "AudioPlaybackHostObject.h"
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+using namespace facebook;
+
+namespace {
+
+constexpr std::array<const char *, 20> kMethodNames = {
+        "playSounds",
+        "loopSounds",
+        "seekSoundsTo",
+        "setSoundsVolume",
+        "setSoundsPan",
+        "setSoundsPlaybackRate",
+        "triggerSounds",
+        "fadeSounds",
+        "scheduleSounds",
+        "setSoundsMarkers",
+        "setSoundsBus",
+        "setBusesGain",
+        "setBusesMuted",
+        "setLimiterEnabled",
+        "setLatencyTuning",
+        "unloadSound",
+        "setMemoryBudget",
+        "prefetchSounds",
+        "getSoundsPosition",
+        "getStreamPosition",
+};
+
+const jsi::Value &argument(jsi::Runtime &runtime, const jsi::Value *args, size_t count, size_t index) {
+    if (index >= count) {
+        throw jsi::JSError(runtime, "Expected " + std::to_string(index + 1) + " arguments");
+    }
+    return args[index];
+}
+
+jsi::Array argumentArray(jsi::Runtime &runtime, const jsi::Value *args, size_t count) {
+    if (count < 1 || !args[0].isObject() || !args[0].getObject(runtime).isArray(runtime)) {
+        throw jsi::JSError(runtime, "Expected an array argument");
+    }
+    return args[0].getObject(runtime).getArray(runtime);
+}
+
+SoundId toSoundId(const jsi::Value &value) {
+    return static_cast<SoundId>(value.asNumber());
+}
+
+// One element of a pair, by the type the engine takes it as
+template<typename T>
+T readValue(jsi::Runtime &runtime, const jsi::Value &value) {
+    if constexpr (std::is_same_v<T, SoundId>) {
+        return toSoundId(value);
+    } else if constexpr (std::is_same_v<T, bool>) {
+        return value.asBool();
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        return value.asString(runtime).utf8(runtime);
+    } else if constexpr (std::is_same_v<T, std::vector<double>>) {
+        auto array = value.asObject(runtime).asArray(runtime);
+        std::vector<double> numbers(array.size(runtime));
+        for (size_t i = 0; i < numbers.size(); ++i) {
+            numbers[i] = array.getValueAtIndex(runtime, i).asNumber();
+        }
+        return numbers;
+    } else {
+        return value.asNumber();
+    }
+}
+
+// [[key, value], ...], like the zip helpers of the JNI functions
+template<typename Key, typename T>
+std::vector<std::pair<Key, T>> readPairs(jsi::Runtime &runtime, const jsi::Value *args, size_t count) {
+    auto array = argumentArray(runtime, args, count);
+    const size_t size = array.size(runtime);
+
+    std::vector<std::pair<Key, T>> pairs;
+    pairs.reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+        auto pair = array.getValueAtIndex(runtime, i).asObject(runtime).asArray(runtime);
+        pairs.emplace_back(readValue<Key>(runtime, pair.getValueAtIndex(runtime, 0)),
+                           readValue<T>(runtime, pair.getValueAtIndex(runtime, 1)));
+    }
+    return pairs;
+}
+
+// [id, ...]
+std::vector<SoundId> readIds(jsi::Runtime &runtime, const jsi::Value *args, size_t count) {
+    auto array = argumentArray(runtime, args, count);
+    const size_t size = array.size(runtime);
+
+    std::vector<SoundId> ids;
+    ids.reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+        ids.push_back(toSoundId(array.getValueAtIndex(runtime, i)));
+    }
+    return ids;
+}
+
+// [{...}, ...], read is called with each object
+template<typename T, typename Read>
+std::vector<T> readObjects(jsi::Runtime &runtime, const jsi::Value *args, size_t count, Read read) {
+    auto array = argumentArray(runtime, args, count);
+    const size_t size = array.size(runtime);
+
+    std::vector<T> requests;
+    requests.reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+        requests.push_back(read(array.getValueAtIndex(runtime, i).asObject(runtime)));
+    }
+    return requests;
+}
+
+// A null or missing property is nullopt, the spec passes null for the time a request doesn't use
+std::optional<int64_t> optionalInt64(jsi::Runtime &runtime, const jsi::Object &object, const char *name) {
+    auto value = object.getProperty(runtime, name);
+    if (value.isNull() || value.isUndefined()) {
+        return std::nullopt;
+    }
+    return static_cast<int64_t>(value.asNumber());
+}
+
+jsi::Function hostFunction(jsi::Runtime &runtime, const jsi::PropNameID &name, unsigned int paramCount,
+                           jsi::HostFunctionType function) {
+    return jsi::Function::createFromHostFunction(runtime, name, paramCount, std::move(function));
+}
+
+}
+
+void AudioPlaybackHostObject::install(jsi::Runtime &runtime, AudioEngine &engine) {
+    runtime.global().setProperty(
+            runtime,
+            "__AudioPlayback",
+            jsi::Object::createFromHostObject(runtime, std::make_shared<AudioPlaybackHostObject>(engine)));
+}
+
+std::vector<jsi::PropNameID> AudioPlaybackHostObject::getPropertyNames(jsi::Runtime &runtime) {
+    std::vector<jsi::PropNameID> names;
+    names.reserve(kMethodNames.size());
+    for (auto methodName : kMethodNames) {
+        names.push_back(jsi::PropNameID::forAscii(runtime, methodName));
+    }
+    return names;
+}
+
+// Every get creates a new function, JS is expected to look the methods up once and keep them.
+// The functions capture the engine rather than this, so they outlive the host object.
+jsi::Value AudioPlaybackHostObject::get(jsi::Runtime &runtime, const jsi::PropNameID &propName) {
+    const auto name = propName.utf8(runtime);
+    auto &engine = mEngine;
+
+    if (name == "playSounds") {
+        return hostFunction(runtime, propName, 1, [&engine](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) {
+            engine.playSounds(readPairs<SoundId, bool>(rt, args, count));
+            return jsi::Value::undefined();
+        });
+    }
+    if (name == "loopSounds") {
+        return hostFunction(runtime, propName, 1, [&engine](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) {
+            engine.loopSounds(readPairs<SoundId, bool>(rt, args, count));
+            return jsi::Value::undefined();
+        });
+    }
+    if (name == "seekSoundsTo") {
+        return hostFunction(runtime, propName, 1, [&engine](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) {
+            engine.seekSoundsTo(readPairs<SoundId, double>(rt, args, count));
+            return jsi::Value::undefined();
+        });
+    }
+    if (name == "setSoundsVolume") {
+        return hostFunction(runtime, propName, 1, [&engine](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) {
+            engine.setSoundsVolume(readPairs<SoundId, double>(rt, args, count));
+            return jsi::Value::undefined();
+        });
+    }
+    if (name == "setSoundsPan") {
+        return hostFunction(runtime, propName, 1, [&engine](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) {
+            engine.setSoundsPan(readPairs<SoundId, double>(rt, args, count));
+            return jsi::Value::undefined();
+        });
+    }
+    if (name == "setSoundsPlaybackRate") {
+        return hostFunction(runtime, propName, 1, [&engine](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) {
+            engine.setSoundsPlaybackRate(readPairs<SoundId, double>(rt, args, count));
+            return jsi::Value::undefined();
+        });
+    }
+    if (name == "triggerSounds") {
+        return hostFunction(runtime, propName, 1, [&engine](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) {
+            engine.triggerSounds(readObjects<TriggerSoundRequest>(rt, args, count, [&rt](const jsi::Object &request) {
+                return TriggerSoundRequest{
+                        .id = toSoundId(request.getProperty(rt, "id")),
+                        .volume = static_cast<float>(request.getProperty(rt, "volume").asNumber()),
+                        .pan = static_cast<float>(request.getProperty(rt, "pan").asNumber()),
+                        .playbackRate = static_cast<float>(request.getProperty(rt, "playbackRate").asNumber())
+                };
+            }));
+            return jsi::Value::undefined();
+        });
+    }
+    if (name == "fadeSounds") {
+        return hostFunction(runtime, propName, 1, [&engine](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) {
+            engine.fadeSounds(readObjects<FadeSoundRequest>(rt, args, count, [&rt](const jsi::Object &request) {
+                return FadeSoundRequest{
+                        .id = toSoundId(request.getProperty(rt, "id")),
+                        .targetVolume = static_cast<float>(request.getProperty(rt, "targetVolume").asNumber()),
+                        .durationMs = static_cast<int32_t>(request.getProperty(rt, "durationMs").asNumber()),
+                        .stopAtEnd = request.getProperty(rt, "stopAtEnd").asBool(),
+                        .curve = static_cast<int>(request.getProperty(rt, "curve").asNumber())
+                };
+            }));
+            return jsi::Value::undefined();
+        });
+    }
+    if (name == "scheduleSounds") {
+        return hostFunction(runtime, propName, 1, [&engine](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) {
+            engine.scheduleSounds(readObjects<ScheduleSoundRequest>(rt, args, count, [&rt](const jsi::Object &request) {
+                return ScheduleSoundRequest{
+                        .id = toSoundId(request.getProperty(rt, "id")),
+                        .isPlaying = request.getProperty(rt, "play").asBool(),
+                        .frame = optionalInt64(rt, request, "atFrame"),
+                        .hostTimeNs = optionalInt64(rt, request, "atHostTimeNs")
+                };
+            }));
+            return jsi::Value::undefined();
+        });
+    }
+    if (name == "setSoundsMarkers") {
+        return hostFunction(runtime, propName, 1, [&engine](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) {
+            engine.setSoundsMarkers(readPairs<SoundId, std::vector<double>>(rt, args, count));
+            return jsi::Value::undefined();
+        });
+    }
+    if (name == "setSoundsBus") {
+        return hostFunction(runtime, propName, 1, [&engine](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) {
+            engine.setSoundsBus(readPairs<SoundId, std::string>(rt, args, count));
+            return jsi::Value::undefined();
+        });
+    }
+    if (name == "setBusesGain") {
+        return hostFunction(runtime, propName, 1, [&engine](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) {
+            engine.setBusesGain(readPairs<std::string, double>(rt, args, count));
+            return jsi::Value::undefined();
+        });
+    }
+    if (name == "setBusesMuted") {
+        return hostFunction(runtime, propName, 1, [&engine](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) {
+            engine.setBusesMuted(readPairs<std::string, bool>(rt, args, count));
+            return jsi::Value::undefined();
+        });
+    }
+    if (name == "setLimiterEnabled") {
+        return hostFunction(runtime, propName, 1, [&engine](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) {
+            engine.setLimiterEnabled(argument(rt, args, count, 0).asBool());
+            return jsi::Value::undefined();
+        });
+    }
+    if (name == "setLatencyTuning") {
+        return hostFunction(runtime, propName, 3, [&engine](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) {
+            engine.setLatencyTuning({
+                    .enabled = argument(rt, args, count, 0).asBool(),
+                    .aggressiveness = argument(rt, args, count, 1).asNumber(),
+                    .maxLatencyMs = argument(rt, args, count, 2).asNumber()
+            });
+            return jsi::Value::undefined();
+        });
+    }
+    if (name == "unloadSound") {
+        return hostFunction(runtime, propName, 1, [&engine](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) {
+            engine.unloadSounds(std::vector<SoundId>{toSoundId(argument(rt, args, count, 0))});
+            return jsi::Value::undefined();
+        });
+    }
+    if (name == "setMemoryBudget") {
+        return hostFunction(runtime, propName, 1, [&engine](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) {
+            engine.setMemoryBudget(static_cast<int64_t>(argument(rt, args, count, 0).asNumber()));
+            return jsi::Value::undefined();
+        });
+    }
+    if (name == "prefetchSounds") {
+        return hostFunction(runtime, propName, 1, [&engine](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) {
+            engine.prefetchSounds(readIds(rt, args, count));
+            return jsi::Value::undefined();
+        });
+    }
+    if (name == "getSoundsPosition") {
+        return hostFunction(runtime, propName, 1, [&engine](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) {
+            auto positions = engine.getSoundsPosition(readIds(rt, args, count));
+            jsi::Array result(rt, positions.size());
+            for (size_t i = 0; i < positions.size(); ++i) {
+                result.setValueAtIndex(rt, i, positions[i]);
+            }
+            return jsi::Value(rt, result);
+        });
+    }
+    if (name == "getStreamPosition") {
+        return hostFunction(runtime, propName, 0, [&engine](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *, size_t) {
+            auto position = engine.getStreamPosition();
+            jsi::Object result(rt);
+            result.setProperty(rt, "framePosition", static_cast<double>(position.framePosition));
+            result.setProperty(rt, "hostTimeNs", static_cast<double>(position.hostTimeNs));
+            return jsi::Value(rt, result);
+        });
+    }
+
+    return jsi::Value::undefined();
+}
@@ -0,0 +1,34 @@
+#ifndef AUDIOPLAYBACK_AUDIOPLAYBACKHOSTOBJECT_H
+#define AUDIOPLAYBACK_AUDIOPLAYBACKHOSTOBJECT_H
+
+#include <vector>
+
+#include <jsi/jsi.h>
+
+#include "AudioEngine.h"
+
+/**
+ * Exposes the per-sound and bus control calls of AudioEngine to JS as global.__AudioPlayback. The
+ * calls run on the JS thread and read their arguments straight from the JS values, so they skip
+ * the ReadableArray conversion and the Java hop the module methods go through. Every control call
+ * goes through here, none of them is left on the asynchronous module queue, so they apply in the
+ * order JS makes them.
+ *
+ * The methods take the same arguments as their counterparts in the module spec, JS validates them
+ * before calling in.
+ */
+class AudioPlaybackHostObject : public facebook::jsi::HostObject {
+public:
+    explicit AudioPlaybackHostObject(AudioEngine &engine) : mEngine(engine) {}
+
+    // Must be called on the JS thread
+    static void install(facebook::jsi::Runtime &runtime, AudioEngine &engine);
+
+    facebook::jsi::Value get(facebook::jsi::Runtime &runtime, const facebook::jsi::PropNameID &name) override;
+    std::vector<facebook::jsi::PropNameID> getPropertyNames(facebook::jsi::Runtime &runtime) override;
+
+private:
+    AudioEngine &mEngine;
+};
+
+#endif //AUDIOPLAYBACK_AUDIOPLAYBACKHOSTOBJECT_H
@@ -0,0 +1,288 @@
+#include "AudioRenderer.h"
+#include "audio/MixKernels.h"
+#include "utils/logging.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+AudioRenderer::AudioRenderer(size_t maxPlayers, size_t commandQueueCapacity, size_t eventQueueCapacity)
+    : mCommandQueue(commandQueueCapacity)
+    , mReaper(maxPlayers)
+    , mEventQueue(eventQueueCapacity) {
+    // Reserve up front so that adding a player on the audio thread never reallocates
+    mActivePlayers.reserve(maxPlayers);
+    mOverflowedPlayers.reserve(maxPlayers);
+    for (auto &bus: mBuses) {
+        bus.buffer.resize(kBusBufferSamples);
+    }
+}
+
+AudioRenderer::~AudioRenderer() {
+    // Nothing renders anymore, so whatever never made it into the reaper can go right away
+    for (const auto player: mOverflowedPlayers) {
+        delete player;
+    }
+}
+
+void AudioRenderer::configure(AudioProperties properties) {
+    acquireRenderLock();
+    mLimiter.configure(properties);
+    mLatencyFrames.store(mLimiter.getLatencyFrames(), std::memory_order_relaxed);
+    releaseRenderLock();
+}
+
+bool AudioRenderer::render(float *audioData, int32_t numFrames, int32_t channelCount) {
+    memset(audioData, 0, sizeof(float) * numFrames * channelCount);
+
+    const int64_t bufferStartFrame = mFramePosition.load(std::memory_order_relaxed);
+
+    // A control thread only holds the lock while the stream is not running or the command queue
+    // overflowed. Never wait for it here, output silence for this buffer instead.
+    if(mRenderLock.test_and_set(std::memory_order_acquire)) {
+        mFramePosition.store(bufferStartFrame + numFrames, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Commands apply at the start of the buffer, which is where replacePlayer measures from
+    processCommands();
+    mFramePosition.store(bufferStartFrame + numFrames, std::memory_order_relaxed);
+
+    const int32_t framesPerChunk = std::max(kBusBufferSamples / channelCount, 1);
+    for (int32_t offset = 0; offset < numFrames; offset += framesPerChunk) {
+        renderChunk(audioData + static_cast<size_t>(offset) * channelCount, std::min(framesPerChunk, numFrames - offset),
+                    channelCount, bufferStartFrame + offset);
+    }
+
+    mRenderLock.clear(std::memory_order_release);
+    return true;
+}
+
+void AudioRenderer::renderChunk(float *audioData, int32_t numFrames, int32_t channelCount, int64_t startFrame) {
+    for (auto &bus: mBuses) {
+        bus.isUsed = false;
+    }
+
+    for (const auto player: mActivePlayers) {
+        Bus &bus = mBuses[player->getBus()];
+        float *target = audioData;
+        if (!bus.isUnity()) {
+            if (!bus.isUsed) {
+                memset(bus.buffer.data(), 0, sizeof(float) * numFrames * channelCount);
+                bus.isUsed = true;
+            }
+            target = bus.buffer.data();
+        }
+        renderPlayer(player, target, numFrames, channelCount, startFrame);
+    }
+
+    for (auto &bus: mBuses) {
+        const float targetGain = bus.getTargetGain();
+        if (bus.isUsed) {
+            if (bus.currentGain != targetGain) {
+                mixWithGainRamp(audioData, bus.buffer.data(), channelCount, numFrames, bus.currentGain,
+                                (targetGain - bus.currentGain) / static_cast<float>(numFrames));
+            } else if (targetGain != 0.0f) {
+                mixWithGain(audioData, bus.buffer.data(), numFrames * channelCount, targetGain);
+            }
+        }
+        bus.currentGain = targetGain;
+    }
+
+    // Disabling the limiter keeps its delay, so the output doesn't shift when it is toggled
+    if (mLimiter.getChannelCount() == channelCount) {
+        mLimiter.process(audioData, numFrames);
+        // A control thread may reset the minimum at any point, only ever lower what it holds
+        const float minGain = mLimiter.takeMinGain();
+        float current = mLimiterMinGain.load(std::memory_order_relaxed);
+        while (minGain < current && !mLimiterMinGain.compare_exchange_weak(current, minGain, std::memory_order_relaxed)) {}
+    }
+}
+
+void AudioRenderer::renderPlayer(Player *player, float *audioData, int32_t numFrames, int32_t channelCount, int64_t startFrame) {
+    // Split the buffer wherever the player has a scheduled event, so it lands on its exact frame
+    int32_t offset = 0;
+    while (offset < numFrames) {
+        const int64_t frame = startFrame + offset;
+        player->applyScheduledEvents(frame);
+        const int32_t frames = player->getFramesUntilScheduledEvent(frame, numFrames - offset);
+        player->renderAudio(audioData + static_cast<size_t>(offset) * channelCount, frames);
+
+        for (size_t i = 0; i < player->getEventCount(); ++i) {
+            const Player::Event &event = player->getEvent(i);
+            const PlaybackEvent playbackEvent = {
+                .type = event.type,
+                .soundId = player->getSoundId(),
+                .markerIndex = event.markerIndex,
+                .framePosition = frame + event.frameOffset
+            };
+            if (!mEventQueue.push(playbackEvent)) {
+                mDroppedEventCount.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        offset += frames;
+    }
+}
+
+void AudioRenderer::postCommand(const AudioCommand &command) {
+    mPostedCommandCount++;
+    if(!mCommandQueue.push(command)) {
+        // The audio thread is not keeping up (or not running at all), apply the backlog ourselves
+        drainCommands();
+        mCommandQueue.push(command);
+    }
+}
+
+void AudioRenderer::postCommands(const AudioCommand *commands, size_t count) {
+    mPostedCommandCount += count;
+    // The producer index is published once for the whole bulk push, so it is atomic as long as it
+    // fits. Otherwise apply everything under the render lock, which is atomic too.
+    if(count > mCommandQueue.capacity() - mCommandQueue.size()) {
+        acquireRenderLock();
+        processCommands();
+        for (size_t i = 0; i < count; ++i) {
+            applyCommand(commands[i]);
+        }
+        releaseRenderLock();
+        return;
+    }
+
+    mCommandQueue.push(commands, count);
+}
+
+void AudioRenderer::expectRemovedPlayers(int64_t count) {
+    // The audio thread can't log, report what it ran into the next time players are removed
+    const int64_t overflowCount = mRetireOverflowCount.load(std::memory_order_relaxed);
+    if(overflowCount != mLoggedRetireOverflowCount) {
+        LOGW("%lld removed players did not fit in the reaper, they are freed later",
+             static_cast<long long>(overflowCount - mLoggedRetireOverflowCount));
+        mLoggedRetireOverflowCount = overflowCount;
+    }
+    mReaper.expect(count);
+}
+
+void AudioRenderer::drainCommands() {
+    // The render lock still protects us against a callback that is in flight
+    acquireRenderLock();
+    processCommands();
+    releaseRenderLock();
+}
+
+void AudioRenderer::acquireRenderLock() {
+    while(mRenderLock.test_and_set(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+}
+
+void AudioRenderer::releaseRenderLock() {
+    mRenderLock.clear(std::memory_order_release);
+}
+
+void AudioRenderer::processCommands() {
+    retireOverflowedPlayers();
+    AudioCommand command {};
+    while(mCommandQueue.pop(command)) {
+        applyCommand(command);
+    }
+}
+
+void AudioRenderer::applyCommand(const AudioCommand &command) {
+    switch (command.type) {
+        case AudioCommandType::addPlayer:
+            mActivePlayers.push_back(command.player);
+            break;
+        case AudioCommandType::removePlayer: {
+            auto it = std::find(mActivePlayers.begin(), mActivePlayers.end(), command.player);
+            if(it != mActivePlayers.end()) {
+                *it = mActivePlayers.back();
+                mActivePlayers.pop_back();
+            }
+            retirePlayer(command.player);
+            break;
+        }
+        case AudioCommandType::replacePlayer: {
+            command.replacement->takeStateFrom(*command.player, mFramePosition.load(std::memory_order_relaxed));
+            // In place, so that the replacement is rendered in the same order as the player it replaces
+            auto it = std::find(mActivePlayers.begin(), mActivePlayers.end(), command.player);
+            if(it != mActivePlayers.end()) {
+                *it = command.replacement;
+            } else {
+                mActivePlayers.push_back(command.replacement);
+            }
+            retirePlayer(command.player);
+            break;
+        }
+        case AudioCommandType::removeAllPlayers:
+            for (const auto player: mActivePlayers) {
+                retirePlayer(player);
+            }
+            mActivePlayers.clear();
+            break;
+        case AudioCommandType::setPlaying:
+            command.player->setPlaying(command.boolValue);
+            break;
+        case AudioCommandType::setLooping:
+            command.player->setLooping(command.boolValue);
+            break;
+        case AudioCommandType::seekTo:
+            command.player->seekTo(command.intValue);
+            break;
+        case AudioCommandType::setVolume:
+            command.player->setVolume(command.floatValue);
+            break;
+        case AudioCommandType::trigger:
+            command.player->trigger(command.floatValue, command.pan, command.playbackRate);
+            break;
+        case AudioCommandType::schedulePlaying:
+            command.player->schedulePlaying(command.intValue, command.boolValue);
+            break;
+        case AudioCommandType::fadeLinear:
+            command.player->fadeTo(command.floatValue, static_cast<int32_t>(command.intValue), GainCurve::linear, command.boolValue);
+            break;
+        case AudioCommandType::fadeExponential:
+            command.player->fadeTo(command.floatValue, static_cast<int32_t>(command.intValue), GainCurve::exponential, command.boolValue);
+            break;
+        case AudioCommandType::setPan:
+            command.player->setPan(command.floatValue);
+            break;
+        case AudioCommandType::setPlaybackRate:
+            command.player->setPlaybackRate(command.floatValue);
+            break;
+        case AudioCommandType::clearMarkers:
+            command.player->clearMarkers();
+            break;
+        case AudioCommandType::addMarker:
+            command.player->addMarker(command.intValue);
+            break;
+        case AudioCommandType::setPlayerBus:
+            command.player->setBus(static_cast<int32_t>(std::clamp<int64_t>(command.intValue, 0, kMaxBuses - 1)));
+            break;
+        case AudioCommandType::setBusGain:
+            if (command.intValue >= 0 && command.intValue < kMaxBuses) mBuses[command.intValue].gain = command.floatValue;
+            break;
+        case AudioCommandType::setBusMuted:
+            if (command.intValue >= 0 && command.intValue < kMaxBuses) mBuses[command.intValue].isMuted = command.boolValue;
+            break;
+        case AudioCommandType::setLimiterEnabled:
+            mLimiter.setEnabled(command.boolValue);
+            break;
+    }
+    mAppliedCommandCount.fetch_add(1, std::memory_order_release);
+}
+
+void AudioRenderer::retirePlayer(Player *player) {
+    // Behind older overflowed players too, so they are freed in the order they were removed
+    if (!mOverflowedPlayers.empty() || !mReaper.retire(player)) {
+        // Only allocates if more than maxPlayers are stuck, which beats leaking them
+        mOverflowedPlayers.push_back(player);
+        mRetireOverflowCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void AudioRenderer::retireOverflowedPlayers() {
+    size_t retiredCount = 0;
+    while (retiredCount < mOverflowedPlayers.size() && mReaper.retire(mOverflowedPlayers[retiredCount])) {
+        retiredCount++;
+    }
+    mOverflowedPlayers.erase(mOverflowedPlayers.begin(), mOverflowedPlayers.begin() + static_cast<ptrdiff_t>(retiredCount));
+}
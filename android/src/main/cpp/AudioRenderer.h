@@ -0,0 +1,190 @@
+#ifndef AUDIOPLAYBACK_AUDIORENDERER_H
+#define AUDIOPLAYBACK_AUDIORENDERER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "AudioConstants.h"
+#include "audio/Limiter.h"
+#include "audio/Player.h"
+#include "AudioCommand.h"
+#include "utils/Reaper.h"
+#include "utils/SpscQueue.h"
+
+// An event of a player's primary voice, handed from the audio thread to whoever listens for them
+struct PlaybackEvent {
+    PlaybackEventType type;
+    int32_t soundId;
+    // Only set for markerReached
+    int32_t markerIndex;
+    // Renderer frame the event happened at, see AudioRenderer::getFramePosition
+    int64_t framePosition;
+};
+
+/**
+ * The platform independent part of the engine: applies commands to the active players and mixes
+ * them into an output buffer.
+ *
+ * Every player is summed into one of kMaxBuses mix buses, each with its own gain and mute, which
+ * all feed the master limiter. Players on a bus at unity gain are summed straight into the output
+ * so the default setup costs nothing extra.
+ *
+ * Events of the players, like reaching the end of a sound, are pushed into a queue that a single
+ * other thread drains with takeEvents().
+ *
+ * AudioEngine drives it from the Oboe callback and OfflineRenderer drives it from a plain loop, so
+ * both run exactly the same mixing code. Commands may be posted by one control thread at a time,
+ * render() is called from a single audio thread.
+ */
+class AudioRenderer {
+public:
+    AudioRenderer(size_t maxPlayers, size_t commandQueueCapacity, size_t eventQueueCapacity = 1024);
+
+    ~AudioRenderer();
+
+    AudioRenderer(const AudioRenderer &) = delete;
+    AudioRenderer &operator=(const AudioRenderer &) = delete;
+
+    static constexpr int32_t kMaxBuses = 16;
+
+    /**
+     * Set up the limiter for the output. Allocates and takes the render lock, so call it while the
+     * stream is not running. Until then, and for any other channel count, the limiter is bypassed.
+     */
+    void configure(AudioProperties properties);
+
+    /**
+     * Apply pending commands and mix every active player into audioData, which is cleared first.
+     *
+     * @return false if a control thread was holding the render lock, audioData is silent then
+     */
+    bool render(float *audioData, int32_t numFrames, int32_t channelCount);
+
+    /**
+     * The frame the next render() call starts at. It counts every frame rendered since the renderer
+     * was created, including silent buffers, and is what scheduled commands refer to.
+     */
+    [[nodiscard]] int64_t getFramePosition() const { return mFramePosition.load(std::memory_order_relaxed); }
+
+    /**
+     * Frames the limiter delays the output by once configured, whether it is enabled or not. A frame
+     * rendered at getFramePosition() reaches the stream this many frames later.
+     */
+    [[nodiscard]] int32_t getLatencyFrames() const { return mLatencyFrames.load(std::memory_order_relaxed); }
+
+    /**
+     * Queue a command for the next render() call. If the queue is full, the backlog is applied
+     * right away on the calling thread.
+     */
+    void postCommand(const AudioCommand &command);
+
+    /**
+     * Queue several commands that the audio thread will see all at once, never split across two
+     * buffers.
+     */
+    void postCommands(const AudioCommand *commands, size_t count);
+
+    // Apply pending commands on the calling thread, for when nothing is calling render()
+    void drainCommands();
+
+    /**
+     * Announce that count players will be removed through commands, see Reaper::expect. Players
+     * swapped out by replacePlayer count as removed too.
+     */
+    void expectRemovedPlayers(int64_t count);
+
+    [[nodiscard]] ReclamationStats getReclamationStats() const { return mReaper.getStats(); }
+
+    /**
+     * Players the reaper had no room for when they were removed, which means more were removed
+     * than announced. They are kept and handed over again on later buffers, never leaked.
+     */
+    [[nodiscard]] int64_t getRetireOverflowCount() const { return mRetireOverflowCount.load(std::memory_order_relaxed); }
+
+    /**
+     * Keep removed players from being freed while a thread without the control lock reads one,
+     * see Reaper::ReadGuard. Only players that were unpublished before their removal was posted
+     * are safe to read this way.
+     */
+    [[nodiscard]] Reaper::ReadGuard guardPlayerReads() { return mReaper.guardReads(); }
+
+    /**
+     * Move up to maxCount events the players produced into events, oldest first. Must only be
+     * called from one thread at a time.
+     *
+     * @return the number of events taken
+     */
+    size_t takeEvents(PlaybackEvent *events, size_t maxCount) { return mEventQueue.pop(events, maxCount); }
+
+    // Events lost because nobody took them before the queue filled up
+    [[nodiscard]] int64_t getDroppedEventCount() const { return mDroppedEventCount.load(std::memory_order_relaxed); }
+
+    // Lowest gain the limiter applied since the last call, 1 when it didn't have to do anything
+    float takeLimiterMinGain() { return mLimiterMinGain.exchange(1.0f, std::memory_order_relaxed); }
+
+    /**
+     * Commands posted so far and commands applied so far. Once the applied count reaches the posted
+     * count read after posting a command, the effects of that command on the players are visible to
+     * the control thread too.
+     */
+    [[nodiscard]] uint64_t getPostedCommandCount() const { return mPostedCommandCount; }
+    [[nodiscard]] uint64_t getAppliedCommandCount() const { return mAppliedCommandCount.load(std::memory_order_acquire); }
+
+    // Only meaningful on the audio thread, right after render()
+    [[nodiscard]] int32_t getActivePlayerCount() const { return static_cast<int32_t>(mActivePlayers.size()); }
+
+private:
+    // Bus buffers hold this many samples, longer buffers are rendered in several chunks
+    static constexpr int32_t kBusBufferSamples = 4096;
+
+    struct Bus {
+        std::vector<float> buffer;
+        float gain = 1;
+        bool isMuted = false;
+        // Gain at the end of the last chunk, changes are ramped over a chunk so they don't click
+        float currentGain = 1;
+        // Whether buffer was cleared and rendered into during the current chunk
+        bool isUsed = false;
+
+        [[nodiscard]] float getTargetGain() const { return isMuted ? 0.0f : gain; }
+        [[nodiscard]] bool isUnity() const { return currentGain == 1.0f && getTargetGain() == 1.0f; }
+    };
+
+    void renderChunk(float *audioData, int32_t numFrames, int32_t channelCount, int64_t startFrame);
+    void renderPlayer(Player *player, float *audioData, int32_t numFrames, int32_t channelCount, int64_t startFrame);
+    void acquireRenderLock();
+    void releaseRenderLock();
+    void processCommands();
+    void applyCommand(const AudioCommand &command);
+    void retirePlayer(Player *player);
+    void retireOverflowedPlayers();
+
+    // Shared between the control threads and the audio thread
+    SpscQueue<AudioCommand> mCommandQueue;
+    std::atomic_flag mRenderLock = ATOMIC_FLAG_INIT;
+    Reaper mReaper;
+    std::atomic<uint64_t> mAppliedCommandCount { 0 };
+    // Only written by the audio thread
+    std::atomic<int64_t> mFramePosition { 0 };
+    SpscQueue<PlaybackEvent> mEventQueue;
+    std::atomic<int64_t> mDroppedEventCount { 0 };
+    std::atomic<int64_t> mRetireOverflowCount { 0 };
+
+    // Control thread state
+    uint64_t mPostedCommandCount = 0;
+    int64_t mLoggedRetireOverflowCount = 0;
+
+    std::atomic<float> mLimiterMinGain { 1.0f };
+    std::atomic<int32_t> mLatencyFrames { 0 };
+
+    // Audio thread state, only accessed while holding mRenderLock
+    std::vector<Player *> mActivePlayers;
+    // Removed players the reaper's queue was too full for, oldest first
+    std::vector<Player *> mOverflowedPlayers;
+    std::array<Bus, kMaxBuses> mBuses;
+    Limiter mLimiter;
+};
+
+#endif //AUDIOPLAYBACK_AUDIORENDERER_H
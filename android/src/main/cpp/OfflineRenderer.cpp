@@ -0,0 +1,113 @@
+#include "OfflineRenderer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+    void writeUint32(std::FILE *file, uint32_t value) {
+        const uint8_t bytes[4] = {
+                static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8),
+                static_cast<uint8_t>(value >> 16), static_cast<uint8_t>(value >> 24)
+        };
+        std::fwrite(bytes, 1, sizeof(bytes), file);
+    }
+
+    void writeUint16(std::FILE *file, uint16_t value) {
+        const uint8_t bytes[2] = { static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8) };
+        std::fwrite(bytes, 1, sizeof(bytes), file);
+    }
+}
+
+OfflineRenderer::OfflineRenderer(AudioProperties properties, int32_t framesPerBuffer)
+    : mProperties(properties)
+    , mFramesPerBuffer(std::max(framesPerBuffer, 1)) {
+    mRenderer.configure(properties);
+}
+
+OfflineRenderer::~OfflineRenderer() {
+    mRenderer.expectRemovedPlayers(mPlayerCount);
+    mRenderer.postCommand({.type = AudioCommandType::removeAllPlayers});
+    mRenderer.drainCommands();
+}
+
+Player *OfflineRenderer::addPlayer(std::unique_ptr<Player> player) {
+    Player *rawPlayer = player.release();
+    mRenderer.postCommand({.type = AudioCommandType::addPlayer, .player = rawPlayer});
+    mPlayerCount++;
+    return rawPlayer;
+}
+
+void OfflineRenderer::removePlayer(Player *player) {
+    mRenderer.expectRemovedPlayers(1);
+    mRenderer.postCommand({.type = AudioCommandType::removePlayer, .player = player});
+    mPlayerCount--;
+}
+
+Player *OfflineRenderer::replacePlayer(Player *player, std::unique_ptr<Player> replacement) {
+    Player *rawReplacement = replacement.release();
+    mRenderer.expectRemovedPlayers(1);
+    mRenderer.postCommand({.type = AudioCommandType::replacePlayer, .player = player, .replacement = rawReplacement});
+    return rawReplacement;
+}
+
+void OfflineRenderer::render(float *output, int64_t numFrames) {
+    if (!mHasSkippedLatency) {
+        mHasSkippedLatency = true;
+        std::vector<float> skipped(static_cast<size_t>(getLatencyFrames()) * mProperties.channelCount);
+        renderBuffers(skipped.data(), getLatencyFrames());
+    }
+    renderBuffers(output, numFrames);
+}
+
+void OfflineRenderer::renderBuffers(float *output, int64_t numFrames) {
+    int64_t framesRendered = 0;
+    while (framesRendered < numFrames) {
+        const auto framesInBuffer = static_cast<int32_t>(std::min<int64_t>(mFramesPerBuffer, numFrames - framesRendered));
+        mRenderer.render(output + framesRendered * mProperties.channelCount, framesInBuffer, mProperties.channelCount);
+        framesRendered += framesInBuffer;
+    }
+}
+
+std::vector<float> OfflineRenderer::renderToBuffer(int64_t numFrames) {
+    std::vector<float> output(static_cast<size_t>(numFrames * mProperties.channelCount));
+    render(output.data(), numFrames);
+    return output;
+}
+
+WriteWavFileResult OfflineRenderer::renderToWavFile(const std::string &path, int64_t numFrames) {
+    const std::vector<float> output = renderToBuffer(numFrames);
+    const auto dataSize = static_cast<uint32_t>(output.size() * sizeof(float));
+
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        return {.error = "Failed to open " + path + " for writing"};
+    }
+
+    // RIFF header followed by a WAVE_FORMAT_IEEE_FLOAT fmt chunk and the data chunk
+    std::fwrite("RIFF", 1, 4, file);
+    writeUint32(file, 36 + dataSize);
+    std::fwrite("WAVE", 1, 4, file);
+    std::fwrite("fmt ", 1, 4, file);
+    writeUint32(file, 16);
+    writeUint16(file, 3);
+    writeUint16(file, static_cast<uint16_t>(mProperties.channelCount));
+    writeUint32(file, static_cast<uint32_t>(mProperties.sampleRate));
+    writeUint32(file, static_cast<uint32_t>(mProperties.sampleRate * mProperties.channelCount * sizeof(float)));
+    writeUint16(file, static_cast<uint16_t>(mProperties.channelCount * sizeof(float)));
+    writeUint16(file, 32);
+    std::fwrite("data", 1, 4, file);
+    writeUint32(file, dataSize);
+
+    for (const float sample: output) {
+        uint32_t bits;
+        memcpy(&bits, &sample, sizeof(bits));
+        writeUint32(file, bits);
+    }
+
+    const bool failed = std::ferror(file) != 0;
+    if (std::fclose(file) != 0 || failed) {
+        return {.error = "Failed to write " + path};
+    }
+    return {.error = std::nullopt};
+}
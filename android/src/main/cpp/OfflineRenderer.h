@@ -0,0 +1,75 @@
+#ifndef AUDIOPLAYBACK_OFFLINERENDERER_H
+#define AUDIOPLAYBACK_OFFLINERENDERER_H
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "AudioConstants.h"
+#include "AudioRenderer.h"
+
+struct WriteWavFileResult {
+    std::optional<std::string> error;
+};
+
+/**
+ * Drives an AudioRenderer without an audio device, so the mixer can be measured and compared
+ * against known output on any machine.
+ *
+ * Rendering is split into buffers of framesPerBuffer frames and commands are applied at the start
+ * of the next buffer, exactly like the Oboe callback does it. Everything runs on the calling
+ * thread, which makes the output deterministic.
+ *
+ * The limiter's delay is rendered ahead and dropped before the first output, so output frame N is
+ * renderer frame N, the frame scheduled commands refer to. Commands posted between two renders
+ * land getLatencyFrames() frames into the next output, as they would on a device.
+ */
+class OfflineRenderer {
+public:
+    OfflineRenderer(AudioProperties properties, int32_t framesPerBuffer);
+    ~OfflineRenderer();
+
+    OfflineRenderer(const OfflineRenderer &) = delete;
+    OfflineRenderer &operator=(const OfflineRenderer &) = delete;
+
+    /**
+     * Hand a player over to the renderer, it is mixed from the next buffer on.
+     *
+     * @return the player, valid until it is removed
+     */
+    Player *addPlayer(std::unique_ptr<Player> player);
+    void removePlayer(Player *player);
+    // Swap player for replacement, which continues where player left off, like a stream change does
+    Player *replacePlayer(Player *player, std::unique_ptr<Player> replacement);
+
+    // Any command besides adding or removing players, which go through the methods above
+    void postCommand(const AudioCommand &command) { mRenderer.postCommand(command); }
+
+    // Events the players produced so far, see AudioRenderer::takeEvents
+    size_t takeEvents(PlaybackEvent *events, size_t maxCount) { return mRenderer.takeEvents(events, maxCount); }
+
+    // Render numFrames interleaved frames into output
+    void render(float *output, int64_t numFrames);
+    std::vector<float> renderToBuffer(int64_t numFrames);
+
+    // Render numFrames frames into a 32-bit float WAV file
+    WriteWavFileResult renderToWavFile(const std::string &path, int64_t numFrames);
+
+    [[nodiscard]] AudioProperties getProperties() const { return mProperties; }
+    [[nodiscard]] int32_t getLatencyFrames() const { return mRenderer.getLatencyFrames(); }
+
+private:
+    static constexpr size_t kMaxPlayers = 1024;
+    static constexpr size_t kCommandQueueCapacity = 1024;
+
+    void renderBuffers(float *output, int64_t numFrames);
+
+    const AudioProperties mProperties;
+    const int32_t mFramesPerBuffer;
+    AudioRenderer mRenderer { kMaxPlayers, kCommandQueueCapacity };
+    int64_t mPlayerCount = 0;
+    bool mHasSkippedLatency = false;
+};
+
+#endif //AUDIOPLAYBACK_OFFLINERENDERER_H
@@ -20,32 +20,186 @@
 
 #include "AAssetDataSource.h"
 
-#include "NDKExtractor.h"
+#include <algorithm>
+#include <cmath>
+
+#include "ChannelMixer.h"
+#include "Decoders.h"
+
+namespace {
+
+SampleBuffer convertFloatToStorageFormat(const float *samples, size_t numSamples, SampleFormat storageFormat) {
+    SampleBuffer buffer(numSamples * getBytesPerSample(storageFormat));
+    if(storageFormat == SampleFormat::int16) {
+        oboe::convertFloatToPcm16(samples, reinterpret_cast<int16_t *>(buffer.data()), static_cast<int32_t>(numSamples));
+    } else {
+        auto output = reinterpret_cast<int8_t *>(buffer.data());
+        for (size_t i = 0; i < numSamples; ++i) {
+            output[i] = static_cast<int8_t>(std::clamp(std::lround(samples[i] * 128.0f), -128L, 127L));
+        }
+    }
+    return buffer;
+}
+
+}
 
 NewFromCompressedAssetResult
 AAssetDataSource::newFromCompressedAsset(int fd, int offset,
-                                         int length, AudioProperties targetProperties) {
+                                         int length, AudioProperties targetProperties,
+                                         ResamplerQuality resamplerQuality,
+                                         SampleFormat storageFormat,
+                                         const std::atomic<bool> *cancelled) {
+
+    auto openResult = openDecoder(fd, offset, length);
+    if(openResult.error) {
+        return {.dataSource = nullptr, .error = openResult.error };
+    }
+    const AudioProperties decodedProperties = openResult.decoder->getProperties();
+
+    // The decoder's output can be kept as is when nothing has to be converted
+    const bool needsConversion = decodedProperties.sampleRate != targetProperties.sampleRate
+            || (decodedProperties.channelCount != targetProperties.channelCount && decodedProperties.channelCount != 1);
+    // Decode straight into the format that is kept, or into floats to convert from
+    const SampleFormat decodeFormat = storageFormat == SampleFormat::int16 && !needsConversion
+            ? SampleFormat::int16
+            : SampleFormat::float32;
 
-    auto decodeResult = NDKExtractor::decodeFileDescriptor(fd, offset, length, targetProperties);
+    auto decodeResult = openResult.decoder->decodeToEnd(decodeFormat, cancelled);
+    // Free the decoder before any conversion allocates more
+    openResult.decoder.reset();
     if(decodeResult.error) {
         return {.dataSource = nullptr, .error = decodeResult.error };
     }
 
-    auto numSamples = decodeResult.data->size() / sizeof(int16_t);
+    auto numSamples = decodeResult.data->size() / getBytesPerSample(decodeFormat);
+    if(!needsConversion && decodeFormat == storageFormat) {
+        return {
+                .dataSource = new AAssetDataSource(std::move(*decodeResult.data),
+                                                   storageFormat,
+                                                   numSamples,
+                                                   decodedProperties),
+                .error = std::nullopt
+        };
+    }
+
+    auto samples = reinterpret_cast<const float *>(decodeResult.data->data());
+    return newFromFloatSamples(samples, numSamples, std::move(*decodeResult.data), decodedProperties,
+                               targetProperties, resamplerQuality, storageFormat);
+}
+
+NewFromCompressedAssetResult
+AAssetDataSource::newFromDataSource(const DataSource &source,
+                                    AudioProperties targetProperties,
+                                    ResamplerQuality resamplerQuality,
+                                    SampleFormat storageFormat) {
+    const void *samples = source.getSamples();
+    if(samples == nullptr) {
+        return {.dataSource = nullptr, .error = "Streamed sounds can't be converted"};
+    }
 
-    // Now we know the exact number of samples we can create a float array to hold the audio data
-    auto outputBuffer = std::make_unique<float[]>(numSamples);
+    const auto numSamples = static_cast<size_t>(source.getSize());
+    if(source.getSampleFormat() == SampleFormat::float32) {
+        return newFromFloatSamples(static_cast<const float *>(samples), numSamples, {}, source.getProperties(),
+                                   targetProperties, resamplerQuality, storageFormat);
+    }
 
-    // The NDK decoder can only decode to int16, we need to convert to floats
-    oboe::convertPcm16ToFloat(
-            reinterpret_cast<int16_t*>(decodeResult.data->data()),
-            outputBuffer.get(),
-            static_cast<int32_t>(numSamples));
+    SampleBuffer floatBuffer(numSamples * sizeof(float));
+    auto floatSamples = reinterpret_cast<float *>(floatBuffer.data());
+    if(source.getSampleFormat() == SampleFormat::int16) {
+        oboe::convertPcm16ToFloat(static_cast<const int16_t *>(samples), floatSamples, static_cast<int32_t>(numSamples));
+    } else {
+        auto input = static_cast<const int8_t *>(samples);
+        for (size_t i = 0; i < numSamples; ++i) {
+            floatSamples[i] = static_cast<float>(input[i]) * (1.0f / 128.0f);
+        }
+    }
+    return newFromFloatSamples(floatSamples, numSamples, std::move(floatBuffer), source.getProperties(),
+                               targetProperties, resamplerQuality, storageFormat);
+}
+
+NewFromCompressedAssetResult
+AAssetDataSource::newFromFloatSamples(const float *samples, size_t numSamples, SampleBuffer samplesOwner,
+                                      AudioProperties sourceProperties,
+                                      AudioProperties targetProperties,
+                                      ResamplerQuality resamplerQuality,
+                                      SampleFormat storageFormat) {
+    // Holds the samples once they were converted, until then they are read from samplesOwner
+    std::unique_ptr<float[]> outputBuffer;
+
+    auto channelCount = sourceProperties.channelCount;
+    if(sourceProperties.sampleRate != targetProperties.sampleRate) {
+        Resampler resampler(sourceProperties.sampleRate, targetProperties.sampleRate, channelCount, resamplerQuality);
+
+        auto inputFrames = static_cast<int64_t>(numSamples) / channelCount;
+        auto outputFrames = resampler.getOutputFrameCount(inputFrames);
+        // Written in full by the resampler, so left uninitialized instead of zeroed
+        std::unique_ptr<float[]> resampledBuffer(new float[outputFrames * channelCount]);
+        resampler.process(samples, inputFrames, resampledBuffer.get());
+
+        samplesOwner = {};
+        outputBuffer = std::move(resampledBuffer);
+        samples = outputBuffer.get();
+        numSamples = outputFrames * channelCount;
+    }
+
+    // Mono sounds stay mono in memory and are expanded by the player while mixing, which halves
+    // their footprint. Any other mismatch is converted once here.
+    if(channelCount != targetProperties.channelCount && channelCount != 1) {
+        ChannelMixer mixer(channelCount, targetProperties.channelCount);
+
+        auto numFrames = static_cast<int64_t>(numSamples) / channelCount;
+        std::unique_ptr<float[]> mixedBuffer(new float[numFrames * targetProperties.channelCount]);
+        mixer.process(samples, numFrames, mixedBuffer.get());
+
+        samplesOwner = {};
+        outputBuffer = std::move(mixedBuffer);
+        samples = outputBuffer.get();
+        numSamples = numFrames * targetProperties.channelCount;
+        channelCount = targetProperties.channelCount;
+    }
+
+    AudioProperties properties {
+            .channelCount = channelCount,
+            .sampleRate = targetProperties.sampleRate
+    };
+
+    if(storageFormat != SampleFormat::float32) {
+        return {
+                .dataSource = new AAssetDataSource(convertFloatToStorageFormat(samples, numSamples, storageFormat),
+                                                   storageFormat,
+                                                   numSamples,
+                                                   properties),
+                .error = std::nullopt
+        };
+    }
+
+    if(!outputBuffer) {
+        // Nothing had to be converted, keep the samples as they are
+        if(!samplesOwner.empty()) {
+            return {
+                    .dataSource = new AAssetDataSource(std::move(samplesOwner), SampleFormat::float32, numSamples, properties),
+                    .error = std::nullopt
+            };
+        }
+        outputBuffer.reset(new float[numSamples]);
+        std::copy(samples, samples + numSamples, outputBuffer.get());
+    }
 
     return {
             .dataSource = new AAssetDataSource(std::move(outputBuffer),
                                                numSamples,
-                                               targetProperties),
+                                               properties),
             .error = std::nullopt
     };
 }
+
+AAssetDataSource *AAssetDataSource::newFromCachedPcm(CachedPcm cachedPcm, SampleFormat storageFormat) {
+    if(cachedPcm.sampleFormat == storageFormat) {
+        return new AAssetDataSource(std::move(cachedPcm));
+    }
+
+    const auto sampleCount = static_cast<size_t>(cachedPcm.sampleCount);
+    SampleBuffer buffer(sampleCount * getBytesPerSample(storageFormat));
+    Decoder::convertSamples(cachedPcm.samples, cachedPcm.sampleFormat, buffer.data(), storageFormat, sampleCount);
+    return new AAssetDataSource(std::move(buffer), storageFormat, sampleCount, cachedPcm.properties);
+}
@@ -17,10 +17,15 @@
 #ifndef AUDIOPLAYBACK_AASSETDATASOURCE_H
 #define AUDIOPLAYBACK_AASSETDATASOURCE_H
 
+#include <atomic>
 #include <optional>
+#include <vector>
 #include <android/asset_manager.h>
 #include <AudioConstants.h>
 #include "DataSource.h"
+#include "PcmCache.h"
+#include "Resampler.h"
+#include <utils/DefaultInitAllocator.h>
 
 class AAssetDataSource;
 
@@ -32,26 +37,91 @@ struct NewFromCompressedAssetResult {
 class AAssetDataSource : public DataSource {
 
 public:
-    [[nodiscard]] int64_t getSize() const override { return mBufferSize; }
+    [[nodiscard]] int64_t getSize() const override { return mSampleCount; }
     [[nodiscard]] AudioProperties getProperties() const override { return mProperties; }
-    [[nodiscard]] const float* getData() const override { return mBuffer.get(); }
+    [[nodiscard]] const float* getData() const override {
+        return mSampleFormat == SampleFormat::float32 ? static_cast<const float *>(mSamples) : nullptr;
+    }
+    [[nodiscard]] SampleFormat getSampleFormat() const override { return mSampleFormat; }
+    [[nodiscard]] const void* getSamples() const override { return mSamples; }
+    [[nodiscard]] bool isMemoryMapped() const override { return mMappedFile != nullptr; }
 
+    /**
+     * Decode the whole asset and keep it in memory as storageFormat. Float keeps the full quality,
+     * int16 halves the memory with no audible difference for most sounds and int8 quarters it at
+     * the cost of audible noise on quiet passages.
+     */
     static NewFromCompressedAssetResult newFromCompressedAsset(
             int fd, int offset, int length,
-            AudioProperties targetProperties);
+            AudioProperties targetProperties,
+            ResamplerQuality resamplerQuality,
+            SampleFormat storageFormat,
+            const std::atomic<bool> *cancelled = nullptr);
+
+    /**
+     * Plays the samples straight from the mapped cache entry, nothing is decoded or copied. Only
+     * when the entry holds another format than storageFormat, which is how float sounds are
+     * cached, are the samples converted into memory.
+     */
+    static AAssetDataSource *newFromCachedPcm(CachedPcm cachedPcm, SampleFormat storageFormat);
 
+    /**
+     * Copy the samples of another resident source, converted to targetProperties the same way a
+     * decoded sound would be. Used to carry loaded sounds over to a stream with other properties.
+     */
+    static NewFromCompressedAssetResult newFromDataSource(
+            const DataSource &source,
+            AudioProperties targetProperties,
+            ResamplerQuality resamplerQuality,
+            SampleFormat storageFormat);
 
 private:
 
+    /**
+     * Resample and mix numSamples float samples to targetProperties and store them as
+     * storageFormat. samplesOwner holds the samples if they are not kept elsewhere, it is released
+     * as soon as they were converted.
+     */
+    static NewFromCompressedAssetResult newFromFloatSamples(
+            const float *samples, size_t numSamples, SampleBuffer samplesOwner,
+            AudioProperties sourceProperties,
+            AudioProperties targetProperties,
+            ResamplerQuality resamplerQuality,
+            SampleFormat storageFormat);
+
     AAssetDataSource(std::unique_ptr<float[]> data, size_t size,
                      const AudioProperties properties)
-            : mBuffer(std::move(data))
-            , mBufferSize(size)
+            : mFloatBuffer(std::move(data))
+            , mSamples(mFloatBuffer.get())
+            , mSampleCount(size)
+            , mSampleFormat(SampleFormat::float32)
             , mProperties(properties) {
     }
 
-    const std::unique_ptr<float[]> mBuffer;
-    const int64_t mBufferSize;
+    AAssetDataSource(SampleBuffer data, SampleFormat sampleFormat, size_t size,
+                     const AudioProperties properties)
+            : mPackedBuffer(std::move(data))
+            , mSamples(mPackedBuffer.data())
+            , mSampleCount(size)
+            , mSampleFormat(sampleFormat)
+            , mProperties(properties) {
+    }
+
+    explicit AAssetDataSource(CachedPcm cachedPcm)
+            : mMappedFile(std::move(cachedPcm.file))
+            , mSamples(cachedPcm.samples)
+            , mSampleCount(cachedPcm.sampleCount)
+            , mSampleFormat(cachedPcm.sampleFormat)
+            , mProperties(cachedPcm.properties) {
+    }
+
+    // Exactly one of them holds the samples
+    const std::unique_ptr<float[]> mFloatBuffer;
+    const SampleBuffer mPackedBuffer;
+    const std::unique_ptr<MappedFile> mMappedFile;
+    const void *const mSamples;
+    const int64_t mSampleCount;
+    const SampleFormat mSampleFormat;
     const AudioProperties mProperties;
 
 };
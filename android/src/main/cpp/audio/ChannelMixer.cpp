@@ -0,0 +1,49 @@
+#include "ChannelMixer.h"
+
+ChannelMixer::ChannelMixer(int32_t inputChannelCount, int32_t outputChannelCount)
+    : mInputChannelCount(inputChannelCount)
+    , mOutputChannelCount(outputChannelCount)
+    , mMatrix(static_cast<size_t>(inputChannelCount) * outputChannelCount, 0.0f) {
+
+    if (inputChannelCount == 1) {
+        for (int32_t out = 0; out < outputChannelCount; ++out) {
+            mMatrix[out] = 1.0f;
+        }
+    } else if (outputChannelCount == 1) {
+        for (int32_t in = 0; in < inputChannelCount; ++in) {
+            mMatrix[in] = 1.0f / static_cast<float>(inputChannelCount);
+        }
+    } else {
+        for (int32_t out = 0; out < outputChannelCount; ++out) {
+            int32_t sources = 0;
+            for (int32_t in = out; in < inputChannelCount; in += outputChannelCount) {
+                sources++;
+            }
+            for (int32_t in = out; in < inputChannelCount; in += outputChannelCount) {
+                mMatrix[out * inputChannelCount + in] = 1.0f / static_cast<float>(sources);
+            }
+        }
+    }
+}
+
+ChannelMixer::ChannelMixer(int32_t inputChannelCount, int32_t outputChannelCount, std::vector<float> matrix)
+    : mInputChannelCount(inputChannelCount)
+    , mOutputChannelCount(outputChannelCount)
+    , mMatrix(std::move(matrix)) {
+}
+
+void ChannelMixer::process(const float *input, int64_t numFrames, float *output) const {
+    for (int64_t i = 0; i < numFrames; ++i) {
+        const float *inputFrame = input + i * mInputChannelCount;
+        float *outputFrame = output + i * mOutputChannelCount;
+
+        for (int32_t out = 0; out < mOutputChannelCount; ++out) {
+            const float *gains = mMatrix.data() + out * mInputChannelCount;
+            float sum = 0.0f;
+            for (int32_t in = 0; in < mInputChannelCount; ++in) {
+                sum += gains[in] * inputFrame[in];
+            }
+            outputFrame[out] = sum;
+        }
+    }
+}
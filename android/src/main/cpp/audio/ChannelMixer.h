@@ -0,0 +1,34 @@
+#ifndef AUDIOPLAYBACK_CHANNELMIXER_H
+#define AUDIOPLAYBACK_CHANNELMIXER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * Converts interleaved float audio between channel counts with a gain matrix.
+ *
+ * Without a known speaker layout the default matrix is deliberately simple: mono is copied to
+ * every output channel, everything is averaged down to mono, and otherwise input channel i is
+ * folded onto output channel i % outputChannelCount and normalized by how many inputs share it.
+ */
+class ChannelMixer {
+public:
+    ChannelMixer(int32_t inputChannelCount, int32_t outputChannelCount);
+
+    /**
+     * Use a custom matrix instead, where matrix[out * inputChannelCount + in] is the gain of input
+     * channel in on output channel out.
+     */
+    ChannelMixer(int32_t inputChannelCount, int32_t outputChannelCount, std::vector<float> matrix);
+
+    void process(const float *input, int64_t numFrames, float *output) const;
+
+private:
+    const int32_t mInputChannelCount;
+    const int32_t mOutputChannelCount;
+    std::vector<float> mMatrix;
+};
+
+#endif //AUDIOPLAYBACK_CHANNELMIXER_H
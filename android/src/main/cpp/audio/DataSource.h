@@ -20,12 +20,51 @@
 #include <cstdint>
 #include <AudioConstants.h>
 
+// How the resident samples of a DataSource are stored. The integer formats trade precision for
+// memory and are converted to float by the mixer as they are played.
+enum class SampleFormat {
+    float32, int16, int8
+};
+
+inline int32_t getBytesPerSample(SampleFormat sampleFormat) {
+    switch (sampleFormat) {
+        case SampleFormat::int16: return sizeof(int16_t);
+        case SampleFormat::int8: return sizeof(int8_t);
+        case SampleFormat::float32:
+        default: return sizeof(float);
+    }
+}
+
 class DataSource {
 public:
     virtual ~DataSource(){};
+    // Number of samples, across all channels
     virtual int64_t getSize() const = 0;
     virtual AudioProperties getProperties() const  = 0;
+    // nullptr when the samples are not stored as floats
     virtual const float* getData() const = 0;
+    virtual SampleFormat getSampleFormat() const { return SampleFormat::float32; }
+    // The resident samples in getSampleFormat()
+    virtual const void* getSamples() const { return getData(); }
+    // Mapped samples live in the page cache and can be dropped by the system, unlike heap memory
+    virtual bool isMemoryMapped() const { return false; }
+};
+
+/**
+ * A DataSource that does not keep its samples resident, getData() returns nullptr and frames are
+ * pulled from the audio thread instead. None of these may block or allocate.
+ */
+class StreamingSource : public DataSource {
+public:
+    /**
+     * @return the number of frames copied into targetData, fewer than requested if the source
+     * fell behind or the end was reached
+     */
+    virtual int32_t readFrames(float *targetData, int32_t numFrames) = 0;
+    // true once every frame of a non looping source has been read
+    virtual bool isFinished() const = 0;
+    virtual void seekTo(int64_t frameIndex) = 0;
+    virtual void setLooping(bool isLooping) = 0;
 };
 
 
@@ -0,0 +1,61 @@
+#include "Decoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+DecodeResult Decoder::decodeToEnd(SampleFormat outputFormat, const std::atomic<bool> *cancelled) {
+    const AudioProperties properties = getProperties();
+    const int64_t durationUs = getDurationUs();
+    const size_t bytesPerSample = getBytesPerSample(outputFormat);
+
+    SampleBuffer data{};
+    if(durationUs > 0) {
+        const int64_t expectedFrames = durationUs * properties.sampleRate / 1000000 + kExtraFramesToReserve;
+        data.reserve(static_cast<size_t>(expectedFrames * properties.channelCount) * bytesPerSample);
+    }
+
+    const OutputCallback onOutput = [&](const void *samples, SampleFormat format, size_t count) {
+        const size_t start = data.size();
+        const size_t bytes = count * bytesPerSample;
+        if(durationUs > 0 && start + bytes > data.capacity()) {
+            // The duration was off, grow by a quarter instead of doubling what is most of the sound
+            data.reserve(std::max(start + bytes, data.capacity() + data.capacity() / 4));
+        }
+        data.resize(start + bytes);
+        convertSamples(samples, format, data.data() + start, outputFormat, count);
+    };
+
+    while(decodeNext(onOutput)) {
+        if (cancelled && cancelled->load(std::memory_order_relaxed)) {
+            return {.error = "Loading the sound was cancelled"};
+        }
+    }
+    if(auto error = getError()) {
+        return {.error = std::move(error)};
+    }
+
+    // Only copies when the duration was far off, otherwise the slack is not worth a second buffer
+    if(data.capacity() - data.size() > data.size() / 8) {
+        data.shrink_to_fit();
+    }
+    return {.data = std::move(data)};
+}
+
+void Decoder::convertSamples(const void *input, SampleFormat inputFormat, void *output, SampleFormat outputFormat, size_t count) {
+    if(inputFormat == outputFormat) {
+        memcpy(output, input, count * getBytesPerSample(inputFormat));
+    } else if(inputFormat == SampleFormat::int16 && outputFormat == SampleFormat::float32) {
+        auto in = static_cast<const int16_t *>(input);
+        auto out = static_cast<float *>(output);
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = static_cast<float>(in[i]) * (1.0f / 32768.0f);
+        }
+    } else if(inputFormat == SampleFormat::float32 && outputFormat == SampleFormat::int16) {
+        auto in = static_cast<const float *>(input);
+        auto out = static_cast<int16_t *>(output);
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = static_cast<int16_t>(std::clamp(std::lround(in[i] * 32768.0f), -32768L, 32767L));
+        }
+    }
+}
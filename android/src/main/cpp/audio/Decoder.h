@@ -0,0 +1,74 @@
+#ifndef AUDIOPLAYBACK_DECODER_H
+#define AUDIOPLAYBACK_DECODER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <AudioConstants.h>
+#include "DataSource.h"
+#include <utils/DefaultInitAllocator.h>
+
+class Decoder;
+
+struct DecodeResult {
+    // Interleaved samples in the requested format, with the properties of the file
+    std::optional<SampleBuffer> data;
+    std::optional<std::string> error;
+};
+
+struct OpenDecoderResult {
+    std::unique_ptr<Decoder> decoder;
+    std::optional<std::string> error;
+};
+
+/**
+ * Turns an audio file into interleaved PCM, a buffer at a time, in the file's own sample rate and
+ * channel count. Implemented by MediaCodec on Android and by software decoders that also build on
+ * any other platform.
+ */
+class Decoder {
+public:
+    virtual ~Decoder() = default;
+
+    // Receives one buffer of decoded audio, count is in samples and format is float32 or int16
+    using OutputCallback = std::function<void(const void *samples, SampleFormat format, size_t count)>;
+
+    [[nodiscard]] virtual AudioProperties getProperties() const = 0;
+    // 0 when the file doesn't tell
+    [[nodiscard]] virtual int64_t getDurationUs() const = 0;
+
+    /**
+     * Decode the next part of the file and hand it to onOutput, possibly in several buffers.
+     *
+     * @return false once the end of the file has been decoded, or decoding failed, see getError()
+     */
+    virtual bool decodeNext(const OutputCallback &onOutput) = 0;
+
+    // Set once decoding failed in a way that decoding further can't recover from
+    [[nodiscard]] virtual std::optional<std::string> getError() const { return std::nullopt; }
+
+    // Restart decoding from the given position
+    virtual void seekTo(int64_t timeUs) = 0;
+
+    /**
+     * Decode the rest of the file into a single buffer of outputFormat, either float32 or int16.
+     * The buffer is sized from getDurationUs() and every decoded buffer is converted as it
+     * arrives, so the samples are written exactly once, without zeroing the buffer first. Stops
+     * with an error as soon as cancelled is set, if given, or the decoder fails.
+     */
+    DecodeResult decodeToEnd(SampleFormat outputFormat, const std::atomic<bool> *cancelled = nullptr);
+
+    // Convert count samples between float32 and int16, in either direction
+    static void convertSamples(const void *input, SampleFormat inputFormat, void *output, SampleFormat outputFormat, size_t count);
+
+private:
+    // Frames the decoder may add on top of the duration, like the padding of MP3 and AAC
+    static constexpr int64_t kExtraFramesToReserve = 4096;
+};
+
+#endif //AUDIOPLAYBACK_DECODER_H
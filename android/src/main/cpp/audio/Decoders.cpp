@@ -0,0 +1,27 @@
+#include "Decoders.h"
+
+#include <utils/logging.h>
+
+#include "NDKExtractor.h"
+#include "WavDecoder.h"
+#include "WavFile.h"
+
+namespace {
+
+// The WAV decoder maps the whole file up front, longer files are read by MediaCodec as they play.
+// 16 MiB is about 90 seconds of 16 bit stereo at 48 kHz.
+constexpr int kMaxSoftwareDecodedFileSize = 16 * 1024 * 1024;
+
+}
+
+OpenDecoderResult openDecoder(int fd, int offset, int length) {
+    if(length <= kMaxSoftwareDecodedFileSize && isWavFile(fd, offset, length)) {
+        auto wavResult = WavDecoder::open(fd, offset, length);
+        if(!wavResult.error) {
+            return wavResult;
+        }
+        LOGD("Decoding WAV file with MediaCodec instead: %s", wavResult.error->c_str());
+    }
+
+    return NDKExtractor::openFileDescriptor(fd, offset, length);
+}
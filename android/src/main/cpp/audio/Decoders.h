@@ -0,0 +1,19 @@
+#ifndef AUDIOPLAYBACK_DECODERS_H
+#define AUDIOPLAYBACK_DECODERS_H
+
+#include "Decoder.h"
+
+/**
+ * Pick the decoder for a file. Short uncompressed clips are decoded in software, which skips
+ * creating and tearing down a codec, a cost that dominates loading many small sound effects.
+ * Everything else, and any file the WAV decoder rejects, goes to MediaCodec, which reads the file
+ * incrementally and may use hardware for long compressed tracks.
+ *
+ * WAV is the only software decoder. Software Ogg Vorbis and MP3 decoding is not implemented, both
+ * go to MediaCodec. Adding it means vendoring stb_vorbis and minimp3, wrapping each in a Decoder
+ * picked here by the file's magic bytes ahead of the MediaCodec fallback, and timing them in
+ * DecoderBenchmark against MediaCodec on a device.
+ */
+OpenDecoderResult openDecoder(int fd, int offset, int length);
+
+#endif //AUDIOPLAYBACK_DECODERS_H
@@ -0,0 +1,198 @@
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#include "Limiter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Below this distance from unity a released gain is as good as there
+constexpr float kSettledGainDifference = 1e-6f;
+
+// gains[i] = threshold / max(peak of frame i, threshold), which is exactly 1 when frame i is under
+// the threshold
+void computeRequiredGains(const float *input, int32_t channelCount, int32_t numFrames, float threshold, float *gains) {
+    int32_t i = 0;
+    // Stereo is by far the most common output, split the frames into left and right lanes
+    if (channelCount == 2) {
+#if defined(__ARM_NEON)
+        const float32x4_t thresholds = vdupq_n_f32(threshold);
+        for (; i + 4 <= numFrames; i += 4) {
+            const float32x4x2_t frames = vld2q_f32(input + i * 2);
+            const float32x4_t peaks = vmaxq_f32(vmaxq_f32(vabsq_f32(frames.val[0]), vabsq_f32(frames.val[1])), thresholds);
+#if defined(__aarch64__)
+            vst1q_f32(gains + i, vdivq_f32(thresholds, peaks));
+#else
+            // 32 bit ARM has no vector division, refine the reciprocal estimate instead
+            float32x4_t reciprocal = vrecpeq_f32(peaks);
+            reciprocal = vmulq_f32(vrecpsq_f32(peaks, reciprocal), reciprocal);
+            reciprocal = vmulq_f32(vrecpsq_f32(peaks, reciprocal), reciprocal);
+            vst1q_f32(gains + i, vminq_f32(vmulq_f32(thresholds, reciprocal), vdupq_n_f32(1.0f)));
+#endif
+        }
+#elif defined(__SSE__)
+        const __m128 thresholds = _mm_set1_ps(threshold);
+        const __m128 signBits = _mm_set1_ps(-0.0f);
+        for (; i + 4 <= numFrames; i += 4) {
+            const __m128 first = _mm_andnot_ps(signBits, _mm_loadu_ps(input + i * 2));
+            const __m128 second = _mm_andnot_ps(signBits, _mm_loadu_ps(input + i * 2 + 4));
+            // Left samples are the even lanes of the two registers, right samples the odd ones
+            const __m128 peaks = _mm_max_ps(_mm_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0)),
+                                            _mm_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1)));
+            _mm_storeu_ps(gains + i, _mm_div_ps(thresholds, _mm_max_ps(peaks, thresholds)));
+        }
+#endif
+    }
+
+    for (; i < numFrames; ++i) {
+        const float *frame = input + static_cast<size_t>(i) * channelCount;
+        float peak = threshold;
+        for (int32_t c = 0; c < channelCount; ++c) peak = std::max(peak, std::fabs(frame[c]));
+        gains[i] = threshold / peak;
+    }
+}
+
+// output[i * channelCount + c] = gains[i] * input[i * channelCount + c] for numFrames frames
+void applyGains(float *output, const float *input, int32_t channelCount, int32_t numFrames, const float *gains) {
+    int32_t i = 0;
+    if (channelCount == 2) {
+#if defined(__ARM_NEON)
+        for (; i + 4 <= numFrames; i += 4) {
+            const float32x4_t frameGains = vld1q_f32(gains + i);
+            const float32x4x2_t interleaved = vzipq_f32(frameGains, frameGains);
+            vst1q_f32(output + i * 2, vmulq_f32(vld1q_f32(input + i * 2), interleaved.val[0]));
+            vst1q_f32(output + i * 2 + 4, vmulq_f32(vld1q_f32(input + i * 2 + 4), interleaved.val[1]));
+        }
+#elif defined(__SSE__)
+        for (; i + 4 <= numFrames; i += 4) {
+            const __m128 frameGains = _mm_loadu_ps(gains + i);
+            _mm_storeu_ps(output + i * 2, _mm_mul_ps(_mm_loadu_ps(input + i * 2), _mm_unpacklo_ps(frameGains, frameGains)));
+            _mm_storeu_ps(output + i * 2 + 4, _mm_mul_ps(_mm_loadu_ps(input + i * 2 + 4), _mm_unpackhi_ps(frameGains, frameGains)));
+        }
+#endif
+    }
+
+    for (; i < numFrames; ++i) {
+        for (int32_t c = 0; c < channelCount; ++c) {
+            output[i * channelCount + c] = input[i * channelCount + c] * gains[i];
+        }
+    }
+}
+
+}
+
+void Limiter::configure(AudioProperties properties) {
+    mChannelCount = std::max(properties.channelCount, 1);
+    mLookaheadFrames = std::max(static_cast<int32_t>(static_cast<float>(properties.sampleRate) * kLookaheadMs / 1000.0f), 1);
+    mReleaseCoefficient = 1.0f - std::exp(-1000.0f / (kReleaseMs * static_cast<float>(properties.sampleRate)));
+
+    mHistory.assign(static_cast<size_t>(mLookaheadFrames + kBlockFrames) * mChannelCount, 0.0f);
+    mRequiredGains.assign(kBlockFrames, 1.0f);
+    mGains.assign(kBlockFrames, 1.0f);
+
+    mWindowMinimums.assign(mLookaheadFrames, 1.0f);
+    mWindowSum = static_cast<float>(mLookaheadFrames);
+    mPosition = 0;
+
+    // The window spans the lookahead plus the frame being output
+    mQueueFrames.assign(mLookaheadFrames + 2, 0);
+    mQueueGains.assign(mLookaheadFrames + 2, 1.0f);
+    mQueueHead = 0;
+    mQueueSize = 0;
+
+    mFrame = 0;
+    mGain = 1;
+    mMinGain = 1;
+}
+
+void Limiter::process(float *audioData, int32_t numFrames) {
+    if (mLookaheadFrames == 0) return;
+
+    const size_t lookaheadSamples = static_cast<size_t>(mLookaheadFrames) * mChannelCount;
+    // Recomputed once per buffer so that rounding errors of the running sum can't build up
+    mWindowSum = 0;
+    for (const float minimum: mWindowMinimums) mWindowSum += minimum;
+
+    // The peaks and the gains are worked out a block at a time, so that only the running minimum
+    // and the release are left to go frame by frame
+    for (int32_t offset = 0; offset < numFrames; offset += kBlockFrames) {
+        const int32_t blockFrames = std::min(kBlockFrames, numFrames - offset);
+        const size_t blockSamples = static_cast<size_t>(blockFrames) * mChannelCount;
+        float *block = audioData + static_cast<size_t>(offset) * mChannelCount;
+        memcpy(mHistory.data() + lookaheadSamples, block, blockSamples * sizeof(float));
+
+        bool isUnderThreshold = true;
+        if (mIsEnabled) {
+            computeRequiredGains(block, mChannelCount, blockFrames, kThreshold, mRequiredGains.data());
+            for (int32_t i = 0; i < blockFrames; ++i) isUnderThreshold &= mRequiredGains[i] == 1.0f;
+        } else {
+            std::fill(mRequiredGains.begin(), mRequiredGains.begin() + blockFrames, 1.0f);
+        }
+
+        if (isUnderThreshold && isSettled()) {
+            // Nothing in the window needs limiting and the release is done, the output is just the
+            // delayed input. Every gain the queue could hold is unity, which an empty queue stands for.
+            memcpy(block, mHistory.data(), blockSamples * sizeof(float));
+            mQueueSize = 0;
+            mGain = 1;
+            mFrame += blockFrames;
+        } else {
+            updateGains(blockFrames);
+            applyGains(block, mHistory.data(), mChannelCount, blockFrames, mGains.data());
+        }
+
+        memmove(mHistory.data(), mHistory.data() + blockSamples, lookaheadSamples * sizeof(float));
+    }
+}
+
+void Limiter::updateGains(int32_t numFrames) {
+    const size_t queueCapacity = mQueueFrames.size();
+    const auto queueIndex = [queueCapacity](size_t index) { return index < queueCapacity ? index : index - queueCapacity; };
+
+    for (int32_t i = 0; i < numFrames; ++i) {
+        const float requiredGain = mRequiredGains[i];
+
+        // Older frames needing less reduction can never be the window minimum again
+        while (mQueueSize > 0 && mQueueGains[queueIndex(mQueueHead + mQueueSize - 1)] >= requiredGain) {
+            mQueueSize--;
+        }
+        const size_t tail = queueIndex(mQueueHead + mQueueSize);
+        mQueueFrames[tail] = mFrame;
+        mQueueGains[tail] = requiredGain;
+        mQueueSize++;
+        while (mQueueFrames[mQueueHead] < mFrame - mLookaheadFrames) {
+            mQueueHead = queueIndex(mQueueHead + 1);
+            mQueueSize--;
+        }
+
+        // Every minimum in the average covers the frame about to be output, so the average is low
+        // enough for it while still changing smoothly
+        const float windowMinimum = mQueueGains[mQueueHead];
+        mWindowSum += windowMinimum - mWindowMinimums[mPosition];
+        mWindowMinimums[mPosition] = windowMinimum;
+        const float targetGain = std::min(mWindowSum / static_cast<float>(mLookaheadFrames), 1.0f);
+        mGain = targetGain < mGain ? targetGain : mGain + (targetGain - mGain) * mReleaseCoefficient;
+        mMinGain = std::min(mMinGain, mGain);
+        mGains[i] = mGain;
+
+        mPosition = mPosition + 1 == mLookaheadFrames ? 0 : mPosition + 1;
+        mFrame++;
+    }
+}
+
+bool Limiter::isSettled() const {
+    // The minimums are at most 1, so they sum up to exactly the lookahead only when they all are
+    return 1.0f - mGain < kSettledGainDifference && mWindowSum == static_cast<float>(mLookaheadFrames);
+}
+
+float Limiter::takeMinGain() {
+    const float minGain = mMinGain;
+    mMinGain = 1;
+    return minGain;
+}
@@ -0,0 +1,75 @@
+#ifndef AUDIOPLAYBACK_LIMITER_H
+#define AUDIOPLAYBACK_LIMITER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "AudioConstants.h"
+
+/**
+ * Lookahead peak limiter for the master output, keeping the mix under -1 dBFS instead of letting
+ * the device clip it.
+ *
+ * The signal is delayed by the lookahead, which gives the gain time to come down smoothly before
+ * a peak arrives: the gain follows a moving average of the lowest gain needed within the
+ * lookahead window, so it never overshoots, and recovers with an exponential release. All
+ * channels share the same gain so the stereo image doesn't move.
+ *
+ * A disabled limiter still delays the signal, so that turning it on or off doesn't shift the
+ * output in time. The gain releases to unity from wherever it was instead of jumping there.
+ *
+ * configure() allocates, process() doesn't and is meant for the audio thread.
+ */
+class Limiter {
+public:
+    void configure(AudioProperties properties);
+
+    // Limit numFrames interleaved frames in place, delaying them by getLatencyFrames()
+    void process(float *audioData, int32_t numFrames);
+
+    void setEnabled(bool isEnabled) { mIsEnabled = isEnabled; }
+    [[nodiscard]] int32_t getChannelCount() const { return mChannelCount; }
+    // 0 until configured
+    [[nodiscard]] int32_t getLatencyFrames() const { return mLookaheadFrames; }
+    // Lowest gain applied since the last call, 1 when nothing was limited
+    float takeMinGain();
+
+private:
+    static constexpr float kThreshold = 0.891f;
+    static constexpr float kLookaheadMs = 1.5f;
+    static constexpr float kReleaseMs = 60.0f;
+    // Frames the peak detection and the gain are worked out for at a time
+    static constexpr int32_t kBlockFrames = 64;
+
+    // Work out mGains for the frames whose required gains are in mRequiredGains
+    void updateGains(int32_t numFrames);
+    // The gain is back at unity and nothing in the lookahead window asks for less
+    [[nodiscard]] bool isSettled() const;
+
+    bool mIsEnabled = true;
+    int32_t mChannelCount = 0;
+    int32_t mLookaheadFrames = 0;
+    float mReleaseCoefficient = 0;
+
+    // The last mLookaheadFrames frames of input, followed by the block being processed
+    std::vector<float> mHistory;
+    std::vector<float> mRequiredGains;
+    std::vector<float> mGains;
+
+    // The last mLookaheadFrames window minimums, averaged into the gain
+    std::vector<float> mWindowMinimums;
+    float mWindowSum = 0;
+    int32_t mPosition = 0;
+
+    // Monotonic queue of the gains needed by the frames in the lookahead window, lowest first
+    std::vector<int64_t> mQueueFrames;
+    std::vector<float> mQueueGains;
+    size_t mQueueHead = 0;
+    size_t mQueueSize = 0;
+
+    int64_t mFrame = 0;
+    float mGain = 1;
+    float mMinGain = 1;
+};
+
+#endif //AUDIOPLAYBACK_LIMITER_H
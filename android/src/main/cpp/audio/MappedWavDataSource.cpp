@@ -0,0 +1,50 @@
+#include "MappedWavDataSource.h"
+
+#include "WavFile.h"
+
+NewFromWavFileResult MappedWavDataSource::newFromFileDescriptor(int fd, int offset, int length,
+                                                                AudioProperties targetProperties) {
+    auto mapResult = MappedFile::map(fd, offset, static_cast<size_t>(length));
+    if(mapResult.error) {
+        return {.dataSource = nullptr, .error = mapResult.error};
+    }
+
+    auto parseResult = parseWavFile(mapResult.file->getData(), mapResult.file->getSize());
+    if(parseResult.error) {
+        return {.dataSource = nullptr, .error = parseResult.error};
+    }
+    const WavFile &wav = *parseResult.file;
+
+    SampleFormat sampleFormat;
+    if(wav.encoding == WavEncoding::pcm16) {
+        sampleFormat = SampleFormat::int16;
+    } else if(wav.encoding == WavEncoding::float32) {
+        sampleFormat = SampleFormat::float32;
+    } else {
+        return {.dataSource = nullptr, .error = "Unsupported WAV sample format, only 16 bit PCM and 32 bit float can be mapped"};
+    }
+
+    if(wav.sampleRate != targetProperties.sampleRate) {
+        return {.dataSource = nullptr, .error = "The WAV file's sample rate differs from the stream's"};
+    }
+    if(wav.channelCount != targetProperties.channelCount && wav.channelCount != 1) {
+        return {.dataSource = nullptr, .error = "The WAV file's channel count differs from the stream's"};
+    }
+
+    // Samples are read directly from the mapping, which needs them aligned
+    if(reinterpret_cast<uintptr_t>(wav.samples) % getBytesPerSample(sampleFormat) != 0) {
+        return {.dataSource = nullptr, .error = "The WAV file's samples are not aligned"};
+    }
+
+    AudioProperties properties {
+            .channelCount = wav.channelCount,
+            .sampleRate = wav.sampleRate
+    };
+
+    return {
+            .dataSource = new MappedWavDataSource(std::move(mapResult.file), wav.samples,
+                                                  wav.frameCount * wav.channelCount,
+                                                  sampleFormat, properties),
+            .error = std::nullopt
+    };
+}
@@ -0,0 +1,56 @@
+#ifndef AUDIOPLAYBACK_MAPPEDWAVDATASOURCE_H
+#define AUDIOPLAYBACK_MAPPEDWAVDATASOURCE_H
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <AudioConstants.h>
+#include <utils/MappedFile.h>
+#include "DataSource.h"
+
+class MappedWavDataSource;
+
+struct NewFromWavFileResult {
+    MappedWavDataSource *dataSource;
+    std::optional<std::string> error;
+};
+
+/**
+ * Plays uncompressed 16 bit or float WAV files straight from a memory mapping of the file, without
+ * decoding or copying them. 16 bit samples are converted to float by the mixer as they are played.
+ *
+ * Only files that already match the sample rate of the stream can be mapped, and they must either
+ * be mono or have the channel count of the stream. Anything else has to be decoded instead.
+ */
+class MappedWavDataSource : public DataSource {
+public:
+    static NewFromWavFileResult newFromFileDescriptor(int fd, int offset, int length,
+                                                      AudioProperties targetProperties);
+
+    [[nodiscard]] int64_t getSize() const override { return mSampleCount; }
+    [[nodiscard]] AudioProperties getProperties() const override { return mProperties; }
+    [[nodiscard]] const float* getData() const override {
+        return mSampleFormat == SampleFormat::float32 ? static_cast<const float *>(mSamples) : nullptr;
+    }
+    [[nodiscard]] SampleFormat getSampleFormat() const override { return mSampleFormat; }
+    [[nodiscard]] const void* getSamples() const override { return mSamples; }
+    [[nodiscard]] bool isMemoryMapped() const override { return true; }
+
+private:
+    MappedWavDataSource(std::unique_ptr<MappedFile> file, const void *samples, int64_t sampleCount,
+                        SampleFormat sampleFormat, AudioProperties properties)
+            : mFile(std::move(file))
+            , mSamples(samples)
+            , mSampleCount(sampleCount)
+            , mSampleFormat(sampleFormat)
+            , mProperties(properties) {
+    }
+
+    const std::unique_ptr<MappedFile> mFile;
+    const void *const mSamples;
+    const int64_t mSampleCount;
+    const SampleFormat mSampleFormat;
+    const AudioProperties mProperties;
+};
+
+#endif //AUDIOPLAYBACK_MAPPEDWAVDATASOURCE_H
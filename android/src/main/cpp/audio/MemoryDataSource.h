@@ -0,0 +1,31 @@
+#ifndef AUDIOPLAYBACK_MEMORYDATASOURCE_H
+#define AUDIOPLAYBACK_MEMORYDATASOURCE_H
+
+#include <utility>
+#include <vector>
+
+#include <AudioConstants.h>
+#include "DataSource.h"
+
+/**
+ * A DataSource over samples that are already decoded, for example synthesized test signals
+ * rendered by OfflineRenderer. The samples must already be in the stream's format.
+ */
+class MemoryDataSource : public DataSource {
+
+public:
+    MemoryDataSource(std::vector<float> samples, AudioProperties properties)
+        : mSamples(std::move(samples))
+        , mProperties(properties) {
+    }
+
+    [[nodiscard]] int64_t getSize() const override { return static_cast<int64_t>(mSamples.size()); }
+    [[nodiscard]] AudioProperties getProperties() const override { return mProperties; }
+    [[nodiscard]] const float* getData() const override { return mSamples.data(); }
+
+private:
+    const std::vector<float> mSamples;
+    const AudioProperties mProperties;
+};
+
+#endif //AUDIOPLAYBACK_MEMORYDATASOURCE_H
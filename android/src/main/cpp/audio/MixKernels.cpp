@@ -0,0 +1,266 @@
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#include "MixKernels.h"
+
+namespace {
+
+// Folded into the gain so that converting a 16 bit sample costs nothing more than the conversion
+constexpr float kInt16ToFloat = 1.0f / 32768.0f;
+constexpr float kInt8ToFloat = 1.0f / 128.0f;
+
+// Ramps only cover the few milliseconds around a volume change, so they are left to the compiler
+template<typename Sample>
+void mixWithGainRampImpl(float *output, const Sample *input, int32_t channelCount, int32_t numFrames,
+                         float gain, float gainStep, float scale) {
+    for (int32_t i = 0; i < numFrames; ++i) {
+        const float frameGain = (gain + gainStep * static_cast<float>(i)) * scale;
+        for (int32_t c = 0; c < channelCount; ++c) {
+            output[i * channelCount + c] += frameGain * static_cast<float>(input[i * channelCount + c]);
+        }
+    }
+}
+
+template<typename Sample>
+void mixMonoWithGainRampImpl(float *output, int32_t outputChannelCount, const Sample *input, int32_t numFrames,
+                             float gain, float gainStep, float scale) {
+    for (int32_t i = 0; i < numFrames; ++i) {
+        const float sample = (gain + gainStep * static_cast<float>(i)) * scale * static_cast<float>(input[i]);
+        for (int32_t c = 0; c < outputChannelCount; ++c) {
+            output[i * outputChannelCount + c] += sample;
+        }
+    }
+}
+
+}
+
+void mixWithGain(float *output, const float *input, int32_t numSamples, float gain) {
+    int32_t i = 0;
+#if defined(__ARM_NEON)
+    const float32x4_t gains = vdupq_n_f32(gain);
+    for (; i + 8 <= numSamples; i += 8) {
+        vst1q_f32(output + i, vmlaq_f32(vld1q_f32(output + i), vld1q_f32(input + i), gains));
+        vst1q_f32(output + i + 4, vmlaq_f32(vld1q_f32(output + i + 4), vld1q_f32(input + i + 4), gains));
+    }
+#elif defined(__SSE__)
+    const __m128 gains = _mm_set1_ps(gain);
+    for (; i + 8 <= numSamples; i += 8) {
+        _mm_storeu_ps(output + i, _mm_add_ps(_mm_loadu_ps(output + i), _mm_mul_ps(_mm_loadu_ps(input + i), gains)));
+        _mm_storeu_ps(output + i + 4, _mm_add_ps(_mm_loadu_ps(output + i + 4), _mm_mul_ps(_mm_loadu_ps(input + i + 4), gains)));
+    }
+#endif
+    for (; i < numSamples; ++i) {
+        output[i] += gain * input[i];
+    }
+}
+
+void mixMonoWithGain(float *output, int32_t outputChannelCount, const float *input, int32_t numFrames, float gain) {
+    if (outputChannelCount == 1) {
+        mixWithGain(output, input, numFrames, gain);
+        return;
+    }
+
+    int32_t i = 0;
+    // Stereo is by far the most common output, duplicate every sample into left and right lanes
+    if (outputChannelCount == 2) {
+#if defined(__ARM_NEON)
+        const float32x4_t gains = vdupq_n_f32(gain);
+        for (; i + 4 <= numFrames; i += 4) {
+            const float32x4_t samples = vmulq_f32(vld1q_f32(input + i), gains);
+            const float32x4x2_t interleaved = vzipq_f32(samples, samples);
+            float *target = output + i * 2;
+            vst1q_f32(target, vaddq_f32(vld1q_f32(target), interleaved.val[0]));
+            vst1q_f32(target + 4, vaddq_f32(vld1q_f32(target + 4), interleaved.val[1]));
+        }
+#elif defined(__SSE__)
+        const __m128 gains = _mm_set1_ps(gain);
+        for (; i + 4 <= numFrames; i += 4) {
+            const __m128 samples = _mm_mul_ps(_mm_loadu_ps(input + i), gains);
+            float *target = output + i * 2;
+            _mm_storeu_ps(target, _mm_add_ps(_mm_loadu_ps(target), _mm_unpacklo_ps(samples, samples)));
+            _mm_storeu_ps(target + 4, _mm_add_ps(_mm_loadu_ps(target + 4), _mm_unpackhi_ps(samples, samples)));
+        }
+#endif
+    }
+
+    for (; i < numFrames; ++i) {
+        const float sample = gain * input[i];
+        float *target = output + i * outputChannelCount;
+        for (int32_t c = 0; c < outputChannelCount; ++c) {
+            target[c] += sample;
+        }
+    }
+}
+
+void mixWithGain(float *output, const int16_t *input, int32_t numSamples, float gain) {
+    const float scaledGain = gain * kInt16ToFloat;
+    int32_t i = 0;
+#if defined(__ARM_NEON)
+    const float32x4_t gains = vdupq_n_f32(scaledGain);
+    for (; i + 8 <= numSamples; i += 8) {
+        const int16x8_t samples = vld1q_s16(input + i);
+        const float32x4_t low = vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples)));
+        const float32x4_t high = vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples)));
+        vst1q_f32(output + i, vmlaq_f32(vld1q_f32(output + i), low, gains));
+        vst1q_f32(output + i + 4, vmlaq_f32(vld1q_f32(output + i + 4), high, gains));
+    }
+#elif defined(__SSE2__)
+    const __m128 gains = _mm_set1_ps(scaledGain);
+    for (; i + 8 <= numSamples; i += 8) {
+        const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i));
+        // Duplicating every sample into both halves of a 32 bit lane and shifting back sign extends it
+        const __m128 low = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16));
+        const __m128 high = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16));
+        _mm_storeu_ps(output + i, _mm_add_ps(_mm_loadu_ps(output + i), _mm_mul_ps(low, gains)));
+        _mm_storeu_ps(output + i + 4, _mm_add_ps(_mm_loadu_ps(output + i + 4), _mm_mul_ps(high, gains)));
+    }
+#endif
+    for (; i < numSamples; ++i) {
+        output[i] += scaledGain * static_cast<float>(input[i]);
+    }
+}
+
+void mixMonoWithGain(float *output, int32_t outputChannelCount, const int16_t *input, int32_t numFrames, float gain) {
+    if (outputChannelCount == 1) {
+        mixWithGain(output, input, numFrames, gain);
+        return;
+    }
+
+    const float scaledGain = gain * kInt16ToFloat;
+    int32_t i = 0;
+    if (outputChannelCount == 2) {
+#if defined(__ARM_NEON)
+        const float32x4_t gains = vdupq_n_f32(scaledGain);
+        for (; i + 4 <= numFrames; i += 4) {
+            const float32x4_t samples = vmulq_f32(vcvtq_f32_s32(vmovl_s16(vld1_s16(input + i))), gains);
+            const float32x4x2_t interleaved = vzipq_f32(samples, samples);
+            float *target = output + i * 2;
+            vst1q_f32(target, vaddq_f32(vld1q_f32(target), interleaved.val[0]));
+            vst1q_f32(target + 4, vaddq_f32(vld1q_f32(target + 4), interleaved.val[1]));
+        }
+#elif defined(__SSE2__)
+        const __m128 gains = _mm_set1_ps(scaledGain);
+        for (; i + 4 <= numFrames; i += 4) {
+            const __m128i raw = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(input + i));
+            const __m128 samples = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(raw, raw), 16)), gains);
+            float *target = output + i * 2;
+            _mm_storeu_ps(target, _mm_add_ps(_mm_loadu_ps(target), _mm_unpacklo_ps(samples, samples)));
+            _mm_storeu_ps(target + 4, _mm_add_ps(_mm_loadu_ps(target + 4), _mm_unpackhi_ps(samples, samples)));
+        }
+#endif
+    }
+
+    for (; i < numFrames; ++i) {
+        const float sample = scaledGain * static_cast<float>(input[i]);
+        float *target = output + i * outputChannelCount;
+        for (int32_t c = 0; c < outputChannelCount; ++c) {
+            target[c] += sample;
+        }
+    }
+}
+
+void mixWithGain(float *output, const int8_t *input, int32_t numSamples, float gain) {
+    const float scaledGain = gain * kInt8ToFloat;
+    int32_t i = 0;
+#if defined(__ARM_NEON)
+    const float32x4_t gains = vdupq_n_f32(scaledGain);
+    for (; i + 8 <= numSamples; i += 8) {
+        const int16x8_t samples = vmovl_s8(vld1_s8(input + i));
+        const float32x4_t low = vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples)));
+        const float32x4_t high = vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples)));
+        vst1q_f32(output + i, vmlaq_f32(vld1q_f32(output + i), low, gains));
+        vst1q_f32(output + i + 4, vmlaq_f32(vld1q_f32(output + i + 4), high, gains));
+    }
+#elif defined(__SSE2__)
+    const __m128 gains = _mm_set1_ps(scaledGain);
+    for (; i + 8 <= numSamples; i += 8) {
+        const __m128i raw = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(input + i));
+        // Same sign extension trick as for 16 bit, twice
+        const __m128i samples = _mm_srai_epi16(_mm_unpacklo_epi8(raw, raw), 8);
+        const __m128 low = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16));
+        const __m128 high = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16));
+        _mm_storeu_ps(output + i, _mm_add_ps(_mm_loadu_ps(output + i), _mm_mul_ps(low, gains)));
+        _mm_storeu_ps(output + i + 4, _mm_add_ps(_mm_loadu_ps(output + i + 4), _mm_mul_ps(high, gains)));
+    }
+#endif
+    for (; i < numSamples; ++i) {
+        output[i] += scaledGain * static_cast<float>(input[i]);
+    }
+}
+
+void mixMonoWithGain(float *output, int32_t outputChannelCount, const int8_t *input, int32_t numFrames, float gain) {
+    if (outputChannelCount == 1) {
+        mixWithGain(output, input, numFrames, gain);
+        return;
+    }
+
+    const float scaledGain = gain * kInt8ToFloat;
+    int32_t i = 0;
+    if (outputChannelCount == 2) {
+#if defined(__ARM_NEON)
+        const float32x4_t gains = vdupq_n_f32(scaledGain);
+        for (; i + 8 <= numFrames; i += 8) {
+            const int16x8_t samples = vmovl_s8(vld1_s8(input + i));
+            const float32x4_t low = vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples))), gains);
+            const float32x4_t high = vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples))), gains);
+            const float32x4x2_t lowInterleaved = vzipq_f32(low, low);
+            const float32x4x2_t highInterleaved = vzipq_f32(high, high);
+            float *target = output + i * 2;
+            vst1q_f32(target, vaddq_f32(vld1q_f32(target), lowInterleaved.val[0]));
+            vst1q_f32(target + 4, vaddq_f32(vld1q_f32(target + 4), lowInterleaved.val[1]));
+            vst1q_f32(target + 8, vaddq_f32(vld1q_f32(target + 8), highInterleaved.val[0]));
+            vst1q_f32(target + 12, vaddq_f32(vld1q_f32(target + 12), highInterleaved.val[1]));
+        }
+#elif defined(__SSE2__)
+        const __m128 gains = _mm_set1_ps(scaledGain);
+        for (; i + 8 <= numFrames; i += 8) {
+            const __m128i raw = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(input + i));
+            const __m128i samples = _mm_srai_epi16(_mm_unpacklo_epi8(raw, raw), 8);
+            const __m128 low = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16)), gains);
+            const __m128 high = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16)), gains);
+            float *target = output + i * 2;
+            _mm_storeu_ps(target, _mm_add_ps(_mm_loadu_ps(target), _mm_unpacklo_ps(low, low)));
+            _mm_storeu_ps(target + 4, _mm_add_ps(_mm_loadu_ps(target + 4), _mm_unpackhi_ps(low, low)));
+            _mm_storeu_ps(target + 8, _mm_add_ps(_mm_loadu_ps(target + 8), _mm_unpacklo_ps(high, high)));
+            _mm_storeu_ps(target + 12, _mm_add_ps(_mm_loadu_ps(target + 12), _mm_unpackhi_ps(high, high)));
+        }
+#endif
+    }
+
+    for (; i < numFrames; ++i) {
+        const float sample = scaledGain * static_cast<float>(input[i]);
+        float *target = output + i * outputChannelCount;
+        for (int32_t c = 0; c < outputChannelCount; ++c) {
+            target[c] += sample;
+        }
+    }
+}
+
+void mixWithGainRamp(float *output, const float *input, int32_t channelCount, int32_t numFrames, float gain, float gainStep) {
+    mixWithGainRampImpl(output, input, channelCount, numFrames, gain, gainStep, 1.0f);
+}
+
+void mixWithGainRamp(float *output, const int16_t *input, int32_t channelCount, int32_t numFrames, float gain, float gainStep) {
+    mixWithGainRampImpl(output, input, channelCount, numFrames, gain, gainStep, kInt16ToFloat);
+}
+
+void mixWithGainRamp(float *output, const int8_t *input, int32_t channelCount, int32_t numFrames, float gain, float gainStep) {
+    mixWithGainRampImpl(output, input, channelCount, numFrames, gain, gainStep, kInt8ToFloat);
+}
+
+void mixMonoWithGainRamp(float *output, int32_t outputChannelCount, const float *input, int32_t numFrames, float gain, float gainStep) {
+    mixMonoWithGainRampImpl(output, outputChannelCount, input, numFrames, gain, gainStep, 1.0f);
+}
+
+void mixMonoWithGainRamp(float *output, int32_t outputChannelCount, const int16_t *input, int32_t numFrames, float gain, float gainStep) {
+    mixMonoWithGainRampImpl(output, outputChannelCount, input, numFrames, gain, gainStep, kInt16ToFloat);
+}
+
+void mixMonoWithGainRamp(float *output, int32_t outputChannelCount, const int8_t *input, int32_t numFrames, float gain, float gainStep) {
+    mixMonoWithGainRampImpl(output, outputChannelCount, input, numFrames, gain, gainStep, kInt8ToFloat);
+}
@@ -0,0 +1,37 @@
+#ifndef AUDIOPLAYBACK_MIXKERNELS_H
+#define AUDIOPLAYBACK_MIXKERNELS_H
+
+#include <cstdint>
+
+/**
+ * Inner loops of the mixer, vectorized with NEON or SSE where available. They accumulate into
+ * output, which is expected to hold whatever has already been mixed for the current buffer.
+ */
+
+// output[i] += gain * input[i] for numSamples samples
+void mixWithGain(float *output, const float *input, int32_t numSamples, float gain);
+
+// Expands a mono input over every interleaved output channel:
+// output[i * outputChannelCount + c] += gain * input[i] for numFrames frames
+void mixMonoWithGain(float *output, int32_t outputChannelCount, const float *input, int32_t numFrames, float gain);
+
+// Same as above for 16 bit input, converted to float on the fly
+void mixWithGain(float *output, const int16_t *input, int32_t numSamples, float gain);
+void mixMonoWithGain(float *output, int32_t outputChannelCount, const int16_t *input, int32_t numFrames, float gain);
+
+// And for 8 bit input
+void mixWithGain(float *output, const int8_t *input, int32_t numSamples, float gain);
+void mixMonoWithGain(float *output, int32_t outputChannelCount, const int8_t *input, int32_t numFrames, float gain);
+
+// With a gain that changes every frame, for volume ramps:
+// output[i * channelCount + c] += (gain + i * gainStep) * input[i * channelCount + c] for numFrames frames
+void mixWithGainRamp(float *output, const float *input, int32_t channelCount, int32_t numFrames, float gain, float gainStep);
+void mixWithGainRamp(float *output, const int16_t *input, int32_t channelCount, int32_t numFrames, float gain, float gainStep);
+void mixWithGainRamp(float *output, const int8_t *input, int32_t channelCount, int32_t numFrames, float gain, float gainStep);
+
+// Same as above for a mono input expanded over every output channel
+void mixMonoWithGainRamp(float *output, int32_t outputChannelCount, const float *input, int32_t numFrames, float gain, float gainStep);
+void mixMonoWithGainRamp(float *output, int32_t outputChannelCount, const int16_t *input, int32_t numFrames, float gain, float gainStep);
+void mixMonoWithGainRamp(float *output, int32_t outputChannelCount, const int8_t *input, int32_t numFrames, float gain, float gainStep);
+
+#endif //AUDIOPLAYBACK_MIXKERNELS_H
@@ -16,8 +16,7 @@
 
 #include <sys/types.h>
 
-#include <cstring>
-#include <sstream>
+#include <algorithm>
 
 #include <media/NdkMediaExtractor.h>
 #include <utils/logging.h>
@@ -25,7 +24,7 @@
 
 #include "NDKExtractor.h"
 
-DecodeFileDescriptorResult NDKExtractor::decodeFileDescriptor(int fd, int offset, int length, AudioProperties targetProperties) {
+OpenDecoderResult NDKExtractor::openFileDescriptor(int fd, int offset, int length) {
     auto extractor = AMediaExtractor_new();
     auto amResult = AMediaExtractor_setDataSourceFd(
             extractor,
@@ -34,112 +33,145 @@ DecodeFileDescriptorResult NDKExtractor::decodeFileDescriptor(int fd, int offset
             static_cast<off64_t>(length));
 
     if (amResult != AMEDIA_OK){
+        AMediaExtractor_delete(extractor);
         return {.error = "Decoding sound file failed"};
     }
 
     // Specify our desired output format by creating it from our source
     auto format = AMediaExtractor_getTrackFormat(extractor, 0);
+    auto cleanUp = [&]() {
+        AMediaFormat_delete(format);
+        AMediaExtractor_delete(extractor);
+    };
 
+    // The sample rate is converted after decoding if it doesn't match the stream
     int32_t sampleRate;
-    if (AMediaFormat_getInt32(format, AMEDIAFORMAT_KEY_SAMPLE_RATE, &sampleRate)){
-        if (sampleRate != targetProperties.sampleRate){
-            std::stringstream error;
-            error
-                << "Resampling audio files is not supported."
-                << "The sample rate of the audio file, "
-                << sampleRate
-                << ", doesn't match the sample rate of the stream, "
-                << targetProperties.sampleRate << ".";
-
-            return {.error = error.str()};
-        }
-    } else {
+    if (!AMediaFormat_getInt32(format, AMEDIAFORMAT_KEY_SAMPLE_RATE, &sampleRate)){
+        cleanUp();
         return {.error = "Failed to load sound file: could not determine sample rate"};
     };
 
+    // Same for the channel count
     int32_t channelCount;
-    if (AMediaFormat_getInt32(format, AMEDIAFORMAT_KEY_CHANNEL_COUNT, &channelCount)){
-        if (channelCount != targetProperties.channelCount){
-            std::stringstream error;
-            error
-                    << "The channel count of the audio file, "
-                    << channelCount
-                    << ", doesn't match the channel count of the stream, "
-                    << targetProperties.channelCount << ".";
-
-            return {.error = error.str()};
-        }
-    } else {
+    if (!AMediaFormat_getInt32(format, AMEDIAFORMAT_KEY_CHANNEL_COUNT, &channelCount)){
+        cleanUp();
         return {.error = "Failed to load sound file: could not determine channel count"};
     }
 
     const char *mimeType;
     if (!AMediaFormat_getString(format, AMEDIAFORMAT_KEY_MIME, &mimeType)) {
+        cleanUp();
         return {.error = "Failed to load sound file: could not determine mimeType"};
     }
 
+    int64_t durationUs = 0;
+    if (!AMediaFormat_getInt64(format, AMEDIAFORMAT_KEY_DURATION, &durationUs)) {
+        durationUs = 0;
+    }
+
     // Obtain the correct decoder
     AMediaExtractor_selectTrack(extractor, 0);
     auto codec = AMediaCodec_createDecoderByType(mimeType);
+    if (codec == nullptr) {
+        cleanUp();
+        return {.error = "Failed to load sound file: no decoder available for " + std::string(mimeType)};
+    }
     AMediaCodec_configure(codec, format, nullptr, nullptr, 0);
     AMediaCodec_start(codec);
 
-    std::vector<uint8_t> data{};
-    // DECODE
-
-    bool isExtracting = true;
-    bool isDecoding = true;
-
-    while(isExtracting || isDecoding){
-
-        if (isExtracting){
+    AudioProperties properties {.channelCount = channelCount, .sampleRate = sampleRate};
+    return {
+        .decoder = std::unique_ptr<Decoder>(new NDKExtractor(extractor, format, codec, properties, durationUs)),
+        .error = std::nullopt
+    };
+}
 
-            auto inputIndex = AMediaCodec_dequeueInputBuffer(codec, 2000);
+NDKExtractor::~NDKExtractor() {
+    // Clean up
+    AMediaCodec_stop(mCodec);
+    AMediaFormat_delete(mFormat);
+    AMediaCodec_delete(mCodec);
+    AMediaExtractor_delete(mExtractor);
+}
 
-            if(inputIndex >= 0) {
+bool NDKExtractor::decodeNext(const OutputCallback &onOutput) {
+    // Fill every input buffer the codec has free. When it has none left it is busy with all of
+    // them and can only make progress by producing output, so that is the only time to wait.
+    bool isCodecFull = true;
+    while(mIsExtracting) {
+        auto inputIndex = AMediaCodec_dequeueInputBuffer(mCodec, 0);
+        if(inputIndex < 0) break;
 
-                // Obtain the actual buffer and read the encoded data into it
-                size_t inputSize {};
-                auto inputBuffer = AMediaCodec_getInputBuffer(codec, inputIndex, &inputSize);
+        queueInput(inputIndex);
+        isCodecFull = false;
+    }
 
-                if(inputBuffer) {
-                    auto sampleSize = AMediaExtractor_readSampleData(extractor, inputBuffer, inputSize);
-                    auto presentationTimeUs = AMediaExtractor_getSampleTime(extractor);
+    if(mIsDecoding) {
+        const int32_t channelCount = mProperties.channelCount;
 
-                    if (sampleSize > 0){
-                        AMediaCodec_queueInputBuffer(codec, inputIndex, 0, sampleSize, presentationTimeUs, 0);
-                        AMediaExtractor_advance(extractor);
-                    } else {
-                        isExtracting = false;
-                        AMediaCodec_queueInputBuffer(codec, inputIndex, 0, 0, presentationTimeUs, AMEDIACODEC_BUFFER_FLAG_END_OF_STREAM);
+        AMediaCodecBufferInfo bufferInfo{};
+        auto outputIndex = AMediaCodec_dequeueOutputBuffer(mCodec, &bufferInfo, isCodecFull ? kCodecTimeoutUs : 0);
+        while(outputIndex >= 0 || outputIndex == AMEDIACODEC_INFO_OUTPUT_FORMAT_CHANGED
+              || outputIndex == AMEDIACODEC_INFO_OUTPUT_BUFFERS_CHANGED) {
+            if(outputIndex >= 0) {
+                auto outputBuffer = AMediaCodec_getOutputBuffer(mCodec, outputIndex, nullptr);
+                if(outputBuffer) {
+                    int64_t skippedSamples = 0;
+                    const int64_t bufferSamples = bufferInfo.size / static_cast<int64_t>(sizeof(int16_t));
+                    if (bufferInfo.presentationTimeUs < mSkipUntilUs) {
+                        // Seeking lands on the previous sync sample, drop what comes before the target
+                        auto skippedFrames = (mSkipUntilUs - bufferInfo.presentationTimeUs) * mProperties.sampleRate / 1000000;
+                        skippedSamples = std::min<int64_t>(skippedFrames * channelCount, bufferSamples);
+                    }
+                    if(skippedSamples < bufferSamples) {
+                        auto samples = reinterpret_cast<const int16_t *>(outputBuffer + bufferInfo.offset);
+                        onOutput(samples + skippedSamples, SampleFormat::int16, static_cast<size_t>(bufferSamples - skippedSamples));
                     }
                 }
-            }
-        }
-
-        if(isDecoding) {
-            AMediaCodecBufferInfo bufferInfo{};
-            auto outputIndex = AMediaCodec_dequeueOutputBuffer(codec, &bufferInfo, 2000);
-            while(outputIndex >= 0) {
-                auto outputBuffer = AMediaCodec_getOutputBuffer(codec, outputIndex, nullptr);
-                if(outputBuffer) {
-                    data.insert(data.end(), outputBuffer, outputBuffer + bufferInfo.size);
+                AMediaCodec_releaseOutputBuffer(mCodec, outputIndex, false);
+                if(bufferInfo.flags & AMEDIACODEC_BUFFER_FLAG_END_OF_STREAM) {
+                    mIsDecoding = false;
+                    break;
                 }
-                AMediaCodec_releaseOutputBuffer(codec, outputIndex, false);
-                outputIndex = AMediaCodec_dequeueOutputBuffer(codec, &bufferInfo, 0);
             }
+            outputIndex = AMediaCodec_dequeueOutputBuffer(mCodec, &bufferInfo, 0);
+        }
 
-            if(bufferInfo.flags & AMEDIACODEC_BUFFER_FLAG_END_OF_STREAM) {
-                isDecoding = false;
-            }
+        // Anything but "try again later" means the codec is in an error state and won't produce
+        // more output, so it would never reach the end of the stream either
+        if(mIsDecoding && outputIndex < 0 && outputIndex != AMEDIACODEC_INFO_TRY_AGAIN_LATER) {
+            LOGE("MediaCodec failed to decode: %zd", outputIndex);
+            mError = "Failed to decode the sound file, MediaCodec error " + std::to_string(outputIndex);
+            mIsExtracting = false;
+            mIsDecoding = false;
         }
     }
 
-    // Clean up
-    AMediaFormat_delete(format);
-    AMediaCodec_delete(codec);
-    AMediaExtractor_delete(extractor);
+    return mIsExtracting || mIsDecoding;
+}
+
+void NDKExtractor::queueInput(ssize_t inputIndex) {
+    // Obtain the actual buffer and read the encoded data into it
+    size_t inputSize {};
+    auto inputBuffer = AMediaCodec_getInputBuffer(mCodec, inputIndex, &inputSize);
+    if(!inputBuffer) return;
+
+    auto sampleSize = AMediaExtractor_readSampleData(mExtractor, inputBuffer, inputSize);
+    auto presentationTimeUs = AMediaExtractor_getSampleTime(mExtractor);
 
-    return {.data = data};
+    if (sampleSize > 0){
+        AMediaCodec_queueInputBuffer(mCodec, inputIndex, 0, sampleSize, presentationTimeUs, 0);
+        AMediaExtractor_advance(mExtractor);
+    } else {
+        mIsExtracting = false;
+        AMediaCodec_queueInputBuffer(mCodec, inputIndex, 0, 0, presentationTimeUs, AMEDIACODEC_BUFFER_FLAG_END_OF_STREAM);
+    }
 }
 
+void NDKExtractor::seekTo(int64_t timeUs) {
+    AMediaExtractor_seekTo(mExtractor, timeUs, AMEDIAEXTRACTOR_SEEK_PREVIOUS_SYNC);
+    AMediaCodec_flush(mCodec);
+    mIsExtracting = true;
+    mIsDecoding = true;
+    mSkipUntilUs = timeUs;
+}
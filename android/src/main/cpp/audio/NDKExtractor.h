@@ -19,19 +19,66 @@
 
 
 #include <cstdint>
+#include <memory>
 #include <android/asset_manager.h>
+#include <media/NdkMediaExtractor.h>
 #include <AudioConstants.h>
+#include "Decoder.h"
 #include "utils/logging.h"
 
-struct DecodeFileDescriptorResult {
-    std::optional<std::vector<uint8_t>> data;
-    std::optional<std::string> error;
-};
+/**
+ * Decodes any format the device supports with AMediaCodec. The codec always outputs int16.
+ */
+class NDKExtractor : public Decoder {
+public:
+    ~NDKExtractor() override;
 
+    /**
+     * Open the first track of the file and start a decoder for it, without decoding anything yet.
+     * Decoded audio is in the file's own format, use getProperties() to find out which one it is.
+     */
+    static OpenDecoderResult openFileDescriptor(int fd, int offset, int length);
 
-class NDKExtractor {
-public:
-    static DecodeFileDescriptorResult decodeFileDescriptor(int fd, int offset, int length, AudioProperties targetProperties);
+    /**
+     * Feed the codec every input buffer it has free and hand whatever PCM it produced to onOutput.
+     * Only blocks while the codec holds all of its input buffers, until the next output is ready.
+     */
+    bool decodeNext(const OutputCallback &onOutput) override;
+
+    /**
+     * Restart decoding from the given position. Output before that position is dropped.
+     */
+    void seekTo(int64_t timeUs) override;
+
+    [[nodiscard]] AudioProperties getProperties() const override { return mProperties; }
+    [[nodiscard]] int64_t getDurationUs() const override { return mDurationUs; }
+    [[nodiscard]] std::optional<std::string> getError() const override { return mError; }
+
+private:
+    // Upper bound for waiting on the codec, it normally returns as soon as a buffer is ready
+    static constexpr int64_t kCodecTimeoutUs = 10000;
+
+    void queueInput(ssize_t inputIndex);
+
+    NDKExtractor(AMediaExtractor *extractor, AMediaFormat *format, AMediaCodec *codec,
+                 AudioProperties properties, int64_t durationUs)
+        : mExtractor(extractor)
+        , mFormat(format)
+        , mCodec(codec)
+        , mProperties(properties)
+        , mDurationUs(durationUs) {
+    }
+
+    AMediaExtractor *mExtractor;
+    AMediaFormat *mFormat;
+    AMediaCodec *mCodec;
+    const AudioProperties mProperties;
+    const int64_t mDurationUs;
+
+    bool mIsExtracting = true;
+    bool mIsDecoding = true;
+    int64_t mSkipUntilUs = 0;
+    std::optional<std::string> mError;
 };
 
 #endif //AUDIOPLAYBACK_NDKMEDIAEXTRACTOR_H
@@ -0,0 +1,319 @@
+#include "PcmCache.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <utils/logging.h>
+#include "Decoder.h"
+
+namespace {
+
+constexpr char kMagic[4] = {'A', 'P', 'C', 'M'};
+
+struct PcmCacheHeader {
+    char magic[4];
+    uint32_t version;
+    int32_t channelCount;
+    int32_t sampleRate;
+    int32_t sampleFormat;
+    int32_t reserved;
+    int64_t sampleCount;
+    uint64_t contentHash;
+};
+
+// The samples follow the header directly, it has to keep them aligned
+static_assert(sizeof(PcmCacheHeader) % alignof(float) == 0);
+
+std::optional<SampleFormat> getSampleFormatFromHeader(int32_t sampleFormat) {
+    switch (sampleFormat) {
+        case static_cast<int32_t>(SampleFormat::float32): return SampleFormat::float32;
+        case static_cast<int32_t>(SampleFormat::int16): return SampleFormat::int16;
+        case static_cast<int32_t>(SampleFormat::int8): return SampleFormat::int8;
+        default: return std::nullopt;
+    }
+}
+
+constexpr char kEntrySuffix[] = ".pcm";
+
+int64_t getNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+bool isEntryName(const std::string &name) {
+    const size_t suffixLength = sizeof(kEntrySuffix) - 1;
+    return name.size() > suffixLength && name.compare(name.size() - suffixLength, suffixLength, kEntrySuffix) == 0;
+}
+
+constexpr uint64_t kFnvOffsetBasis = 0xcbf29ce484222325ULL;
+constexpr uint64_t kFnvPrime = 0x100000001b3ULL;
+
+bool writeAll(int fd, const void *data, size_t size) {
+    auto bytes = static_cast<const uint8_t *>(data);
+    while (size > 0) {
+        auto written = write(fd, bytes, size);
+        if(written == -1) {
+            if(errno == EINTR) continue;
+            return false;
+        }
+        bytes += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+}
+
+PcmCache::PcmCache(std::string directory, int64_t maxBytes)
+    : mDirectory(std::move(directory))
+    , mMaxBytes(maxBytes) {
+    scanDirectory();
+}
+
+void PcmCache::scanDirectory() {
+    DIR *directory = opendir(mDirectory.c_str());
+    if(directory == nullptr) {
+        LOGW("Failed to read the decoded sound cache: %s", strerror(errno));
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    while(const dirent *entry = readdir(directory)) {
+        const std::string name = entry->d_name;
+        struct stat status {};
+        if(!isEntryName(name) || stat((mDirectory + "/" + name).c_str(), &status) == -1 || !S_ISREG(status.st_mode)) {
+            continue;
+        }
+        mEntries[name] = {
+                .sizeBytes = static_cast<int64_t>(status.st_size),
+                .lastUseNs = static_cast<int64_t>(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec
+        };
+        mSizeBytes += static_cast<int64_t>(status.st_size);
+    }
+    closedir(directory);
+    evictOverLimit();
+}
+
+void PcmCache::setMaxBytes(int64_t maxBytes) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mMaxBytes = maxBytes;
+    evictOverLimit();
+}
+
+void PcmCache::addEntry(const std::string &name, int64_t sizeBytes) {
+    removeEntry(name);
+    mEntries[name] = {.sizeBytes = sizeBytes, .lastUseNs = getNowNs()};
+    mSizeBytes += sizeBytes;
+}
+
+void PcmCache::removeEntry(const std::string &name) {
+    auto it = mEntries.find(name);
+    if(it != mEntries.end()) {
+        mSizeBytes -= it->second.sizeBytes;
+        mEntries.erase(it);
+    }
+}
+
+void PcmCache::touchEntry(const std::string &name) {
+    auto it = mEntries.find(name);
+    if(it == mEntries.end()) return;
+
+    it->second.lastUseNs = getNowNs();
+    // Best effort, the order is only off after a restart if this fails
+    utimensat(AT_FDCWD, (mDirectory + "/" + name).c_str(), nullptr, 0);
+}
+
+void PcmCache::evictOverLimit() {
+    while(mSizeBytes > mMaxBytes && !mEntries.empty()) {
+        // Linear, but there are only ever a few hundred entries and eviction is rare
+        auto oldest = std::min_element(mEntries.begin(), mEntries.end(), [](const auto &a, const auto &b) {
+            return a.second.lastUseNs < b.second.lastUseNs;
+        });
+        // Sounds mapping the entry keep their pages until they are unloaded
+        unlink((mDirectory + "/" + oldest->first).c_str());
+        mSizeBytes -= oldest->second.sizeBytes;
+        mEntries.erase(oldest);
+        mEvictionCount++;
+    }
+}
+
+std::optional<PcmCacheKey> PcmCache::makeKey(int fd, int offset, int length,
+                                             AudioProperties targetProperties,
+                                             int32_t resamplerQuality,
+                                             SampleFormat sampleFormat) {
+    // FNV-1a, the key only needs to tell files apart, not to resist tampering
+    uint64_t hash = kFnvOffsetBasis;
+    std::vector<uint8_t> chunk(64 * 1024);
+
+    int64_t position = offset;
+    int64_t remaining = length;
+    while (remaining > 0) {
+        auto toRead = static_cast<size_t>(std::min<int64_t>(remaining, static_cast<int64_t>(chunk.size())));
+        auto bytesRead = pread(fd, chunk.data(), toRead, position);
+        if(bytesRead == -1 && errno == EINTR) continue;
+        if(bytesRead <= 0) {
+            LOGW("Failed to hash the sound file, it won't be cached: %s",
+                 bytesRead == 0 ? "unexpected end of file" : strerror(errno));
+            return std::nullopt;
+        }
+
+        for (ssize_t i = 0; i < bytesRead; ++i) {
+            hash = (hash ^ chunk[i]) * kFnvPrime;
+        }
+        position += bytesRead;
+        remaining -= bytesRead;
+    }
+
+    return PcmCacheKey {
+            .contentHash = hash,
+            .contentLength = length,
+            .targetProperties = targetProperties,
+            .resamplerQuality = resamplerQuality,
+            .sampleFormat = sampleFormat
+    };
+}
+
+std::optional<CachedPcm> PcmCache::lookup(const PcmCacheKey &key) {
+    const auto name = getEntryName(key);
+    const auto path = mDirectory + "/" + name;
+    if(access(path.c_str(), F_OK) == -1) {
+        mMissCount.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+
+    auto openResult = MappedFile::open(path);
+    if(openResult.error) {
+        LOGW("Failed to open cached sound %s: %s", path.c_str(), openResult.error->c_str());
+        mMissCount.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+
+    auto &file = openResult.file;
+    PcmCacheHeader header {};
+    bool isValid = file->getSize() >= sizeof(header);
+    if(isValid) {
+        std::memcpy(&header, file->getData(), sizeof(header));
+        isValid = std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0
+                  && header.version == kVersion
+                  && header.contentHash == key.contentHash
+                  && getSampleFormatFromHeader(header.sampleFormat) == key.sampleFormat
+                  && header.channelCount > 0
+                  && header.sampleCount >= 0
+                  && file->getSize() == sizeof(header) + static_cast<size_t>(header.sampleCount) * getBytesPerSample(key.sampleFormat);
+    }
+
+    if(!isValid) {
+        LOGW("Discarding invalid or outdated cached sound %s", path.c_str());
+        file.reset();
+        std::lock_guard<std::mutex> lock(mMutex);
+        unlink(path.c_str());
+        removeEntry(name);
+        mMissCount.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        touchEntry(name);
+    }
+
+    const void *samples = file->getData() + sizeof(header);
+    mHitCount.fetch_add(1, std::memory_order_relaxed);
+    mBytesSaved.fetch_add(header.sampleCount * getBytesPerSample(key.sampleFormat), std::memory_order_relaxed);
+
+    return CachedPcm {
+            .file = std::move(file),
+            .samples = samples,
+            .sampleFormat = key.sampleFormat,
+            .sampleCount = header.sampleCount,
+            .properties = {.channelCount = header.channelCount, .sampleRate = header.sampleRate}
+    };
+}
+
+void PcmCache::store(const PcmCacheKey &key, const void *samples, SampleFormat sampleFormat, int64_t sampleCount,
+                     AudioProperties properties) {
+    const size_t sampleBytes = static_cast<size_t>(sampleCount) * getBytesPerSample(key.sampleFormat);
+    const auto entryBytes = static_cast<int64_t>(sizeof(PcmCacheHeader) + sampleBytes);
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if(entryBytes > mMaxBytes) {
+            LOGD("Not caching a decoded sound of %lld bytes, the cache only holds %lld",
+                 static_cast<long long>(entryBytes), static_cast<long long>(mMaxBytes));
+            return;
+        }
+    }
+
+    SampleBuffer converted;
+    if(sampleFormat != key.sampleFormat) {
+        converted.resize(sampleBytes);
+        Decoder::convertSamples(samples, sampleFormat, converted.data(), key.sampleFormat, static_cast<size_t>(sampleCount));
+        samples = converted.data();
+    }
+
+    const auto name = getEntryName(key);
+    const auto path = mDirectory + "/" + name;
+    auto temporaryPath = path + ".XXXXXX";
+
+    int fd = mkstemp(temporaryPath.data());
+    if(fd == -1) {
+        LOGW("Failed to create cache file for the sound: %s", strerror(errno));
+        return;
+    }
+
+    PcmCacheHeader header {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.channelCount = properties.channelCount;
+    header.sampleRate = properties.sampleRate;
+    header.sampleFormat = static_cast<int32_t>(key.sampleFormat);
+    header.sampleCount = sampleCount;
+    header.contentHash = key.contentHash;
+
+    bool isWritten = writeAll(fd, &header, sizeof(header))
+                     && writeAll(fd, samples, sampleBytes);
+    if(close(fd) == -1) {
+        isWritten = false;
+    }
+
+    // Readers either see the complete entry or none at all
+    if(!isWritten || rename(temporaryPath.c_str(), path.c_str()) == -1) {
+        LOGW("Failed to write cache file for the sound: %s", strerror(errno));
+        unlink(temporaryPath.c_str());
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    addEntry(name, entryBytes);
+    evictOverLimit();
+}
+
+PcmCacheStats PcmCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return {
+            .hitCount = mHitCount.load(std::memory_order_relaxed),
+            .missCount = mMissCount.load(std::memory_order_relaxed),
+            .bytesSaved = mBytesSaved.load(std::memory_order_relaxed),
+            .sizeBytes = mSizeBytes,
+            .evictionCount = mEvictionCount
+    };
+}
+
+std::string PcmCache::getEntryName(const PcmCacheKey &key) const {
+    char name[96];
+    snprintf(name, sizeof(name), "%016" PRIx64 "-%" PRId64 "-%d-%d-q%d-f%d.pcm",
+             key.contentHash,
+             key.contentLength,
+             key.targetProperties.sampleRate,
+             key.targetProperties.channelCount,
+             key.resamplerQuality,
+             static_cast<int32_t>(key.sampleFormat));
+    return name;
+}
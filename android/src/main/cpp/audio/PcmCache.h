@@ -0,0 +1,119 @@
+#ifndef AUDIOPLAYBACK_PCMCACHE_H
+#define AUDIOPLAYBACK_PCMCACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <AudioConstants.h>
+#include <utils/MappedFile.h>
+#include "DataSource.h"
+
+struct PcmCacheKey {
+    // Hash and length of the compressed file, so a changed asset never hits a stale entry
+    uint64_t contentHash;
+    int64_t contentLength;
+    AudioProperties targetProperties;
+    int32_t resamplerQuality;
+    SampleFormat sampleFormat;
+};
+
+struct PcmCacheStats {
+    int64_t hitCount;
+    int64_t missCount;
+    // Decoded audio read from the cache instead of being decoded again
+    int64_t bytesSaved;
+    // Disk space taken by the entries
+    int64_t sizeBytes;
+    // Entries removed to stay within the size limit
+    int64_t evictionCount;
+};
+
+// Decoded audio mapped from a cache entry, the samples stay valid as long as the mapping is alive
+struct CachedPcm {
+    std::unique_ptr<MappedFile> file;
+    const void *samples;
+    SampleFormat sampleFormat;
+    int64_t sampleCount;
+    AudioProperties properties;
+};
+
+/**
+ * Persists fully decoded sounds to disk so that loading the same file again, even after the app
+ * restarts, maps the samples instead of running them through the codec.
+ *
+ * Entries are keyed by the content of the compressed file and by everything that changes the
+ * decoded output. Each entry is a small versioned header followed by interleaved samples,
+ * written to a temporary file and renamed so a crash never leaves a truncated entry behind. Any
+ * entry that can't be read back is treated as a miss and removed.
+ *
+ * The entries are kept within a size limit by removing the least recently used ones. Their
+ * modification times record when they were last used, so the order survives restarts.
+ *
+ * All methods are safe to call from several threads at once.
+ */
+class PcmCache {
+public:
+    static constexpr int64_t kDefaultMaxBytes = 128LL * 1024 * 1024;
+
+    // Picks up the entries already in directory, removing the oldest ones if they are over maxBytes
+    explicit PcmCache(std::string directory, int64_t maxBytes = kDefaultMaxBytes);
+
+    /**
+     * Hash the compressed data in [offset, offset + length) of the file. This reads the file but
+     * doesn't decode it, and doesn't move the file offset.
+     */
+    static std::optional<PcmCacheKey> makeKey(int fd, int offset, int length,
+                                              AudioProperties targetProperties,
+                                              int32_t resamplerQuality,
+                                              SampleFormat sampleFormat);
+
+    std::optional<CachedPcm> lookup(const PcmCacheKey &key);
+
+    /**
+     * Write an entry for key, converting the samples from sampleFormat to the key's format if they
+     * differ. Entries larger than the whole limit are not written.
+     */
+    void store(const PcmCacheKey &key, const void *samples, SampleFormat sampleFormat, int64_t sampleCount,
+               AudioProperties properties);
+
+    // Removes the least recently used entries right away if the cache is over the new limit
+    void setMaxBytes(int64_t maxBytes);
+
+    [[nodiscard]] PcmCacheStats getStats() const;
+
+private:
+    static constexpr uint32_t kVersion = 2;
+
+    struct Entry {
+        int64_t sizeBytes;
+        // Nanoseconds since the epoch, the same clock as the file's modification time
+        int64_t lastUseNs;
+    };
+
+    [[nodiscard]] std::string getEntryName(const PcmCacheKey &key) const;
+    void scanDirectory();
+    // The rest need mMutex
+    void addEntry(const std::string &name, int64_t sizeBytes);
+    void removeEntry(const std::string &name);
+    void touchEntry(const std::string &name);
+    void evictOverLimit();
+
+    const std::string mDirectory;
+
+    // Guards everything below, the files themselves are only ever replaced atomically
+    mutable std::mutex mMutex;
+    std::unordered_map<std::string, Entry> mEntries;
+    int64_t mSizeBytes = 0;
+    int64_t mMaxBytes;
+    int64_t mEvictionCount = 0;
+
+    std::atomic<int64_t> mHitCount {0};
+    std::atomic<int64_t> mMissCount {0};
+    std::atomic<int64_t> mBytesSaved {0};
+};
+
+#endif //AUDIOPLAYBACK_PCMCACHE_H
@@ -15,48 +15,774 @@
  */
 
 #include "Player.h"
-#include "utils/logging.h"
+#include "MixKernels.h"
+
+#include <cmath>
+
+namespace {
+    constexpr double kFractionScale = 4294967296.0;
+    constexpr float kInverseFractionScale = 1.0f / 4294967296.0f;
+    // A position step of one frame per frame
+    constexpr int64_t kUnitStep = int64_t { 1 } << 32;
+
+    inline float toFloat(float sample) { return sample; }
+    inline float toFloat(int16_t sample) { return static_cast<float>(sample) * (1.0f / 32768.0f); }
+    inline float toFloat(int8_t sample) { return static_cast<float>(sample) * (1.0f / 128.0f); }
+
+    // Four point, third order Hermite spline between y0 and y1
+    inline float interpolateCubic(float yMinus1, float y0, float y1, float y2, float t) {
+        const float c1 = 0.5f * (y1 - yMinus1);
+        const float c2 = yMinus1 - 2.5f * y0 + 2.0f * y1 - 0.5f * y2;
+        const float c3 = 0.5f * (y2 - yMinus1) + 1.5f * (y0 - y1);
+        return ((c3 * t + c2) * t + c1) * t + y0;
+    }
+
+    // The value between source[0] and source[stride], t of the way to the latter
+    template<typename Sample, Interpolation interpolation>
+    inline float interpolate(const Sample *source, int32_t stride, float t) {
+        if constexpr (interpolation == Interpolation::cubic) {
+            return interpolateCubic(toFloat(source[-stride]), toFloat(source[0]), toFloat(source[stride]), toFloat(source[2 * stride]), t);
+        } else {
+            const float y0 = toFloat(source[0]);
+            return y0 + t * (toFloat(source[stride]) - y0);
+        }
+    }
+
+    /**
+     * Mix numFrames frames read at a fixed point position that advances by step every frame, where
+     * every neighbour needed for interpolation is known to be inside the data. The channel counts
+     * are template arguments for the common stereo output layouts, 0 when only known at runtime.
+     * Channel 1 is scaled by right, every other channel by left.
+     */
+    template<typename Sample, Interpolation interpolation, int32_t SourceChannels, int32_t OutputChannels>
+    void mixInterpolatedRun(float *output, int32_t outputChannelCount, const Sample *input, int32_t inputChannelCount,
+                            int64_t position, int64_t step, int32_t numFrames,
+                            float left, float leftStep, float right, float rightStep) {
+        const int32_t sourceChannels = SourceChannels ? SourceChannels : inputChannelCount;
+        const int32_t outputChannels = OutputChannels ? OutputChannels : outputChannelCount;
+        for (int32_t i = 0; i < numFrames; ++i) {
+            const Sample *source = input + (position >> 32) * sourceChannels;
+            const float t = static_cast<float>(static_cast<uint32_t>(position)) * kInverseFractionScale;
+            float *target = output + i * outputChannels;
+            if constexpr (SourceChannels == 1 && OutputChannels == 2) {
+                const float value = interpolate<Sample, interpolation>(source, 1, t);
+                target[0] += value * left;
+                target[1] += value * right;
+            } else if constexpr (SourceChannels == 2 && OutputChannels == 2) {
+                target[0] += interpolate<Sample, interpolation>(source, 2, t) * left;
+                target[1] += interpolate<Sample, interpolation>(source + 1, 2, t) * right;
+            } else {
+                for (int32_t channel = 0; channel < outputChannels; ++channel) {
+                    const float value = interpolate<Sample, interpolation>(source + (sourceChannels == 1 ? 0 : channel), sourceChannels, t);
+                    target[channel] += value * (channel == 1 ? right : left);
+                }
+            }
+            left += leftStep;
+            right += rightStep;
+            position += step;
+        }
+    }
+}
 
 void Player::renderAudio(float *targetData, int32_t numFrames){
+    mEventCount = 0;
+    if (mStreamingSource) {
+        renderStreamingAudio(targetData, numFrames);
+        return;
+    }
+
+    for (auto &voice: mVoices) {
+        renderVoice(voice, targetData, numFrames);
+    }
+    publishState();
+}
 
+void Player::renderVoice(Voice &voice, float *targetData, int32_t numFrames) {
     const AudioProperties properties = mSource->getProperties();
+    const int64_t totalSourceFrames = mSource->getSize() / properties.channelCount;
+    const void *samples = mSource->getSamples();
+    const SampleFormat sampleFormat = mSource->getSampleFormat();
+
+    if (totalSourceFrames <= 0) {
+        voice.isPlaying = false;
+        return;
+    }
+
+    if (needsInterpolation(voice)) {
+        switch (sampleFormat) {
+            case SampleFormat::int16:
+                renderInterpolatedVoice(voice, targetData, static_cast<const int16_t *>(samples), totalSourceFrames, numFrames);
+                break;
+            case SampleFormat::int8:
+                renderInterpolatedVoice(voice, targetData, static_cast<const int8_t *>(samples), totalSourceFrames, numFrames);
+                break;
+            case SampleFormat::float32:
+                renderInterpolatedVoice(voice, targetData, static_cast<const float *>(samples), totalSourceFrames, numFrames);
+                break;
+        }
+        return;
+    }
+
+    // Mix in contiguous runs that stop at the end of the data or where a ramp changes the voice's
+    // state, so the kernels never have to check for either
+    int32_t framesRendered = 0;
+    while (framesRendered < numFrames) {
+        applyRampEndActions(voice);
+        if (!voice.isPlaying) break;
+        // A stolen voice that restarted at another rate or pan is rendered the other way from here
+        if (needsInterpolation(voice)) {
+            renderVoice(voice, targetData + framesRendered * mOutputChannelCount, numFrames - framesRendered);
+            return;
+        }
+
+        const auto framesInRun = static_cast<int32_t>(std::min<int64_t>(numFrames - framesRendered, totalSourceFrames - voice.readFrameIndex));
+        float *target = targetData + framesRendered * mOutputChannelCount;
+        const int64_t sampleIndex = static_cast<int64_t>(voice.readFrameIndex) * properties.channelCount;
+        int32_t framesMixed = 0;
+        switch (sampleFormat) {
+            case SampleFormat::int16:
+                framesMixed = mixVoiceFrames(voice, target, static_cast<const int16_t *>(samples) + sampleIndex,
+                                             properties.channelCount, framesInRun);
+                break;
+            case SampleFormat::int8:
+                framesMixed = mixVoiceFrames(voice, target, static_cast<const int8_t *>(samples) + sampleIndex,
+                                             properties.channelCount, framesInRun);
+                break;
+            case SampleFormat::float32:
+                framesMixed = mixVoiceFrames(voice, target, static_cast<const float *>(samples) + sampleIndex,
+                                             properties.channelCount, framesInRun);
+                break;
+        }
+
+        if (isPrimaryVoice(voice)) {
+            addMarkerEvents(static_cast<int64_t>(voice.readFrameIndex) << 32, static_cast<int64_t>(voice.readFrameIndex + framesMixed) << 32,
+                            kUnitStep, framesRendered);
+        }
+        framesRendered += framesMixed;
+        voice.readFrameIndex += framesMixed;
+        if (voice.readFrameIndex >= totalSourceFrames) {
+            voice.readFrameIndex = 0;
+            if (isPrimaryVoice(voice)) addEvent(voice.isLooping ? PlaybackEventType::looped : PlaybackEventType::ended, framesRendered);
+            if (!voice.isLooping) stopVoice(voice);
+        }
+    }
+    applyRampEndActions(voice);
+}
+
+template<typename Sample>
+void Player::renderInterpolatedVoice(Voice &voice, float *targetData, const Sample *sourceData, int64_t totalSourceFrames, int32_t numFrames) {
+    const int32_t sourceChannelCount = mSource->getProperties().channelCount;
+
+    // Every ramp is interpolated linearly within a segment, the rate is held for the segment
+    int32_t framesRendered = 0;
+    while (framesRendered < numFrames) {
+        applyRampEndActions(voice);
+        if (!voice.isPlaying) return;
+
+        int32_t frames = std::min(numFrames - framesRendered, kRampSegmentFrames);
+        for (const Ramp *ramp: {&voice.volumeRamp, &voice.envelopeRamp, &voice.panRamp, &voice.playbackRateRamp}) {
+            if (ramp->framesRemaining > 0) frames = std::min(frames, ramp->framesRemaining);
+        }
+
+        const ChannelGains startGains = getChannelGains(voice, sourceChannelCount);
+        const float startRate = voice.playbackRate;
+        advanceRamp(voice.volume, voice.volumeRamp, frames);
+        advanceRamp(voice.envelope, voice.envelopeRamp, frames);
+        advanceRamp(voice.pan, voice.panRamp, frames);
+        advanceRamp(voice.playbackRate, voice.playbackRateRamp, frames);
+        const ChannelGains endGains = getChannelGains(voice, sourceChannelCount);
+        const ChannelGains gainSteps = {
+            .left = (endGains.left - startGains.left) / static_cast<float>(frames),
+            .right = (endGains.right - startGains.right) / static_cast<float>(frames)
+        };
+        const auto step = static_cast<int64_t>(0.5 * (startRate + voice.playbackRate) * kFractionScale);
+
+        const int64_t startPosition = (static_cast<int64_t>(voice.readFrameIndex) << 32) | voice.readFrameFraction;
+        int64_t position = startPosition;
+        float *target = targetData + framesRendered * mOutputChannelCount;
+        const int32_t framesMixed = mInterpolation == Interpolation::cubic
+            ? mixInterpolatedFrames<Sample, Interpolation::cubic>(target, sourceData, sourceChannelCount, totalSourceFrames, voice.isLooping,
+                                                                  position, step, frames, startGains, gainSteps)
+            : mixInterpolatedFrames<Sample, Interpolation::linear>(target, sourceData, sourceChannelCount, totalSourceFrames, voice.isLooping,
+                                                                   position, step, frames, startGains, gainSteps);
+        const int32_t segmentOffset = framesRendered;
+        framesRendered += framesMixed;
+
+        const int64_t endPosition = totalSourceFrames << 32;
+        if (framesMixed < frames) {
+            if (isPrimaryVoice(voice)) {
+                addMarkerEvents(startPosition, endPosition, step, segmentOffset);
+                addEvent(PlaybackEventType::ended, framesRendered);
+            }
+            setReadFrame(voice, 0);
+            stopVoice(voice);
+            // A stolen voice that ran out while fading restarts right away
+            if (voice.isPlaying) renderVoice(voice, targetData + framesRendered * mOutputChannelCount, numFrames - framesRendered);
+            return;
+        }
+        if (isPrimaryVoice(voice)) {
+            if (position < startPosition) {
+                const auto framesUntilEnd = static_cast<int32_t>((endPosition - startPosition + step - 1) / step);
+                addMarkerEvents(startPosition, endPosition, step, segmentOffset);
+                addEvent(PlaybackEventType::looped, segmentOffset + framesUntilEnd);
+                addMarkerEvents(0, position, step, segmentOffset + framesUntilEnd);
+            } else {
+                addMarkerEvents(startPosition, position, step, segmentOffset);
+            }
+        }
+        voice.readFrameIndex = static_cast<int32_t>(position >> 32);
+        voice.readFrameFraction = static_cast<uint32_t>(position);
+    }
+    applyRampEndActions(voice);
+}
+
+template<typename Sample, Interpolation interpolation>
+int32_t Player::mixInterpolatedFrames(float *targetData, const Sample *sourceData, int32_t sourceChannelCount, int64_t totalSourceFrames,
+                                      bool isLooping, int64_t &position, int64_t step, int32_t numFrames,
+                                      ChannelGains gains, ChannelGains gainSteps) const {
+    const int64_t endPosition = totalSourceFrames << 32;
+    // Frames in between have all of their neighbours inside the data
+    const int64_t interiorStart = interpolation == Interpolation::cubic ? int64_t { 1 } << 32 : 0;
+    const int64_t interiorEnd = (totalSourceFrames - (interpolation == Interpolation::cubic ? 2 : 1)) << 32;
 
-    if (mIsPlaying){
+    int32_t framesMixed = 0;
+    while (framesMixed < numFrames) {
+        if (position >= endPosition) {
+            if (!isLooping) return framesMixed;
+            position %= endPosition;
+        }
 
-        int64_t framesToRenderFromData = numFrames;
-        int64_t totalSourceFrames = mSource->getSize() / properties.channelCount;
-        const float *data = mSource->getData();
+        float *target = targetData + framesMixed * mOutputChannelCount;
+        const float left = gains.left + gainSteps.left * static_cast<float>(framesMixed);
+        const float right = gains.right + gainSteps.right * static_cast<float>(framesMixed);
 
-        // Check whether we're about to reach the end of the recording
-        if (!mIsLooping && mReadFrameIndex + numFrames >= totalSourceFrames){
-            framesToRenderFromData = totalSourceFrames - mReadFrameIndex;
-            mIsPlaying = false;
+        if (position >= interiorStart && position < interiorEnd) {
+            const auto frames = static_cast<int32_t>(std::min<int64_t>(numFrames - framesMixed, (interiorEnd - position + step - 1) / step));
+            if (mOutputChannelCount == 2 && sourceChannelCount == 1) {
+                mixInterpolatedRun<Sample, interpolation, 1, 2>(target, 2, sourceData, 1, position, step, frames,
+                                                                left, gainSteps.left, right, gainSteps.right);
+            } else if (mOutputChannelCount == 2 && sourceChannelCount == 2) {
+                mixInterpolatedRun<Sample, interpolation, 2, 2>(target, 2, sourceData, 2, position, step, frames,
+                                                                left, gainSteps.left, right, gainSteps.right);
+            } else {
+                mixInterpolatedRun<Sample, interpolation, 0, 0>(target, mOutputChannelCount, sourceData, sourceChannelCount, position, step, frames,
+                                                                left, gainSteps.left, right, gainSteps.right);
+            }
+            position += step * frames;
+            framesMixed += frames;
+            continue;
         }
 
-        for (int i = 0; i < framesToRenderFromData; ++i) {
-            for (int j = 0; j < properties.channelCount; ++j) {
-                targetData[(i*properties.channelCount)+j] += (mVolume * data[(mReadFrameIndex*properties.channelCount)+j]);
+        // Near the edges, neighbours outside the data are either wrapped around or silent
+        auto sampleAt = [&](int64_t frame, int32_t channel) {
+            if (frame < 0 || frame >= totalSourceFrames) {
+                if (!isLooping) return 0.0f;
+                frame = ((frame % totalSourceFrames) + totalSourceFrames) % totalSourceFrames;
+            }
+            return toFloat(sourceData[frame * sourceChannelCount + channel]);
+        };
+        const int64_t frame = position >> 32;
+        const float t = static_cast<float>(static_cast<uint32_t>(position)) * kInverseFractionScale;
+        for (int32_t channel = 0; channel < mOutputChannelCount; ++channel) {
+            const int32_t sourceChannel = sourceChannelCount == 1 ? 0 : channel;
+            float value;
+            if constexpr (interpolation == Interpolation::cubic) {
+                value = interpolateCubic(sampleAt(frame - 1, sourceChannel), sampleAt(frame, sourceChannel),
+                                         sampleAt(frame + 1, sourceChannel), sampleAt(frame + 2, sourceChannel), t);
+            } else {
+                const float y0 = sampleAt(frame, sourceChannel);
+                value = y0 + t * (sampleAt(frame + 1, sourceChannel) - y0);
             }
+            target[channel] += value * (channel == 1 ? right : left);
+        }
+        position += step;
+        ++framesMixed;
+    }
+    return numFrames;
+}
+
+bool Player::needsInterpolation(const Voice &voice) const {
+    return voice.playbackRate != 1 || voice.playbackRateRamp.framesRemaining > 0 || voice.readFrameFraction != 0
+           || (mOutputChannelCount == 2 && (voice.pan != 0 || voice.panRamp.framesRemaining > 0));
+}
+
+Player::ChannelGains Player::getChannelGains(const Voice &voice, int32_t sourceChannelCount) const {
+    const float gain = voice.volume * voice.envelope;
+    if (mOutputChannelCount != 2 || voice.pan == 0) return {.left = gain, .right = gain};
+
+    constexpr auto kQuarterPi = static_cast<float>(M_PI / 4);
+    if (sourceChannelCount == 1) {
+        // Equal power, scaled so that the center stays at unity
+        const float angle = (voice.pan + 1) * kQuarterPi;
+        return {.left = gain * static_cast<float>(M_SQRT2) * std::cos(angle), .right = gain * static_cast<float>(M_SQRT2) * std::sin(angle)};
+    }
+    // Balance, only the channel on the other side is turned down
+    const float attenuation = std::cos(std::abs(voice.pan) * 2 * kQuarterPi);
+    return voice.pan < 0 ? ChannelGains {.left = gain, .right = gain * attenuation} : ChannelGains {.left = gain * attenuation, .right = gain};
+}
 
-            // Increment and handle wraparound
-            if (++mReadFrameIndex >= totalSourceFrames) mReadFrameIndex = 0;
+void Player::renderStreamingAudio(float *targetData, int32_t numFrames) {
+    Voice &voice = mVoices[0];
+    applyRampEndActions(voice);
+    if (!voice.isPlaying) return;
+
+    const int32_t channelCount = mSource->getProperties().channelCount;
+    const int32_t framesPerChunk = kStreamingChunkSamples / channelCount;
+    const int64_t totalSourceFrames = mSource->getSize() / channelCount;
+
+    int32_t framesRendered = 0;
+    while (voice.isPlaying && framesRendered < numFrames) {
+        const int32_t framesToRead = std::min(framesPerChunk, numFrames - framesRendered);
+        const int32_t framesRead = mStreamingSource->readFrames(mStreamingBuffer.get(), framesToRead);
+        const int32_t framesMixed = mixVoiceFrames(voice, targetData + (framesRendered * mOutputChannelCount),
+                                                   mStreamingBuffer.get(), channelCount, framesRead);
+
+        const int32_t fromFrame = voice.readFrameIndex;
+        voice.readFrameIndex += framesMixed;
+        if (totalSourceFrames > 0 && voice.readFrameIndex >= totalSourceFrames) {
+            voice.readFrameIndex -= totalSourceFrames;
+            const auto framesUntilEnd = static_cast<int32_t>(totalSourceFrames - fromFrame);
+            addMarkerEvents(static_cast<int64_t>(fromFrame) << 32, totalSourceFrames << 32, kUnitStep, framesRendered);
+            addEvent(PlaybackEventType::looped, framesRendered + framesUntilEnd);
+            addMarkerEvents(0, static_cast<int64_t>(voice.readFrameIndex) << 32, kUnitStep, framesRendered + framesUntilEnd);
+        } else {
+            addMarkerEvents(static_cast<int64_t>(fromFrame) << 32, static_cast<int64_t>(voice.readFrameIndex) << 32, kUnitStep, framesRendered);
         }
+        framesRendered += framesMixed;
+
+        if (framesMixed < framesRead) {
+            // A ramp ended part way through the chunk, give the frames that were not played back
+            mStreamingSource->seekTo(voice.readFrameIndex);
+            applyRampEndActions(voice);
+            continue;
+        }
+        applyRampEndActions(voice);
+
+        // Either the decoder fell behind or the track ended, the rest of this buffer stays silent
+        if (framesRead < framesToRead) break;
     }
+
+    if (mStreamingSource->isFinished()) {
+        if (voice.isPlaying) addEvent(PlaybackEventType::ended, framesRendered);
+        stopVoice(voice);
+        seekTo(0);
+    }
+    publishState();
 }
 
-void Player::seekTo(int64_t timeInMs) {
-    if(timeInMs == 0) {
-        mReadFrameIndex = 0;
+template<typename Sample>
+void Player::mixFrames(float *targetData, const Sample *sourceData, int32_t sourceChannelCount, int32_t numFrames, float gain, float gainStep) const {
+    if (gainStep != 0) {
+        if (sourceChannelCount == mOutputChannelCount) {
+            mixWithGainRamp(targetData, sourceData, sourceChannelCount, numFrames, gain, gainStep);
+        } else {
+            mixMonoWithGainRamp(targetData, mOutputChannelCount, sourceData, numFrames, gain, gainStep);
+        }
         return;
     }
-    const AudioProperties audioProperties = mSource->getProperties();
 
+    if (sourceChannelCount == mOutputChannelCount) {
+        mixWithGain(targetData, sourceData, numFrames * sourceChannelCount, gain);
+    } else {
+        // Mono source, expand to every output channel
+        mixMonoWithGain(targetData, mOutputChannelCount, sourceData, numFrames, gain);
+    }
+}
+
+template<typename Sample>
+int32_t Player::mixVoiceFrames(Voice &voice, float *targetData, const Sample *sourceData, int32_t sourceChannelCount, int32_t numFrames) {
+    int32_t framesMixed = 0;
+    while (framesMixed < numFrames) {
+        float *target = targetData + framesMixed * mOutputChannelCount;
+        const Sample *source = sourceData + framesMixed * sourceChannelCount;
+
+        if (voice.volumeRamp.framesRemaining == 0 && voice.envelopeRamp.framesRemaining == 0) {
+            mixFrames(target, source, sourceChannelCount, numFrames - framesMixed, voice.volume * voice.envelope, 0);
+            return numFrames;
+        }
+
+        // Both ramps are interpolated linearly within a segment, which can't be heard at this length
+        int32_t frames = std::min(numFrames - framesMixed, kRampSegmentFrames);
+        if (voice.volumeRamp.framesRemaining > 0) frames = std::min(frames, voice.volumeRamp.framesRemaining);
+        if (voice.envelopeRamp.framesRemaining > 0) frames = std::min(frames, voice.envelopeRamp.framesRemaining);
+
+        const float startGain = voice.volume * voice.envelope;
+        advanceRamp(voice.volume, voice.volumeRamp, frames);
+        advanceRamp(voice.envelope, voice.envelopeRamp, frames);
+        const float endGain = voice.volume * voice.envelope;
+        mixFrames(target, source, sourceChannelCount, frames, startGain, (endGain - startGain) / static_cast<float>(frames));
+
+        framesMixed += frames;
+        if (hasRampEndAction(voice)) break;
+    }
+    return framesMixed;
+}
+
+void Player::applyRampEndActions(Voice &voice) {
+    if (!hasRampEndAction(voice)) return;
+
+    if (voice.volumeRamp.framesRemaining == 0 && voice.stopAtVolumeRampEnd) {
+        stopVoice(voice);
+        setReadFrame(voice, 0);
+        if (mStreamingSource) mStreamingSource->seekTo(0);
+        return;
+    }
+
+    if (voice.envelopeRamp.framesRemaining == 0) {
+        if (voice.restartAtEnvelopeEnd) {
+            restartVoice(voice, voice.restartVolume, voice.restartPan, voice.restartPlaybackRate);
+            return;
+        }
+        if (voice.seekAtEnvelopeEnd >= 0) {
+            setReadFrame(voice, voice.seekAtEnvelopeEnd);
+            voice.seekAtEnvelopeEnd = -1;
+            if (mStreamingSource) mStreamingSource->seekTo(voice.readFrameIndex);
+            if (!voice.pauseAtEnvelopeEnd) startRamp(voice.envelope, voice.envelopeRamp, 1, getDeclickFrames(), GainCurve::linear);
+        }
+        if (voice.pauseAtEnvelopeEnd) {
+            voice.pauseAtEnvelopeEnd = false;
+            voice.isPlaying = false;
+            voice.envelope = 1;
+        }
+    }
+}
+
+bool Player::hasRampEndAction(const Voice &voice) {
+    return (voice.volumeRamp.framesRemaining == 0 && voice.stopAtVolumeRampEnd)
+           || (voice.envelopeRamp.framesRemaining == 0
+               && (voice.pauseAtEnvelopeEnd || voice.seekAtEnvelopeEnd >= 0 || voice.restartAtEnvelopeEnd));
+}
+
+void Player::stopVoice(Voice &voice) {
+    if (voice.seekAtEnvelopeEnd >= 0) setReadFrame(voice, voice.seekAtEnvelopeEnd);
+    advanceRamp(voice.volume, voice.volumeRamp, voice.volumeRamp.framesRemaining);
+    advanceRamp(voice.pan, voice.panRamp, voice.panRamp.framesRemaining);
+    advanceRamp(voice.playbackRate, voice.playbackRateRamp, voice.playbackRateRamp.framesRemaining);
+    voice.stopAtVolumeRampEnd = false;
+    voice.envelope = 1;
+    voice.envelopeRamp.framesRemaining = 0;
+    voice.pauseAtEnvelopeEnd = false;
+    voice.seekAtEnvelopeEnd = -1;
+    voice.isPlaying = false;
+    if (voice.restartAtEnvelopeEnd) restartVoice(voice, voice.restartVolume, voice.restartPan, voice.restartPlaybackRate);
+}
+
+void Player::startRamp(float &value, Ramp &ramp, float target, int32_t numFrames, GainCurve curve) {
+    ramp.target = target;
+    if (numFrames <= 0) {
+        value = target;
+        ramp.framesRemaining = 0;
+        return;
+    }
+
+    ramp.framesRemaining = numFrames;
+    ramp.isExponential = curve == GainCurve::exponential;
+    if (ramp.isExponential) {
+        value = std::max(value, kMinExponentialGain);
+        ramp.step = std::pow(std::max(target, kMinExponentialGain) / value, 1.0f / static_cast<float>(numFrames));
+    } else {
+        ramp.step = (target - value) / static_cast<float>(numFrames);
+    }
+}
+
+void Player::advanceRamp(float &value, Ramp &ramp, int32_t numFrames) {
+    if (ramp.framesRemaining == 0) return;
+
+    if (numFrames >= ramp.framesRemaining) {
+        value = ramp.target;
+        ramp.framesRemaining = 0;
+        return;
+    }
+
+    value = ramp.isExponential ? value * std::pow(ramp.step, static_cast<float>(numFrames)) : value + ramp.step * static_cast<float>(numFrames);
+    ramp.framesRemaining -= numFrames;
+}
+
+int32_t Player::getDeclickFrames() const {
+    return mSource->getProperties().sampleRate * kDeclickMs / 1000;
+}
+
+void Player::setPlaying(bool isPlaying) {
+    Voice &voice = mVoices[0];
+    if (isPlaying) {
+        if (!voice.isPlaying) {
+            voice.isPlaying = true;
+            // Starting from the top can't click, resuming in the middle of the sound can
+            voice.envelope = voice.readFrameIndex == 0 ? 1 : 0;
+        }
+        voice.pauseAtEnvelopeEnd = false;
+        // A pending seek fades back in by itself once it's done
+        if (voice.envelope < 1 && voice.seekAtEnvelopeEnd < 0) {
+            startRamp(voice.envelope, voice.envelopeRamp, 1, getDeclickFrames(), GainCurve::linear);
+        }
+    } else if (voice.isPlaying && !voice.pauseAtEnvelopeEnd) {
+        voice.pauseAtEnvelopeEnd = true;
+        startRamp(voice.envelope, voice.envelopeRamp, 0, getDeclickFrames(), GainCurve::linear);
+    }
+    publishState();
+}
+
+void Player::setVolume(float volume) {
+    Voice &voice = mVoices[0];
+    voice.stopAtVolumeRampEnd = false;
+    startRamp(voice.volume, voice.volumeRamp, volume, voice.isPlaying ? getDeclickFrames() : 0, GainCurve::linear);
+}
+
+void Player::fadeTo(float volume, int32_t durationMs, GainCurve curve, bool stopAtEnd) {
+    const auto durationFrames = static_cast<int32_t>(static_cast<int64_t>(std::max(durationMs, 0)) * mSource->getProperties().sampleRate / 1000);
+    for (auto &voice: mVoices) {
+        if (voice.isPlaying) {
+            startRamp(voice.volume, voice.volumeRamp, volume, durationFrames, curve);
+            voice.stopAtVolumeRampEnd = stopAtEnd;
+        } else {
+            startRamp(voice.volume, voice.volumeRamp, volume, 0, curve);
+        }
+    }
+}
+
+void Player::setPan(float pan) {
+    Voice &voice = mVoices[0];
+    startRamp(voice.pan, voice.panRamp, std::clamp(pan, -1.0f, 1.0f), voice.isPlaying ? getDeclickFrames() : 0, GainCurve::linear);
+}
+
+void Player::setPlaybackRate(float rate) {
+    // Streaming sources are read at the speed they decode, always one frame per frame
+    if (mStreamingSource) return;
+
+    Voice &voice = mVoices[0];
+    startRamp(voice.playbackRate, voice.playbackRateRamp, std::clamp(rate, kMinPlaybackRate, kMaxPlaybackRate),
+              voice.isPlaying ? getDeclickFrames() : 0, GainCurve::linear);
+}
+
+void Player::setLooping(bool isLooping) {
+    mVoices[0].isLooping = isLooping;
+    if (mStreamingSource) mStreamingSource->setLooping(isLooping);
+}
+
+int32_t Player::getSeekFrame(int64_t timeInMs) const {
+    if (timeInMs == 0) return 0;
+
+    const AudioProperties audioProperties = mSource->getProperties();
     auto targetFrame = static_cast<int32_t>((static_cast<int32_t>(timeInMs) / 1000.0) * audioProperties.sampleRate);
     auto totalFrames = static_cast<int32_t>(mSource->getSize() / audioProperties.channelCount);
+    return std::min(std::max(targetFrame, 0), totalFrames);
+}
+
+void Player::seekTo(int64_t timeInMs) {
+    Voice &voice = mVoices[0];
+    const int32_t targetFrame = getSeekFrame(timeInMs);
+
+    if (voice.isPlaying) {
+        // Jumping while audible would click, fade out first and seek once silent
+        voice.seekAtEnvelopeEnd = targetFrame;
+        startRamp(voice.envelope, voice.envelopeRamp, 0, getDeclickFrames(), GainCurve::linear);
+    } else {
+        setReadFrame(voice, targetFrame);
+        voice.seekAtEnvelopeEnd = -1;
+        if (mStreamingSource) mStreamingSource->seekTo(voice.readFrameIndex);
+    }
+    publishState();
+}
+
+void Player::trigger(float volume, float pan, float playbackRate) {
+    // Streaming sources are read at the speed they decode, always one frame per frame
+    if (mStreamingSource) playbackRate = 1;
+    pan = std::clamp(pan, -1.0f, 1.0f);
+    playbackRate = std::clamp(playbackRate, kMinPlaybackRate, kMaxPlaybackRate);
+
+    if (mVoices.size() == 1) {
+        restartVoice(mVoices[0], volume, pan, playbackRate);
+        if (mStreamingSource) mStreamingSource->seekTo(0);
+        publishState();
+        return;
+    }
 
-    if(targetFrame >= 0 && targetFrame < totalFrames) {
-        mReadFrameIndex = targetFrame;
+    Voice &voice = findVoiceToTrigger();
+    if (voice.isPlaying) {
+        // Cutting a stolen voice mid-waveform would click, fade it out first and restart once silent
+        if (!voice.restartAtEnvelopeEnd) startRamp(voice.envelope, voice.envelopeRamp, 0, getDeclickFrames(), GainCurve::linear);
+        voice.restartAtEnvelopeEnd = true;
+        voice.restartVolume = volume;
+        voice.restartPan = pan;
+        voice.restartPlaybackRate = playbackRate;
     } else {
-        mReadFrameIndex = std::min(std::max(targetFrame, 0), totalFrames);
+        restartVoice(voice, volume, pan, playbackRate);
+    }
+    voice.isLooping = false;
+    voice.startOrder = ++mTriggerCount;
+    publishState();
+}
+
+void Player::restartVoice(Voice &voice, float volume, float pan, float playbackRate) {
+    // Triggering is meant to be immediate, so it cuts whatever the voice was fading
+    voice.restartAtEnvelopeEnd = false;
+    stopVoice(voice);
+    setReadFrame(voice, 0);
+    voice.volume = volume;
+    voice.pan = pan;
+    voice.playbackRate = playbackRate;
+    voice.isPlaying = true;
+}
+
+void Player::setReadFrame(Voice &voice, int32_t frame) {
+    voice.readFrameIndex = frame;
+    voice.readFrameFraction = 0;
+}
+
+void Player::schedulePlaying(int64_t frame, bool isPlaying) {
+    if (mScheduledEventCount == kMaxScheduledEvents) return;
+
+    size_t index = mScheduledEventCount;
+    while (index > 0 && mScheduledEvents[index - 1].frame > frame) {
+        mScheduledEvents[index] = mScheduledEvents[index - 1];
+        --index;
+    }
+    mScheduledEvents[index] = {.frame = frame, .isPlaying = isPlaying};
+    mScheduledEventCount++;
+    publishState();
+}
+
+void Player::applyScheduledEvents(int64_t frame) {
+    size_t dueCount = 0;
+    while (dueCount < mScheduledEventCount && mScheduledEvents[dueCount].frame <= frame) {
+        setPlaying(mScheduledEvents[dueCount].isPlaying);
+        ++dueCount;
+    }
+    if (dueCount == 0) return;
+
+    std::copy(mScheduledEvents.begin() + dueCount, mScheduledEvents.begin() + mScheduledEventCount, mScheduledEvents.begin());
+    mScheduledEventCount -= dueCount;
+    publishState();
+}
+
+int32_t Player::getFramesUntilScheduledEvent(int64_t frame, int32_t numFrames) const {
+    if (mScheduledEventCount == 0) return numFrames;
+    return static_cast<int32_t>(std::clamp<int64_t>(mScheduledEvents[0].frame - frame, 1, numFrames));
+}
+
+void Player::clearMarkers() {
+    mMarkerCount = 0;
+    mAddedMarkerCount = 0;
+}
+
+void Player::addMarker(int64_t timeInMs) {
+    const int32_t index = mAddedMarkerCount++;
+    if (mMarkerCount == kMaxMarkers) return;
+
+    const Marker marker = {.frame = getSeekFrame(timeInMs), .index = index};
+    size_t position = mMarkerCount;
+    while (position > 0 && mMarkers[position - 1].frame > marker.frame) {
+        mMarkers[position] = mMarkers[position - 1];
+        --position;
+    }
+    mMarkers[position] = marker;
+    mMarkerCount++;
+}
+
+void Player::addMarkerEvents(int64_t fromPosition, int64_t toPosition, int64_t step, int32_t frameOffset) {
+    for (size_t i = 0; i < mMarkerCount; ++i) {
+        const int64_t markerPosition = static_cast<int64_t>(mMarkers[i].frame) << 32;
+        if (markerPosition < fromPosition) continue;
+        if (markerPosition >= toPosition) break;
+
+        const auto framesUntilMarker = static_cast<int32_t>((markerPosition - fromPosition + step - 1) / step);
+        addEvent(PlaybackEventType::markerReached, frameOffset + framesUntilMarker, mMarkers[i].index);
+    }
+}
+
+void Player::addEvent(PlaybackEventType type, int32_t frameOffset, int32_t markerIndex) {
+    if (mEventCount == kMaxEvents) return;
+    mEvents[mEventCount++] = {.type = type, .frameOffset = frameOffset, .markerIndex = markerIndex};
+}
+
+double Player::getPositionMs(int32_t latencyFrames) const {
+    const double heldBackFrames = latencyFrames * static_cast<double>(mPublishedRate.load(std::memory_order_relaxed));
+    const double frame = std::max(mPublishedFrame.load(std::memory_order_relaxed) - heldBackFrames, 0.0);
+    return frame * 1000.0 / mSource->getProperties().sampleRate;
+}
+
+void Player::publishState() {
+    // A sound that is about to start is not idle either
+    bool isIdle = mVoices[0].readFrameIndex == 0 && mScheduledEventCount == 0;
+    for (const auto &voice: mVoices) {
+        isIdle = isIdle && !voice.isPlaying;
+    }
+    mIsIdle.store(isIdle, std::memory_order_relaxed);
+    mPublishedFrame.store(mVoices[0].readFrameIndex, std::memory_order_relaxed);
+    mPublishedRate.store(mVoices[0].isPlaying ? mVoices[0].playbackRate : 0.0f, std::memory_order_relaxed);
+}
+
+void Player::takeStateFrom(const Player &other, int64_t framePosition) {
+    // Sources always have the sample rate of the stream they were loaded for, so this is the
+    // ratio between the two streams as well
+    const double ratio = static_cast<double>(mSource->getProperties().sampleRate) / other.mSource->getProperties().sampleRate;
+    const int64_t totalFrames = mSource->getSize() / mSource->getProperties().channelCount;
+    const int64_t lastPosition = std::max<int64_t>(totalFrames - 1, 0) << 32;
+    auto scaleFrame = [&](int32_t frame) {
+        return static_cast<int32_t>(std::clamp<int64_t>(std::llround(frame * ratio), 0, totalFrames));
+    };
+
+    const size_t voiceCount = std::min(mVoices.size(), other.mVoices.size());
+    for (size_t i = 0; i < voiceCount; ++i) {
+        Voice &voice = mVoices[i];
+        voice = other.mVoices[i];
+        if (ratio == 1) continue;
+
+        const int64_t position = (static_cast<int64_t>(voice.readFrameIndex) << 32) | voice.readFrameFraction;
+        const auto scaledPosition = std::clamp<int64_t>(static_cast<int64_t>(static_cast<double>(position) * ratio), 0, lastPosition);
+        voice.readFrameIndex = static_cast<int32_t>(scaledPosition >> 32);
+        voice.readFrameFraction = mStreamingSource ? 0 : static_cast<uint32_t>(scaledPosition);
+        if (voice.seekAtEnvelopeEnd >= 0) voice.seekAtEnvelopeEnd = scaleFrame(voice.seekAtEnvelopeEnd);
+        for (Ramp *ramp: {&voice.volumeRamp, &voice.envelopeRamp, &voice.panRamp, &voice.playbackRateRamp}) {
+            scaleRamp(*ramp, ratio);
+        }
+    }
+    mTriggerCount = other.mTriggerCount;
+    mBus = other.mBus;
+    mSoundId = other.mSoundId;
+
+    mScheduledEventCount = other.mScheduledEventCount;
+    for (size_t i = 0; i < mScheduledEventCount; ++i) {
+        const ScheduledEvent &event = other.mScheduledEvents[i];
+        const int64_t framesUntilEvent = std::max<int64_t>(event.frame - framePosition, 0);
+        mScheduledEvents[i] = {.frame = framePosition + std::llround(static_cast<double>(framesUntilEvent) * ratio), .isPlaying = event.isPlaying};
+    }
+
+    // Scaling keeps the markers sorted
+    mMarkerCount = other.mMarkerCount;
+    mAddedMarkerCount = other.mAddedMarkerCount;
+    for (size_t i = 0; i < mMarkerCount; ++i) {
+        mMarkers[i] = {.frame = scaleFrame(other.mMarkers[i].frame), .index = other.mMarkers[i].index};
+    }
+    publishState();
+}
+
+void Player::scaleRamp(Ramp &ramp, double ratio) {
+    if (ramp.framesRemaining == 0) return;
+
+    const int32_t framesRemaining = std::max<int32_t>(static_cast<int32_t>(std::lround(ramp.framesRemaining * ratio)), 1);
+    const double stepScale = static_cast<double>(ramp.framesRemaining) / framesRemaining;
+    ramp.step = ramp.isExponential
+        ? static_cast<float>(std::pow(static_cast<double>(ramp.step), stepScale))
+        : static_cast<float>(ramp.step * stepScale);
+    ramp.framesRemaining = framesRemaining;
+}
+
+Player::Voice &Player::findVoiceToTrigger() {
+    // The primary voice is never handed out, it keeps its own position for pause and resume
+    Voice *candidate = &mVoices[1];
+    for (size_t i = 1; i < mVoices.size(); ++i) {
+        Voice &voice = mVoices[i];
+        if (!voice.isPlaying) return voice;
+
+        switch (mVoiceStealingPolicy) {
+            case VoiceStealingPolicy::oldest:
+                if (voice.startOrder < candidate->startOrder) candidate = &voice;
+                break;
+            case VoiceStealingPolicy::quietest:
+                if (voice.volume < candidate->volume) candidate = &voice;
+                break;
+        }
     }
+    return *candidate;
 }
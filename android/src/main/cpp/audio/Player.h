@@ -17,19 +17,45 @@
 #ifndef AUDIOPLAYBACK_PLAYER_H
 #define AUDIOPLAYBACK_PLAYER_H
 
+#include <algorithm>
 #include <cstdint>
 #include <array>
+#include <vector>
 
 #include <chrono>
 #include <memory>
 #include <atomic>
 #include <utility>
 
-#include <android/asset_manager.h>
-
 #include "shared/IRenderableAudio.h"
 #include "DataSource.h"
-#include "utils/logging.h"
+
+enum class VoiceStealingPolicy {
+    oldest, quietest
+};
+
+enum class GainCurve {
+    // Constant change in amplitude per frame, fading out this way seems to drop off at the very end
+    linear,
+    // Constant change in decibels per frame, perceived as an even fade
+    exponential
+};
+
+enum class Interpolation {
+    // Two neighbouring samples, cheap but dulls high frequencies a little at rates close to 1
+    linear,
+    // Four point Hermite spline, about twice the cost of linear
+    cubic
+};
+
+enum class PlaybackEventType {
+    // The primary voice reached the end of a sound that doesn't loop and stopped
+    ended,
+    // The primary voice wrapped around to the start of a looping sound
+    looped,
+    // The primary voice played past one of the markers
+    markerReached
+};
 
 class Player : public IRenderableAudio{
 
@@ -38,23 +64,288 @@ public:
      * Construct a new Player from the given DataSource.
      *
      * @param source
+     * @param outputChannelCount the channel count of the stream, source must either have the same
+     * channel count or be mono
+     * @param maxVoices how many instances of the sound can play at the same time, streaming sources
+     * only ever have one
+     * @param voiceStealingPolicy which voice to restart when all of them are busy
+     * @param interpolation how samples between frames are read while playing at a rate other than 1
      */
-    explicit Player(DataSource *source)
-        : mSource(source)
+    Player(DataSource *source, int32_t outputChannelCount, int32_t maxVoices, VoiceStealingPolicy voiceStealingPolicy,
+           Interpolation interpolation)
+        : Player(std::shared_ptr<DataSource>(source), outputChannelCount, maxVoices, voiceStealingPolicy, interpolation)
     {};
 
+    // A source can be shared by several players, as long as only one of them is ever rendered
+    Player(std::shared_ptr<DataSource> source, int32_t outputChannelCount, int32_t maxVoices, VoiceStealingPolicy voiceStealingPolicy,
+           Interpolation interpolation)
+        : mOutputChannelCount(outputChannelCount)
+        , mVoiceStealingPolicy(voiceStealingPolicy)
+        , mInterpolation(interpolation)
+        , mSource(std::move(source))
+        , mStreamingSource(dynamic_cast<StreamingSource *>(mSource.get()))
+        , mStreamingBuffer(mStreamingSource ? std::make_unique<float[]>(kStreamingChunkSamples) : nullptr)
+        , mVoices(mStreamingSource ? 1 : std::max(maxVoices, 1))
+    {};
+
+    // The player is owned by the audio thread once added to the engine, so everything below must
+    // only be called from the audio callback (or while the engine holds its render lock).
     void renderAudio(float *targetData, int32_t numFrames) override;
-    void setPlaying(bool isPlaying) { LOGE("Setting isPlaying to: %d", isPlaying); mIsPlaying = isPlaying; };
-    void setLooping(bool isLooping) { mIsLooping = isLooping; };
-    void setVolume(float volume) { mVolume = volume; };
+
+    /**
+     * These control the primary voice, which can be paused, resumed, looped and seeked. While it
+     * plays, volume changes are smoothed and pausing, resuming in the middle of the sound and
+     * seeking fade over a few milliseconds, so that none of them click.
+     */
+    void setPlaying(bool isPlaying);
+    void setLooping(bool isLooping);
+    void setVolume(float volume);
     void seekTo(int64_t timeInMs);
 
+    /**
+     * Pan of the primary voice from -1 (left) to 1 (right). Mono sounds are panned with an equal
+     * power law that leaves the center as loud as before, stereo sounds have the opposite channel
+     * turned down. Only applies to stereo output.
+     */
+    void setPan(float pan);
+
+    /**
+     * Speed of the primary voice, which shifts its pitch with it: 2 is an octave up, 0.5 an octave
+     * down. Clamped to kMinPlaybackRate..kMaxPlaybackRate. Pan and rate changes are smoothed like
+     * volume changes. Streamed sounds always play at rate 1.
+     */
+    void setPlaybackRate(float rate);
+
+    /**
+     * Move the volume of every voice to volume over durationMs. With stopAtEnd the voices stop and
+     * rewind once they get there, which makes fading out and stopping a single command.
+     */
+    void fadeTo(float volume, int32_t durationMs, GainCurve curve, bool stopAtEnd);
+
+    /**
+     * Play the sound from its start on an additional one-shot voice, overlapping whatever is
+     * already playing. With a single voice this restarts the primary voice instead.
+     */
+    void trigger(float volume, float pan, float playbackRate);
+
+    /**
+     * Start or pause the primary voice at an exact frame of the renderer's timeline instead of at
+     * the start of the next buffer. Events in the past apply as soon as the player is rendered.
+     * Up to kMaxScheduledEvents can be pending, later ones are dropped. AudioEngine rejects them
+     * before they get here.
+     */
+    void schedulePlaying(int64_t frame, bool isPlaying);
+
+    // Apply the scheduled events that are due at frame
+    void applyScheduledEvents(int64_t frame);
+
+    // How many of the numFrames frames starting at frame can be rendered before the next event is due
+    [[nodiscard]] int32_t getFramesUntilScheduledEvent(int64_t frame, int32_t numFrames) const;
+
+    /**
+     * Times of the sound that produce a markerReached event whenever the primary voice plays past
+     * them. Up to kMaxMarkers, numbered in the order they were added, later ones are dropped.
+     */
+    void clearMarkers();
+    void addMarker(int64_t timeInMs);
+
+    struct Event {
+        PlaybackEventType type;
+        // Frames from the start of the buffer passed to renderAudio
+        int32_t frameOffset;
+        // Only set for markerReached
+        int32_t markerIndex;
+    };
+
+    // Events of the primary voice produced by the last renderAudio call, up to kMaxEvents
+    [[nodiscard]] size_t getEventCount() const { return mEventCount; }
+    [[nodiscard]] const Event &getEvent(size_t index) const { return mEvents[index]; }
+
+    // Identifies the player in the events it produces, set before handing it to the audio thread
+    void setSoundId(int32_t soundId) { mSoundId = soundId; }
+    [[nodiscard]] int32_t getSoundId() const { return mSoundId; }
+
+    // Index of the mix bus the player is summed into, see AudioRenderer
+    void setBus(int32_t bus) { mBus = bus; }
+    [[nodiscard]] int32_t getBus() const { return mBus; }
+
+    // The source never changes, so unlike the rest of the player it can be inspected from any thread
+    [[nodiscard]] const DataSource *getSource() const { return mSource.get(); }
+    [[nodiscard]] const std::shared_ptr<DataSource> &getSharedSource() const { return mSource; }
+    [[nodiscard]] int32_t getOutputChannelCount() const { return mOutputChannelCount; }
+
+    /**
+     * Continue exactly where other left off: voices with their positions, ramps and play state,
+     * markers, scheduled events, bus and sound id. Used when other's sound was converted for a
+     * stream with another sample rate or channel count, positions are scaled from other's source
+     * to ours and scheduled events keep their distance in time from framePosition. Both players
+     * must be owned by the audio thread.
+     */
+    void takeStateFrom(const Player &other, int64_t framePosition);
+
+    /**
+     * Whether no voice is playing and the sound is rewound, so that dropping the player and creating
+     * it again later would not be noticed. Published by the audio thread, readable from any thread.
+     */
+    [[nodiscard]] bool isIdle() const { return mIsIdle.load(std::memory_order_relaxed); }
+
+    /**
+     * Position of the primary voice, published by the audio thread like isIdle. While it plays, the
+     * part the output still holds back by latencyFrames is taken off, which leaves what is being heard.
+     */
+    [[nodiscard]] double getPositionMs(int32_t latencyFrames = 0) const;
+
+    static constexpr float kMinPlaybackRate = 0.125f;
+    static constexpr float kMaxPlaybackRate = 8.0f;
+    static constexpr size_t kMaxMarkers = 16;
+    static constexpr size_t kMaxEvents = 16;
+    static constexpr size_t kMaxScheduledEvents = 16;
+
 private:
-    int32_t mReadFrameIndex = 0;
-    float mVolume = 1;
-    std::atomic<bool> mIsPlaying { false };
-    std::atomic<bool> mIsLooping { false };
-    std::unique_ptr<DataSource> mSource;
+    static constexpr int32_t kStreamingChunkSamples = 1024;
+    static constexpr int32_t kDeclickMs = 5;
+    // Ramps are mixed in pieces of this many frames, with the gain interpolated linearly in each
+    static constexpr int32_t kRampSegmentFrames = 64;
+    // Exponential ramps can't reach or start from silence, they snap to it at the end instead
+    static constexpr float kMinExponentialGain = 0.0001f;
+
+    // Moves a value towards target over framesRemaining frames
+    struct Ramp {
+        float target = 1;
+        // Added to the value every frame, or multiplied with it for exponential ramps
+        float step = 0;
+        int32_t framesRemaining = 0;
+        bool isExponential = false;
+    };
+
+    struct Voice {
+        int32_t readFrameIndex = 0;
+        // Position between readFrameIndex and the next frame, in units of 2^-32 frames
+        uint32_t readFrameFraction = 0;
+        float volume = 1;
+        Ramp volumeRamp;
+        bool stopAtVolumeRampEnd = false;
+        // A short fade on top of the volume for pausing, resuming and seeking
+        float envelope = 1;
+        Ramp envelopeRamp;
+        bool pauseAtEnvelopeEnd = false;
+        // -1 when no seek is waiting for the envelope to reach silence
+        int32_t seekAtEnvelopeEnd = -1;
+        // Set while a stolen voice fades out, it restarts with the restart values once silent
+        bool restartAtEnvelopeEnd = false;
+        float restartVolume = 1;
+        float restartPan = 0;
+        float restartPlaybackRate = 1;
+        float pan = 0;
+        Ramp panRamp;
+        float playbackRate = 1;
+        Ramp playbackRateRamp;
+        bool isPlaying = false;
+        bool isLooping = false;
+        // Increases with every trigger, used to find the oldest voice
+        uint64_t startOrder = 0;
+    };
+
+    struct ScheduledEvent {
+        int64_t frame;
+        bool isPlaying;
+    };
+
+    struct Marker {
+        int32_t frame;
+        int32_t index;
+    };
+
+    // Gain of the first two output channels
+    struct ChannelGains {
+        float left;
+        float right;
+    };
+
+    void renderVoice(Voice &voice, float *targetData, int32_t numFrames);
+    // Used instead of mixVoiceFrames while the voice is panned or doesn't play at rate 1
+    template<typename Sample>
+    void renderInterpolatedVoice(Voice &voice, float *targetData, const Sample *sourceData, int64_t totalSourceFrames, int32_t numFrames);
+    /**
+     * Mix up to numFrames frames read at the fixed point position (32 fractional bits), which
+     * advances by step every frame and wraps around when the voice loops. Gains ramp linearly.
+     *
+     * @return the frames mixed, fewer than numFrames when a voice that doesn't loop reached the end
+     */
+    template<typename Sample, Interpolation interpolation>
+    int32_t mixInterpolatedFrames(float *targetData, const Sample *sourceData, int32_t sourceChannelCount, int64_t totalSourceFrames,
+                                  bool isLooping, int64_t &position, int64_t step, int32_t numFrames,
+                                  ChannelGains gains, ChannelGains gainSteps) const;
+    [[nodiscard]] bool needsInterpolation(const Voice &voice) const;
+    [[nodiscard]] ChannelGains getChannelGains(const Voice &voice, int32_t sourceChannelCount) const;
+    void renderStreamingAudio(float *targetData, int32_t numFrames);
+    // Sample is float, int16_t or int8_t, matching the SampleFormat of the source
+    template<typename Sample>
+    void mixFrames(float *targetData, const Sample *sourceData, int32_t sourceChannelCount, int32_t numFrames, float gain, float gainStep) const;
+    /**
+     * Mix numFrames frames at the voice's gain, advancing its ramps. Stops early when a ramp ends
+     * with a pause, seek, restart or stop, which the caller applies with applyRampEndActions once it has
+     * advanced the read position.
+     *
+     * @return the frames mixed
+     */
+    template<typename Sample>
+    int32_t mixVoiceFrames(Voice &voice, float *targetData, const Sample *sourceData, int32_t sourceChannelCount, int32_t numFrames);
+    void applyRampEndActions(Voice &voice);
+    // Reset the voice to a stopped state, finishing any ramp and applying a pending seek or restart
+    void stopVoice(Voice &voice);
+    void restartVoice(Voice &voice, float volume, float pan, float playbackRate);
+    // Move the voice to frame, dropping whatever fraction of a frame it was at
+    static void setReadFrame(Voice &voice, int32_t frame);
+    [[nodiscard]] int32_t getDeclickFrames() const;
+    [[nodiscard]] int32_t getSeekFrame(int64_t timeInMs) const;
+    static void startRamp(float &value, Ramp &ramp, float target, int32_t numFrames, GainCurve curve);
+    static void advanceRamp(float &value, Ramp &ramp, int32_t numFrames);
+    static bool hasRampEndAction(const Voice &voice);
+    // Keep the ramp's remaining duration in time when the frame rate changes by ratio
+    static void scaleRamp(Ramp &ramp, double ratio);
+    /**
+     * Record a markerReached event for every marker the primary voice passed moving from
+     * fromPosition to toPosition, both fixed point with 32 fractional bits, at step per frame.
+     */
+    void addMarkerEvents(int64_t fromPosition, int64_t toPosition, int64_t step, int32_t frameOffset);
+    void addEvent(PlaybackEventType type, int32_t frameOffset, int32_t markerIndex = 0);
+    [[nodiscard]] bool isPrimaryVoice(const Voice &voice) const { return &voice == mVoices.data(); }
+    Voice &findVoiceToTrigger();
+    // Publish the idle state and the position of the primary voice to other threads
+    void publishState();
+
+    const int32_t mOutputChannelCount;
+    const VoiceStealingPolicy mVoiceStealingPolicy;
+    const Interpolation mInterpolation;
+    std::shared_ptr<DataSource> mSource;
+
+    // Only set when mSource streams its data instead of keeping it resident
+    StreamingSource *mStreamingSource;
+    std::unique_ptr<float[]> mStreamingBuffer;
+
+    // Allocated once so that triggering a voice never allocates. The first one is the primary voice.
+    std::vector<Voice> mVoices;
+    uint64_t mTriggerCount = 0;
+    int32_t mBus = 0;
+
+    // Sorted by frame, events for the same frame keep the order they were scheduled in
+    std::array<ScheduledEvent, kMaxScheduledEvents> mScheduledEvents {};
+    size_t mScheduledEventCount = 0;
+
+    // Sorted by frame
+    std::array<Marker, kMaxMarkers> mMarkers {};
+    size_t mMarkerCount = 0;
+    int32_t mAddedMarkerCount = 0;
+
+    std::array<Event, kMaxEvents> mEvents {};
+    size_t mEventCount = 0;
+    int32_t mSoundId = 0;
+
+    std::atomic<bool> mIsIdle { true };
+    std::atomic<int32_t> mPublishedFrame { 0 };
+    // Source frames the primary voice moves per output frame, 0 while it is paused
+    std::atomic<float> mPublishedRate { 0 };
 };
 
 #endif //AUDIOPLAYBACK_PLAYER_H
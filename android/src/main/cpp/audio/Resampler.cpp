@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#include "Resampler.h"
+
+namespace {
+    struct QualitySettings {
+        int32_t numTaps;
+        double kaiserBeta;
+        // Fraction of the narrower Nyquist frequency that is kept
+        double passband;
+    };
+
+    QualitySettings getQualitySettings(ResamplerQuality quality) {
+        switch (quality) {
+            case ResamplerQuality::low: return {.numTaps = 8, .kaiserBeta = 5.0, .passband = 0.85};
+            case ResamplerQuality::medium: return {.numTaps = 16, .kaiserBeta = 7.0, .passband = 0.90};
+            case ResamplerQuality::high: return {.numTaps = 32, .kaiserBeta = 9.0, .passband = 0.94};
+        }
+        return {.numTaps = 16, .kaiserBeta = 7.0, .passband = 0.90};
+    }
+
+    // Zeroth order modified Bessel function of the first kind, used by the Kaiser window
+    double besselI0(double x) {
+        double sum = 1.0;
+        double term = 1.0;
+        for (int k = 1; k < 32; ++k) {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+            if (term < sum * 1e-12) break;
+        }
+        return sum;
+    }
+
+    // numTaps is always a multiple of 4
+    inline float dotProduct(const float *coefficients, const float *samples, int32_t numTaps) {
+#if defined(__ARM_NEON)
+        float32x4_t sum = vdupq_n_f32(0.0f);
+        for (int32_t i = 0; i < numTaps; i += 4) {
+            sum = vmlaq_f32(sum, vld1q_f32(coefficients + i), vld1q_f32(samples + i));
+        }
+        float32x2_t half = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+        return vget_lane_f32(vpadd_f32(half, half), 0);
+#elif defined(__SSE__)
+        __m128 sum = _mm_setzero_ps();
+        for (int32_t i = 0; i < numTaps; i += 4) {
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(coefficients + i), _mm_loadu_ps(samples + i)));
+        }
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, sum);
+        return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#else
+        float sum = 0.0f;
+        for (int32_t i = 0; i < numTaps; ++i) {
+            sum += coefficients[i] * samples[i];
+        }
+        return sum;
+#endif
+    }
+}
+
+Resampler::Resampler(int32_t inputSampleRate, int32_t outputSampleRate, int32_t channelCount, ResamplerQuality quality)
+    : mChannelCount(channelCount) {
+    const int64_t divisor = std::gcd(inputSampleRate, outputSampleRate);
+    mInterpolation = outputSampleRate / divisor;
+    mDecimation = inputSampleRate / divisor;
+    mNumPhases = static_cast<int32_t>(std::min(mInterpolation, kMaxPhases));
+
+    const QualitySettings settings = getQualitySettings(quality);
+
+    // When downsampling the cutoff drops below the input's Nyquist frequency, the filter has to get
+    // proportionally longer to keep the same transition band
+    const double ratio = std::min(1.0, static_cast<double>(outputSampleRate) / inputSampleRate);
+    const double cutoff = ratio * settings.passband;
+    mNumTaps = static_cast<int32_t>(std::ceil(settings.numTaps / ratio / 4.0)) * 4;
+
+    const double halfTaps = mNumTaps / 2.0;
+    const double windowNormalization = besselI0(settings.kaiserBeta);
+
+    mCoefficients.resize(static_cast<size_t>(mNumPhases) * mNumTaps);
+    for (int32_t phase = 0; phase < mNumPhases; ++phase) {
+        const double fraction = static_cast<double>(phase) / mNumPhases;
+        float *row = mCoefficients.data() + static_cast<size_t>(phase) * mNumTaps;
+
+        double sum = 0.0;
+        for (int32_t tap = 0; tap < mNumTaps; ++tap) {
+            // Distance between the input sample under this tap and the output position
+            const double distance = (tap - halfTaps + 1) - fraction;
+            const double x = M_PI * cutoff * distance;
+            const double sinc = distance == 0.0 ? 1.0 : std::sin(x) / x;
+
+            const double windowPosition = distance / halfTaps;
+            const double window = std::abs(windowPosition) >= 1.0
+                    ? 0.0
+                    : besselI0(settings.kaiserBeta * std::sqrt(1.0 - windowPosition * windowPosition)) / windowNormalization;
+
+            const double coefficient = cutoff * sinc * window;
+            row[tap] = static_cast<float>(coefficient);
+            sum += coefficient;
+        }
+
+        // Normalize every phase to unity gain so a constant signal stays constant
+        for (int32_t tap = 0; tap < mNumTaps; ++tap) {
+            row[tap] = static_cast<float>(row[tap] / sum);
+        }
+    }
+}
+
+int64_t Resampler::getOutputFrameCount(int64_t inputFrameCount) const {
+    return inputFrameCount * mInterpolation / mDecimation;
+}
+
+void Resampler::process(const float *input, int64_t inputFrameCount, float *output) const {
+    const int64_t outputFrameCount = getOutputFrameCount(inputFrameCount);
+
+    // Work on one zero padded channel at a time so that every tap window is contiguous in memory.
+    // Input frame j lives at index j + mNumTaps / 2, so the window for position i starts at i + 1.
+    std::vector<float> channel(static_cast<size_t>(inputFrameCount + mNumTaps + 1), 0.0f);
+    const int64_t padding = mNumTaps / 2;
+
+    for (int32_t c = 0; c < mChannelCount; ++c) {
+        for (int64_t i = 0; i < inputFrameCount; ++i) {
+            channel[i + padding] = input[i * mChannelCount + c];
+        }
+
+        for (int64_t n = 0; n < outputFrameCount; ++n) {
+            const int64_t position = n * mDecimation;
+            int64_t index = position / mInterpolation;
+            int64_t phase = position % mInterpolation;
+
+            if (mInterpolation > kMaxPhases) {
+                phase = (phase * mNumPhases + mInterpolation / 2) / mInterpolation;
+                if (phase == mNumPhases) {
+                    phase = 0;
+                    index++;
+                }
+            }
+
+            const float *coefficients = mCoefficients.data() + phase * mNumTaps;
+            output[n * mChannelCount + c] = dotProduct(coefficients, channel.data() + index + 1, mNumTaps);
+        }
+    }
+}
+
+ResamplerQuality Resampler::getQualityFromInt(int quality) {
+    switch (quality) {
+        case 0: return ResamplerQuality::low;
+        case 1: return ResamplerQuality::medium;
+        case 2: return ResamplerQuality::high;
+        default: return ResamplerQuality::medium;
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef AUDIOPLAYBACK_RESAMPLER_H
+#define AUDIOPLAYBACK_RESAMPLER_H
+
+#include <cstdint>
+#include <vector>
+
+enum class ResamplerQuality {
+    low, medium, high
+};
+
+/**
+ * Polyphase windowed-sinc sample rate converter for interleaved float audio.
+ *
+ * The filter bank is computed once on construction, so the same instance can be reused to convert
+ * several buffers between the same pair of rates. It is meant to run at load time, not on the
+ * audio thread.
+ */
+class Resampler {
+public:
+    Resampler(int32_t inputSampleRate, int32_t outputSampleRate, int32_t channelCount, ResamplerQuality quality);
+
+    [[nodiscard]] int64_t getOutputFrameCount(int64_t inputFrameCount) const;
+
+    /**
+     * Convert the whole input buffer. output must have room for getOutputFrameCount() frames.
+     */
+    void process(const float *input, int64_t inputFrameCount, float *output) const;
+
+    static ResamplerQuality getQualityFromInt(int quality);
+
+private:
+    // Rates like 44100 -> 48000 reduce to 147/160 phases, anything needing more gets its phase
+    // rounded to the closest of this many
+    static constexpr int64_t kMaxPhases = 1024;
+
+    const int32_t mChannelCount;
+    // Output frame n reads around input position n * mDecimation / mInterpolation
+    int64_t mInterpolation;
+    int64_t mDecimation;
+    int32_t mNumPhases;
+    int32_t mNumTaps;
+    // mNumPhases rows of mNumTaps coefficients
+    std::vector<float> mCoefficients;
+};
+
+#endif //AUDIOPLAYBACK_RESAMPLER_H
@@ -0,0 +1,226 @@
+#include <unistd.h>
+
+#include <algorithm>
+#include <sstream>
+
+#include <utils/logging.h>
+
+#include "StreamingDataSource.h"
+#include "Decoders.h"
+
+NewStreamingDataSourceResult
+StreamingDataSource::newFromCompressedAsset(int fd, int offset, int length,
+                                            AudioProperties targetProperties,
+                                            int32_t readAheadMs) {
+    // The caller closes the file descriptor once loading is done, but we keep reading from it
+    int ownedFd = dup(fd);
+    if(ownedFd == -1) {
+        return {.dataSource = nullptr, .error = "Failed to load sound file: could not duplicate the file descriptor"};
+    }
+
+    auto openResult = openDecoder(ownedFd, offset, length);
+    if(openResult.error) {
+        close(ownedFd);
+        return {.dataSource = nullptr, .error = openResult.error};
+    }
+
+    // Resampling only happens when a sound is fully loaded
+    auto sourceProperties = openResult.decoder->getProperties();
+    std::optional<std::string> error;
+    if(sourceProperties.sampleRate != targetProperties.sampleRate) {
+        std::stringstream stream;
+        stream
+            << "Streaming sounds must have the same sample rate as the stream. "
+            << "The sample rate of the audio file, "
+            << sourceProperties.sampleRate
+            << ", doesn't match the sample rate of the stream, "
+            << targetProperties.sampleRate << ".";
+        error = stream.str();
+    }
+
+    // Mono is expanded by the player while mixing, any other mismatch needs a full load
+    if(sourceProperties.channelCount != targetProperties.channelCount && sourceProperties.channelCount != 1) {
+        std::stringstream stream;
+        stream
+            << "Streaming sounds must be mono or have the same channel count as the stream. "
+            << "The channel count of the audio file, "
+            << sourceProperties.channelCount
+            << ", doesn't match the channel count of the stream, "
+            << targetProperties.channelCount << ".";
+        error = stream.str();
+    }
+
+    if(error) {
+        openResult.decoder.reset();
+        close(ownedFd);
+        return {.dataSource = nullptr, .error = error};
+    }
+
+    int64_t readAheadFrames = std::max<int64_t>(1, static_cast<int64_t>(readAheadMs) * sourceProperties.sampleRate / 1000);
+    auto dataSource = new StreamingDataSource(
+            ownedFd,
+            std::move(openResult.decoder),
+            static_cast<size_t>(readAheadFrames * sourceProperties.channelCount));
+
+    // Wait for the read-ahead to fill up so that playing right away doesn't start with an underrun.
+    // A corrupt file fails the decoder and a stalled one never fills it, neither may hang the load.
+    std::optional<std::string> primingError;
+    {
+        std::unique_lock<std::mutex> lock(dataSource->mMutex);
+        const bool isDone = dataSource->mCondition.wait_for(lock, kPrimingTimeout, [dataSource] {
+            return dataSource->mIsPrimed || dataSource->mDecodeError;
+        });
+        if(dataSource->mDecodeError) {
+            primingError = dataSource->mDecodeError;
+        } else if(!isDone) {
+            primingError = "Failed to load sound file: decoding did not start in time";
+        }
+    }
+
+    if(primingError) {
+        delete dataSource;
+        return {.dataSource = nullptr, .error = primingError};
+    }
+    return {.dataSource = dataSource, .error = std::nullopt};
+}
+
+StreamingDataSource::StreamingDataSource(int fd, std::unique_ptr<Decoder> decoder, size_t ringCapacity)
+    : mFd(fd)
+    , mDecoder(std::move(decoder))
+    , mProperties(mDecoder->getProperties())
+    , mSize(mDecoder->getDurationUs() * mProperties.sampleRate / 1000000 * mProperties.channelCount)
+    , mPollInterval(std::clamp<int64_t>(
+            static_cast<int64_t>(ringCapacity / mProperties.channelCount) * 1000 / mProperties.sampleRate / 4,
+            5, 100))
+    , mRing(ringCapacity)
+    , mThread(&StreamingDataSource::run, this) {
+}
+
+StreamingDataSource::~StreamingDataSource() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mIsStopping = true;
+    }
+    mCondition.notify_all();
+    mThread.join();
+
+    mDecoder.reset();
+    close(mFd);
+}
+
+int32_t StreamingDataSource::readFrames(float *targetData, int32_t numFrames) {
+    if(hasPendingSeek()) {
+        return 0;
+    }
+
+    const auto completedSeekGeneration = mCompletedSeekGeneration.load(std::memory_order_acquire);
+    if(mConsumedSeekGeneration != completedSeekGeneration) {
+        // Drop everything that was decoded before the decoder jumped to the new position
+        const auto seekSampleMarker = mSeekSampleMarker.load(std::memory_order_relaxed);
+        if(seekSampleMarker > mPoppedSamples) {
+            mPoppedSamples += mRing.skip(seekSampleMarker - mPoppedSamples);
+        }
+        mConsumedSeekGeneration = completedSeekGeneration;
+    }
+
+    // The decoder only ever pushes whole frames, so only read whole frames as well
+    const auto channelCount = static_cast<size_t>(mProperties.channelCount);
+    const auto availableSamples = mRing.size() / channelCount * channelCount;
+    const auto samplesToRead = std::min(static_cast<size_t>(numFrames) * channelCount, availableSamples);
+    const auto samplesRead = mRing.pop(targetData, samplesToRead);
+
+    mPoppedSamples += samplesRead;
+    return static_cast<int32_t>(samplesRead / channelCount);
+}
+
+bool StreamingDataSource::isFinished() const {
+    return !hasPendingSeek() &&
+           mConsumedSeekGeneration == mCompletedSeekGeneration.load(std::memory_order_acquire) &&
+           mIsEndOfStream.load(std::memory_order_acquire) &&
+           mRing.empty();
+}
+
+void StreamingDataSource::seekTo(int64_t frameIndex) {
+    mRequestedSeekFrame.store(frameIndex, std::memory_order_relaxed);
+    mRequestedSeekGeneration.fetch_add(1, std::memory_order_release);
+}
+
+bool StreamingDataSource::hasPendingSeek() const {
+    return mRequestedSeekGeneration.load(std::memory_order_relaxed) !=
+           mCompletedSeekGeneration.load(std::memory_order_acquire);
+}
+
+void StreamingDataSource::run() {
+    const auto channelCount = static_cast<size_t>(mProperties.channelCount);
+
+    std::vector<float> converted {};
+    size_t convertedOffset = 0;
+    uint32_t handledSeekGeneration = 0;
+    bool isDecoding = true;
+    // A failed decoder is not retried, not even by seeking or looping
+    bool hasFailed = false;
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    while(!mIsStopping) {
+        lock.unlock();
+
+        const auto requestedSeekGeneration = mRequestedSeekGeneration.load(std::memory_order_acquire);
+        if(requestedSeekGeneration != handledSeekGeneration) {
+            const auto frameIndex = mRequestedSeekFrame.load(std::memory_order_relaxed);
+            mDecoder->seekTo(frameIndex * 1000000 / mProperties.sampleRate);
+            converted.clear();
+            convertedOffset = 0;
+            isDecoding = true;
+
+            mIsEndOfStream.store(false, std::memory_order_relaxed);
+            mSeekSampleMarker.store(mPushedSamples, std::memory_order_relaxed);
+            mCompletedSeekGeneration.store(requestedSeekGeneration, std::memory_order_release);
+            handledSeekGeneration = requestedSeekGeneration;
+        }
+
+        bool isIdle = false;
+        if(convertedOffset < converted.size()) {
+            const auto freeSamples = (mRing.capacity() - mRing.size()) / channelCount * channelCount;
+            const auto pushed = mRing.push(converted.data() + convertedOffset,
+                                           std::min(converted.size() - convertedOffset, freeSamples));
+            convertedOffset += pushed;
+            mPushedSamples += pushed;
+            // The ring is full, wait for the audio thread to catch up
+            isIdle = convertedOffset < converted.size();
+        } else if(isDecoding && !hasFailed) {
+            converted.clear();
+            convertedOffset = 0;
+            // Convert each decoded buffer to float as it arrives
+            isDecoding = mDecoder->decodeNext([&converted](const void *samples, SampleFormat format, size_t count) {
+                const size_t start = converted.size();
+                converted.resize(start + count);
+                Decoder::convertSamples(samples, format, converted.data() + start, SampleFormat::float32, count);
+            });
+            if(!isDecoding) {
+                if(auto error = mDecoder->getError()) {
+                    LOGE("Streaming sound stopped decoding: %s", error->c_str());
+                    hasFailed = true;
+                    std::lock_guard<std::mutex> errorLock(mMutex);
+                    mDecodeError = std::move(error);
+                    mCondition.notify_all();
+                }
+            }
+        } else if(!hasFailed && mIsLooping.load(std::memory_order_relaxed)) {
+            mDecoder->seekTo(0);
+            isDecoding = true;
+            mIsEndOfStream.store(false, std::memory_order_release);
+        } else {
+            mIsEndOfStream.store(true, std::memory_order_release);
+            isIdle = true;
+        }
+
+        lock.lock();
+        if(isIdle) {
+            if(!mIsPrimed) {
+                mIsPrimed = true;
+                mCondition.notify_all();
+            }
+            mCondition.wait_for(lock, mPollInterval, [this] { return mIsStopping; });
+        }
+    }
+}
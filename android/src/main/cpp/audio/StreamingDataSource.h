@@ -0,0 +1,94 @@
+#ifndef AUDIOPLAYBACK_STREAMINGDATASOURCE_H
+#define AUDIOPLAYBACK_STREAMINGDATASOURCE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include <AudioConstants.h>
+#include "DataSource.h"
+#include "Decoder.h"
+#include "utils/SpscQueue.h"
+
+class StreamingDataSource;
+
+struct NewStreamingDataSourceResult {
+    StreamingDataSource *dataSource;
+    std::optional<std::string> error;
+};
+
+/**
+ * A DataSource that keeps only a short window of decoded audio in memory.
+ *
+ * A decoder thread keeps a ring of float samples filled ahead of the playback position. The audio
+ * thread consumes it with readFrames() and controls the decoder through seekTo()/setLooping(),
+ * none of which block or allocate.
+ */
+class StreamingDataSource : public StreamingSource {
+
+public:
+    ~StreamingDataSource() override;
+
+    // Estimated from the track duration, the decoder is the only one that knows the exact size
+    [[nodiscard]] int64_t getSize() const override { return mSize; }
+    [[nodiscard]] AudioProperties getProperties() const override { return mProperties; }
+    [[nodiscard]] const float* getData() const override { return nullptr; }
+
+    static NewStreamingDataSourceResult newFromCompressedAsset(
+            int fd, int offset, int length,
+            AudioProperties targetProperties,
+            int32_t readAheadMs);
+
+    int32_t readFrames(float *targetData, int32_t numFrames) override;
+    [[nodiscard]] bool isFinished() const override;
+    void seekTo(int64_t frameIndex) override;
+    void setLooping(bool isLooping) override { mIsLooping.store(isLooping, std::memory_order_relaxed); }
+
+private:
+    // Longest a load waits for the read-ahead to fill up
+    static constexpr auto kPrimingTimeout = std::chrono::seconds(5);
+
+    StreamingDataSource(int fd, std::unique_ptr<Decoder> decoder, size_t ringCapacity);
+
+    void run();
+    bool hasPendingSeek() const;
+
+    const int mFd;
+    std::unique_ptr<Decoder> mDecoder;
+    const AudioProperties mProperties;
+    const int64_t mSize;
+    const std::chrono::milliseconds mPollInterval;
+
+    SpscQueue<float> mRing;
+
+    // Seeks are requested by the audio thread and acknowledged by the decoder thread, along with
+    // the number of samples it had pushed before it started writing from the new position.
+    std::atomic<int64_t> mRequestedSeekFrame { 0 };
+    std::atomic<uint32_t> mRequestedSeekGeneration { 0 };
+    std::atomic<uint32_t> mCompletedSeekGeneration { 0 };
+    std::atomic<uint64_t> mSeekSampleMarker { 0 };
+    std::atomic<bool> mIsEndOfStream { false };
+    std::atomic<bool> mIsLooping { false };
+
+    // Audio thread state
+    uint32_t mConsumedSeekGeneration = 0;
+    uint64_t mPoppedSamples = 0;
+
+    // Decoder thread state
+    uint64_t mPushedSamples = 0;
+
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    bool mIsStopping = false;
+    bool mIsPrimed = false;
+    // Set by the decoder thread when the decoder failed
+    std::optional<std::string> mDecodeError;
+    std::thread mThread;
+};
+
+#endif //AUDIOPLAYBACK_STREAMINGDATASOURCE_H
@@ -0,0 +1,119 @@
+#include "WavDecoder.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+template<typename T>
+T readSample(const std::byte *data) {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+// The formats the mixer reads natively, provided the samples are aligned for them
+std::optional<SampleFormat> getDirectFormat(const WavFile &wav) {
+    std::optional<SampleFormat> format;
+    if(wav.encoding == WavEncoding::pcm16) {
+        format = SampleFormat::int16;
+    } else if(wav.encoding == WavEncoding::float32) {
+        format = SampleFormat::float32;
+    }
+    if(format && reinterpret_cast<uintptr_t>(wav.samples) % getBytesPerSample(*format) != 0) {
+        return std::nullopt;
+    }
+    return format;
+}
+
+void convertToFloat(const std::byte *input, WavEncoding encoding, float *output, size_t count) {
+    switch (encoding) {
+        case WavEncoding::pcm8:
+            // 8 bit WAV is the only unsigned encoding
+            for (size_t i = 0; i < count; ++i) {
+                output[i] = (static_cast<float>(std::to_integer<uint8_t>(input[i])) - 128.0f) * (1.0f / 128.0f);
+            }
+            break;
+        case WavEncoding::pcm16:
+            for (size_t i = 0; i < count; ++i) {
+                output[i] = static_cast<float>(readSample<int16_t>(input + i * 2)) * (1.0f / 32768.0f);
+            }
+            break;
+        case WavEncoding::pcm24:
+            for (size_t i = 0; i < count; ++i) {
+                const std::byte *sample = input + i * 3;
+                // Assemble the sample in the top bytes so that the sign carries over
+                const auto value = static_cast<int32_t>(
+                        std::to_integer<uint32_t>(sample[0]) << 8 |
+                        std::to_integer<uint32_t>(sample[1]) << 16 |
+                        std::to_integer<uint32_t>(sample[2]) << 24);
+                output[i] = static_cast<float>(value) * (1.0f / 2147483648.0f);
+            }
+            break;
+        case WavEncoding::pcm32:
+            for (size_t i = 0; i < count; ++i) {
+                output[i] = static_cast<float>(readSample<int32_t>(input + i * 4)) * (1.0f / 2147483648.0f);
+            }
+            break;
+        case WavEncoding::float32:
+            std::memcpy(output, input, count * sizeof(float));
+            break;
+        case WavEncoding::float64:
+            for (size_t i = 0; i < count; ++i) {
+                output[i] = static_cast<float>(readSample<double>(input + i * 8));
+            }
+            break;
+    }
+}
+
+}
+
+OpenDecoderResult WavDecoder::open(int fd, int offset, int length) {
+    auto mapResult = MappedFile::map(fd, offset, static_cast<size_t>(length));
+    if(mapResult.error) {
+        return {.decoder = nullptr, .error = mapResult.error};
+    }
+
+    auto parseResult = parseWavFile(mapResult.file->getData(), mapResult.file->getSize());
+    if(parseResult.error) {
+        return {.decoder = nullptr, .error = parseResult.error};
+    }
+
+    return {
+            .decoder = std::unique_ptr<Decoder>(new WavDecoder(std::move(mapResult.file), *parseResult.file)),
+            .error = std::nullopt
+    };
+}
+
+WavDecoder::WavDecoder(std::unique_ptr<MappedFile> file, WavFile wav)
+    : mFile(std::move(file))
+    , mWav(wav)
+    , mProperties({.channelCount = wav.channelCount, .sampleRate = wav.sampleRate})
+    , mDirectFormat(getDirectFormat(wav)) {
+}
+
+bool WavDecoder::decodeNext(const OutputCallback &onOutput) {
+    const int64_t frameCount = std::min(kFramesPerBuffer, mWav.frameCount - mFramePosition);
+    if(frameCount <= 0) {
+        return false;
+    }
+
+    const auto sampleOffset = static_cast<size_t>(mFramePosition * mWav.channelCount);
+    const auto sampleCount = static_cast<size_t>(frameCount * mWav.channelCount);
+    const std::byte *input = mWav.samples + sampleOffset * getBytesPerSample(mWav.encoding);
+
+    if(mDirectFormat) {
+        onOutput(input, *mDirectFormat, sampleCount);
+    } else {
+        mConverted.resize(sampleCount);
+        convertToFloat(input, mWav.encoding, mConverted.data(), sampleCount);
+        onOutput(mConverted.data(), SampleFormat::float32, sampleCount);
+    }
+
+    mFramePosition += frameCount;
+    return mFramePosition < mWav.frameCount;
+}
+
+void WavDecoder::seekTo(int64_t timeUs) {
+    mFramePosition = std::clamp<int64_t>(timeUs * mWav.sampleRate / 1000000, 0, mWav.frameCount);
+}
@@ -0,0 +1,44 @@
+#ifndef AUDIOPLAYBACK_WAVDECODER_H
+#define AUDIOPLAYBACK_WAVDECODER_H
+
+#include <memory>
+#include <vector>
+
+#include <utils/MappedFile.h>
+#include "Decoder.h"
+#include "WavFile.h"
+
+/**
+ * Decodes PCM and float WAV files in software, from a memory mapping of the file. 16 bit and 32
+ * bit float samples are handed out straight from the mapping, the other encodings are converted to
+ * float a buffer at a time.
+ */
+class WavDecoder : public Decoder {
+public:
+    static OpenDecoderResult open(int fd, int offset, int length);
+
+    [[nodiscard]] AudioProperties getProperties() const override { return mProperties; }
+    [[nodiscard]] int64_t getDurationUs() const override {
+        return mWav.frameCount * 1000000 / mWav.sampleRate;
+    }
+
+    bool decodeNext(const OutputCallback &onOutput) override;
+    void seekTo(int64_t timeUs) override;
+
+private:
+    // Keeps the buffers handed to the callback in the range a codec would produce
+    static constexpr int64_t kFramesPerBuffer = 4096;
+
+    WavDecoder(std::unique_ptr<MappedFile> file, WavFile wav);
+
+    const std::unique_ptr<MappedFile> mFile;
+    const WavFile mWav;
+    const AudioProperties mProperties;
+    // Set when the samples can be handed out without converting them
+    const std::optional<SampleFormat> mDirectFormat;
+
+    int64_t mFramePosition = 0;
+    std::vector<float> mConverted;
+};
+
+#endif //AUDIOPLAYBACK_WAVDECODER_H
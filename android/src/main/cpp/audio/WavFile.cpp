@@ -0,0 +1,167 @@
+#include "WavFile.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t kRiffHeaderSize = 12;
+constexpr size_t kChunkHeaderSize = 8;
+constexpr size_t kFmtChunkMinSize = 16;
+constexpr size_t kFmtExtensibleSubFormatOffset = 24;
+
+constexpr uint16_t kWaveFormatPcm = 1;
+constexpr uint16_t kWaveFormatIeeeFloat = 3;
+constexpr uint16_t kWaveFormatExtensible = 0xFFFE;
+
+// WAV files are little endian, like every ABI Android runs on
+template<typename T>
+T readLittleEndian(const std::byte *data) {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+struct WavFormat {
+    WavEncoding encoding;
+    int32_t channelCount;
+    int32_t sampleRate;
+};
+
+struct ParseFmtChunkResult {
+    std::optional<WavFormat> format;
+    std::optional<std::string> error;
+};
+
+std::optional<WavEncoding> getEncoding(uint16_t formatTag, uint16_t bitsPerSample) {
+    if(formatTag == kWaveFormatPcm) {
+        switch (bitsPerSample) {
+            case 8: return WavEncoding::pcm8;
+            case 16: return WavEncoding::pcm16;
+            case 24: return WavEncoding::pcm24;
+            case 32: return WavEncoding::pcm32;
+            default: return std::nullopt;
+        }
+    }
+    if(formatTag == kWaveFormatIeeeFloat) {
+        switch (bitsPerSample) {
+            case 32: return WavEncoding::float32;
+            case 64: return WavEncoding::float64;
+            default: return std::nullopt;
+        }
+    }
+    return std::nullopt;
+}
+
+ParseFmtChunkResult parseFmtChunk(const std::byte *chunk, size_t size) {
+    if(size < kFmtChunkMinSize) {
+        return {.format = std::nullopt, .error = "Invalid WAV file: the fmt chunk is too small"};
+    }
+
+    auto formatTag = readLittleEndian<uint16_t>(chunk);
+    auto channelCount = readLittleEndian<uint16_t>(chunk + 2);
+    auto sampleRate = readLittleEndian<uint32_t>(chunk + 4);
+    auto bitsPerSample = readLittleEndian<uint16_t>(chunk + 14);
+
+    // The actual format of extensible files is in the first two bytes of the sub format GUID
+    if(formatTag == kWaveFormatExtensible && size >= kFmtExtensibleSubFormatOffset + 2) {
+        formatTag = readLittleEndian<uint16_t>(chunk + kFmtExtensibleSubFormatOffset);
+    }
+
+    if(channelCount == 0 || sampleRate == 0) {
+        return {.format = std::nullopt, .error = "Invalid WAV file: no channels or no sample rate"};
+    }
+
+    auto encoding = getEncoding(formatTag, bitsPerSample);
+    if(!encoding) {
+        return {.format = std::nullopt, .error = "Unsupported WAV sample format, only 8 to 32 bit PCM and 32 or 64 bit float are supported"};
+    }
+
+    return {
+            .format = WavFormat {
+                    .encoding = *encoding,
+                    .channelCount = channelCount,
+                    .sampleRate = static_cast<int32_t>(sampleRate)
+            },
+            .error = std::nullopt
+    };
+}
+
+}
+
+bool isWavFile(int fd, int offset, int length) {
+    if(length < static_cast<int>(kRiffHeaderSize)) return false;
+
+    char header[kRiffHeaderSize];
+    ssize_t bytesRead;
+    do {
+        bytesRead = pread(fd, header, sizeof(header), offset);
+    } while (bytesRead == -1 && errno == EINTR);
+
+    return bytesRead == static_cast<ssize_t>(sizeof(header))
+           && std::memcmp(header, "RIFF", 4) == 0
+           && std::memcmp(header + 8, "WAVE", 4) == 0;
+}
+
+ParseWavFileResult parseWavFile(const std::byte *data, size_t size) {
+    std::optional<WavFormat> format;
+    const std::byte *samples = nullptr;
+    size_t samplesSize = 0;
+
+    size_t position = kRiffHeaderSize;
+    while (position + kChunkHeaderSize <= size && !(format && samples)) {
+        const std::byte *chunk = data + position;
+        const size_t available = size - position - kChunkHeaderSize;
+        const size_t chunkSize = std::min<size_t>(readLittleEndian<uint32_t>(chunk + 4), available);
+
+        if(std::memcmp(chunk, "fmt ", 4) == 0) {
+            auto parseResult = parseFmtChunk(chunk + kChunkHeaderSize, chunkSize);
+            if(parseResult.error) {
+                return {.file = std::nullopt, .error = parseResult.error};
+            }
+            format = parseResult.format;
+        } else if(std::memcmp(chunk, "data", 4) == 0) {
+            // Files written while recording may claim a bigger data chunk than they have, so the
+            // size is clamped to the end of the file above
+            samples = chunk + kChunkHeaderSize;
+            samplesSize = chunkSize;
+        }
+
+        // Chunks are padded to an even size
+        position += kChunkHeaderSize + chunkSize + (chunkSize & 1);
+    }
+
+    if(!format || samples == nullptr) {
+        return {.file = std::nullopt, .error = "Invalid WAV file: missing fmt or data chunk"};
+    }
+
+    const auto frameCount = static_cast<int64_t>(samplesSize / (getBytesPerSample(format->encoding) * format->channelCount));
+    if(frameCount == 0) {
+        return {.file = std::nullopt, .error = "Invalid WAV file: the file has no samples"};
+    }
+
+    return {
+            .file = WavFile {
+                    .encoding = format->encoding,
+                    .channelCount = format->channelCount,
+                    .sampleRate = format->sampleRate,
+                    .samples = samples,
+                    .frameCount = frameCount
+            },
+            .error = std::nullopt
+    };
+}
+
+int32_t getBytesPerSample(WavEncoding encoding) {
+    switch (encoding) {
+        case WavEncoding::pcm8: return 1;
+        case WavEncoding::pcm16: return 2;
+        case WavEncoding::pcm24: return 3;
+        case WavEncoding::pcm32: return 4;
+        case WavEncoding::float32: return 4;
+        case WavEncoding::float64: return 8;
+    }
+    return 1;
+}
@@ -0,0 +1,36 @@
+#ifndef AUDIOPLAYBACK_WAVFILE_H
+#define AUDIOPLAYBACK_WAVFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+enum class WavEncoding {
+    pcm8, pcm16, pcm24, pcm32, float32, float64
+};
+
+// The layout of a WAV file held in memory
+struct WavFile {
+    WavEncoding encoding;
+    int32_t channelCount;
+    int32_t sampleRate;
+    // Points into the parsed memory
+    const std::byte *samples;
+    int64_t frameCount;
+};
+
+struct ParseWavFileResult {
+    std::optional<WavFile> file;
+    std::optional<std::string> error;
+};
+
+// Only checks the RIFF/WAVE signature, without reading the rest of the file
+bool isWavFile(int fd, int offset, int length);
+
+// Find the format and the samples of the WAV file in data, which must stay valid while they are used
+ParseWavFileResult parseWavFile(const std::byte *data, size_t size);
+
+int32_t getBytesPerSample(WavEncoding encoding);
+
+#endif //AUDIOPLAYBACK_WAVFILE_H
@@ -2,57 +2,106 @@
 // Created by Rami Elwan on 28.10.24.
 //
 #include <jni.h>
+#include <algorithm>
+#include <array>
+#include <memory>
 #include <string>
+#include <type_traits>
 
 #include <android/asset_manager_jni.h>
 
 #include "AudioEngine.h"
+#include "AudioPlaybackHostObject.h"
 #include "utils/logging.h"
 
 auto audioEngine = std::make_unique<AudioEngine>();
 
-std::vector<std::pair<std::string, bool>> zipStringBooleanArrays(JNIEnv  *env, jobjectArray stringArray, jbooleanArray boolArray ){
-    jsize size = env->GetArrayLength(stringArray);
+std::vector<std::pair<SoundId, bool>> zipIntBooleanArrays(JNIEnv  *env, jintArray intArray, jbooleanArray boolArray ){
+    jsize size = env->GetArrayLength(intArray);
 
-    std::vector<std::pair<std::string, bool>> zipped{};
+    std::vector<std::pair<SoundId, bool>> zipped{};
+    zipped.reserve(size);
+    jint *jIntArray = env->GetIntArrayElements(intArray, nullptr);
     jboolean *jbooleanArray = env->GetBooleanArrayElements(boolArray, nullptr);
 
     for(jsize i = 0; i < size; i++){
-        auto idObject = (jstring)env->GetObjectArrayElement(stringArray, i);
-        const char *cString = env->GetStringUTFChars(idObject, nullptr);
-        std::string cppString(cString);
-        env->ReleaseStringUTFChars(idObject, cString);
-        env->DeleteLocalRef(idObject);
-
-        zipped.emplace_back(cppString, jbooleanArray[i]);
+        zipped.emplace_back(jIntArray[i], jbooleanArray[i]);
     }
 
-    env->ReleaseBooleanArrayElements(boolArray, jbooleanArray, 0);
+    env->ReleaseBooleanArrayElements(boolArray, jbooleanArray, JNI_ABORT);
+    env->ReleaseIntArrayElements(intArray, jIntArray, JNI_ABORT);
 
     return  zipped;
 }
 
-std::vector<std::pair<std::string, double>> zipStringDoubleArrays(JNIEnv  *env, jobjectArray stringArray, jdoubleArray doubleArray ){
-    jsize size = env->GetArrayLength(stringArray);
+std::vector<std::pair<SoundId, double>> zipIntDoubleArrays(JNIEnv  *env, jintArray intArray, jdoubleArray doubleArray ){
+    jsize size = env->GetArrayLength(intArray);
 
-    std::vector<std::pair<std::string, double>> zipped{};
+    std::vector<std::pair<SoundId, double>> zipped{};
+    zipped.reserve(size);
+    jint *jIntArray = env->GetIntArrayElements(intArray, nullptr);
     jdouble *jDoubleArray = env->GetDoubleArrayElements(doubleArray, nullptr);
 
     for(jsize i = 0; i < size; i++){
-        auto idObject = (jstring)env->GetObjectArrayElement(stringArray, i);
-        const char *cString = env->GetStringUTFChars(idObject, nullptr);
-        std::string cppString(cString);
-        env->ReleaseStringUTFChars(idObject, cString);
-        env->DeleteLocalRef(idObject);
-
-        zipped.emplace_back(cppString, jDoubleArray[i]);
+        zipped.emplace_back(jIntArray[i], jDoubleArray[i]);
     }
 
-    env->ReleaseDoubleArrayElements(doubleArray, jDoubleArray, 0);
+    env->ReleaseDoubleArrayElements(doubleArray, jDoubleArray, JNI_ABORT);
+    env->ReleaseIntArrayElements(intArray, jIntArray, JNI_ABORT);
 
     return  zipped;
 }
 
+std::vector<SoundId> jniIntArrayToVector(JNIEnv* env, jintArray intArray) {
+    std::vector<SoundId> cppVector(env->GetArrayLength(intArray));
+    env->GetIntArrayRegion(intArray, 0, static_cast<jsize>(cppVector.size()), cppVector.data());
+    return cppVector;
+}
+
+// Detaches the thread it belongs to from the VM once that thread exits
+struct JniThreadAttachment {
+    JavaVM *vm = nullptr;
+
+    ~JniThreadAttachment() {
+        if(vm) {
+            vm->DetachCurrentThread();
+        }
+    }
+};
+
+thread_local JniThreadAttachment jniThreadAttachment;
+
+// Run fn with a JNIEnv for the calling thread. Attaching is far too slow to do for every event
+// batch, so a native thread is attached the first time and stays attached until it exits.
+template<typename Fn>
+void withJniEnv(JavaVM *vm, Fn fn) {
+    JNIEnv *env = nullptr;
+    if(vm->GetEnv(reinterpret_cast<void **>(&env), JNI_VERSION_1_6) == JNI_EDETACHED) {
+        if(vm->AttachCurrentThread(&env, nullptr) != JNI_OK) {
+            LOGE("Failed to attach thread to the JVM");
+            return;
+        }
+        jniThreadAttachment.vm = vm;
+    }
+
+    fn(env);
+
+    // Nothing would ever clear it on a thread that stays attached
+    if(env->ExceptionCheck()) {
+        env->ExceptionDescribe();
+        env->ExceptionClear();
+    }
+}
+
+// A global reference deleted along with its last copy, on whichever thread that happens
+std::shared_ptr<std::remove_pointer_t<jobject>> makeSharedGlobalRef(JNIEnv *env, jobject obj) {
+    JavaVM *vm = nullptr;
+    env->GetJavaVM(&vm);
+    return {env->NewGlobalRef(obj), [vm](jobject ref) {
+        withJniEnv(vm, [ref](JNIEnv *threadEnv) { threadEnv->DeleteGlobalRef(ref); });
+    }};
+}
+
 std::string jstringToStdString(JNIEnv* env, jstring jStr) {
     if (!jStr) {
         return ""; // Return an empty std::string if jStr is null
@@ -66,19 +115,17 @@ std::string jstringToStdString(JNIEnv* env, jstring jStr) {
     return str;
 }
 
-std::vector<std::string> jniStringArrayToStringVector(JNIEnv* env, jobjectArray stringArray) {
-    std::vector<std::string> cppVector{};
-    jsize length = env->GetArrayLength(stringArray);
+std::vector<std::string> jniStringArrayToVector(JNIEnv *env, jobjectArray stringArray) {
+    jsize size = env->GetArrayLength(stringArray);
 
-    for(jsize i = 0; i < length; ++i) {
-        auto javaString = (jstring)env->GetObjectArrayElement(stringArray, i);
-        const char* chars = env->GetStringUTFChars(javaString, nullptr);
-        cppVector.emplace_back(chars);
-        env->ReleaseStringUTFChars(javaString, chars);
-        env->DeleteLocalRef(javaString);
+    std::vector<std::string> strings;
+    strings.reserve(size);
+    for(jsize i = 0; i < size; i++) {
+        auto jStr = static_cast<jstring>(env->GetObjectArrayElement(stringArray, i));
+        strings.push_back(jstringToStdString(env, jStr));
+        env->DeleteLocalRef(jStr);
     }
-
-    return cppVector;
+    return strings;
 }
 
 extern "C" {
@@ -156,20 +203,51 @@ Java_com_audioplayback_AudioPlaybackModule_closeAudioStreamNative(JNIEnv *env, j
     return returnValue;
 }
 
+JNIEXPORT jobject JNICALL
+Java_com_audioplayback_AudioPlaybackModule_reconfigureStreamNative(JNIEnv *env, jobject, jdouble sampleRate, jdouble channelCount) {
+    auto result = audioEngine->reconfigureStream(sampleRate, channelCount);
+
+    jclass structClass = env->FindClass("com/audioplayback/models/ReconfigureStreamResult");
+    jmethodID constructor = env->GetMethodID(structClass, "<init>", "(Ljava/lang/String;[I)V");
+
+    jstring jError = result.error.has_value() ? env->NewStringUTF(result.error->c_str()): nullptr;
+    const auto unloadedCount = static_cast<jsize>(result.unloadedSoundIds.size());
+    jintArray jUnloadedSoundIds = env->NewIntArray(unloadedCount);
+    env->SetIntArrayRegion(jUnloadedSoundIds, 0, unloadedCount, result.unloadedSoundIds.data());
+    jobject returnValue = env->NewObject(structClass, constructor, jError, jUnloadedSoundIds);
+
+    if(jError) {
+        env->DeleteLocalRef(jError);
+    }
+    env->DeleteLocalRef(jUnloadedSoundIds);
+
+    return returnValue;
+}
+
 JNIEXPORT void JNICALL
 Java_com_audioplayback_AudioPlaybackModule_unloadSoundsNative(JNIEnv *env, jobject ,
-                                                              jobjectArray ids) {
+                                                              jintArray ids) {
     if(ids == nullptr) {
         audioEngine->unloadSounds(std::nullopt);
     } else {
-        audioEngine->unloadSounds(jniStringArrayToStringVector(env, ids));
+        audioEngine->unloadSounds(jniIntArrayToVector(env, ids));
     }
 }
 
 
 JNIEXPORT jobject JNICALL
-Java_com_audioplayback_AudioPlaybackModule_loadSoundNative(JNIEnv *env, jobject , jint fd, jint fileLength, jint fileOffset) {
-   auto result = audioEngine->loadSound(fd, fileOffset, fileLength);
+Java_com_audioplayback_AudioPlaybackModule_loadSoundNative(JNIEnv *env, jobject , jint fd, jint fileLength, jint fileOffset,
+                                                           jboolean streaming, jint readAheadMs, jint resamplerQuality,
+                                                           jint maxVoices, jint voiceStealingPolicy, jint storageFormat) {
+   LoadSoundOptions options {
+       .streaming = static_cast<bool>(streaming),
+       .readAheadMs = readAheadMs,
+       .resamplerQuality = resamplerQuality,
+       .maxVoices = maxVoices,
+       .voiceStealingPolicy = voiceStealingPolicy,
+       .storageFormat = storageFormat
+   };
+   auto result = audioEngine->loadSound(fd, fileOffset, fileLength, options);
 
    // Once done, close the file descriptor
    if (close(fd) == -1) {
@@ -179,14 +257,22 @@ Java_com_audioplayback_AudioPlaybackModule_loadSoundNative(JNIEnv *env, jobject
    }
 
     jclass structClass = env->FindClass("com/audioplayback/models/LoadSoundResult");
-    jmethodID constructor = env->GetMethodID(structClass, "<init>", "(Ljava/lang/String;Ljava/lang/String;)V");
+    jmethodID constructor = env->GetMethodID(structClass, "<init>", "(Ljava/lang/String;Ljava/lang/Integer;)V");
+
+    jobject jId = nullptr;
+    if(result.id.has_value()) {
+        jclass integerClass = env->FindClass("java/lang/Integer");
+        jmethodID integerConstructor = env->GetMethodID(integerClass, "<init>", "(I)V");
+        jId = env->NewObject(integerClass, integerConstructor, static_cast<jint>(*result.id));
+    }
 
     jstring jError = result.error.has_value() ? env->NewStringUTF(result.error->c_str()): nullptr;
-    jstring jId = result.id.has_value() ? env->NewStringUTF(result.id->c_str()): nullptr;
     jobject returnValue = env->NewObject(structClass, constructor, jError, jId);
 
     if(jError) {
         env->DeleteLocalRef(jError);
+    }
+    if(jId) {
         env->DeleteLocalRef(jId);
     }
 
@@ -195,28 +281,368 @@ Java_com_audioplayback_AudioPlaybackModule_loadSoundNative(JNIEnv *env, jobject
 
 
 JNIEXPORT void JNICALL
-Java_com_audioplayback_AudioPlaybackModule_playSoundsNative(JNIEnv *env, jobject , jobjectArray ids,
+Java_com_audioplayback_AudioPlaybackModule_loadSoundsNative(JNIEnv *env, jobject obj, jint requestId,
+                                                            jintArray fds, jintArray fileLengths, jintArray fileOffsets,
+                                                            jbooleanArray streaming, jintArray readAheadMs, jintArray resamplerQuality,
+                                                            jintArray maxVoices, jintArray voiceStealingPolicy,
+                                                            jintArray storageFormat) {
+    const jsize size = env->GetArrayLength(fds);
+    const auto fdValues = jniIntArrayToVector(env, fds);
+    const auto lengthValues = jniIntArrayToVector(env, fileLengths);
+    const auto offsetValues = jniIntArrayToVector(env, fileOffsets);
+    const auto readAheadMsValues = jniIntArrayToVector(env, readAheadMs);
+    const auto resamplerQualityValues = jniIntArrayToVector(env, resamplerQuality);
+    const auto maxVoicesValues = jniIntArrayToVector(env, maxVoices);
+    const auto voiceStealingPolicyValues = jniIntArrayToVector(env, voiceStealingPolicy);
+    const auto storageFormatValues = jniIntArrayToVector(env, storageFormat);
+    std::vector<jboolean> streamingValues(size);
+    env->GetBooleanArrayRegion(streaming, 0, size, streamingValues.data());
+
+    std::vector<LoadSoundRequest> requests{};
+    requests.reserve(size);
+    for(jsize i = 0; i < size; i++) {
+        requests.push_back({
+            .fd = fdValues[i],
+            .offset = offsetValues[i],
+            .length = lengthValues[i],
+            .options = {
+                .streaming = static_cast<bool>(streamingValues[i]),
+                .readAheadMs = readAheadMsValues[i],
+                .resamplerQuality = resamplerQualityValues[i],
+                .maxVoices = maxVoicesValues[i],
+                .voiceStealingPolicy = voiceStealingPolicyValues[i],
+                .storageFormat = storageFormatValues[i]
+            }
+        });
+    }
+
+    // The callbacks run on decoding threads, where FindClass can't see the app's classes, so
+    // resolve everything here
+    JavaVM *vm = nullptr;
+    env->GetJavaVM(&vm);
+    jobject module = env->NewGlobalRef(obj);
+    jclass moduleClass = env->GetObjectClass(obj);
+    jmethodID onProgress = env->GetMethodID(moduleClass, "onLoadSoundsProgress", "(IILjava/lang/String;)V");
+    jmethodID onComplete = env->GetMethodID(moduleClass, "onLoadSoundsComplete", "(I[I[Ljava/lang/String;)V");
+    auto stringClass = static_cast<jclass>(env->NewGlobalRef(env->FindClass("java/lang/String")));
+    env->DeleteLocalRef(moduleClass);
+
+    LoadSoundsCallbacks callbacks {
+        .onProgress = [=](size_t index, const std::optional<std::string> &error) {
+            withJniEnv(vm, [&](JNIEnv *threadEnv) {
+                jstring jError = error.has_value() ? threadEnv->NewStringUTF(error->c_str()) : nullptr;
+                threadEnv->CallVoidMethod(module, onProgress, requestId, static_cast<jint>(index), jError);
+                if(jError) {
+                    threadEnv->DeleteLocalRef(jError);
+                }
+            });
+        },
+        .onComplete = [=](const std::vector<LoadSoundResult> &results) {
+            withJniEnv(vm, [&](JNIEnv *threadEnv) {
+                const auto resultCount = static_cast<jsize>(results.size());
+                jintArray jIds = threadEnv->NewIntArray(resultCount);
+                jobjectArray jErrors = threadEnv->NewObjectArray(resultCount, stringClass, nullptr);
+
+                std::vector<jint> ids(resultCount);
+                for(jsize i = 0; i < resultCount; i++) {
+                    ids[i] = results[i].id.value_or(0);
+                    if(results[i].error.has_value()) {
+                        jstring jError = threadEnv->NewStringUTF(results[i].error->c_str());
+                        threadEnv->SetObjectArrayElement(jErrors, i, jError);
+                        threadEnv->DeleteLocalRef(jError);
+                    }
+                }
+                threadEnv->SetIntArrayRegion(jIds, 0, resultCount, ids.data());
+
+                threadEnv->CallVoidMethod(module, onComplete, requestId, jIds, jErrors);
+
+                threadEnv->DeleteLocalRef(jIds);
+                threadEnv->DeleteLocalRef(jErrors);
+                threadEnv->DeleteGlobalRef(stringClass);
+                threadEnv->DeleteGlobalRef(module);
+            });
+        }
+    };
+
+    audioEngine->loadSounds(requestId, std::move(requests), std::move(callbacks));
+}
+
+JNIEXPORT void JNICALL
+Java_com_audioplayback_AudioPlaybackModule_setDecodedCacheDirectoryNative(JNIEnv *env, jobject , jstring directory) {
+    const char *directoryChars = env->GetStringUTFChars(directory, nullptr);
+    audioEngine->setDecodedCacheDirectory(directoryChars);
+    env->ReleaseStringUTFChars(directory, directoryChars);
+}
+
+JNIEXPORT void JNICALL
+Java_com_audioplayback_AudioPlaybackModule_setDecodedCacheOptionsNative(JNIEnv *, jobject , jlong maxBytes, jboolean storeFloat) {
+    audioEngine->setDecodedCacheOptions(maxBytes, storeFloat);
+}
+
+JNIEXPORT void JNICALL
+Java_com_audioplayback_AudioPlaybackModule_setMemoryBudgetNative(JNIEnv *, jobject , jlong bytes) {
+    audioEngine->setMemoryBudget(bytes);
+}
+
+JNIEXPORT void JNICALL
+Java_com_audioplayback_AudioPlaybackModule_prefetchSoundsNative(JNIEnv *env, jobject , jintArray ids) {
+    audioEngine->prefetchSounds(jniIntArrayToVector(env, ids));
+}
+
+JNIEXPORT void JNICALL
+Java_com_audioplayback_AudioPlaybackModule_cancelLoadSoundsNative(JNIEnv *, jobject , jint requestId) {
+    audioEngine->cancelLoadSounds(requestId);
+}
+
+JNIEXPORT void JNICALL
+Java_com_audioplayback_AudioPlaybackModule_playSoundsNative(JNIEnv *env, jobject , jintArray ids,
                                           jbooleanArray values) {
-    audioEngine->playSounds(zipStringBooleanArrays(env, ids, values));
+    audioEngine->playSounds(zipIntBooleanArrays(env, ids, values));
 }
 
 JNIEXPORT void JNICALL
-Java_com_audioplayback_AudioPlaybackModule_loopSoundsNative(JNIEnv *env, jobject , jobjectArray ids,
+Java_com_audioplayback_AudioPlaybackModule_loopSoundsNative(JNIEnv *env, jobject , jintArray ids,
                                           jbooleanArray values) {
-    audioEngine->loopSounds(zipStringBooleanArrays(env, ids, values));
+    audioEngine->loopSounds(zipIntBooleanArrays(env, ids, values));
 }
 
 JNIEXPORT void JNICALL
-Java_com_audioplayback_AudioPlaybackModule_seekSoundsToNative(JNIEnv *env, jobject , jobjectArray ids,
+Java_com_audioplayback_AudioPlaybackModule_seekSoundsToNative(JNIEnv *env, jobject , jintArray ids,
                                             jdoubleArray values) {
-    audioEngine->seekSoundsTo(zipStringDoubleArrays(env, ids, values));
+    audioEngine->seekSoundsTo(zipIntDoubleArrays(env, ids, values));
 }
 
 JNIEXPORT void JNICALL
 Java_com_audioplayback_AudioPlaybackModule_setSoundsVolumeNative(JNIEnv *env, jobject ,
-                                                                 jobjectArray ids,
+                                                                 jintArray ids,
                                                                  jdoubleArray values) {
-    audioEngine->setSoundsVolume(zipStringDoubleArrays(env, ids, values));
+    audioEngine->setSoundsVolume(zipIntDoubleArrays(env, ids, values));
+}
+
+JNIEXPORT void JNICALL
+Java_com_audioplayback_AudioPlaybackModule_triggerSoundsNative(JNIEnv *env, jobject ,
+                                                               jintArray ids,
+                                                               jdoubleArray volumes,
+                                                               jdoubleArray pans,
+                                                               jdoubleArray playbackRates) {
+    auto soundIds = jniIntArrayToVector(env, ids);
+    std::vector<jdouble> jVolumes(soundIds.size());
+    std::vector<jdouble> jPans(soundIds.size());
+    std::vector<jdouble> jPlaybackRates(soundIds.size());
+    env->GetDoubleArrayRegion(volumes, 0, static_cast<jsize>(soundIds.size()), jVolumes.data());
+    env->GetDoubleArrayRegion(pans, 0, static_cast<jsize>(soundIds.size()), jPans.data());
+    env->GetDoubleArrayRegion(playbackRates, 0, static_cast<jsize>(soundIds.size()), jPlaybackRates.data());
+
+    std::vector<TriggerSoundRequest> requests;
+    requests.reserve(soundIds.size());
+    for (size_t i = 0; i < soundIds.size(); ++i) {
+        requests.push_back({
+            .id = soundIds[i],
+            .volume = static_cast<float>(jVolumes[i]),
+            .pan = static_cast<float>(jPans[i]),
+            .playbackRate = static_cast<float>(jPlaybackRates[i])
+        });
+    }
+    audioEngine->triggerSounds(requests);
+}
+
+JNIEXPORT void JNICALL
+Java_com_audioplayback_AudioPlaybackModule_setSoundsPanNative(JNIEnv *env, jobject ,
+                                                             jintArray ids,
+                                                             jdoubleArray values) {
+    audioEngine->setSoundsPan(zipIntDoubleArrays(env, ids, values));
+}
+
+JNIEXPORT void JNICALL
+Java_com_audioplayback_AudioPlaybackModule_setSoundsPlaybackRateNative(JNIEnv *env, jobject ,
+                                                                      jintArray ids,
+                                                                      jdoubleArray values) {
+    audioEngine->setSoundsPlaybackRate(zipIntDoubleArrays(env, ids, values));
+}
+
+JNIEXPORT void JNICALL
+Java_com_audioplayback_AudioPlaybackModule_setSoundsMarkersNative(JNIEnv *env, jobject ,
+                                                                 jintArray ids,
+                                                                 jintArray markerCounts,
+                                                                 jdoubleArray markers) {
+    // The markers of every sound one after the other, markerCounts tells where each list ends
+    auto soundIds = jniIntArrayToVector(env, ids);
+    auto counts = jniIntArrayToVector(env, markerCounts);
+    std::vector<jdouble> times(env->GetArrayLength(markers));
+    env->GetDoubleArrayRegion(markers, 0, static_cast<jsize>(times.size()), times.data());
+
+    std::vector<std::pair<SoundId, std::vector<double>>> pairs;
+    pairs.reserve(soundIds.size());
+    size_t offset = 0;
+    for (size_t i = 0; i < soundIds.size(); ++i) {
+        const size_t count = std::min(static_cast<size_t>(std::max(counts[i], 0)), times.size() - offset);
+        pairs.emplace_back(soundIds[i], std::vector<double>(times.begin() + offset, times.begin() + offset + count));
+        offset += count;
+    }
+    audioEngine->setSoundsMarkers(pairs);
+}
+
+JNIEXPORT jdoubleArray JNICALL
+Java_com_audioplayback_AudioPlaybackModule_getSoundsPositionNative(JNIEnv *env, jobject , jintArray ids) {
+    auto positions = audioEngine->getSoundsPosition(jniIntArrayToVector(env, ids));
+
+    jdoubleArray jPositions = env->NewDoubleArray(static_cast<jsize>(positions.size()));
+    env->SetDoubleArrayRegion(jPositions, 0, static_cast<jsize>(positions.size()), positions.data());
+    return jPositions;
+}
+
+JNIEXPORT void JNICALL
+Java_com_audioplayback_AudioPlaybackModule_setPlaybackEventsListenerNative(JNIEnv *env, jobject obj) {
+    // The events are delivered from the engine's own thread, resolve everything here like loadSounds
+    JavaVM *vm = nullptr;
+    env->GetJavaVM(&vm);
+    // Owned by the callback, so the reference to a module the app replaced goes away with it
+    auto module = makeSharedGlobalRef(env, obj);
+    jclass moduleClass = env->GetObjectClass(obj);
+    jmethodID onPlaybackEvents = env->GetMethodID(moduleClass, "onPlaybackEvents", "([I[I[I[J)V");
+    env->DeleteLocalRef(moduleClass);
+
+    audioEngine->setPlaybackEventsCallback([=](const std::vector<PlaybackEvent> &events) {
+        withJniEnv(vm, [&](JNIEnv *threadEnv) {
+            const auto eventCount = static_cast<jsize>(events.size());
+            std::vector<jint> ids(eventCount);
+            std::vector<jint> types(eventCount);
+            std::vector<jint> markerIndices(eventCount);
+            std::vector<jlong> framePositions(eventCount);
+            for(jsize i = 0; i < eventCount; i++) {
+                ids[i] = events[i].soundId;
+                types[i] = static_cast<jint>(events[i].type);
+                markerIndices[i] = events[i].markerIndex;
+                framePositions[i] = events[i].framePosition;
+            }
+
+            jintArray jIds = threadEnv->NewIntArray(eventCount);
+            jintArray jTypes = threadEnv->NewIntArray(eventCount);
+            jintArray jMarkerIndices = threadEnv->NewIntArray(eventCount);
+            jlongArray jFramePositions = threadEnv->NewLongArray(eventCount);
+            threadEnv->SetIntArrayRegion(jIds, 0, eventCount, ids.data());
+            threadEnv->SetIntArrayRegion(jTypes, 0, eventCount, types.data());
+            threadEnv->SetIntArrayRegion(jMarkerIndices, 0, eventCount, markerIndices.data());
+            threadEnv->SetLongArrayRegion(jFramePositions, 0, eventCount, framePositions.data());
+
+            threadEnv->CallVoidMethod(module.get(), onPlaybackEvents, jIds, jTypes, jMarkerIndices, jFramePositions);
+
+            threadEnv->DeleteLocalRef(jIds);
+            threadEnv->DeleteLocalRef(jTypes);
+            threadEnv->DeleteLocalRef(jMarkerIndices);
+            threadEnv->DeleteLocalRef(jFramePositions);
+        });
+    });
+}
+
+JNIEXPORT void JNICALL
+Java_com_audioplayback_AudioPlaybackModule_fadeSoundsNative(JNIEnv *env, jobject ,
+                                                            jintArray ids,
+                                                            jdoubleArray targetVolumes,
+                                                            jintArray durationsMs,
+                                                            jbooleanArray stopAtEnd,
+                                                            jintArray curves) {
+    auto volumes = zipIntDoubleArrays(env, ids, targetVolumes);
+    auto stops = zipIntBooleanArrays(env, ids, stopAtEnd);
+    auto durations = jniIntArrayToVector(env, durationsMs);
+    auto curveValues = jniIntArrayToVector(env, curves);
+
+    std::vector<FadeSoundRequest> requests;
+    requests.reserve(volumes.size());
+    for (size_t i = 0; i < volumes.size(); ++i) {
+        requests.push_back({
+            .id = volumes[i].first,
+            .targetVolume = static_cast<float>(volumes[i].second),
+            .durationMs = durations[i],
+            .stopAtEnd = stops[i].second,
+            .curve = curveValues[i]
+        });
+    }
+    audioEngine->fadeSounds(requests);
+}
+
+JNIEXPORT void JNICALL
+Java_com_audioplayback_AudioPlaybackModule_setSoundsBusNative(JNIEnv *env, jobject ,
+                                                             jintArray ids,
+                                                             jobjectArray buses) {
+    auto soundIds = jniIntArrayToVector(env, ids);
+    auto busNames = jniStringArrayToVector(env, buses);
+
+    std::vector<std::pair<SoundId, std::string>> pairs;
+    pairs.reserve(soundIds.size());
+    for (size_t i = 0; i < soundIds.size(); ++i) {
+        pairs.emplace_back(soundIds[i], std::move(busNames[i]));
+    }
+    audioEngine->setSoundsBus(pairs);
+}
+
+JNIEXPORT void JNICALL
+Java_com_audioplayback_AudioPlaybackModule_setBusesGainNative(JNIEnv *env, jobject ,
+                                                             jobjectArray buses,
+                                                             jdoubleArray gains) {
+    auto busNames = jniStringArrayToVector(env, buses);
+    std::vector<jdouble> jGains(busNames.size());
+    env->GetDoubleArrayRegion(gains, 0, static_cast<jsize>(jGains.size()), jGains.data());
+
+    std::vector<std::pair<std::string, double>> pairs;
+    pairs.reserve(busNames.size());
+    for (size_t i = 0; i < busNames.size(); ++i) {
+        pairs.emplace_back(std::move(busNames[i]), jGains[i]);
+    }
+    audioEngine->setBusesGain(pairs);
+}
+
+JNIEXPORT void JNICALL
+Java_com_audioplayback_AudioPlaybackModule_setBusesMutedNative(JNIEnv *env, jobject ,
+                                                              jobjectArray buses,
+                                                              jbooleanArray muted) {
+    auto busNames = jniStringArrayToVector(env, buses);
+    std::vector<jboolean> jMuted(busNames.size());
+    env->GetBooleanArrayRegion(muted, 0, static_cast<jsize>(jMuted.size()), jMuted.data());
+
+    std::vector<std::pair<std::string, bool>> pairs;
+    pairs.reserve(busNames.size());
+    for (size_t i = 0; i < busNames.size(); ++i) {
+        pairs.emplace_back(std::move(busNames[i]), jMuted[i]);
+    }
+    audioEngine->setBusesMuted(pairs);
+}
+
+JNIEXPORT void JNICALL
+Java_com_audioplayback_AudioPlaybackModule_setLimiterEnabledNative(JNIEnv *, jobject , jboolean enabled) {
+    audioEngine->setLimiterEnabled(enabled);
+}
+
+JNIEXPORT void JNICALL
+Java_com_audioplayback_AudioPlaybackModule_setLatencyTuningNative(JNIEnv *, jobject , jboolean enabled,
+                                                                  jdouble aggressiveness, jdouble maxLatencyMs) {
+    audioEngine->setLatencyTuning({.enabled = static_cast<bool>(enabled), .aggressiveness = aggressiveness, .maxLatencyMs = maxLatencyMs});
+}
+
+// frames and hostTimesNs hold -1 where the request doesn't use them
+JNIEXPORT void JNICALL
+Java_com_audioplayback_AudioPlaybackModule_scheduleSoundsNative(JNIEnv *env, jobject ,
+                                                                jintArray ids,
+                                                                jbooleanArray values,
+                                                                jlongArray frames,
+                                                                jlongArray hostTimesNs) {
+    auto pairs = zipIntBooleanArrays(env, ids, values);
+    std::vector<jlong> jFrames(pairs.size());
+    std::vector<jlong> jHostTimesNs(pairs.size());
+    env->GetLongArrayRegion(frames, 0, static_cast<jsize>(pairs.size()), jFrames.data());
+    env->GetLongArrayRegion(hostTimesNs, 0, static_cast<jsize>(pairs.size()), jHostTimesNs.data());
+
+    std::vector<ScheduleSoundRequest> requests;
+    requests.reserve(pairs.size());
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        requests.push_back({
+            .id = pairs[i].first,
+            .isPlaying = pairs[i].second,
+            .frame = jFrames[i] >= 0 ? std::optional<int64_t>(jFrames[i]) : std::nullopt,
+            .hostTimeNs = jHostTimesNs[i] >= 0 ? std::optional<int64_t>(jHostTimesNs[i]) : std::nullopt
+        });
+    }
+    audioEngine->scheduleSounds(requests);
 }
 }
 
@@ -225,3 +651,99 @@ JNIEXPORT jint JNICALL
 Java_com_audioplayback_AudioPlaybackModule_getStreamStateNative(JNIEnv *, jobject ) {
     return static_cast<int>(audioEngine->getStreamState());
 }
+
+extern "C"
+JNIEXPORT jobject JNICALL
+Java_com_audioplayback_AudioPlaybackModule_getStreamPositionNative(JNIEnv *env, jobject ) {
+    auto position = audioEngine->getStreamPosition();
+
+    jclass structClass = env->FindClass("com/audioplayback/models/StreamPosition");
+    jmethodID constructor = env->GetMethodID(structClass, "<init>", "(JJ)V");
+    return env->NewObject(structClass, constructor,
+                          static_cast<jlong>(position.framePosition),
+                          static_cast<jlong>(position.hostTimeNs));
+}
+
+// jsContext is the jsi::Runtime of the JS thread, this has to be called from that thread
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_audioplayback_AudioPlaybackModule_installJsiBindingsNative(JNIEnv *, jobject , jlong jsContext) {
+    auto *runtime = reinterpret_cast<facebook::jsi::Runtime *>(jsContext);
+    AudioPlaybackHostObject::install(*runtime, *audioEngine);
+}
+
+extern "C"
+JNIEXPORT jobject JNICALL
+Java_com_audioplayback_AudioPlaybackModule_getEngineStatsNative(JNIEnv *env, jobject ) {
+    auto stats = audioEngine->getEngineStats();
+
+    jclass structClass = env->FindClass("com/audioplayback/models/EngineStats");
+    jmethodID constructor = env->GetMethodID(structClass, "<init>", "(JDDDII[JJIJJJJJJJJJIJJDDDIIIDDDJJ[J[I[I)V");
+
+    jlongArray jHistogram = env->NewLongArray(CallbackStats::kHistogramBucketCount);
+    std::array<jlong, CallbackStats::kHistogramBucketCount> histogram {};
+    std::copy(stats.callback.loadHistogram.begin(), stats.callback.loadHistogram.end(), histogram.begin());
+    env->SetLongArrayRegion(jHistogram, 0, CallbackStats::kHistogramBucketCount, histogram.data());
+
+    // The buffer size history is passed as one array per field
+    const auto &history = stats.latency.bufferSizeHistory;
+    const auto historySize = static_cast<jsize>(history.size());
+    std::vector<jlong> historyFramePositions(history.size());
+    std::vector<jint> historyBufferSizes(history.size());
+    std::vector<jint> historyXRunCounts(history.size());
+    for (size_t i = 0; i < history.size(); ++i) {
+        historyFramePositions[i] = history[i].framePosition;
+        historyBufferSizes[i] = history[i].bufferSizeFrames;
+        historyXRunCounts[i] = history[i].xRunCount;
+    }
+    jlongArray jHistoryFramePositions = env->NewLongArray(historySize);
+    env->SetLongArrayRegion(jHistoryFramePositions, 0, historySize, historyFramePositions.data());
+    jintArray jHistoryBufferSizes = env->NewIntArray(historySize);
+    env->SetIntArrayRegion(jHistoryBufferSizes, 0, historySize, historyBufferSizes.data());
+    jintArray jHistoryXRunCounts = env->NewIntArray(historySize);
+    env->SetIntArrayRegion(jHistoryXRunCounts, 0, historySize, historyXRunCounts.data());
+
+    jobject returnValue = env->NewObject(
+            structClass, constructor,
+            static_cast<jlong>(stats.callback.callbackCount),
+            stats.callback.lastDurationUs,
+            stats.callback.maxDurationUs,
+            stats.callback.averageDurationUs,
+            stats.callback.lastFrameCount,
+            stats.callback.lastActivePlayerCount,
+            jHistogram,
+            static_cast<jlong>(stats.callback.overrunCount),
+            stats.xRunCount,
+            static_cast<jlong>(stats.reclamation.pendingCount),
+            static_cast<jlong>(stats.reclamation.retiredCount),
+            static_cast<jlong>(stats.pcmCache.hitCount),
+            static_cast<jlong>(stats.pcmCache.missCount),
+            static_cast<jlong>(stats.pcmCache.bytesSaved),
+            static_cast<jlong>(stats.memory.heapBytes),
+            static_cast<jlong>(stats.memory.mappedBytes),
+            static_cast<jlong>(stats.memoryBudget.budgetBytes),
+            static_cast<jlong>(stats.memoryBudget.residentBytes),
+            stats.memoryBudget.evictedSoundCount,
+            static_cast<jlong>(stats.memoryBudget.evictionCount),
+            static_cast<jlong>(stats.memoryBudget.reloadCount),
+            stats.memoryBudget.lastReloadDurationMs,
+            stats.memoryBudget.maxReloadDurationMs,
+            stats.limiterGainReductionDb,
+            stats.latency.bufferSizeFrames,
+            stats.latency.framesPerBurst,
+            stats.latency.bufferCapacityFrames,
+            stats.latency.bufferLatencyMs,
+            stats.latency.outputLatencyMs,
+            stats.latency.limiterLatencyMs,
+            static_cast<jlong>(stats.latency.bufferSizeIncreaseCount),
+            static_cast<jlong>(stats.latency.bufferSizeDecreaseCount),
+            jHistoryFramePositions,
+            jHistoryBufferSizes,
+            jHistoryXRunCounts);
+
+    env->DeleteLocalRef(jHistogram);
+    env->DeleteLocalRef(jHistoryFramePositions);
+    env->DeleteLocalRef(jHistoryBufferSizes);
+    env->DeleteLocalRef(jHistoryXRunCounts);
+    return returnValue;
+}
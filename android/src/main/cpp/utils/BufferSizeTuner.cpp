@@ -0,0 +1,102 @@
+#include "BufferSizeTuner.h"
+
+#include <algorithm>
+#include <cmath>
+
+BufferSizeTuner::BufferSizeTuner(size_t historyCapacity)
+    : mHistory(historyCapacity) {
+}
+
+void BufferSizeTuner::configure(int32_t framesPerBurst, int32_t capacityFrames, int32_t sampleRate) {
+    mFramesPerBurst = std::max(framesPerBurst, 1);
+    mCapacityFrames = std::max(capacityFrames, mFramesPerBurst);
+    mSampleRate = sampleRate;
+    // The next stream starts over from a single burst
+    mIsRunning = false;
+    mLastRecordedSize = 0;
+}
+
+void BufferSizeTuner::setOptions(const BufferSizeTunerOptions &options) {
+    mAggressiveness.store(static_cast<float>(std::clamp(options.aggressiveness, 0.0, 1.0)), std::memory_order_relaxed);
+    mMaxLatencyMs.store(static_cast<float>(std::max(options.maxLatencyMs, 0.0)), std::memory_order_relaxed);
+    mEnabled.store(options.enabled, std::memory_order_relaxed);
+}
+
+int32_t BufferSizeTuner::getMaxBufferSize() const {
+    const float maxLatencyMs = mMaxLatencyMs.load(std::memory_order_relaxed);
+    if(maxLatencyMs <= 0) {
+        return mCapacityFrames;
+    }
+    const auto maxFrames = static_cast<int32_t>(maxLatencyMs * static_cast<float>(mSampleRate) / 1000.0f);
+    return std::clamp(maxFrames, mFramesPerBurst, mCapacityFrames);
+}
+
+int32_t BufferSizeTuner::update(int32_t xRunCount, int32_t numFrames, int32_t currentSize) {
+    if(xRunCount < 0 || mFramesPerBurst == 0 || !mEnabled.load(std::memory_order_relaxed)) {
+        // Starts over from a single burst when enabled again
+        mIsRunning = false;
+        return currentSize;
+    }
+
+    const int32_t maxSize = getMaxBufferSize();
+    if(!mIsRunning) {
+        mIsRunning = true;
+        mLastXRunCount = xRunCount;
+        mCleanFrames = 0;
+        mBackoff = 0;
+        mIsShrinkPending = false;
+        return mFramesPerBurst;
+    }
+
+    const float aggressiveness = mAggressiveness.load(std::memory_order_relaxed);
+    const int32_t newXRuns = xRunCount - mLastXRunCount;
+    mLastXRunCount = xRunCount;
+
+    if(newXRuns > 0) {
+        mCleanFrames = 0;
+        if(mIsShrinkPending) {
+            // The last shrink went too far, wait longer before trying again
+            mBackoff = std::min(mBackoff + 1, kMaxBackoff);
+            mIsShrinkPending = false;
+        }
+        const int32_t burstsPerXRun = aggressiveness >= 0.5f ? 1 : 2;
+        const int32_t growth = std::min(newXRuns * burstsPerXRun, kMaxGrowthBursts) * mFramesPerBurst;
+        return std::min(currentSize + growth, maxSize);
+    }
+
+    if(currentSize > maxSize) {
+        // The ceiling was lowered
+        return maxSize;
+    }
+
+    mCleanFrames += numFrames;
+    const auto intervalMs = static_cast<int64_t>(std::lround(
+            kCautiousShrinkIntervalMs + (kAggressiveShrinkIntervalMs - kCautiousShrinkIntervalMs) * aggressiveness));
+    const int64_t intervalFrames = (intervalMs * mSampleRate / 1000) << mBackoff;
+    if(mCleanFrames < intervalFrames) {
+        return currentSize;
+    }
+
+    mCleanFrames = 0;
+    if(mIsShrinkPending) {
+        // The previous shrink held for a whole interval
+        mBackoff = std::max(mBackoff - 1, 0);
+    }
+    if(currentSize <= mFramesPerBurst) {
+        mIsShrinkPending = false;
+        return currentSize;
+    }
+    mIsShrinkPending = true;
+    return std::max(currentSize - mFramesPerBurst, mFramesPerBurst);
+}
+
+void BufferSizeTuner::recordChange(int32_t bufferSizeFrames, int64_t framePosition, int32_t xRunCount) {
+    if(bufferSizeFrames == mLastRecordedSize) return;
+
+    if(mLastRecordedSize != 0) {
+        auto &counter = bufferSizeFrames > mLastRecordedSize ? mIncreaseCount : mDecreaseCount;
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    mLastRecordedSize = bufferSizeFrames;
+    mHistory.push({.framePosition = framePosition, .bufferSizeFrames = bufferSizeFrames, .xRunCount = xRunCount});
+}
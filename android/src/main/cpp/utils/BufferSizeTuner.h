@@ -0,0 +1,94 @@
+#ifndef AUDIOPLAYBACK_BUFFERSIZETUNER_H
+#define AUDIOPLAYBACK_BUFFERSIZETUNER_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "SpscQueue.h"
+
+struct BufferSizeChange {
+    // Renderer frame position of the callback that changed the size
+    int64_t framePosition;
+    int32_t bufferSizeFrames;
+    // The stream's XRun count at that time
+    int32_t xRunCount;
+};
+
+struct BufferSizeTunerOptions {
+    bool enabled;
+    // From 0 to 1. Higher values shrink the buffer again sooner after underruns stop and grow it
+    // by less when they happen, favouring latency over safety.
+    double aggressiveness;
+    // Largest buffer the tuner sets, in milliseconds. 0 allows the whole capacity of the stream.
+    double maxLatencyMs;
+};
+
+/**
+ * Adapts the buffer size of a stream to the underruns it reports, like oboe::LatencyTuner but in
+ * both directions. It starts at a single burst, grows by whole bursts whenever the XRun count goes
+ * up and gives a burst back after every stretch of clean playback. A shrink that is followed by an
+ * underrun doubles the stretch needed for the next one, so a device settles on the smallest size
+ * it can sustain instead of oscillating around it.
+ *
+ * Enabled by default. configure() is called while no callback is running. update() and
+ * recordChange() are called by the audio thread only and never block or allocate, the options can
+ * be set from any thread.
+ */
+class BufferSizeTuner {
+public:
+    explicit BufferSizeTuner(size_t historyCapacity);
+
+    void configure(int32_t framesPerBurst, int32_t capacityFrames, int32_t sampleRate);
+    void setOptions(const BufferSizeTunerOptions &options);
+
+    /**
+     * Decide the buffer size after a callback of numFrames.
+     *
+     * @param xRunCount what the stream reports, the tuner does nothing while it is negative
+     * @return the size to set, currentSize when it should stay as it is
+     */
+    int32_t update(int32_t xRunCount, int32_t numFrames, int32_t currentSize);
+    // The stream may round the requested size, so the tuner continues from what it actually set
+    void recordChange(int32_t bufferSizeFrames, int64_t framePosition, int32_t xRunCount);
+
+    // Changes since the last call, oldest first. Changes made while nobody takes them are dropped
+    // once the history is full, they are still counted.
+    size_t takeHistory(BufferSizeChange *changes, size_t maxCount) { return mHistory.pop(changes, maxCount); }
+    [[nodiscard]] int64_t getIncreaseCount() const { return mIncreaseCount.load(std::memory_order_relaxed); }
+    [[nodiscard]] int64_t getDecreaseCount() const { return mDecreaseCount.load(std::memory_order_relaxed); }
+
+private:
+    // Clean playback needed before a shrink at aggressiveness 0 and 1
+    static constexpr int64_t kCautiousShrinkIntervalMs = 30000;
+    static constexpr int64_t kAggressiveShrinkIntervalMs = 2000;
+    // The shrink interval is doubled at most this many times
+    static constexpr int32_t kMaxBackoff = 5;
+    // Bursts added at once when many underruns were reported by a single callback
+    static constexpr int32_t kMaxGrowthBursts = 4;
+
+    int32_t getMaxBufferSize() const;
+
+    int32_t mFramesPerBurst = 0;
+    int32_t mCapacityFrames = 0;
+    int32_t mSampleRate = 0;
+
+    std::atomic<bool> mEnabled { true };
+    std::atomic<float> mAggressiveness { 0.5f };
+    std::atomic<float> mMaxLatencyMs { 0.0f };
+
+    // Audio thread state
+    bool mIsRunning = false;
+    int32_t mLastXRunCount = 0;
+    int64_t mCleanFrames = 0;
+    int32_t mBackoff = 0;
+    // Set by a shrink until either an underrun or the next shrink tells whether it held
+    bool mIsShrinkPending = false;
+
+    SpscQueue<BufferSizeChange> mHistory;
+    std::atomic<int64_t> mIncreaseCount { 0 };
+    std::atomic<int64_t> mDecreaseCount { 0 };
+    int32_t mLastRecordedSize = 0;
+};
+
+#endif //AUDIOPLAYBACK_BUFFERSIZETUNER_H
@@ -0,0 +1,39 @@
+#include "CallbackMonitor.h"
+
+#include <algorithm>
+
+void CallbackMonitor::record(int64_t durationNs, int32_t numFrames, int32_t sampleRate, int32_t activePlayerCount) {
+    increment(mCallbackCount);
+    increment(mTotalDurationNs, durationNs);
+    mLastDurationNs.store(durationNs, std::memory_order_relaxed);
+    if (durationNs > mMaxDurationNs.load(std::memory_order_relaxed)) {
+        mMaxDurationNs.store(durationNs, std::memory_order_relaxed);
+    }
+    mLastFrameCount.store(numFrames, std::memory_order_relaxed);
+    mLastActivePlayerCount.store(activePlayerCount, std::memory_order_relaxed);
+
+    if (numFrames > 0 && sampleRate > 0) {
+        const int64_t periodNs = static_cast<int64_t>(numFrames) * 1000000000 / sampleRate;
+        const int64_t bucket = periodNs > 0
+                ? std::min<int64_t>(durationNs * 10 / periodNs, CallbackStats::kHistogramBucketCount - 1)
+                : CallbackStats::kHistogramBucketCount - 1;
+        increment(mLoadHistogram[bucket]);
+    }
+}
+
+CallbackStats CallbackMonitor::getStats() const {
+    CallbackStats stats {};
+    stats.callbackCount = mCallbackCount.load(std::memory_order_relaxed);
+    stats.lastDurationUs = static_cast<double>(mLastDurationNs.load(std::memory_order_relaxed)) / 1000.0;
+    stats.maxDurationUs = static_cast<double>(mMaxDurationNs.load(std::memory_order_relaxed)) / 1000.0;
+    stats.averageDurationUs = stats.callbackCount > 0
+            ? static_cast<double>(mTotalDurationNs.load(std::memory_order_relaxed)) / 1000.0 / static_cast<double>(stats.callbackCount)
+            : 0.0;
+    stats.lastFrameCount = mLastFrameCount.load(std::memory_order_relaxed);
+    stats.lastActivePlayerCount = mLastActivePlayerCount.load(std::memory_order_relaxed);
+    for (int32_t i = 0; i < CallbackStats::kHistogramBucketCount; ++i) {
+        stats.loadHistogram[i] = mLoadHistogram[i].load(std::memory_order_relaxed);
+    }
+    stats.overrunCount = stats.loadHistogram[CallbackStats::kHistogramBucketCount - 1];
+    return stats;
+}
@@ -0,0 +1,51 @@
+#ifndef AUDIOPLAYBACK_CALLBACKMONITOR_H
+#define AUDIOPLAYBACK_CALLBACKMONITOR_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+struct CallbackStats {
+    static constexpr int32_t kHistogramBucketCount = 11;
+
+    int64_t callbackCount;
+    double lastDurationUs;
+    double maxDurationUs;
+    double averageDurationUs;
+    int32_t lastFrameCount;
+    int32_t lastActivePlayerCount;
+    // Bucket i counts callbacks that took between i * 10% and (i + 1) * 10% of the buffer period,
+    // the last bucket counts the ones that took longer than the whole period
+    std::array<int64_t, kHistogramBucketCount> loadHistogram;
+    int64_t overrunCount;
+};
+
+/**
+ * Records how long each audio callback took compared to the duration of the buffer it rendered.
+ *
+ * record() is called by the audio thread only and never blocks, the counters are atomics so that
+ * getStats() can read them from any thread. A snapshot is not guaranteed to be consistent across
+ * counters, which is fine for telemetry.
+ */
+class CallbackMonitor {
+public:
+    void record(int64_t durationNs, int32_t numFrames, int32_t sampleRate, int32_t activePlayerCount);
+
+    [[nodiscard]] CallbackStats getStats() const;
+
+private:
+    // Only written by the audio thread, so a relaxed load and store is enough to increment
+    static void increment(std::atomic<int64_t> &counter, int64_t value = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    std::atomic<int64_t> mCallbackCount { 0 };
+    std::atomic<int64_t> mTotalDurationNs { 0 };
+    std::atomic<int64_t> mLastDurationNs { 0 };
+    std::atomic<int64_t> mMaxDurationNs { 0 };
+    std::atomic<int32_t> mLastFrameCount { 0 };
+    std::atomic<int32_t> mLastActivePlayerCount { 0 };
+    std::array<std::atomic<int64_t>, CallbackStats::kHistogramBucketCount> mLoadHistogram {};
+};
+
+#endif //AUDIOPLAYBACK_CALLBACKMONITOR_H
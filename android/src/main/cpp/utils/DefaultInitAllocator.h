@@ -0,0 +1,40 @@
+#ifndef AUDIOPLAYBACK_DEFAULTINITALLOCATOR_H
+#define AUDIOPLAYBACK_DEFAULTINITALLOCATOR_H
+
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * std::allocator, except that elements created without a value are default initialized instead of
+ * value initialized. For trivial types that leaves them uninitialized, so resize() on a vector only
+ * allocates instead of also zeroing memory that is about to be overwritten.
+ */
+template<typename T>
+class DefaultInitAllocator : public std::allocator<T> {
+public:
+    template<typename U>
+    struct rebind {
+        using other = DefaultInitAllocator<U>;
+    };
+
+    using std::allocator<T>::allocator;
+
+    template<typename U>
+    void construct(U *pointer) noexcept(std::is_nothrow_default_constructible_v<U>) {
+        ::new(static_cast<void *>(pointer)) U;
+    }
+
+    template<typename U, typename... Args>
+    void construct(U *pointer, Args &&... args) {
+        ::new(static_cast<void *>(pointer)) U(std::forward<Args>(args)...);
+    }
+};
+
+// Bytes of samples in any SampleFormat, resized before every write into it
+using SampleBuffer = std::vector<uint8_t, DefaultInitAllocator<uint8_t>>;
+
+#endif //AUDIOPLAYBACK_DEFAULTINITALLOCATOR_H
@@ -0,0 +1,120 @@
+#ifndef AUDIOPLAYBACK_HANDLETABLE_H
+#define AUDIOPLAYBACK_HANDLETABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * Owns objects in a fixed number of slots and hands out integer handles to them.
+ *
+ * A handle packs the slot index in its low 16 bits and the slot's generation above it. Removing an
+ * object bumps the generation, so a stale handle never resolves to whatever reuses the slot.
+ * Lookups are O(1) and nothing allocates after construction. Handles are always positive, so 0 and
+ * negative values can be used as "no handle". Not thread safe.
+ */
+template<typename T>
+class HandleTable {
+public:
+    using Handle = int32_t;
+
+    explicit HandleTable(size_t capacity) : mSlots(capacity) {
+        mFreeSlots.reserve(capacity);
+        for (size_t i = capacity; i > 0; --i) {
+            mFreeSlots.push_back(static_cast<uint32_t>(i - 1));
+        }
+    }
+
+    /**
+     * @return the handle of the inserted object, or 0 if every slot is taken
+     */
+    Handle insert(std::unique_ptr<T> object) {
+        if (mFreeSlots.empty()) return 0;
+
+        const uint32_t index = mFreeSlots.back();
+        mFreeSlots.pop_back();
+
+        Slot &slot = mSlots[index];
+        slot.object = std::move(object);
+        mSize++;
+        return makeHandle(index, slot.generation);
+    }
+
+    // nullptr if the handle is stale or was never valid
+    T *get(Handle handle) {
+        const Slot *slot = findSlot(handle);
+        return slot ? slot->object.get() : nullptr;
+    }
+
+    // Gives up ownership of the object, nullptr if the handle is stale or was never valid
+    std::unique_ptr<T> remove(Handle handle) {
+        Slot *slot = findSlot(handle);
+        if (!slot) return nullptr;
+        return release(*slot, static_cast<uint32_t>(handle & kIndexMask));
+    }
+
+    // Gives up ownership of every object, calling callback(std::unique_ptr<T>) for each of them
+    template<typename Callback>
+    void removeAll(Callback callback) {
+        for (uint32_t index = 0; index < mSlots.size(); ++index) {
+            if (mSlots[index].object) {
+                callback(release(mSlots[index], index));
+            }
+        }
+    }
+
+    // Calls callback(Handle, T &) for every object, without giving up ownership
+    template<typename Callback>
+    void forEach(Callback callback) {
+        for (uint32_t index = 0; index < mSlots.size(); ++index) {
+            Slot &slot = mSlots[index];
+            if (slot.object) {
+                callback(makeHandle(index, slot.generation), *slot.object);
+            }
+        }
+    }
+
+    [[nodiscard]] size_t size() const { return mSize; }
+
+    // Slot a valid handle refers to, shared with every other handle of that slot
+    static size_t getIndex(Handle handle) { return static_cast<size_t>(handle & kIndexMask); }
+
+private:
+    static constexpr int32_t kIndexBits = 16;
+    static constexpr int32_t kIndexMask = (1 << kIndexBits) - 1;
+    // Keeps handles positive
+    static constexpr uint32_t kMaxGeneration = (1u << (31 - kIndexBits)) - 1;
+
+    struct Slot {
+        std::unique_ptr<T> object;
+        uint32_t generation = 1;
+    };
+
+    static Handle makeHandle(uint32_t index, uint32_t generation) {
+        return static_cast<Handle>((generation << kIndexBits) | index);
+    }
+
+    Slot *findSlot(Handle handle) {
+        if (handle <= 0) return nullptr;
+        const auto index = static_cast<uint32_t>(handle & kIndexMask);
+        const auto generation = static_cast<uint32_t>(handle) >> kIndexBits;
+        if (index >= mSlots.size()) return nullptr;
+
+        Slot &slot = mSlots[index];
+        return slot.object && slot.generation == generation ? &slot : nullptr;
+    }
+
+    std::unique_ptr<T> release(Slot &slot, uint32_t index) {
+        slot.generation = slot.generation == kMaxGeneration ? 1 : slot.generation + 1;
+        mFreeSlots.push_back(index);
+        mSize--;
+        return std::move(slot.object);
+    }
+
+    std::vector<Slot> mSlots;
+    std::vector<uint32_t> mFreeSlots;
+    size_t mSize = 0;
+};
+
+#endif //AUDIOPLAYBACK_HANDLETABLE_H
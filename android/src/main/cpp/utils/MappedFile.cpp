@@ -0,0 +1,55 @@
+#include "MappedFile.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef MAP_POPULATE
+#define MAP_POPULATE 0
+#endif
+
+OpenMappedFileResult MappedFile::open(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd == -1) {
+        return {.file = nullptr, .error = std::string("Failed to open file: ") + strerror(errno)};
+    }
+
+    struct stat fileStat {};
+    if(fstat(fd, &fileStat) == -1) {
+        auto error = std::string("Failed to get the file size: ") + strerror(errno);
+        close(fd);
+        return {.file = nullptr, .error = error};
+    }
+
+    auto result = map(fd, 0, static_cast<size_t>(fileStat.st_size));
+    close(fd);
+    return result;
+}
+
+OpenMappedFileResult MappedFile::map(int fd, int64_t offset, size_t length) {
+    if(length == 0) {
+        return {.file = nullptr, .error = "Failed to map file: the file is empty"};
+    }
+
+    const auto pageSize = static_cast<int64_t>(sysconf(_SC_PAGESIZE));
+    const int64_t mappingOffset = offset - offset % pageSize;
+    const auto delta = static_cast<size_t>(offset - mappingOffset);
+    const size_t mappingSize = length + delta;
+
+    void *mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED | MAP_POPULATE, fd, static_cast<off_t>(mappingOffset));
+    if(mapping == MAP_FAILED) {
+        return {.file = nullptr, .error = std::string("Failed to map file: ") + strerror(errno)};
+    }
+
+    return {
+            .file = std::unique_ptr<MappedFile>(new MappedFile(mapping, mappingSize, static_cast<const std::byte *>(mapping) + delta, length)),
+            .error = std::nullopt
+    };
+}
+
+MappedFile::~MappedFile() {
+    munmap(mMapping, mMappingSize);
+}
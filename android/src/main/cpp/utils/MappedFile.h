@@ -0,0 +1,49 @@
+#ifndef AUDIOPLAYBACK_MAPPEDFILE_H
+#define AUDIOPLAYBACK_MAPPEDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+class MappedFile;
+
+struct OpenMappedFileResult {
+    std::unique_ptr<MappedFile> file;
+    std::optional<std::string> error;
+};
+
+/**
+ * A file, or a range of one, mapped read-only into memory and unmapped on destruction. The
+ * mapping is shared, so other processes mapping the same file share its pages.
+ *
+ * The pages are populated when the file is opened so that the first read, which may happen on the
+ * audio thread, doesn't fault them in. Clean file pages can still be evicted under memory pressure.
+ */
+class MappedFile {
+public:
+    static OpenMappedFileResult open(const std::string &path);
+    // Map length bytes starting at offset, fd can be closed afterwards
+    static OpenMappedFileResult map(int fd, int64_t offset, size_t length);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    [[nodiscard]] const std::byte *getData() const { return mData; }
+    [[nodiscard]] size_t getSize() const { return mSize; }
+
+private:
+    MappedFile(void *mapping, size_t mappingSize, const std::byte *data, size_t size)
+            : mMapping(mapping), mMappingSize(mappingSize), mData(data), mSize(size) {}
+
+    // Mappings start on a page boundary, which the requested range usually doesn't
+    void *const mMapping;
+    const size_t mMappingSize;
+    const std::byte *const mData;
+    const size_t mSize;
+};
+
+#endif //AUDIOPLAYBACK_MAPPEDFILE_H
@@ -0,0 +1,55 @@
+#include "Reaper.h"
+
+Reaper::Reaper(size_t capacity)
+    : mQueue(capacity)
+    , mThread(&Reaper::run, this) {
+}
+
+Reaper::~Reaper() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mIsStopping = true;
+    }
+    mCondition.notify_one();
+    mThread.join();
+
+    // Whatever is left was retired after the last pass
+    reap();
+}
+
+ReclamationStats Reaper::getStats() const {
+    return {
+        .pendingCount = mPendingCount.load(std::memory_order_relaxed),
+        .retiredCount = mRetiredCount.load(std::memory_order_relaxed)
+    };
+}
+
+void Reaper::run() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    while(!mIsStopping) {
+        // Polling instead of being notified keeps retire() free of any locking
+        mCondition.wait_for(lock, kReapInterval, [this] { return mIsStopping; });
+
+        lock.unlock();
+        reap();
+        lock.lock();
+    }
+}
+
+void Reaper::reap() {
+    Garbage garbage {};
+    while(mDeferred || mQueue.pop(garbage)) {
+        if(mDeferred) {
+            garbage = *mDeferred;
+            mDeferred.reset();
+        }
+        // Checked after taking the object, whoever starts reading later only finds its successor
+        if(mReaderCount.load() > 0) {
+            mDeferred = garbage;
+            return;
+        }
+        garbage.deleter(garbage.object);
+        mPendingCount.fetch_sub(1, std::memory_order_relaxed);
+        mRetiredCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef AUDIOPLAYBACK_REAPER_H
+#define AUDIOPLAYBACK_REAPER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include "SpscQueue.h"
+
+struct ReclamationStats {
+    // Objects that were handed off for destruction but have not been freed yet
+    int64_t pendingCount;
+    // Objects freed by the reaper since it was created
+    int64_t retiredCount;
+};
+
+/**
+ * Frees objects on a background thread so that neither the audio thread nor the control threads
+ * pay for potentially large deallocations.
+ *
+ * The audio thread hands over objects it no longer references with retire(), which never blocks,
+ * allocates or frees. There must be a single thread retiring objects at a time.
+ *
+ * Threads that read retired objects without any lock, through pointers that are cleared before
+ * the objects are retired, hold a ReadGuard while they do. Nothing is freed while one is alive.
+ */
+class Reaper {
+public:
+    class ReadGuard {
+    public:
+        explicit ReadGuard(Reaper &reaper) : mReaper(reaper) { mReaper.mReaderCount.fetch_add(1); }
+        ~ReadGuard() { mReaper.mReaderCount.fetch_sub(1); }
+
+        ReadGuard(const ReadGuard &) = delete;
+        ReadGuard &operator=(const ReadGuard &) = delete;
+
+    private:
+        Reaper &mReaper;
+    };
+
+    explicit Reaper(size_t capacity);
+    ~Reaper();
+
+    Reaper(const Reaper &) = delete;
+    Reaper &operator=(const Reaper &) = delete;
+
+    /**
+     * Announce that count objects will be retired soon. Called from the control thread so that
+     * objects in flight are accounted for before the audio thread gets to them.
+     */
+    void expect(int64_t count) { mPendingCount.fetch_add(count, std::memory_order_relaxed); }
+
+    /**
+     * The queue is sized to the maximum number of objects that can be pending, so this only fails
+     * if a caller retired something it did not expect first.
+     *
+     * @return false if the queue is full, the object is not taken then and the caller still owns it
+     */
+    template<typename T>
+    [[nodiscard]] bool retire(T *object) {
+        return mQueue.push({object, [](void *garbage) { delete static_cast<T *>(garbage); }});
+    }
+
+    [[nodiscard]] ReclamationStats getStats() const;
+
+    // Nothing retired is freed until the guard is gone
+    [[nodiscard]] ReadGuard guardReads() { return ReadGuard(*this); }
+
+private:
+    static constexpr auto kReapInterval = std::chrono::milliseconds(50);
+
+    struct Garbage {
+        void *object;
+        void (*deleter)(void *);
+    };
+
+    void run();
+    void reap();
+
+    SpscQueue<Garbage> mQueue;
+    // Sequentially consistent, a reader counted after an object was taken can't reach it anymore
+    std::atomic<int32_t> mReaderCount { 0 };
+    // Taken from the queue while a reader was active, freed by a later pass
+    std::optional<Garbage> mDeferred;
+    std::atomic<int64_t> mPendingCount { 0 };
+    std::atomic<int64_t> mRetiredCount { 0 };
+
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    bool mIsStopping = false;
+    std::thread mThread;
+};
+
+#endif //AUDIOPLAYBACK_REAPER_H
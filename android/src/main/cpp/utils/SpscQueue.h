@@ -0,0 +1,132 @@
+#ifndef AUDIOPLAYBACK_SPSCQUEUE_H
+#define AUDIOPLAYBACK_SPSCQUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+/**
+ * Bounded, wait-free single-producer/single-consumer ring buffer.
+ *
+ * All storage is allocated up front so neither push nor pop ever allocates, which makes it safe
+ * to use from the audio callback. Callers that have more than one producer (or consumer) must
+ * serialize that side themselves.
+ */
+template<typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity)
+        : mCapacity(roundUpToPowerOfTwo(capacity))
+        , mMask(mCapacity - 1)
+        , mBuffer(std::make_unique<T[]>(mCapacity))
+    {};
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    /**
+     * @return false if the queue is full, in which case the item is not enqueued
+     */
+    bool push(const T &item) {
+        const size_t writeIndex = mWriteIndex.load(std::memory_order_relaxed);
+        if (writeIndex - mReadIndex.load(std::memory_order_acquire) == mCapacity) {
+            return false;
+        }
+
+        mBuffer[writeIndex & mMask] = item;
+        mWriteIndex.store(writeIndex + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @return false if the queue is empty, in which case item is left untouched
+     */
+    bool pop(T &item) {
+        const size_t readIndex = mReadIndex.load(std::memory_order_relaxed);
+        if (readIndex == mWriteIndex.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        item = mBuffer[readIndex & mMask];
+        mReadIndex.store(readIndex + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Push as many of the given items as fit.
+     *
+     * @return the number of items enqueued
+     */
+    size_t push(const T *items, size_t count) {
+        const size_t writeIndex = mWriteIndex.load(std::memory_order_relaxed);
+        const size_t available = mCapacity - (writeIndex - mReadIndex.load(std::memory_order_acquire));
+        const size_t toWrite = std::min(count, available);
+
+        // Copy in at most two contiguous runs, up to the end of the buffer and then from its start
+        const size_t start = writeIndex & mMask;
+        const size_t firstRun = std::min(toWrite, mCapacity - start);
+        std::copy(items, items + firstRun, mBuffer.get() + start);
+        std::copy(items + firstRun, items + toWrite, mBuffer.get());
+
+        mWriteIndex.store(writeIndex + toWrite, std::memory_order_release);
+        return toWrite;
+    }
+
+    /**
+     * Pop up to count items into the given array.
+     *
+     * @return the number of items dequeued
+     */
+    size_t pop(T *items, size_t count) {
+        const size_t readIndex = mReadIndex.load(std::memory_order_relaxed);
+        const size_t available = mWriteIndex.load(std::memory_order_acquire) - readIndex;
+        const size_t toRead = std::min(count, available);
+
+        const size_t start = readIndex & mMask;
+        const size_t firstRun = std::min(toRead, mCapacity - start);
+        std::copy(mBuffer.get() + start, mBuffer.get() + start + firstRun, items);
+        std::copy(mBuffer.get(), mBuffer.get() + (toRead - firstRun), items + firstRun);
+
+        mReadIndex.store(readIndex + toRead, std::memory_order_release);
+        return toRead;
+    }
+
+    /**
+     * Drop up to count items from the consumer side without copying them.
+     *
+     * @return the number of items dropped
+     */
+    size_t skip(size_t count) {
+        const size_t readIndex = mReadIndex.load(std::memory_order_relaxed);
+        const size_t available = mWriteIndex.load(std::memory_order_acquire) - readIndex;
+        const size_t toSkip = std::min(count, available);
+
+        mReadIndex.store(readIndex + toSkip, std::memory_order_release);
+        return toSkip;
+    }
+
+    [[nodiscard]] size_t size() const {
+        return mWriteIndex.load(std::memory_order_acquire) - mReadIndex.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] bool empty() const { return size() == 0; }
+    [[nodiscard]] size_t capacity() const { return mCapacity; }
+
+private:
+    static size_t roundUpToPowerOfTwo(size_t value) {
+        size_t result = 1;
+        while (result < value) result <<= 1;
+        return result;
+    }
+
+    const size_t mCapacity;
+    const size_t mMask;
+    const std::unique_ptr<T[]> mBuffer;
+
+    // Keep the indices on separate cache lines so the producer and consumer don't false-share
+    alignas(64) std::atomic<size_t> mWriteIndex { 0 };
+    alignas(64) std::atomic<size_t> mReadIndex { 0 };
+};
+
+#endif //AUDIOPLAYBACK_SPSCQUEUE_H
@@ -0,0 +1,40 @@
+#ifndef AUDIOPLAYBACK_UNIQUEFD_H
+#define AUDIOPLAYBACK_UNIQUEFD_H
+
+#include <unistd.h>
+
+// Owns a file descriptor and closes it on destruction, -1 when empty
+class UniqueFd {
+public:
+    UniqueFd() = default;
+    explicit UniqueFd(int fd) : mFd(fd) {}
+    ~UniqueFd() { reset(); }
+
+    UniqueFd(UniqueFd &&other) noexcept : mFd(other.release()) {}
+    UniqueFd &operator=(UniqueFd &&other) noexcept {
+        if (this != &other) reset(other.release());
+        return *this;
+    }
+
+    UniqueFd(const UniqueFd &) = delete;
+    UniqueFd &operator=(const UniqueFd &) = delete;
+
+    [[nodiscard]] int get() const { return mFd; }
+    [[nodiscard]] bool isValid() const { return mFd >= 0; }
+
+    int release() {
+        const int fd = mFd;
+        mFd = -1;
+        return fd;
+    }
+
+    void reset(int fd = -1) {
+        if (mFd >= 0) close(mFd);
+        mFd = fd;
+    }
+
+private:
+    int mFd = -1;
+};
+
+#endif //AUDIOPLAYBACK_UNIQUEFD_H
@@ -0,0 +1,48 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+WorkerPool::WorkerPool(size_t maxThreadCount) {
+    const size_t cores = std::max(std::thread::hardware_concurrency(), 1u);
+    const size_t threadCount = std::max<size_t>(std::min(maxThreadCount, cores), 1);
+
+    mThreads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        mThreads.emplace_back(&WorkerPool::run, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mIsStopping = true;
+        mJobs.clear();
+    }
+    mCondition.notify_all();
+    for (auto &thread: mThreads) {
+        thread.join();
+    }
+}
+
+void WorkerPool::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mJobs.push_back(std::move(job));
+    }
+    mCondition.notify_one();
+}
+
+void WorkerPool::run() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true) {
+        mCondition.wait(lock, [this] { return mIsStopping || !mJobs.empty(); });
+        if (mIsStopping) return;
+
+        auto job = std::move(mJobs.front());
+        mJobs.pop_front();
+
+        lock.unlock();
+        job();
+        lock.lock();
+    }
+}
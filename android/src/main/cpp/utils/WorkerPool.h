@@ -0,0 +1,40 @@
+#ifndef AUDIOPLAYBACK_WORKERPOOL_H
+#define AUDIOPLAYBACK_WORKERPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A fixed number of threads running submitted jobs in order of submission.
+ *
+ * Used for work that is too slow for the calling thread, like decoding sounds. Jobs that have not
+ * started yet when the pool is destroyed are dropped.
+ */
+class WorkerPool {
+public:
+    // At least one thread, and no more than there are cores
+    explicit WorkerPool(size_t maxThreadCount);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    void submit(std::function<void()> job);
+
+    [[nodiscard]] size_t getThreadCount() const { return mThreads.size(); }
+
+private:
+    void run();
+
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::deque<std::function<void()>> mJobs;
+    bool mIsStopping = false;
+    std::vector<std::thread> mThreads;
+};
+
+#endif //AUDIOPLAYBACK_WORKERPOOL_H
@@ -5,14 +5,27 @@
 #ifndef AUDIOPLAYBACK_LOGGING_H
 #define AUDIOPLAYBACK_LOGGING_H
 
-#include <android/log.h>
 #include <vector>
 
 #define LIB_NAME "react-native-audio-playback"
+
+#ifdef __ANDROID__
+#include <android/log.h>
+
 #define LOGD(...) ((void)__android_log_print(ANDROID_LOG_DEBUG, LIB_NAME, __VA_ARGS__))
 #define LOGI(...) ((void)__android_log_print(ANDROID_LOG_INFO, LIB_NAME, __VA_ARGS__))
 #define LOGW(...) ((void)__android_log_print(ANDROID_LOG_WARN, LIB_NAME, __VA_ARGS__))
 #define LOGE(...) ((void)__android_log_print(ANDROID_LOG_ERROR, LIB_NAME, __VA_ARGS__))
+#else
+// Host builds of the engine core (see OfflineRenderer) log to stderr instead
+#include <cstdio>
+
+#define LOG_TO_STDERR(level, ...) ((void)(fprintf(stderr, level " " LIB_NAME ": " __VA_ARGS__), fputc('\n', stderr)))
+#define LOGD(...) LOG_TO_STDERR("D", __VA_ARGS__)
+#define LOGI(...) LOG_TO_STDERR("I", __VA_ARGS__)
+#define LOGW(...) LOG_TO_STDERR("W", __VA_ARGS__)
+#define LOGE(...) LOG_TO_STDERR("E", __VA_ARGS__)
+#endif
 
 
 #endif //AUDIOPLAYBACK_LOGGING_H
@@ -2,6 +2,8 @@ package com.audioplayback
 
 import android.net.Uri
 import com.audioplayback.models.CloseAudioStreamResult
+import com.audioplayback.models.ReconfigureStreamResult
+import com.audioplayback.models.EngineStats
 import com.facebook.react.bridge.Promise
 import com.facebook.react.bridge.ReactApplicationContext
 import com.facebook.react.bridge.ReactMethod
@@ -12,19 +14,36 @@ import com.audioplayback.models.LoadSoundResult
 import com.audioplayback.models.OpenAudioStreamResult
 import com.audioplayback.models.PauseAudioStreamResult
 import com.audioplayback.models.SetupAudioStreamResult
+import com.audioplayback.models.StreamPosition
 import com.facebook.react.bridge.Arguments
 import com.facebook.react.bridge.ReadableMap
+import com.facebook.react.bridge.WritableArray
 import com.facebook.react.bridge.WritableMap
+import com.facebook.react.modules.core.DeviceEventManagerModule
 import kotlinx.coroutines.CoroutineScope
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.launch
 import kotlinx.coroutines.withContext
+import java.io.File
 import java.net.URL
+import java.util.concurrent.ConcurrentHashMap
 
 
 class AudioPlaybackModule internal constructor(context: ReactApplicationContext) :
   AudioPlaybackSpec(context) {
 
+  // Pending loadSounds calls, resolved once the engine is done with them
+  private val loadSoundsPromises = ConcurrentHashMap<Int, Promise>()
+
+  init {
+    // Decoded sounds are kept across launches, the system clears them when it needs the space
+    val decodedCacheDirectory = File(context.cacheDir, DECODED_CACHE_DIRECTORY)
+    if (decodedCacheDirectory.isDirectory || decodedCacheDirectory.mkdirs()) {
+      setDecodedCacheDirectoryNative(decodedCacheDirectory.absolutePath)
+    }
+    setPlaybackEventsListenerNative()
+  }
+
   override fun getName(): String {
     return NAME
   }
@@ -67,46 +86,224 @@ class AudioPlaybackModule internal constructor(context: ReactApplicationContext)
   }
 
 
+  @ReactMethod
+  override fun reconfigureStream(sampleRate: Double, channelCount: Double, promise: Promise) {
+    // Converting every loaded sound takes a while, the old stream keeps playing meanwhile
+    CoroutineScope(Dispatchers.IO).launch {
+      val result = reconfigureStreamNative(sampleRate, channelCount)
+      val map = Arguments.createMap()
+      result.error?.let { map.putString("error", it) } ?: map.putNull("error")
+      val unloadedSoundIds = Arguments.createArray()
+      result.unloadedSoundIds.forEach { unloadedSoundIds.pushInt(it) }
+      map.putArray("unloadedSoundIds", unloadedSoundIds)
+      promise.resolve(map)
+    }
+  }
+
   @ReactMethod
   override fun loopSounds(arg: ReadableArray) {
-    val (ids, values) = readableArrayToStringBooleanArray(arg)
+    val (ids, values) = readableArrayToIntBooleanArray(arg)
     loopSoundsNative(ids, values)
   }
 
   @ReactMethod
   override fun playSounds(arg: ReadableArray) {
-    val (ids, values) = readableArrayToStringBooleanArray(arg)
+    val (ids, values) = readableArrayToIntBooleanArray(arg)
     playSoundsNative(ids, values)
   }
 
   @ReactMethod
   override fun seekSoundsTo(arg: ReadableArray) {
-    val (ids, doubles) = readableArrayToStringDoubleArray(arg)
+    val (ids, doubles) = readableArrayToIntDoubleArray(arg)
     seekSoundsToNative(ids, doubles)
   }
 
   @ReactMethod
   override fun setSoundsVolume(arg: ReadableArray) {
-    val (ids, doubles) = readableArrayToStringDoubleArray(arg)
+    val (ids, doubles) = readableArrayToIntDoubleArray(arg)
     setSoundsVolumeNative(ids, doubles)
   }
 
+  @ReactMethod
+  override fun triggerSounds(arg: ReadableArray) {
+    val size = arg.size()
+    val ids = IntArray(size)
+    val volumes = DoubleArray(size)
+    val pans = DoubleArray(size)
+    val playbackRates = DoubleArray(size) { 1.0 }
+
+    for (i in 0 until size) {
+      val request = arg.getMap(i) ?: continue
+      ids[i] = request.getInt("id")
+      volumes[i] = request.getDouble("volume")
+      pans[i] = request.getDouble("pan")
+      playbackRates[i] = request.getDouble("playbackRate")
+    }
+
+    triggerSoundsNative(ids, volumes, pans, playbackRates)
+  }
+
+  @ReactMethod
+  override fun setSoundsPan(arg: ReadableArray) {
+    val (ids, doubles) = readableArrayToIntDoubleArray(arg)
+    setSoundsPanNative(ids, doubles)
+  }
+
+  @ReactMethod
+  override fun setSoundsPlaybackRate(arg: ReadableArray) {
+    val (ids, doubles) = readableArrayToIntDoubleArray(arg)
+    setSoundsPlaybackRateNative(ids, doubles)
+  }
+
+  @ReactMethod
+  override fun fadeSounds(arg: ReadableArray) {
+    val size = arg.size()
+    val ids = IntArray(size)
+    val targetVolumes = DoubleArray(size)
+    val durationsMs = IntArray(size)
+    val stopAtEnd = BooleanArray(size)
+    val curves = IntArray(size)
+
+    for (i in 0 until size) {
+      val request = arg.getMap(i) ?: continue
+      ids[i] = request.getInt("id")
+      targetVolumes[i] = request.getDouble("targetVolume")
+      durationsMs[i] = request.getInt("durationMs")
+      stopAtEnd[i] = request.getBoolean("stopAtEnd")
+      curves[i] = request.getInt("curve")
+    }
+
+    fadeSoundsNative(ids, targetVolumes, durationsMs, stopAtEnd, curves)
+  }
+
+  @ReactMethod
+  override fun setSoundsMarkers(arg: ReadableArray) {
+    val size = arg.size()
+    val ids = IntArray(size)
+    val markerCounts = IntArray(size)
+    val markers = ArrayList<Double>()
+
+    for (i in 0 until size) {
+      val pair = arg.getArray(i) ?: continue
+      val times = pair.getArray(1) ?: continue
+      ids[i] = pair.getInt(0)
+      markerCounts[i] = times.size()
+      for (j in 0 until times.size()) {
+        markers.add(times.getDouble(j))
+      }
+    }
+
+    setSoundsMarkersNative(ids, markerCounts, markers.toDoubleArray())
+  }
+
+  @ReactMethod(isBlockingSynchronousMethod = true)
+  override fun getSoundsPosition(ids: ReadableArray): WritableArray {
+    val positions = getSoundsPositionNative(IntArray(ids.size()) { ids.getInt(it) })
+    val array = Arguments.createArray()
+    positions.forEach { array.pushDouble(it) }
+    return array
+  }
+
+  @ReactMethod
+  override fun setSoundsBus(arg: ReadableArray) {
+    val size = arg.size()
+    val ids = IntArray(size)
+    val buses = Array(size) { "" }
+
+    for (i in 0 until size) {
+      val pair = arg.getArray(i) ?: continue
+      ids[i] = pair.getInt(0)
+      buses[i] = pair.getString(1) ?: ""
+    }
+
+    setSoundsBusNative(ids, buses)
+  }
+
+  @ReactMethod
+  override fun setBusesGain(arg: ReadableArray) {
+    val size = arg.size()
+    val buses = Array(size) { "" }
+    val gains = DoubleArray(size)
+
+    for (i in 0 until size) {
+      val pair = arg.getArray(i) ?: continue
+      buses[i] = pair.getString(0) ?: ""
+      gains[i] = pair.getDouble(1)
+    }
+
+    setBusesGainNative(buses, gains)
+  }
+
+  @ReactMethod
+  override fun setBusesMuted(arg: ReadableArray) {
+    val size = arg.size()
+    val buses = Array(size) { "" }
+    val muted = BooleanArray(size)
+
+    for (i in 0 until size) {
+      val pair = arg.getArray(i) ?: continue
+      buses[i] = pair.getString(0) ?: ""
+      muted[i] = pair.getBoolean(1)
+    }
+
+    setBusesMutedNative(buses, muted)
+  }
+
+  @ReactMethod
+  override fun setLimiterEnabled(enabled: Boolean) {
+    setLimiterEnabledNative(enabled)
+  }
 
   @ReactMethod
-  override fun unloadSound(id: String) {
-    unloadSoundsNative(arrayOf(id))
+  override fun setLatencyTuning(enabled: Boolean, aggressiveness: Double, maxLatencyMs: Double) {
+    setLatencyTuningNative(enabled, aggressiveness, maxLatencyMs)
   }
 
   @ReactMethod
-  override fun loadSound(uri: String, promise: Promise) {
+  override fun scheduleSounds(arg: ReadableArray) {
+    val size = arg.size()
+    val ids = IntArray(size)
+    val values = BooleanArray(size)
+    // -1 marks the time a request doesn't use
+    val frames = LongArray(size) { -1 }
+    val hostTimesNs = LongArray(size) { -1 }
+
+    for (i in 0 until size) {
+      val request = arg.getMap(i) ?: continue
+      ids[i] = request.getInt("id")
+      values[i] = request.getBoolean("play")
+      if (request.hasKey("atFrame") && !request.isNull("atFrame")) {
+        frames[i] = request.getDouble("atFrame").toLong()
+      } else if (request.hasKey("atHostTimeNs") && !request.isNull("atHostTimeNs")) {
+        hostTimesNs[i] = request.getDouble("atHostTimeNs").toLong()
+      }
+    }
+
+    scheduleSoundsNative(ids, values, frames, hostTimesNs)
+  }
+
+
+  @ReactMethod
+  override fun unloadSound(id: Double) {
+    unloadSoundsNative(intArrayOf(id.toInt()))
+  }
+
+  @ReactMethod
+  override fun loadSound(uri: String, options: ReadableMap, promise: Promise) {
     val map = Arguments.createMap()
+    val streaming = options.getBoolean("streaming")
+    val readAheadMs = options.getInt("readAheadMs")
+    val resamplerQuality = options.getInt("resamplerQuality")
+    val maxVoices = options.getInt("maxVoices")
+    val voiceStealing = options.getInt("voiceStealing")
+    val storageFormat = options.getInt("storageFormat")
 
     val scheme = Uri.parse(uri).scheme
     if( scheme == null) {
       val fileDescriptorProps = FileDescriptorProps.fromLocalResource(reactApplicationContext, uri)
-      val result = loadSoundNative(fileDescriptorProps.id, fileDescriptorProps.length, fileDescriptorProps.offset)
+      val result = loadSoundNative(fileDescriptorProps.id, fileDescriptorProps.length, fileDescriptorProps.offset, streaming, readAheadMs, resamplerQuality, maxVoices, voiceStealing, storageFormat)
       result.error?.let { map.putString("error", it) } ?: map.putNull("error")
-      result.id?.let { map.putString("id", it) } ?: map.putNull("id")
+      result.id?.let { map.putInt("id", it) } ?: map.putNull("id")
       promise.resolve(map)
     } else {
       CoroutineScope(Dispatchers.Main).launch {
@@ -118,9 +315,9 @@ class AudioPlaybackModule internal constructor(context: ReactApplicationContext)
             map.putString("error", "Failed to load sound file")
             map.putNull("id")
           } else {
-            val result = loadSoundNative(fileDescriptorProps.id, fileDescriptorProps.length, fileDescriptorProps.offset)
+            val result = loadSoundNative(fileDescriptorProps.id, fileDescriptorProps.length, fileDescriptorProps.offset, streaming, readAheadMs, resamplerQuality, maxVoices, voiceStealing, storageFormat)
             result.error?.let { map.putString("error", it) } ?: map.putNull("error")
-            result.id?.let { map.putString("id", it) } ?: map.putNull("id")
+            result.id?.let { map.putInt("id", it) } ?: map.putNull("id")
             promise.resolve(map)
           }
         }
@@ -128,15 +325,212 @@ class AudioPlaybackModule internal constructor(context: ReactApplicationContext)
     }
   }
 
+  @ReactMethod
+  override fun loadSounds(requestId: Double, sounds: ReadableArray, promise: Promise) {
+    val id = requestId.toInt()
+    loadSoundsPromises[id] = promise
+
+    CoroutineScope(Dispatchers.IO).launch {
+      val size = sounds.size()
+      val fds = IntArray(size) { -1 }
+      val lengths = IntArray(size)
+      val offsets = IntArray(size)
+      val streaming = BooleanArray(size)
+      val readAheadMs = IntArray(size)
+      val resamplerQuality = IntArray(size)
+      val maxVoices = IntArray(size)
+      val voiceStealing = IntArray(size)
+      val storageFormat = IntArray(size)
+
+      for (i in 0 until size) {
+        val sound = sounds.getMap(i) ?: continue
+        val uri = sound.getString("uri") ?: continue
+        val options = sound.getMap("options") ?: continue
+
+        // A file that can't be opened keeps its fd at -1 and is reported as failed by the engine
+        val fileDescriptorProps = try {
+          if (Uri.parse(uri).scheme == null) {
+            FileDescriptorProps.fromLocalResource(reactApplicationContext, uri)
+          } else {
+            FileDescriptorProps.getFileDescriptorPropsFromUrl(reactApplicationContext, URL(uri))
+          }
+        } catch (e: Exception) {
+          null
+        }
+
+        fileDescriptorProps?.let {
+          fds[i] = it.id
+          lengths[i] = it.length
+          offsets[i] = it.offset
+        }
+        streaming[i] = options.getBoolean("streaming")
+        readAheadMs[i] = options.getInt("readAheadMs")
+        resamplerQuality[i] = options.getInt("resamplerQuality")
+        maxVoices[i] = options.getInt("maxVoices")
+        voiceStealing[i] = options.getInt("voiceStealing")
+        storageFormat[i] = options.getInt("storageFormat")
+      }
+
+      loadSoundsNative(id, fds, lengths, offsets, streaming, readAheadMs, resamplerQuality, maxVoices, voiceStealing, storageFormat)
+    }
+  }
+
+  @ReactMethod
+  override fun cancelLoadSounds(requestId: Double) {
+    cancelLoadSoundsNative(requestId.toInt())
+  }
+
+  @ReactMethod
+  override fun setDecodedCacheOptions(maxBytes: Double, storeFloat: Boolean) {
+    setDecodedCacheOptionsNative(maxBytes.toLong(), storeFloat)
+  }
+
+  @ReactMethod
+  override fun setMemoryBudget(bytes: Double) {
+    setMemoryBudgetNative(bytes.toLong())
+  }
+
+  @ReactMethod
+  override fun prefetchSounds(ids: ReadableArray) {
+    prefetchSoundsNative(IntArray(ids.size()) { ids.getInt(it) })
+  }
+
+  @ReactMethod
+  override fun addListener(eventName: String) {
+    // Events are emitted regardless of listeners, required by NativeEventEmitter
+  }
+
+  @ReactMethod
+  override fun removeListeners(count: Double) {
+    // Events are emitted regardless of listeners, required by NativeEventEmitter
+  }
+
+  // Called from native decoding threads
+  @Suppress("unused")
+  private fun onLoadSoundsProgress(requestId: Int, index: Int, error: String?) {
+    val map = Arguments.createMap()
+    map.putInt("requestId", requestId)
+    map.putInt("index", index)
+    error?.let { map.putString("error", it) } ?: map.putNull("error")
+    reactApplicationContext
+      .getJSModule(DeviceEventManagerModule.RCTDeviceEventEmitter::class.java)
+      .emit(LOAD_SOUNDS_PROGRESS_EVENT, map)
+  }
+
+  // Called from native decoding threads
+  @Suppress("unused")
+  private fun onLoadSoundsComplete(requestId: Int, ids: IntArray, errors: Array<String?>) {
+    val promise = loadSoundsPromises.remove(requestId) ?: return
+    val results = Arguments.createArray()
+    for (i in ids.indices) {
+      val map = Arguments.createMap()
+      errors[i]?.let { map.putString("error", it) } ?: map.putNull("error")
+      if (errors[i] == null) map.putInt("id", ids[i]) else map.putNull("id")
+      results.pushMap(map)
+    }
+    promise.resolve(results)
+  }
+
+  // Called from the native event thread with a batch of events, see PlaybackEventType
+  @Suppress("unused")
+  private fun onPlaybackEvents(ids: IntArray, types: IntArray, markerIndices: IntArray, framePositions: LongArray) {
+    val events = Arguments.createArray()
+    for (i in ids.indices) {
+      val event = Arguments.createMap()
+      event.putInt("soundId", ids[i])
+      event.putString("type", PLAYBACK_EVENT_TYPES.getOrElse(types[i]) { "unknown" })
+      event.putInt("markerIndex", markerIndices[i])
+      event.putDouble("framePosition", framePositions[i].toDouble())
+      events.pushMap(event)
+    }
+    val map = Arguments.createMap()
+    map.putArray("events", events)
+    reactApplicationContext
+      .getJSModule(DeviceEventManagerModule.RCTDeviceEventEmitter::class.java)
+      .emit(PLAYBACK_EVENTS_EVENT, map)
+  }
+
   @ReactMethod(isBlockingSynchronousMethod = true)
   override fun getStreamState(): Double {
     return getStreamStateNative().toDouble()
   }
 
-  private fun readableArrayToStringBooleanArray(arg: ReadableArray): Pair<Array<String>, BooleanArray> {
+  // Runs on the JS thread, which is where the runtime has to be touched
+  @ReactMethod(isBlockingSynchronousMethod = true)
+  override fun installJsiBindings(): Boolean {
+    val jsContext = reactApplicationContext.javaScriptContextHolder?.get() ?: 0L
+    if (jsContext == 0L) {
+      return false
+    }
+    installJsiBindingsNative(jsContext)
+    return true
+  }
+
+  @ReactMethod(isBlockingSynchronousMethod = true)
+  override fun getStreamPosition(): WritableMap {
+    val position = getStreamPositionNative()
+    val map = Arguments.createMap()
+    map.putDouble("framePosition", position.framePosition.toDouble())
+    map.putDouble("hostTimeNs", position.hostTimeNs.toDouble())
+    return map
+  }
+
+  @ReactMethod(isBlockingSynchronousMethod = true)
+  override fun getEngineStats(): WritableMap {
+    val stats = getEngineStatsNative()
+    val histogram = Arguments.createArray()
+    stats.callbackLoadHistogram.forEach { histogram.pushDouble(it.toDouble()) }
+
+    val bufferSizeHistory = Arguments.createArray()
+    for (i in stats.bufferSizeHistorySizes.indices) {
+      val change = Arguments.createMap()
+      change.putDouble("framePosition", stats.bufferSizeHistoryFramePositions[i].toDouble())
+      change.putInt("bufferSizeFrames", stats.bufferSizeHistorySizes[i])
+      change.putInt("xRunCount", stats.bufferSizeHistoryXRunCounts[i])
+      bufferSizeHistory.pushMap(change)
+    }
+
+    val map = Arguments.createMap()
+    map.putDouble("callbackCount", stats.callbackCount.toDouble())
+    map.putDouble("lastCallbackDurationUs", stats.lastCallbackDurationUs)
+    map.putDouble("maxCallbackDurationUs", stats.maxCallbackDurationUs)
+    map.putDouble("averageCallbackDurationUs", stats.averageCallbackDurationUs)
+    map.putInt("lastFrameCount", stats.lastFrameCount)
+    map.putInt("activePlayerCount", stats.activePlayerCount)
+    map.putArray("callbackLoadHistogram", histogram)
+    map.putDouble("overrunCount", stats.overrunCount.toDouble())
+    map.putInt("xRunCount", stats.xRunCount)
+    map.putDouble("pendingReclamationCount", stats.pendingReclamationCount.toDouble())
+    map.putDouble("reclaimedCount", stats.reclaimedCount.toDouble())
+    map.putDouble("decodedCacheHitCount", stats.decodedCacheHitCount.toDouble())
+    map.putDouble("decodedCacheMissCount", stats.decodedCacheMissCount.toDouble())
+    map.putDouble("decodedCacheBytesSaved", stats.decodedCacheBytesSaved.toDouble())
+    map.putDouble("soundHeapBytes", stats.soundHeapBytes.toDouble())
+    map.putDouble("soundMappedBytes", stats.soundMappedBytes.toDouble())
+    map.putDouble("memoryBudgetBytes", stats.memoryBudgetBytes.toDouble())
+    map.putDouble("residentSoundBytes", stats.residentSoundBytes.toDouble())
+    map.putInt("evictedSoundCount", stats.evictedSoundCount)
+    map.putDouble("evictionCount", stats.evictionCount.toDouble())
+    map.putDouble("reloadCount", stats.reloadCount.toDouble())
+    map.putDouble("lastReloadDurationMs", stats.lastReloadDurationMs)
+    map.putDouble("maxReloadDurationMs", stats.maxReloadDurationMs)
+    map.putDouble("limiterGainReductionDb", stats.limiterGainReductionDb)
+    map.putInt("bufferSizeFrames", stats.bufferSizeFrames)
+    map.putInt("framesPerBurst", stats.framesPerBurst)
+    map.putInt("bufferCapacityFrames", stats.bufferCapacityFrames)
+    map.putDouble("bufferLatencyMs", stats.bufferLatencyMs)
+    map.putDouble("outputLatencyMs", stats.outputLatencyMs)
+    map.putDouble("limiterLatencyMs", stats.limiterLatencyMs)
+    map.putDouble("bufferSizeIncreaseCount", stats.bufferSizeIncreaseCount.toDouble())
+    map.putDouble("bufferSizeDecreaseCount", stats.bufferSizeDecreaseCount.toDouble())
+    map.putArray("bufferSizeHistory", bufferSizeHistory)
+    return map
+  }
+
+  private fun readableArrayToIntBooleanArray(arg: ReadableArray): Pair<IntArray, BooleanArray> {
     val size = arg.size()
     // Arrays to hold the results
-    val strings = Array(size) { "" }
+    val ids = IntArray(size)
     val bools = BooleanArray(size)
 
 
@@ -146,25 +540,25 @@ class AudioPlaybackModule internal constructor(context: ReactApplicationContext)
         // Get the nested array
         val nestedArray = arg.getArray(i)!! // Type was checked to be array so it is safe to use !!
 
-        // Extract id (String) and value (Boolean)
+        // Extract id (Int) and value (Boolean)
         if (nestedArray.size() == 2) {
-          val string = nestedArray.getString(0)!! // First element as String
+          val id = nestedArray.getInt(0) // First element as Int
           val bool = nestedArray.getBoolean(1) // Second element as Boolean
 
           // Add to the respective arrays
-          strings[i] = string
+          ids[i] = id
           bools[i] = bool
         }
       }
     }
 
-    return Pair(strings, bools)
+    return Pair(ids, bools)
   }
 
-  private fun readableArrayToStringDoubleArray(arg: ReadableArray): Pair<Array<String>, DoubleArray> {
+  private fun readableArrayToIntDoubleArray(arg: ReadableArray): Pair<IntArray, DoubleArray> {
     val size = arg.size()
     // Arrays to hold the results
-    val strings = Array(size) { "" }
+    val ids = IntArray(size)
     val bools = DoubleArray(size)
 
 
@@ -174,19 +568,19 @@ class AudioPlaybackModule internal constructor(context: ReactApplicationContext)
         // Get the nested array
         val nestedArray = arg.getArray(i)!! // Type was checked to be array so it is safe to use !!
 
-        // Extract id (String) and value (Boolean)
+        // Extract id (Int) and value (Double)
         if (nestedArray.size() == 2) {
-          val string = nestedArray.getString(0)!! // First element as String
-          val bool = nestedArray.getDouble(1) // Second element as Boolean
+          val id = nestedArray.getInt(0) // First element as Int
+          val bool = nestedArray.getDouble(1) // Second element as Double
 
           // Add to the respective arrays
-          strings[i] = string
+          ids[i] = id
           bools[i] = bool
         }
       }
     }
 
-    return Pair(strings, bools)
+    return Pair(ids, bools)
   }
 
   override fun invalidate() {
@@ -199,13 +593,36 @@ class AudioPlaybackModule internal constructor(context: ReactApplicationContext)
   private external fun openAudioStreamNative(): OpenAudioStreamResult
   private external fun pauseAudioStreamNative(): PauseAudioStreamResult
   private external fun closeAudioStreamNative(): CloseAudioStreamResult
-  private external fun playSoundsNative(ids: Array<String>, values: BooleanArray)
-  private external fun loopSoundsNative(ids: Array<String>, values: BooleanArray)
-  private external fun seekSoundsToNative(ids: Array<String>, values: DoubleArray)
-  private external fun setSoundsVolumeNative(ids: Array<String>, values: DoubleArray)
-  private external fun loadSoundNative(fd: Int, fileLength: Int, fileOffset: Int): LoadSoundResult
-  private external fun unloadSoundsNative(ids: Array<String>?)
+  private external fun reconfigureStreamNative(sampleRate: Double, channelCount: Double): ReconfigureStreamResult
+  private external fun playSoundsNative(ids: IntArray, values: BooleanArray)
+  private external fun loopSoundsNative(ids: IntArray, values: BooleanArray)
+  private external fun seekSoundsToNative(ids: IntArray, values: DoubleArray)
+  private external fun setSoundsVolumeNative(ids: IntArray, values: DoubleArray)
+  private external fun triggerSoundsNative(ids: IntArray, volumes: DoubleArray, pans: DoubleArray, playbackRates: DoubleArray)
+  private external fun setSoundsPanNative(ids: IntArray, values: DoubleArray)
+  private external fun setSoundsPlaybackRateNative(ids: IntArray, values: DoubleArray)
+  private external fun fadeSoundsNative(ids: IntArray, targetVolumes: DoubleArray, durationsMs: IntArray, stopAtEnd: BooleanArray, curves: IntArray)
+  private external fun setSoundsMarkersNative(ids: IntArray, markerCounts: IntArray, markers: DoubleArray)
+  private external fun getSoundsPositionNative(ids: IntArray): DoubleArray
+  private external fun setPlaybackEventsListenerNative()
+  private external fun setSoundsBusNative(ids: IntArray, buses: Array<String>)
+  private external fun setBusesGainNative(buses: Array<String>, gains: DoubleArray)
+  private external fun setBusesMutedNative(buses: Array<String>, muted: BooleanArray)
+  private external fun setLimiterEnabledNative(enabled: Boolean)
+  private external fun setLatencyTuningNative(enabled: Boolean, aggressiveness: Double, maxLatencyMs: Double)
+  private external fun scheduleSoundsNative(ids: IntArray, values: BooleanArray, frames: LongArray, hostTimesNs: LongArray)
+  private external fun loadSoundNative(fd: Int, fileLength: Int, fileOffset: Int, streaming: Boolean, readAheadMs: Int, resamplerQuality: Int, maxVoices: Int, voiceStealingPolicy: Int, storageFormat: Int): LoadSoundResult
+  private external fun unloadSoundsNative(ids: IntArray?)
+  private external fun loadSoundsNative(requestId: Int, fds: IntArray, fileLengths: IntArray, fileOffsets: IntArray, streaming: BooleanArray, readAheadMs: IntArray, resamplerQuality: IntArray, maxVoices: IntArray, voiceStealingPolicy: IntArray, storageFormat: IntArray)
+  private external fun cancelLoadSoundsNative(requestId: Int)
+  private external fun setDecodedCacheDirectoryNative(directory: String)
+  private external fun setDecodedCacheOptionsNative(maxBytes: Long, storeFloat: Boolean)
+  private external fun setMemoryBudgetNative(bytes: Long)
+  private external fun prefetchSoundsNative(ids: IntArray)
   private external fun getStreamStateNative(): Int
+  private external fun getStreamPositionNative(): StreamPosition
+  private external fun getEngineStatsNative(): EngineStats
+  private external fun installJsiBindingsNative(jsContext: Long)
 
   // Example method
   // See https://reactnative.dev/docs/native-modules-android
@@ -216,5 +633,10 @@ class AudioPlaybackModule internal constructor(context: ReactApplicationContext)
     }
     const val NAME = "AudioPlayback"
     const val LOG = "AudioPlaybackModule"
+    const val DECODED_CACHE_DIRECTORY = "audio-playback-decoded"
+    const val LOAD_SOUNDS_PROGRESS_EVENT = "AudioPlaybackLoadSoundsProgress"
+    const val PLAYBACK_EVENTS_EVENT = "AudioPlaybackPlaybackEvents"
+    // Indexed by the native PlaybackEventType
+    private val PLAYBACK_EVENT_TYPES = arrayOf("ended", "looped", "markerReached")
   }
 }
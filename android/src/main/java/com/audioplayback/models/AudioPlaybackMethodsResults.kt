@@ -4,4 +4,43 @@ data class SetupAudioStreamResult(val error: String?)
 data class OpenAudioStreamResult(val error: String?)
 data class PauseAudioStreamResult(val error: String?)
 data class CloseAudioStreamResult(val error: String?)
-data class LoadSoundResult(val error: String?, val id: String?)
+data class ReconfigureStreamResult(val error: String?, val unloadedSoundIds: IntArray)
+data class LoadSoundResult(val error: String?, val id: Int?)
+data class StreamPosition(val framePosition: Long, val hostTimeNs: Long)
+data class EngineStats(
+  val callbackCount: Long,
+  val lastCallbackDurationUs: Double,
+  val maxCallbackDurationUs: Double,
+  val averageCallbackDurationUs: Double,
+  val lastFrameCount: Int,
+  val activePlayerCount: Int,
+  val callbackLoadHistogram: LongArray,
+  val overrunCount: Long,
+  val xRunCount: Int,
+  val pendingReclamationCount: Long,
+  val reclaimedCount: Long,
+  val decodedCacheHitCount: Long,
+  val decodedCacheMissCount: Long,
+  val decodedCacheBytesSaved: Long,
+  val soundHeapBytes: Long,
+  val soundMappedBytes: Long,
+  val memoryBudgetBytes: Long,
+  val residentSoundBytes: Long,
+  val evictedSoundCount: Int,
+  val evictionCount: Long,
+  val reloadCount: Long,
+  val lastReloadDurationMs: Double,
+  val maxReloadDurationMs: Double,
+  val limiterGainReductionDb: Double,
+  val bufferSizeFrames: Int,
+  val framesPerBurst: Int,
+  val bufferCapacityFrames: Int,
+  val bufferLatencyMs: Double,
+  val outputLatencyMs: Double,
+  val limiterLatencyMs: Double,
+  val bufferSizeIncreaseCount: Long,
+  val bufferSizeDecreaseCount: Long,
+  val bufferSizeHistoryFramePositions: LongArray,
+  val bufferSizeHistorySizes: IntArray,
+  val bufferSizeHistoryXRunCounts: IntArray
+)
@@ -5,6 +5,7 @@ import com.facebook.react.bridge.ReactApplicationContext
 import com.facebook.react.bridge.ReactContextBaseJavaModule
 import com.facebook.react.bridge.ReadableArray
 import com.facebook.react.bridge.ReadableMap
+import com.facebook.react.bridge.WritableArray
 import com.facebook.react.bridge.WritableMap
 
 
@@ -19,6 +20,8 @@ abstract class AudioPlaybackSpec internal constructor(context: ReactApplicationC
 
   abstract fun closeAudioStream(): WritableMap
 
+  abstract fun reconfigureStream(sampleRate: Double, channelCount: Double, promise: Promise)
+
   abstract fun loopSounds(arg: ReadableArray)
 
   abstract fun playSounds(arg: ReadableArray)
@@ -27,9 +30,53 @@ abstract class AudioPlaybackSpec internal constructor(context: ReactApplicationC
 
   abstract fun setSoundsVolume(arg: ReadableArray)
 
-  abstract fun unloadSound(id: String)
+  abstract fun triggerSounds(arg: ReadableArray)
+
+  abstract fun setSoundsPan(arg: ReadableArray)
+
+  abstract fun setSoundsPlaybackRate(arg: ReadableArray)
+
+  abstract fun scheduleSounds(arg: ReadableArray)
+
+  abstract fun fadeSounds(arg: ReadableArray)
+
+  abstract fun setSoundsMarkers(arg: ReadableArray)
+
+  abstract fun getSoundsPosition(ids: ReadableArray): WritableArray
+
+  abstract fun setSoundsBus(arg: ReadableArray)
+
+  abstract fun setBusesGain(arg: ReadableArray)
+
+  abstract fun setBusesMuted(arg: ReadableArray)
+
+  abstract fun setLimiterEnabled(enabled: Boolean)
+
+  abstract fun setLatencyTuning(enabled: Boolean, aggressiveness: Double, maxLatencyMs: Double)
 
-  abstract fun loadSound(uri: String, promise: Promise)
+  abstract fun unloadSound(id: Double)
+
+  abstract fun loadSound(uri: String, options: ReadableMap, promise: Promise)
+
+  abstract fun loadSounds(requestId: Double, sounds: ReadableArray, promise: Promise)
+
+  abstract fun cancelLoadSounds(requestId: Double)
+
+  abstract fun setDecodedCacheOptions(maxBytes: Double, storeFloat: Boolean)
+
+  abstract fun setMemoryBudget(bytes: Double)
+
+  abstract fun prefetchSounds(ids: ReadableArray)
+
+  abstract fun addListener(eventName: String)
+
+  abstract fun removeListeners(count: Double)
 
   abstract fun getStreamState(): Double
+
+  abstract fun getStreamPosition(): WritableMap
+
+  abstract fun getEngineStats(): WritableMap
+
+  abstract fun installJsiBindings(): Boolean
 }
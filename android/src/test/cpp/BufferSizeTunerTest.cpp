@@ -0,0 +1,144 @@
+#include <cstdint>
+#include <vector>
+
+#include "utils/BufferSizeTuner.h"
+
+#include "TestUtils.h"
+
+/**
+ * Drives BufferSizeTuner with the XRun counts of a simulated stream and checks the sizes it picks:
+ * it grows by whole bursts on underruns, gives a burst back after each stretch of clean playback,
+ * waits longer after a shrink that didn't hold, and never goes past maxLatencyMs or the capacity.
+ */
+
+namespace {
+    constexpr int32_t kFramesPerBurst = 192;
+    constexpr int32_t kCapacityFrames = 16 * kFramesPerBurst;
+    constexpr int32_t kSampleRate = 48000;
+    // 2 s of clean playback at aggressiveness 1, in callbacks of a burst
+    constexpr int64_t kAggressiveShrinkCallbacks = 2 * kSampleRate / kFramesPerBurst;
+
+    struct SimulatedStream {
+        BufferSizeTuner tuner { 64 };
+        // What a fresh stream reports before the tuner sets anything
+        int32_t bufferSizeFrames = kCapacityFrames;
+        int32_t xRunCount = 0;
+        int64_t framePosition = 0;
+
+        explicit SimulatedStream(double aggressiveness, double maxLatencyMs = 0) {
+            tuner.configure(kFramesPerBurst, kCapacityFrames, kSampleRate);
+            tuner.setOptions({.enabled = true, .aggressiveness = aggressiveness, .maxLatencyMs = maxLatencyMs});
+            callback();
+        }
+
+        void callback(int32_t newXRuns = 0) {
+            xRunCount += newXRuns;
+            bufferSizeFrames = tuner.update(xRunCount, kFramesPerBurst, bufferSizeFrames);
+            tuner.recordChange(bufferSizeFrames, framePosition, xRunCount);
+            framePosition += kFramesPerBurst;
+        }
+
+        // Clean callbacks until the size changes, 0 if it doesn't within maxCallbacks
+        int64_t runUntilChange(int64_t maxCallbacks) {
+            const int32_t sizeBefore = bufferSizeFrames;
+            for (int64_t i = 1; i <= maxCallbacks; ++i) {
+                callback();
+                if (bufferSizeFrames != sizeBefore) return i;
+            }
+            return 0;
+        }
+    };
+
+    void testGrowsOnXRuns() {
+        SimulatedStream stream(0.5);
+        CHECK(stream.bufferSizeFrames == kFramesPerBurst);
+
+        stream.callback(1);
+        CHECK(stream.bufferSizeFrames == 2 * kFramesPerBurst);
+        // Clean callbacks right after don't change anything
+        stream.callback();
+        CHECK(stream.bufferSizeFrames == 2 * kFramesPerBurst);
+        // Many underruns in one callback grow by a few bursts at most
+        stream.callback(10);
+        CHECK(stream.bufferSizeFrames == 6 * kFramesPerBurst);
+
+        CHECK(stream.tuner.getIncreaseCount() == 2);
+        std::vector<BufferSizeChange> history(8);
+        history.resize(stream.tuner.takeHistory(history.data(), history.size()));
+        CHECK(history.size() == 3);
+        if (history.size() == 3) {
+            CHECK(history[0].bufferSizeFrames == kFramesPerBurst);
+            CHECK(history[2].bufferSizeFrames == 6 * kFramesPerBurst);
+            CHECK(history[2].xRunCount == 11);
+            CHECK(history[2].framePosition == 3 * kFramesPerBurst);
+        }
+
+        // Cautious tuning grows by two bursts per underrun
+        SimulatedStream cautious(0);
+        cautious.callback(1);
+        CHECK(cautious.bufferSizeFrames == 3 * kFramesPerBurst);
+    }
+
+    void testShrinksAfterCleanPlayback() {
+        SimulatedStream stream(1);
+        stream.callback(2);
+        CHECK(stream.bufferSizeFrames == 3 * kFramesPerBurst);
+
+        CHECK(stream.runUntilChange(10 * kAggressiveShrinkCallbacks) == kAggressiveShrinkCallbacks);
+        CHECK(stream.bufferSizeFrames == 2 * kFramesPerBurst);
+        CHECK(stream.runUntilChange(10 * kAggressiveShrinkCallbacks) == kAggressiveShrinkCallbacks);
+        CHECK(stream.bufferSizeFrames == kFramesPerBurst);
+        // Never below a single burst
+        CHECK(stream.runUntilChange(10 * kAggressiveShrinkCallbacks) == 0);
+        CHECK(stream.tuner.getDecreaseCount() == 2);
+
+        // Cautious tuning waits 30 s instead of 2 s
+        SimulatedStream cautious(0);
+        cautious.callback(1);
+        CHECK(cautious.runUntilChange(100 * kAggressiveShrinkCallbacks) == 15 * kAggressiveShrinkCallbacks);
+    }
+
+    void testBacksOffAfterFailedShrink() {
+        SimulatedStream stream(1);
+        stream.callback(2);
+        CHECK(stream.runUntilChange(10 * kAggressiveShrinkCallbacks) == kAggressiveShrinkCallbacks);
+
+        // The smaller size underruns, so it grows back and the next try waits twice as long
+        stream.callback(1);
+        CHECK(stream.bufferSizeFrames == 3 * kFramesPerBurst);
+        CHECK(stream.runUntilChange(10 * kAggressiveShrinkCallbacks) == 2 * kAggressiveShrinkCallbacks);
+        CHECK(stream.bufferSizeFrames == 2 * kFramesPerBurst);
+    }
+
+    void testStaysWithinMaxLatency() {
+        // 10 ms is 480 frames, between two and three bursts
+        SimulatedStream stream(0.5, 10);
+        stream.callback(10);
+        CHECK(stream.bufferSizeFrames == 480);
+        stream.callback(10);
+        CHECK(stream.bufferSizeFrames == 480);
+
+        // Lowering the ceiling takes effect on the next callback, even without underruns
+        stream.tuner.setOptions({.enabled = true, .aggressiveness = 0.5, .maxLatencyMs = 5});
+        stream.callback();
+        CHECK(stream.bufferSizeFrames == 240);
+
+        // Below a burst, the ceiling is a burst
+        SimulatedStream tiny(0.5, 1);
+        tiny.callback(10);
+        CHECK(tiny.bufferSizeFrames == kFramesPerBurst);
+
+        // Without a ceiling, the capacity of the stream is the limit
+        SimulatedStream unlimited(0.5);
+        for (int i = 0; i < 10; ++i) unlimited.callback(10);
+        CHECK(unlimited.bufferSizeFrames == kCapacityFrames);
+    }
+}
+
+int main() {
+    testGrowsOnXRuns();
+    testShrinksAfterCleanPlayback();
+    testBacksOffAfterFailedShrink();
+    testStaysWithinMaxLatency();
+    return testResult();
+}
@@ -0,0 +1,214 @@
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "AudioRenderer.h"
+#include "audio/MemoryDataSource.h"
+#include "utils/SpscQueue.h"
+
+#include "TestUtils.h"
+
+/**
+ * Runs control threads against an AudioRenderer while a fake stream renders it in a tight loop,
+ * the way AudioEngine does with the Oboe callback, and checks that every command is applied exactly
+ * once and in order. The command queue is kept small so that it overflows and control threads
+ * apply the backlog themselves while the stream is rendering.
+ */
+
+namespace {
+    constexpr AudioProperties kProperties = {.channelCount = 2, .sampleRate = 48000};
+    constexpr int32_t kFramesPerBuffer = 192;
+    constexpr float kSourceLevel = 0.1f;
+
+    // Consumer pops exactly what the producer pushed, with single and bulk calls of every size
+    void testSpscQueue() {
+        SpscQueue<uint64_t> queue(64);
+        constexpr uint64_t kItemCount = 2'000'000;
+
+        std::thread producer([&queue] {
+            std::mt19937 random(1);
+            uint64_t items[100];
+            uint64_t next = 0;
+            while (next < kItemCount) {
+                size_t pushed;
+                if (random() % 2 == 0) {
+                    pushed = queue.push(next) ? 1 : 0;
+                } else {
+                    const size_t count = std::min<uint64_t>(random() % 100 + 1, kItemCount - next);
+                    for (size_t i = 0; i < count; ++i) items[i] = next + i;
+                    pushed = queue.push(items, count);
+                }
+                next += pushed;
+                // Don't spin through a whole time slice when both threads share a core
+                if (pushed == 0) std::this_thread::yield();
+            }
+        });
+
+        std::mt19937 random(2);
+        uint64_t items[100];
+        uint64_t expected = 0;
+        bool isInOrder = true;
+        while (expected < kItemCount) {
+            size_t count;
+            if (random() % 2 == 0) {
+                count = queue.pop(items[0]) ? 1 : 0;
+            } else {
+                count = queue.pop(items, random() % 100 + 1);
+            }
+            for (size_t i = 0; i < count; ++i) {
+                isInOrder &= items[i] == expected;
+                expected++;
+            }
+            if (count == 0) std::this_thread::yield();
+        }
+        producer.join();
+
+        CHECK(isInOrder);
+        CHECK(queue.empty());
+    }
+
+    std::unique_ptr<Player> makePlayer(int32_t frameCount) {
+        std::vector<float> samples(static_cast<size_t>(frameCount * kProperties.channelCount), kSourceLevel);
+        return std::make_unique<Player>(new MemoryDataSource(std::move(samples), kProperties), kProperties.channelCount,
+                                        4, VoiceStealingPolicy::oldest, Interpolation::linear);
+    }
+
+    void testRendererUnderConcurrentCommands() {
+        constexpr int kControlThreadCount = 4;
+        constexpr int kIterationsPerThread = 10'000;
+
+        constexpr int64_t kMaxPendingPlayers = 512;
+
+        AudioRenderer renderer(1024, 32);
+        renderer.configure(kProperties);
+
+        // Posting must be serialized across control threads, AudioEngine does it with its control mutex
+        std::mutex controlMutex;
+        std::vector<Player *> players;
+        for (int i = 0; i < kControlThreadCount; ++i) {
+            players.push_back(makePlayer(kProperties.sampleRate / 10).release());
+            renderer.postCommand({.type = AudioCommandType::addPlayer, .player = players.back()});
+        }
+        renderer.postCommand({.type = AudioCommandType::setLimiterEnabled, .boolValue = false});
+
+        std::atomic<bool> isStreamRunning { true };
+        std::atomic<int64_t> renderedBufferCount { 0 };
+        std::atomic<bool> isOutputFinite { true };
+        std::thread stream([&] {
+            std::vector<float> buffer(kFramesPerBuffer * kProperties.channelCount);
+            while (isStreamRunning.load(std::memory_order_relaxed)) {
+                renderer.render(buffer.data(), kFramesPerBuffer, kProperties.channelCount);
+                for (const float sample: buffer) {
+                    if (!std::isfinite(sample)) isOutputFinite = false;
+                }
+                renderedBufferCount++;
+            }
+        });
+
+        std::atomic<int64_t> temporaryPlayerCount { 0 };
+        std::vector<std::thread> controlThreads;
+        for (int threadIndex = 0; threadIndex < kControlThreadCount; ++threadIndex) {
+            controlThreads.emplace_back([&, threadIndex] {
+                Player *player = players[threadIndex];
+                std::mt19937 random(static_cast<uint32_t>(threadIndex + 10));
+                for (int i = 0; i < kIterationsPerThread; ++i) {
+                    std::lock_guard<std::mutex> lock(controlMutex);
+                    switch (random() % 6) {
+                        case 0:
+                            renderer.postCommand({.type = AudioCommandType::setVolume, .player = player,
+                                                  .floatValue = static_cast<float>(random() % 100) / 100.0f});
+                            break;
+                        case 1:
+                            renderer.postCommand({.type = AudioCommandType::setPlaying, .player = player, .boolValue = random() % 2 == 0});
+                            break;
+                        case 2:
+                            renderer.postCommand({.type = AudioCommandType::seekTo, .player = player,
+                                                  .intValue = static_cast<int64_t>(random() % 1000)});
+                            break;
+                        case 3:
+                            renderer.postCommand({.type = AudioCommandType::trigger, .player = player, .floatValue = 0.5f,
+                                                  .pan = 0, .playbackRate = 1});
+                            break;
+                        case 4: {
+                            const AudioCommand commands[] = {
+                                    {.type = AudioCommandType::setLooping, .player = player, .boolValue = true},
+                                    {.type = AudioCommandType::setPan, .player = player, .floatValue = -0.5f},
+                                    {.type = AudioCommandType::setPlaybackRate, .player = player, .floatValue = 1.5f},
+                            };
+                            renderer.postCommands(commands, std::size(commands));
+                            break;
+                        }
+                        case 5: {
+                            // A player that lives for a few buffers, freed by the reaper. Like AudioEngine,
+                            // don't hand over more players than the reaper has room for.
+                            if (renderer.getReclamationStats().pendingCount >= kMaxPendingPlayers) break;
+                            temporaryPlayerCount++;
+                            Player *temporary = makePlayer(kFramesPerBuffer).release();
+                            renderer.postCommand({.type = AudioCommandType::addPlayer, .player = temporary});
+                            renderer.postCommand({.type = AudioCommandType::setPlaying, .player = temporary, .boolValue = true});
+                            renderer.expectRemovedPlayers(1);
+                            renderer.postCommand({.type = AudioCommandType::removePlayer, .player = temporary});
+                            break;
+                        }
+                    }
+                }
+
+                // Leave every player in a known state, which the output is checked against below
+                std::lock_guard<std::mutex> lock(controlMutex);
+                const AudioCommand commands[] = {
+                        {.type = AudioCommandType::setPan, .player = player, .floatValue = 0},
+                        {.type = AudioCommandType::setPlaybackRate, .player = player, .floatValue = 1},
+                        {.type = AudioCommandType::setLooping, .player = player, .boolValue = true},
+                        {.type = AudioCommandType::setVolume, .player = player, .floatValue = 0.25f * static_cast<float>(threadIndex + 1)},
+                        {.type = AudioCommandType::setPlaying, .player = player, .boolValue = true},
+                };
+                renderer.postCommands(commands, std::size(commands));
+            });
+        }
+
+        for (auto &thread: controlThreads) {
+            thread.join();
+        }
+        isStreamRunning = false;
+        stream.join();
+        renderer.drainCommands();
+
+        std::printf("rendered %lld buffers while posting\n", static_cast<long long>(renderedBufferCount.load()));
+        CHECK(isOutputFinite);
+        CHECK(renderer.getAppliedCommandCount() == renderer.getPostedCommandCount());
+
+        // Let the ramps and the triggered voices run out, the sounds are 100 ms long
+        std::vector<float> output(static_cast<size_t>(kProperties.sampleRate * kProperties.channelCount));
+        renderer.render(output.data(), kProperties.sampleRate / 5, kProperties.channelCount);
+        renderer.render(output.data(), kFramesPerBuffer, kProperties.channelCount);
+        float expected = 0;
+        for (int i = 0; i < kControlThreadCount; ++i) {
+            expected += kSourceLevel * 0.25f * static_cast<float>(i + 1);
+        }
+        CHECK_NEAR(output[0], expected, 1e-5);
+        CHECK_NEAR(output[kFramesPerBuffer * kProperties.channelCount - 1], expected, 1e-5);
+
+        // Every temporary player was freed, none leaked or was freed twice
+        for (int i = 0; i < 100 && renderer.getReclamationStats().pendingCount > 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        CHECK(renderer.getReclamationStats().pendingCount == 0);
+        CHECK(renderer.getReclamationStats().retiredCount == temporaryPlayerCount);
+
+        renderer.expectRemovedPlayers(kControlThreadCount);
+        renderer.postCommand({.type = AudioCommandType::removeAllPlayers});
+        renderer.drainCommands();
+    }
+}
+
+int main() {
+    testSpscQueue();
+    testRendererUnderConcurrentCommands();
+    return testResult();
+}
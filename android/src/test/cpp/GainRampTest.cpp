@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "OfflineRenderer.h"
+#include "audio/MemoryDataSource.h"
+
+#include "TestUtils.h"
+
+/**
+ * Renders a looping DC signal and checks the gain changes Player applies to it: volume changes and
+ * fades ramp monotonically over exactly their length, pausing and seeking while playing fade to
+ * silence instead of cutting, and a fade with stopAtEnd leaves the player stopped and rewound.
+ */
+
+namespace {
+    constexpr AudioProperties kProperties = {.channelCount = 2, .sampleRate = 48000};
+    constexpr int32_t kFramesPerBuffer = 192;
+    constexpr float kLevel = 0.5f;
+    // 5 ms, what volume changes ramp over and pauses and seeks fade out over
+    constexpr int32_t kDeclickFrames = kProperties.sampleRate / 200;
+    // Rendered before and after each command, every ramp here is over within that
+    constexpr int64_t kSettleFrames = 9600;
+
+    struct Setup {
+        std::unique_ptr<OfflineRenderer> renderer;
+        Player *player;
+    };
+
+    Setup makeLoopingDc(float volume = 1) {
+        auto renderer = std::make_unique<OfflineRenderer>(kProperties, kFramesPerBuffer);
+        renderer->postCommand({.type = AudioCommandType::setLimiterEnabled, .boolValue = false});
+        std::vector<float> samples(static_cast<size_t>(kProperties.sampleRate * kProperties.channelCount), kLevel);
+        Player *player = renderer->addPlayer(std::make_unique<Player>(new MemoryDataSource(std::move(samples), kProperties),
+                                                                      kProperties.channelCount, 1, VoiceStealingPolicy::oldest,
+                                                                      Interpolation::linear));
+        renderer->postCommand({.type = AudioCommandType::setLooping, .player = player, .boolValue = true});
+        // Set before playing, so it applies right away
+        renderer->postCommand({.type = AudioCommandType::setVolume, .player = player, .floatValue = volume});
+        renderer->postCommand({.type = AudioCommandType::setPlaying, .player = player, .boolValue = true});
+        return {std::move(renderer), player};
+    }
+
+    // The left channel of kSettleFrames before and after the command
+    std::vector<float> renderAround(OfflineRenderer &renderer, const AudioCommand &command) {
+        auto output = renderer.renderToBuffer(kSettleFrames);
+        renderer.postCommand(command);
+        const auto rest = renderer.renderToBuffer(kSettleFrames);
+        output.insert(output.end(), rest.begin(), rest.end());
+
+        std::vector<float> left(output.size() / kProperties.channelCount);
+        for (size_t i = 0; i < left.size(); ++i) left[i] = output[i * kProperties.channelCount];
+        return left;
+    }
+
+    // Frames strictly between the levels before and after a ramp
+    int64_t countRampFrames(const std::vector<float> &output, float from, float to) {
+        constexpr float kTolerance = 1e-6f;
+        const float low = std::min(from, to) + kTolerance;
+        const float high = std::max(from, to) - kTolerance;
+        return std::count_if(output.begin(), output.end(), [low, high](float sample) { return sample > low && sample < high; });
+    }
+
+    bool isMonotonic(const std::vector<float> &output, bool isFalling) {
+        for (size_t i = 1; i < output.size(); ++i) {
+            if (isFalling ? output[i] > output[i - 1] + 1e-6f : output[i] < output[i - 1] - 1e-6f) return false;
+        }
+        return true;
+    }
+
+    float getLargestStep(const std::vector<float> &output) {
+        float largest = 0;
+        for (size_t i = 1; i < output.size(); ++i) largest = std::max(largest, std::fabs(output[i] - output[i - 1]));
+        return largest;
+    }
+
+    void testVolumeChangeRamps() {
+        auto [renderer, player] = makeLoopingDc();
+        const auto output = renderAround(*renderer, {.type = AudioCommandType::setVolume, .player = player, .floatValue = 0.2f});
+
+        CHECK(output.front() == kLevel);
+        CHECK_NEAR(output.back(), kLevel * 0.2f, 1e-6);
+        CHECK(isMonotonic(output, true));
+        // The first frame of the ramp is still at the old level
+        CHECK(countRampFrames(output, kLevel, kLevel * 0.2f) == kDeclickFrames - 1);
+    }
+
+    void testFadeRamps(AudioCommandType type, float fromVolume, float toVolume) {
+        constexpr int32_t kFadeMs = 100;
+        constexpr int64_t kFadeFrames = kProperties.sampleRate * kFadeMs / 1000;
+        auto [renderer, player] = makeLoopingDc(fromVolume);
+        const auto output = renderAround(*renderer, {.type = type, .player = player, .boolValue = false, .floatValue = toVolume, .intValue = kFadeMs});
+
+        CHECK_NEAR(output.front(), kLevel * fromVolume, 1e-6);
+        CHECK_NEAR(output.back(), kLevel * toVolume, 1e-5);
+        CHECK(isMonotonic(output, toVolume < fromVolume));
+        const int64_t rampFrames = countRampFrames(output, kLevel * fromVolume, kLevel * toVolume);
+        CHECK(rampFrames >= kFadeFrames - 2 && rampFrames <= kFadeFrames);
+    }
+
+    void testPauseDeclicksToSilence() {
+        auto [renderer, player] = makeLoopingDc();
+        const auto output = renderAround(*renderer, {.type = AudioCommandType::setPlaying, .player = player, .boolValue = false});
+
+        CHECK(output.front() == kLevel);
+        CHECK(output.back() == 0.0f);
+        CHECK(isMonotonic(output, true));
+        CHECK(countRampFrames(output, kLevel, 0) == kDeclickFrames - 1);
+        // No frame drops by more than one step of the ramp
+        CHECK(getLargestStep(output) <= kLevel / kDeclickFrames * 1.01f);
+    }
+
+    void testSeekDeclicksThroughSilence() {
+        auto [renderer, player] = makeLoopingDc();
+        const auto output = renderAround(*renderer, {.type = AudioCommandType::seekTo, .player = player, .intValue = 250});
+
+        CHECK(output.front() == kLevel);
+        CHECK(output.back() == kLevel);
+        // Out to silence and back in, with the jump in between
+        CHECK(*std::min_element(output.begin(), output.end()) <= kLevel / kDeclickFrames);
+        CHECK(countRampFrames(output, kLevel, 0) >= 2 * (kDeclickFrames - 1));
+        CHECK(getLargestStep(output) <= kLevel / kDeclickFrames * 1.01f);
+    }
+
+    void testFadeWithStopAtEndEndsVoice() {
+        constexpr int32_t kFadeMs = 50;
+        auto [renderer, player] = makeLoopingDc();
+        const auto output = renderAround(*renderer, {.type = AudioCommandType::fadeLinear, .player = player, .boolValue = true, .floatValue = 0, .intValue = kFadeMs});
+
+        CHECK(output.back() == 0.0f);
+        CHECK(isMonotonic(output, true));
+        // Stopped and rewound, which is what a fresh player looks like
+        CHECK(player->isIdle());
+
+        // Playing again starts from the top at the volume the fade left
+        renderer->postCommand({.type = AudioCommandType::setVolume, .player = player, .floatValue = 1});
+        renderer->postCommand({.type = AudioCommandType::setPlaying, .player = player, .boolValue = true});
+        const auto restarted = renderer->renderToBuffer(kSettleFrames);
+        CHECK(restarted[(kSettleFrames - 1) * kProperties.channelCount] == kLevel);
+    }
+}
+
+int main() {
+    testVolumeChangeRamps();
+    testFadeRamps(AudioCommandType::fadeLinear, 1, 0.1f);
+    testFadeRamps(AudioCommandType::fadeLinear, 0.2f, 1);
+    testFadeRamps(AudioCommandType::fadeExponential, 1, 0.1f);
+    testFadeRamps(AudioCommandType::fadeExponential, 0.2f, 1);
+    testPauseDeclicksToSilence();
+    testSeekDeclicksThroughSilence();
+    testFadeWithStopAtEndEndsVoice();
+    return testResult();
+}
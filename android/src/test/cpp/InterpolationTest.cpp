@@ -0,0 +1,140 @@
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "OfflineRenderer.h"
+#include "audio/MemoryDataSource.h"
+
+#include "TestUtils.h"
+
+/**
+ * Checks the interpolated read path of Player: at unit rate it has to give exactly what the plain
+ * copy does, so that a voice moving between the two paths doesn't click, and near the edges of the
+ * sound the cubic spline has to take its missing neighbours from the other end of a looping sound
+ * and silence for a one-shot.
+ */
+
+namespace {
+    constexpr AudioProperties kStereoProperties = {.channelCount = 2, .sampleRate = 48000};
+    constexpr AudioProperties kMonoProperties = {.channelCount = 1, .sampleRate = 48000};
+    constexpr int32_t kFramesPerBuffer = 192;
+    constexpr int32_t kSourceFrames = 4800;
+    constexpr int32_t kEdgeSourceFrames = 300;
+    // Exact in 32.32 fixed point, so the read positions can be worked out without rounding
+    constexpr float kEdgeRate = 0.75f;
+
+    // Far from 0 at both ends, so a wrapped neighbour and a silent one give different output
+    float sourceSample(int64_t frame, int32_t channel, int32_t frameCount) {
+        const double phase = 2 * M_PI * 3 * static_cast<double>(frame) / frameCount;
+        return static_cast<float>(0.5 + 0.3 * (channel == 0 ? std::sin(phase) : std::cos(phase)));
+    }
+
+    std::vector<float> makeSource(AudioProperties properties, int32_t frameCount) {
+        std::vector<float> samples(static_cast<size_t>(frameCount) * properties.channelCount);
+        for (int32_t i = 0; i < frameCount; ++i) {
+            for (int32_t c = 0; c < properties.channelCount; ++c) {
+                samples[i * properties.channelCount + c] = sourceSample(i, c, frameCount);
+            }
+        }
+        return samples;
+    }
+
+    // Renders the source through a looping player at unit rate. With reassertRate, every buffer
+    // sets the rate to the 1 it already is, which ramps it in place and keeps the voice on the
+    // interpolated path.
+    std::vector<float> renderUnitRate(AudioProperties sourceProperties, Interpolation interpolation, bool reassertRate) {
+        OfflineRenderer renderer(kStereoProperties, kFramesPerBuffer);
+        renderer.postCommand({.type = AudioCommandType::setLimiterEnabled, .boolValue = false});
+        Player *player = renderer.addPlayer(std::make_unique<Player>(new MemoryDataSource(makeSource(sourceProperties, kSourceFrames), sourceProperties),
+                                                                     kStereoProperties.channelCount, 1, VoiceStealingPolicy::oldest,
+                                                                     interpolation));
+        renderer.postCommand({.type = AudioCommandType::setLooping, .player = player, .boolValue = true});
+        renderer.postCommand({.type = AudioCommandType::setVolume, .player = player, .floatValue = 0.7f});
+        renderer.postCommand({.type = AudioCommandType::setPlaying, .player = player, .boolValue = true});
+
+        std::vector<float> output;
+        for (int32_t frame = 0; frame < kSourceFrames * 2; frame += kFramesPerBuffer) {
+            if (reassertRate) {
+                renderer.postCommand({.type = AudioCommandType::setPlaybackRate, .player = player, .floatValue = 1});
+            }
+            const auto buffer = renderer.renderToBuffer(kFramesPerBuffer);
+            output.insert(output.end(), buffer.begin(), buffer.end());
+        }
+        return output;
+    }
+
+    void testUnitRateMatchesPlainCopy(AudioProperties sourceProperties, Interpolation interpolation) {
+        const auto plain = renderUnitRate(sourceProperties, interpolation, false);
+        const auto interpolated = renderUnitRate(sourceProperties, interpolation, true);
+        CHECK(plain.size() == interpolated.size());
+        int32_t mismatches = 0;
+        for (size_t i = 0; i < plain.size() && i < interpolated.size(); ++i) {
+            if (plain[i] != interpolated[i]) mismatches++;
+        }
+        CHECK(mismatches == 0);
+    }
+
+    // The Hermite spline of Player, with the neighbours outside the sound filled in like it should
+    float expectedCubic(int64_t position, bool isLooping) {
+        const auto sampleAt = [isLooping](int64_t frame) -> double {
+            if (frame < 0 || frame >= kEdgeSourceFrames) {
+                if (!isLooping) return 0;
+                frame = (frame + kEdgeSourceFrames) % kEdgeSourceFrames;
+            }
+            return sourceSample(frame, 0, kEdgeSourceFrames);
+        };
+        const int64_t frame = position >> 32;
+        const double t = static_cast<double>(static_cast<uint32_t>(position)) / 4294967296.0;
+        const double yMinus1 = sampleAt(frame - 1), y0 = sampleAt(frame), y1 = sampleAt(frame + 1), y2 = sampleAt(frame + 2);
+        const double c1 = 0.5 * (y1 - yMinus1);
+        const double c2 = yMinus1 - 2.5 * y0 + 2 * y1 - 0.5 * y2;
+        const double c3 = 0.5 * (y2 - yMinus1) + 1.5 * (y0 - y1);
+        return static_cast<float>(((c3 * t + c2) * t + c1) * t + y0);
+    }
+
+    std::vector<float> renderEdges(bool isLooping, int32_t frameCount) {
+        OfflineRenderer renderer(kMonoProperties, kFramesPerBuffer);
+        renderer.postCommand({.type = AudioCommandType::setLimiterEnabled, .boolValue = false});
+        Player *player = renderer.addPlayer(std::make_unique<Player>(new MemoryDataSource(makeSource(kMonoProperties, kEdgeSourceFrames), kMonoProperties),
+                                                                     kMonoProperties.channelCount, 1, VoiceStealingPolicy::oldest,
+                                                                     Interpolation::cubic));
+        // Set before playing, so the rate is there from the first frame instead of ramping to it
+        renderer.postCommand({.type = AudioCommandType::setPlaybackRate, .player = player, .floatValue = kEdgeRate});
+        renderer.postCommand({.type = AudioCommandType::setLooping, .player = player, .boolValue = isLooping});
+        renderer.postCommand({.type = AudioCommandType::setPlaying, .player = player, .boolValue = true});
+        return renderer.renderToBuffer(frameCount);
+    }
+
+    void testCubicEdges() {
+        const auto step = static_cast<int64_t>(kEdgeRate * 4294967296.0);
+        const int64_t endPosition = static_cast<int64_t>(kEdgeSourceFrames) << 32;
+        // Past the end of the sound twice over
+        const auto frameCount = static_cast<int32_t>(2 * endPosition / step + kFramesPerBuffer);
+        const auto looping = renderEdges(true, frameCount);
+        const auto oneShot = renderEdges(false, frameCount);
+        CHECK(static_cast<int32_t>(looping.size()) == frameCount && static_cast<int32_t>(oneShot.size()) == frameCount);
+
+        float loopingError = 0;
+        float oneShotError = 0;
+        for (int32_t i = 0; i < frameCount; ++i) {
+            const int64_t position = i * step;
+            loopingError = std::max(loopingError, std::fabs(looping[i] - expectedCubic(position % endPosition, true)));
+            const float oneShotExpected = position < endPosition ? expectedCubic(position, false) : 0.0f;
+            oneShotError = std::max(oneShotError, std::fabs(oneShot[i] - oneShotExpected));
+        }
+        CHECK(loopingError < 1e-6f);
+        CHECK(oneShotError < 1e-6f);
+
+        // The last frames before the end read past it, which is where the two have to differ
+        const auto lastFrame = static_cast<int32_t>((endPosition - 1) / step);
+        CHECK(std::fabs(looping[lastFrame] - oneShot[lastFrame]) > 0.01f);
+    }
+}
+
+int main() {
+    testUnitRateMatchesPlainCopy(kMonoProperties, Interpolation::linear);
+    testUnitRateMatchesPlainCopy(kStereoProperties, Interpolation::linear);
+    testUnitRateMatchesPlainCopy(kStereoProperties, Interpolation::cubic);
+    testCubicEdges();
+    return testResult();
+}
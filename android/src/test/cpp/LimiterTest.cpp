@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "audio/Limiter.h"
+
+#include "TestUtils.h"
+
+/**
+ * Checks that the limiter keeps the output under its threshold, delays it by the same amount
+ * whether it is enabled or not, and moves between limited and unlimited output smoothly when it is
+ * toggled.
+ */
+
+namespace {
+    constexpr AudioProperties kProperties = {.channelCount = 2, .sampleRate = 48000};
+    constexpr int32_t kFramesPerBuffer = 192;
+    constexpr float kThreshold = 0.891f;
+
+    std::vector<float> process(Limiter &limiter, std::vector<float> samples) {
+        const auto frameCount = static_cast<int32_t>(samples.size() / kProperties.channelCount);
+        for (int32_t offset = 0; offset < frameCount; offset += kFramesPerBuffer) {
+            limiter.process(samples.data() + offset * kProperties.channelCount, std::min(kFramesPerBuffer, frameCount - offset));
+        }
+        return samples;
+    }
+
+    float getLargestStep(const std::vector<float> &samples) {
+        float largestStep = 0;
+        for (size_t i = kProperties.channelCount; i < samples.size(); ++i) {
+            largestStep = std::max(largestStep, std::fabs(samples[i] - samples[i - kProperties.channelCount]));
+        }
+        return largestStep;
+    }
+
+    void testOutputStaysUnderThreshold() {
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> distribution(-3, 3);
+        std::vector<float> samples(kProperties.sampleRate * kProperties.channelCount);
+        for (auto &sample: samples) sample = distribution(random);
+
+        Limiter limiter;
+        limiter.configure(kProperties);
+        const auto output = process(limiter, samples);
+        float peak = 0;
+        for (const float sample: output) peak = std::max(peak, std::fabs(sample));
+        // The gain is an average of the gains needed, which rounding can leave a hair above them
+        CHECK(peak <= kThreshold + 1e-5f);
+        CHECK(limiter.takeMinGain() < 0.5f);
+        CHECK(limiter.takeMinGain() == 1.0f);
+    }
+
+    void testLatencyDoesNotDependOnEnabled() {
+        for (const bool isEnabled: {true, false}) {
+            Limiter limiter;
+            limiter.configure(kProperties);
+            limiter.setEnabled(isEnabled);
+            std::vector<float> samples(kFramesPerBuffer * 4 * kProperties.channelCount);
+            samples[10 * kProperties.channelCount] = 0.5f;
+
+            const auto output = process(limiter, samples);
+            const auto impulse = std::find_if(output.begin(), output.end(), [](float sample) { return sample != 0; });
+            CHECK(impulse != output.end() && *impulse == 0.5f);
+            CHECK(impulse - output.begin() == (10 + limiter.getLatencyFrames()) * kProperties.channelCount);
+        }
+    }
+
+    // A constant signal at twice full scale, limited, then unlimited, then limited again
+    void testToggleIsSmooth() {
+        constexpr float kLevel = 2.0f;
+        Limiter limiter;
+        limiter.configure(kProperties);
+        std::vector<float> samples(kProperties.sampleRate / 2 * kProperties.channelCount, kLevel);
+
+        auto output = process(limiter, samples);
+        CHECK_NEAR(output.back(), kThreshold, 1e-4);
+
+        limiter.setEnabled(false);
+        const auto disabled = process(limiter, samples);
+        // The gain releases to unity instead of jumping there, 500 ms is about 8 release time constants
+        CHECK(getLargestStep(disabled) < 0.01f);
+        CHECK_NEAR(disabled.back(), kLevel, 1e-3);
+
+        limiter.setEnabled(true);
+        const auto enabled = process(limiter, samples);
+        // Coming back in, the gain moves down over the lookahead like it does for any peak
+        CHECK(getLargestStep(enabled) <= (kLevel - kThreshold) / static_cast<float>(limiter.getLatencyFrames()) + 1e-4f);
+        CHECK_NEAR(enabled.back(), kThreshold, 1e-4);
+    }
+}
+
+int main() {
+    testOutputStaysUnderThreshold();
+    testLatencyDoesNotDependOnEnabled();
+    testToggleIsSmooth();
+    return testResult();
+}
@@ -0,0 +1,129 @@
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "OfflineRenderer.h"
+#include "audio/MemoryDataSource.h"
+#include "audio/WavFile.h"
+
+#include "TestUtils.h"
+
+/**
+ * Renders a fixed scene through OfflineRenderer and compares it against the output worked out by
+ * hand from the sources: a looping mono sine at half volume and a stereo one-shot at a quarter,
+ * with the limiter off so the mix is a plain sum.
+ */
+
+namespace {
+    constexpr AudioProperties kOutputProperties = {.channelCount = 2, .sampleRate = 48000};
+    constexpr AudioProperties kMonoProperties = {.channelCount = 1, .sampleRate = 48000};
+    constexpr int32_t kSineFrames = 48000;
+    constexpr int32_t kOneShotFrames = 12000;
+    constexpr int64_t kRenderFrames = 72000;
+    constexpr float kSineVolume = 0.5f;
+    constexpr float kOneShotVolume = 0.25f;
+
+    float sineSample(int64_t frame) {
+        // A whole number of cycles over the loop, so it wraps without a jump
+        return static_cast<float>(std::sin(2 * M_PI * 440 * static_cast<double>(frame) / kSineFrames));
+    }
+
+    // Left rises and right falls, so swapped or merged channels show up in the output
+    float oneShotSample(int64_t frame, int32_t channel) {
+        const auto value = static_cast<float>(frame) / kOneShotFrames;
+        return channel == 0 ? value : -value;
+    }
+
+    float expectedSample(int64_t frame, int32_t channel) {
+        float expected = kSineVolume * sineSample(frame % kSineFrames);
+        if (frame < kOneShotFrames) expected += kOneShotVolume * oneShotSample(frame, channel);
+        return expected;
+    }
+
+    std::unique_ptr<OfflineRenderer> makeScene(int32_t framesPerBuffer) {
+        auto renderer = std::make_unique<OfflineRenderer>(kOutputProperties, framesPerBuffer);
+        renderer->postCommand({.type = AudioCommandType::setLimiterEnabled, .boolValue = false});
+
+        std::vector<float> sine(kSineFrames);
+        for (int32_t i = 0; i < kSineFrames; ++i) {
+            sine[i] = sineSample(i);
+        }
+        Player *sinePlayer = renderer->addPlayer(std::make_unique<Player>(new MemoryDataSource(std::move(sine), kMonoProperties),
+                                                                          kOutputProperties.channelCount, 1, VoiceStealingPolicy::oldest,
+                                                                          Interpolation::linear));
+        renderer->postCommand({.type = AudioCommandType::setLooping, .player = sinePlayer, .boolValue = true});
+        renderer->postCommand({.type = AudioCommandType::setVolume, .player = sinePlayer, .floatValue = kSineVolume});
+        renderer->postCommand({.type = AudioCommandType::setPlaying, .player = sinePlayer, .boolValue = true});
+
+        std::vector<float> oneShot(kOneShotFrames * kOutputProperties.channelCount);
+        for (int32_t i = 0; i < kOneShotFrames; ++i) {
+            oneShot[i * 2] = oneShotSample(i, 0);
+            oneShot[i * 2 + 1] = oneShotSample(i, 1);
+        }
+        Player *oneShotPlayer = renderer->addPlayer(std::make_unique<Player>(new MemoryDataSource(std::move(oneShot), kOutputProperties),
+                                                                             kOutputProperties.channelCount, 1, VoiceStealingPolicy::oldest,
+                                                                             Interpolation::linear));
+        renderer->postCommand({.type = AudioCommandType::setVolume, .player = oneShotPlayer, .floatValue = kOneShotVolume});
+        renderer->postCommand({.type = AudioCommandType::setPlaying, .player = oneShotPlayer, .boolValue = true});
+        return renderer;
+    }
+
+    void testOutputMatchesGolden() {
+        const auto output = makeScene(192)->renderToBuffer(kRenderFrames);
+        CHECK(output.size() == static_cast<size_t>(kRenderFrames * kOutputProperties.channelCount));
+
+        float largestError = 0;
+        for (int64_t frame = 0; frame < kRenderFrames; ++frame) {
+            for (int32_t channel = 0; channel < kOutputProperties.channelCount; ++channel) {
+                const float actual = output[static_cast<size_t>(frame * kOutputProperties.channelCount + channel)];
+                largestError = std::max(largestError, std::fabs(actual - expectedSample(frame, channel)));
+            }
+        }
+        CHECK_NEAR(largestError, 0, 1e-6);
+    }
+
+    // Commands are applied between buffers, with none arriving mid-render the buffer size must not matter
+    void testOutputDoesNotDependOnBufferSize() {
+        const auto output = makeScene(192)->renderToBuffer(kRenderFrames);
+        for (const int32_t framesPerBuffer: {1, 64, 1000, 4096}) {
+            CHECK(makeScene(framesPerBuffer)->renderToBuffer(kRenderFrames) == output);
+        }
+    }
+
+    void testWavFileMatchesBuffer() {
+        const auto path = (std::filesystem::temp_directory_path() / "OfflineRendererTest.wav").string();
+        const auto result = makeScene(192)->renderToWavFile(path, kRenderFrames);
+        CHECK(!result.error);
+
+        std::ifstream stream(path, std::ios::binary);
+        const std::vector<char> contents((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+        std::filesystem::remove(path);
+        const auto parsed = parseWavFile(reinterpret_cast<const std::byte *>(contents.data()), contents.size());
+        CHECK(parsed.file.has_value());
+        if (!parsed.file) return;
+
+        const WavFile &file = *parsed.file;
+        CHECK(file.encoding == WavEncoding::float32);
+        CHECK(file.channelCount == kOutputProperties.channelCount);
+        CHECK(file.sampleRate == kOutputProperties.sampleRate);
+        CHECK(file.frameCount == kRenderFrames);
+        if (file.frameCount != kRenderFrames) return;
+
+        std::vector<float> samples(static_cast<size_t>(kRenderFrames * kOutputProperties.channelCount));
+        std::memcpy(samples.data(), file.samples, samples.size() * sizeof(float));
+        CHECK(samples == makeScene(192)->renderToBuffer(kRenderFrames));
+    }
+}
+
+int main() {
+    testOutputMatchesGolden();
+    testOutputDoesNotDependOnBufferSize();
+    testWavFileMatchesBuffer();
+    return testResult();
+}
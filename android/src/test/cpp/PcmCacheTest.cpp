@@ -0,0 +1,121 @@
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "audio/PcmCache.h"
+
+#include "TestUtils.h"
+
+/**
+ * Checks the decoded sound cache on a scratch directory: entries read back as written, float
+ * samples stored under an int16 key come back converted, and the cache stays within its size
+ * limit by removing the least recently used entries, also across instances on the same directory.
+ */
+
+namespace {
+    constexpr AudioProperties kProperties = {.channelCount = 2, .sampleRate = 48000};
+    constexpr int64_t kSampleCount = 4800;
+    // One entry, with room to spare for its header
+    constexpr int64_t kEntryBytes = kSampleCount * 2 + 64;
+    // Apart enough for file modification times to tell the entries apart
+    constexpr auto kUseInterval = std::chrono::milliseconds(20);
+
+    PcmCacheKey makeKey(uint64_t contentHash) {
+        return {
+            .contentHash = contentHash,
+            .contentLength = 1000,
+            .targetProperties = kProperties,
+            .resamplerQuality = 1,
+            .sampleFormat = SampleFormat::int16
+        };
+    }
+
+    std::vector<int16_t> makeSamples(int16_t value) {
+        return std::vector<int16_t>(kSampleCount, value);
+    }
+
+    std::string makeDirectory() {
+        const auto directory = std::filesystem::temp_directory_path() / "PcmCacheTest";
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+        return directory.string();
+    }
+
+    void testRoundTrip() {
+        PcmCache cache(makeDirectory());
+        CHECK(!cache.lookup(makeKey(1)));
+
+        const auto samples = makeSamples(1234);
+        cache.store(makeKey(1), samples.data(), SampleFormat::int16, kSampleCount, kProperties);
+        const auto cached = cache.lookup(makeKey(1));
+        CHECK(cached.has_value());
+        if (cached) {
+            CHECK(cached->sampleFormat == SampleFormat::int16);
+            CHECK(cached->sampleCount == kSampleCount);
+            CHECK(cached->properties.channelCount == kProperties.channelCount);
+            CHECK(static_cast<const int16_t *>(cached->samples)[kSampleCount - 1] == 1234);
+        }
+
+        const std::vector<float> floatSamples(kSampleCount, 0.5f);
+        cache.store(makeKey(2), floatSamples.data(), SampleFormat::float32, kSampleCount, kProperties);
+        const auto converted = cache.lookup(makeKey(2));
+        CHECK(converted.has_value());
+        if (converted) {
+            CHECK(converted->file->getSize() < kSampleCount * sizeof(float));
+            CHECK(static_cast<const int16_t *>(converted->samples)[0] == 16384);
+        }
+
+        const auto stats = cache.getStats();
+        CHECK(stats.hitCount == 2);
+        CHECK(stats.missCount == 1);
+        CHECK(stats.evictionCount == 0);
+    }
+
+    void testLeastRecentlyUsedEviction() {
+        const auto directory = makeDirectory();
+        PcmCache cache(directory, kEntryBytes * 2);
+        const auto samples = makeSamples(1);
+
+        cache.store(makeKey(1), samples.data(), SampleFormat::int16, kSampleCount, kProperties);
+        std::this_thread::sleep_for(kUseInterval);
+        cache.store(makeKey(2), samples.data(), SampleFormat::int16, kSampleCount, kProperties);
+        std::this_thread::sleep_for(kUseInterval);
+        // Used after 2 was written, which makes 2 the least recently used
+        CHECK(cache.lookup(makeKey(1)).has_value());
+        std::this_thread::sleep_for(kUseInterval);
+        cache.store(makeKey(3), samples.data(), SampleFormat::int16, kSampleCount, kProperties);
+
+        CHECK(cache.getStats().evictionCount == 1);
+        CHECK(cache.getStats().sizeBytes <= kEntryBytes * 2);
+        CHECK(cache.lookup(makeKey(1)).has_value());
+        CHECK(!cache.lookup(makeKey(2)).has_value());
+        CHECK(cache.lookup(makeKey(3)).has_value());
+
+        // Entries that could never fit are not written at all
+        const std::vector<int16_t> tooLong(kSampleCount * 3);
+        cache.store(makeKey(4), tooLong.data(), SampleFormat::int16, static_cast<int64_t>(tooLong.size()), kProperties);
+        CHECK(!cache.lookup(makeKey(4)).has_value());
+        CHECK(cache.getStats().evictionCount == 1);
+
+        // The order is picked up from the files, 3 was used after 1
+        std::this_thread::sleep_for(kUseInterval);
+        CHECK(cache.lookup(makeKey(3)).has_value());
+        PcmCache reopened(directory, kEntryBytes * 2);
+        CHECK(reopened.getStats().sizeBytes == cache.getStats().sizeBytes);
+        reopened.setMaxBytes(kEntryBytes);
+        CHECK(reopened.getStats().evictionCount == 1);
+        CHECK(!reopened.lookup(makeKey(1)).has_value());
+        CHECK(reopened.lookup(makeKey(3)).has_value());
+
+        std::filesystem::remove_all(directory);
+    }
+}
+
+int main() {
+    testRoundTrip();
+    testLeastRecentlyUsedEviction();
+    return testResult();
+}
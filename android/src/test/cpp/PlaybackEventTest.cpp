@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "OfflineRenderer.h"
+#include "audio/MemoryDataSource.h"
+
+#include "TestUtils.h"
+
+/**
+ * Plays short sounds through OfflineRenderer and checks the events they produce: ended at the end
+ * of a one-shot sound, looped every time a looping sound wraps around and markerReached for every
+ * marker it plays past, each on the renderer frame it happened at and with the sound's id. Covers
+ * the plain and the interpolated read paths and buffer sizes that don't divide the sound.
+ */
+
+namespace {
+    constexpr AudioProperties kProperties = {.channelCount = 2, .sampleRate = 48000};
+    constexpr int32_t kSoundId = 7;
+    constexpr int32_t kSourceFrames = 1000;
+    // 48 frames per millisecond
+    constexpr int64_t kLateMarkerMs = 12;
+    constexpr int64_t kEarlyMarkerMs = 5;
+
+    struct ExpectedEvent {
+        PlaybackEventType type;
+        int32_t markerIndex;
+        int64_t framePosition;
+    };
+
+    Player *addPlayer(OfflineRenderer &renderer, bool isLooping, float playbackRate) {
+        std::vector<float> samples(static_cast<size_t>(kSourceFrames * kProperties.channelCount), 0.25f);
+        auto player = std::make_unique<Player>(new MemoryDataSource(std::move(samples), kProperties), kProperties.channelCount, 1,
+                                               VoiceStealingPolicy::oldest, Interpolation::linear);
+        player->setSoundId(kSoundId);
+        Player *rawPlayer = renderer.addPlayer(std::move(player));
+        renderer.postCommand({.type = AudioCommandType::setLooping, .player = rawPlayer, .boolValue = isLooping});
+        // Set before playing, so the rate doesn't ramp
+        renderer.postCommand({.type = AudioCommandType::setPlaybackRate, .player = rawPlayer, .floatValue = playbackRate});
+        // Added out of order, the indices follow the order they were added in
+        renderer.postCommand({.type = AudioCommandType::addMarker, .player = rawPlayer, .intValue = kLateMarkerMs});
+        renderer.postCommand({.type = AudioCommandType::addMarker, .player = rawPlayer, .intValue = kEarlyMarkerMs});
+        renderer.postCommand({.type = AudioCommandType::setPlaying, .player = rawPlayer, .boolValue = true});
+        return rawPlayer;
+    }
+
+    std::vector<PlaybackEvent> renderAndTakeEvents(OfflineRenderer &renderer, int64_t numFrames) {
+        renderer.renderToBuffer(numFrames);
+        std::vector<PlaybackEvent> events(64);
+        events.resize(renderer.takeEvents(events.data(), events.size()));
+        return events;
+    }
+
+    void checkEvents(const std::vector<PlaybackEvent> &events, const std::vector<ExpectedEvent> &expected) {
+        CHECK(events.size() == expected.size());
+        for (size_t i = 0; i < std::min(events.size(), expected.size()); ++i) {
+            CHECK(events[i].type == expected[i].type);
+            CHECK(events[i].soundId == kSoundId);
+            CHECK(events[i].framePosition == expected[i].framePosition);
+            if (expected[i].type == PlaybackEventType::markerReached) {
+                CHECK(events[i].markerIndex == expected[i].markerIndex);
+            }
+        }
+    }
+
+    void testOneShot(int32_t framesPerBuffer) {
+        OfflineRenderer renderer(kProperties, framesPerBuffer);
+        addPlayer(renderer, false, 1);
+        checkEvents(renderAndTakeEvents(renderer, 3 * kSourceFrames), {
+            {PlaybackEventType::markerReached, 1, kEarlyMarkerMs * 48},
+            {PlaybackEventType::markerReached, 0, kLateMarkerMs * 48},
+            {PlaybackEventType::ended, 0, kSourceFrames},
+        });
+    }
+
+    void testLooping(int32_t framesPerBuffer) {
+        OfflineRenderer renderer(kProperties, framesPerBuffer);
+        addPlayer(renderer, true, 1);
+        std::vector<ExpectedEvent> expected;
+        for (int64_t loop = 0; loop < 3; ++loop) {
+            const int64_t start = loop * kSourceFrames;
+            expected.push_back({PlaybackEventType::markerReached, 1, start + kEarlyMarkerMs * 48});
+            expected.push_back({PlaybackEventType::markerReached, 0, start + kLateMarkerMs * 48});
+            expected.push_back({PlaybackEventType::looped, 0, start + kSourceFrames});
+        }
+        // Stops short of the first marker of the next loop
+        checkEvents(renderAndTakeEvents(renderer, 3 * kSourceFrames + kSourceFrames / 10), expected);
+    }
+
+    // At half speed every frame of the sound takes two
+    void testInterpolated(int32_t framesPerBuffer) {
+        OfflineRenderer renderer(kProperties, framesPerBuffer);
+        addPlayer(renderer, false, 0.5f);
+        checkEvents(renderAndTakeEvents(renderer, 3 * kSourceFrames), {
+            {PlaybackEventType::markerReached, 1, 2 * kEarlyMarkerMs * 48},
+            {PlaybackEventType::markerReached, 0, 2 * kLateMarkerMs * 48},
+            {PlaybackEventType::ended, 0, 2 * kSourceFrames},
+        });
+    }
+
+    void testLoopingInterpolated(int32_t framesPerBuffer) {
+        OfflineRenderer renderer(kProperties, framesPerBuffer);
+        addPlayer(renderer, true, 0.5f);
+        std::vector<ExpectedEvent> expected;
+        for (int64_t loop = 0; loop < 2; ++loop) {
+            const int64_t start = loop * 2 * kSourceFrames;
+            expected.push_back({PlaybackEventType::markerReached, 1, start + 2 * kEarlyMarkerMs * 48});
+            expected.push_back({PlaybackEventType::markerReached, 0, start + 2 * kLateMarkerMs * 48});
+            expected.push_back({PlaybackEventType::looped, 0, start + 2 * kSourceFrames});
+        }
+        checkEvents(renderAndTakeEvents(renderer, 4 * kSourceFrames + kSourceFrames / 10), expected);
+    }
+}
+
+int main() {
+    for (const int32_t framesPerBuffer: {1, 37, 192, 4096}) {
+        testOneShot(framesPerBuffer);
+        testLooping(framesPerBuffer);
+        testInterpolated(framesPerBuffer);
+        testLoopingInterpolated(framesPerBuffer);
+    }
+    return testResult();
+}
@@ -0,0 +1,133 @@
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "OfflineRenderer.h"
+#include "audio/MemoryDataSource.h"
+
+#include "TestUtils.h"
+
+/**
+ * Replaces a playing 48 kHz player with one converted for a 24 kHz stream, the way reconfiguring the
+ * stream does, and checks that the replacement continues where the original left off: at the same
+ * time in the sound, with its markers, scheduled events and ramps at the same times, and with the
+ * sound id and looping carried over. Source frames are rendered one per output frame either way, so
+ * after the swap everything is half as many frames away.
+ */
+
+namespace {
+    constexpr AudioProperties kProperties = {.channelCount = 2, .sampleRate = 48000};
+    constexpr AudioProperties kConvertedProperties = {.channelCount = 2, .sampleRate = 24000};
+    constexpr int32_t kFramesPerBuffer = 192;
+    constexpr int32_t kSoundId = 5;
+    constexpr float kLevel = 0.5f;
+    // 250 ms in
+    constexpr int64_t kSwapFrame = 12000;
+
+    std::unique_ptr<Player> makePlayer(AudioProperties sourceProperties) {
+        // One second
+        std::vector<float> samples(static_cast<size_t>(sourceProperties.sampleRate * sourceProperties.channelCount), kLevel);
+        auto player = std::make_unique<Player>(new MemoryDataSource(std::move(samples), sourceProperties), kProperties.channelCount, 1,
+                                               VoiceStealingPolicy::oldest, Interpolation::linear);
+        player->setSoundId(kSoundId);
+        return player;
+    }
+
+    struct Setup {
+        std::unique_ptr<OfflineRenderer> renderer;
+        Player *player;
+    };
+
+    Setup makePlaying() {
+        auto renderer = std::make_unique<OfflineRenderer>(kProperties, kFramesPerBuffer);
+        renderer->postCommand({.type = AudioCommandType::setLimiterEnabled, .boolValue = false});
+        Player *player = renderer->addPlayer(makePlayer(kProperties));
+        renderer->postCommand({.type = AudioCommandType::setPlaying, .player = player, .boolValue = true});
+        return {std::move(renderer), player};
+    }
+
+    // Renders up to the swap and replaces the player, the replacement takes over at renderer frame
+    // kSwapFrame
+    Player *swapAfterRendering(OfflineRenderer &renderer, Player *player) {
+        renderer.renderToBuffer(kSwapFrame - renderer.getLatencyFrames());
+        return renderer.replacePlayer(player, makePlayer(kConvertedProperties));
+    }
+
+    // Left sample of what is heard framesAfterSwap renderer frames after the swap, the output of
+    // the next render starts the latency before it
+    float getSampleAfterSwap(const OfflineRenderer &renderer, const std::vector<float> &output, int64_t framesAfterSwap) {
+        return output[static_cast<size_t>((framesAfterSwap + renderer.getLatencyFrames()) * kProperties.channelCount)];
+    }
+
+    std::vector<PlaybackEvent> takeEvents(OfflineRenderer &renderer) {
+        std::vector<PlaybackEvent> events(64);
+        events.resize(renderer.takeEvents(events.data(), events.size()));
+        return events;
+    }
+
+    void testContinuesAtSameTime() {
+        constexpr int64_t kMarkerMs = 300;
+        auto [renderer, player] = makePlaying();
+        renderer->postCommand({.type = AudioCommandType::setLooping, .player = player, .boolValue = true});
+        renderer->postCommand({.type = AudioCommandType::addMarker, .player = player, .intValue = kMarkerMs});
+        Player *replacement = swapAfterRendering(*renderer, player);
+
+        // One output frame of the replacement is two of the original
+        renderer->renderToBuffer(1);
+        CHECK_NEAR(replacement->getPositionMs(), kSwapFrame * 1000.0 / kProperties.sampleRate, 0.05);
+
+        // The marker is 50 ms ahead, the end of the sound 750 ms
+        renderer->renderToBuffer(kConvertedProperties.sampleRate - 1);
+        const auto events = takeEvents(*renderer);
+        CHECK(events.size() == 2);
+        if (events.size() == 2) {
+            CHECK(events[0].type == PlaybackEventType::markerReached);
+            CHECK(events[0].markerIndex == 0);
+            CHECK(events[0].soundId == kSoundId);
+            CHECK(events[0].framePosition == kSwapFrame + kConvertedProperties.sampleRate * (kMarkerMs - 250) / 1000);
+            CHECK(events[1].type == PlaybackEventType::looped);
+            CHECK(events[1].soundId == kSoundId);
+            CHECK(events[1].framePosition == kSwapFrame + kConvertedProperties.sampleRate * 750 / 1000);
+        }
+    }
+
+    void testScheduledEventsKeepTheirTime() {
+        // 200 ms after the swap, which is 4800 frames of the replacement
+        constexpr int64_t kPauseFrame = kSwapFrame + kProperties.sampleRate / 5;
+        constexpr int64_t kPauseFramesAfterSwap = kConvertedProperties.sampleRate / 5;
+        auto [renderer, player] = makePlaying();
+        renderer->postCommand({.type = AudioCommandType::schedulePlaying, .player = player, .boolValue = false, .intValue = kPauseFrame});
+        swapAfterRendering(*renderer, player);
+
+        const auto output = renderer->renderToBuffer(kProperties.sampleRate / 5);
+        // The first frame of the declick is still at the old level
+        CHECK(getSampleAfterSwap(*renderer, output, kPauseFramesAfterSwap) == kLevel);
+        CHECK(getSampleAfterSwap(*renderer, output, kPauseFramesAfterSwap + 1) < kLevel);
+        // Silent once the 5 ms declick is over
+        CHECK(getSampleAfterSwap(*renderer, output, kPauseFramesAfterSwap + kProperties.sampleRate / 200) == 0.0f);
+    }
+
+    void testRampsKeepTheirLength() {
+        constexpr int32_t kFadeMs = 1000;
+        auto [renderer, player] = makePlaying();
+        renderer->postCommand({.type = AudioCommandType::fadeLinear, .player = player, .boolValue = false, .floatValue = 0, .intValue = kFadeMs});
+        swapAfterRendering(*renderer, player);
+
+        // A quarter of the fade is over and the remaining 750 ms are 18000 frames of the replacement
+        constexpr int64_t kRemainingFrames = kConvertedProperties.sampleRate * 3 / 4;
+        const auto output = renderer->renderToBuffer(kRemainingFrames + kFramesPerBuffer);
+        CHECK_NEAR(getSampleAfterSwap(*renderer, output, 0), kLevel * 0.75f, 0.01);
+        CHECK_NEAR(getSampleAfterSwap(*renderer, output, kRemainingFrames / 3), kLevel * 0.5f, 0.01);
+        // Ramps advance in segments of 64 frames
+        CHECK(getSampleAfterSwap(*renderer, output, kRemainingFrames - 64) > 0.0f);
+        CHECK(getSampleAfterSwap(*renderer, output, kRemainingFrames) == 0.0f);
+    }
+}
+
+int main() {
+    testContinuesAtSameTime();
+    testScheduledEventsKeepTheirTime();
+    testRampsKeepTheirLength();
+    return testResult();
+}
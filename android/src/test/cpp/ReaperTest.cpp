@@ -0,0 +1,143 @@
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "AudioRenderer.h"
+#include "audio/MemoryDataSource.h"
+#include "utils/Reaper.h"
+
+#include "TestUtils.h"
+
+/**
+ * Checks that the reaper holds off freeing while a read guard is alive, that retiring into a full
+ * queue hands the object back instead of losing it and AudioRenderer retires it later, and that
+ * readers loading a published pointer under a guard never see the object it pointed to freed
+ * while a writer keeps replacing and retiring it, the way AudioEngine::getSoundsPosition reads
+ * players.
+ */
+
+namespace {
+    // A few passes of the reaper
+    constexpr auto kSettleTime = std::chrono::milliseconds(200);
+    constexpr uint32_t kAliveMagic = 0xA11CE;
+
+    std::atomic<int64_t> gFreedCount { 0 };
+
+    struct Tracked {
+        uint32_t magic = kAliveMagic;
+        ~Tracked() {
+            magic = 0;
+            gFreedCount++;
+        }
+    };
+
+    void testGuardDefersFreeing() {
+        Reaper reaper(16);
+        const int64_t freedBefore = gFreedCount;
+        {
+            const auto guard = reaper.guardReads();
+            reaper.expect(2);
+            CHECK(reaper.retire(new Tracked()));
+            CHECK(reaper.retire(new Tracked()));
+            std::this_thread::sleep_for(kSettleTime);
+            CHECK(gFreedCount == freedBefore);
+            CHECK(reaper.getStats().pendingCount == 2);
+        }
+        std::this_thread::sleep_for(kSettleTime);
+        CHECK(gFreedCount == freedBefore + 2);
+        CHECK(reaper.getStats().pendingCount == 0);
+        CHECK(reaper.getStats().retiredCount == 2);
+    }
+
+    void testFullQueueHandsObjectBack() {
+        Reaper reaper(2);
+        Tracked *kept = new Tracked();
+        const int64_t freedBefore = gFreedCount;
+        {
+            // The reaper takes one object while the guard is alive and holds it back, the queue
+            // then fills up behind it
+            const auto guard = reaper.guardReads();
+            reaper.expect(4);
+            CHECK(reaper.retire(new Tracked()));
+            CHECK(reaper.retire(new Tracked()));
+            std::this_thread::sleep_for(kSettleTime);
+            CHECK(reaper.retire(new Tracked()));
+            CHECK(!reaper.retire(kept));
+            CHECK(kept->magic == kAliveMagic);
+        }
+        std::this_thread::sleep_for(kSettleTime);
+        CHECK(gFreedCount == freedBefore + 3);
+        CHECK(reaper.retire(kept));
+        std::this_thread::sleep_for(kSettleTime);
+        CHECK(reaper.getStats().pendingCount == 0);
+        CHECK(reaper.getStats().retiredCount == 4);
+    }
+
+    // Players removed beyond what the reaper has room for stay with the renderer until they fit
+    void testRendererKeepsOverflowedPlayers() {
+        constexpr AudioProperties kProperties = {.channelCount = 2, .sampleRate = 48000};
+        constexpr int32_t kPlayerCount = 8;
+        AudioRenderer renderer(2, 64);
+        std::vector<float> output(192 * kProperties.channelCount);
+        for (int32_t i = 0; i < kPlayerCount; ++i) {
+            auto *player = new Player(new MemoryDataSource(std::vector<float>(256 * kProperties.channelCount), kProperties),
+                                      kProperties.channelCount, 1, VoiceStealingPolicy::oldest, Interpolation::linear);
+            renderer.postCommand({.type = AudioCommandType::addPlayer, .player = player});
+        }
+        {
+            const auto guard = renderer.guardPlayerReads();
+            renderer.expectRemovedPlayers(kPlayerCount);
+            renderer.postCommand({.type = AudioCommandType::removeAllPlayers});
+            renderer.render(output.data(), 192, kProperties.channelCount);
+            CHECK(renderer.getRetireOverflowCount() > 0);
+        }
+        for (int i = 0; i < 10 && renderer.getReclamationStats().pendingCount > 0; ++i) {
+            std::this_thread::sleep_for(kSettleTime);
+            renderer.render(output.data(), 192, kProperties.channelCount);
+        }
+        CHECK(renderer.getReclamationStats().pendingCount == 0);
+        CHECK(renderer.getReclamationStats().retiredCount == kPlayerCount);
+    }
+
+    void testGuardedReadsNeverSeeFreedObjects() {
+        constexpr int kReplacementCount = 20000;
+        Reaper reaper(kReplacementCount + 1);
+        std::atomic<Tracked *> published { new Tracked() };
+        std::atomic<bool> isDone { false };
+        std::atomic<int64_t> deadReadCount { 0 };
+
+        std::vector<std::thread> readers;
+        for (int i = 0; i < 2; ++i) {
+            readers.emplace_back([&] {
+                while (!isDone.load()) {
+                    const auto guard = reaper.guardReads();
+                    const Tracked *tracked = published.load();
+                    if (tracked->magic != kAliveMagic) deadReadCount++;
+                }
+            });
+        }
+
+        reaper.expect(kReplacementCount);
+        for (int i = 0; i < kReplacementCount; ++i) {
+            // Unpublished before it is retired, like a player before its removal is posted
+            Tracked *previous = published.exchange(new Tracked());
+            CHECK(reaper.retire(previous));
+            if (i % 1000 == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        isDone = true;
+        for (auto &reader: readers) reader.join();
+
+        CHECK(deadReadCount == 0);
+        delete published.load();
+    }
+}
+
+int main() {
+    testGuardDefersFreeing();
+    testFullQueueHandsObjectBack();
+    testRendererKeepsOverflowedPlayers();
+    testGuardedReadsNeverSeeFreedObjects();
+    return testResult();
+}
@@ -0,0 +1,104 @@
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "OfflineRenderer.h"
+#include "audio/MemoryDataSource.h"
+
+#include "TestUtils.h"
+
+/**
+ * Schedules players to start and stop at frames that fall inside a buffer, for several buffer
+ * sizes, and checks that the output starts on exactly the scheduled frame.
+ */
+
+namespace {
+    constexpr AudioProperties kProperties = {.channelCount = 2, .sampleRate = 48000};
+    constexpr AudioProperties kMonoProperties = {.channelCount = 1, .sampleRate = 48000};
+    // 5 ms, the declick ramp a scheduled pause fades out over
+    constexpr int64_t kDeclickFrames = kProperties.sampleRate / 200;
+
+    Player *addConstantPlayer(OfflineRenderer &renderer, AudioProperties properties, int32_t frameCount, float level) {
+        std::vector<float> samples(static_cast<size_t>(frameCount * properties.channelCount), level);
+        return renderer.addPlayer(std::make_unique<Player>(new MemoryDataSource(std::move(samples), properties), kProperties.channelCount,
+                                                           1, VoiceStealingPolicy::oldest, Interpolation::linear));
+    }
+
+    int64_t findFirstNonZeroFrame(const std::vector<float> &output) {
+        for (size_t i = 0; i < output.size(); ++i) {
+            if (output[i] != 0) return static_cast<int64_t>(i) / kProperties.channelCount;
+        }
+        return -1;
+    }
+
+    void testOnsetIsSampleExact(int32_t framesPerBuffer) {
+        constexpr int64_t kStartFrame = 1237;
+        OfflineRenderer renderer(kProperties, framesPerBuffer);
+        renderer.postCommand({.type = AudioCommandType::setLimiterEnabled, .boolValue = false});
+        Player *player = addConstantPlayer(renderer, kProperties, 4800, 0.5f);
+
+        renderer.postCommand({.type = AudioCommandType::schedulePlaying, .player = player, .boolValue = true, .intValue = kStartFrame});
+        const auto output = renderer.renderToBuffer(4000);
+
+        CHECK(findFirstNonZeroFrame(output) == kStartFrame);
+        CHECK(output[kStartFrame * kProperties.channelCount] == 0.5f);
+        CHECK(output[kStartFrame * kProperties.channelCount + 1] == 0.5f);
+    }
+
+    // Scheduled after rendering started, for a frame a few buffers ahead
+    void testOnsetScheduledWhileRunning(int32_t framesPerBuffer) {
+        constexpr int64_t kRenderedFrames = 1000;
+        constexpr int64_t kStartFrame = 2345;
+        OfflineRenderer renderer(kProperties, framesPerBuffer);
+        renderer.postCommand({.type = AudioCommandType::setLimiterEnabled, .boolValue = false});
+        Player *player = addConstantPlayer(renderer, kProperties, 4800, 0.5f);
+
+        auto output = renderer.renderToBuffer(kRenderedFrames);
+        renderer.postCommand({.type = AudioCommandType::schedulePlaying, .player = player, .boolValue = true, .intValue = kStartFrame});
+        const auto rest = renderer.renderToBuffer(4000);
+        output.insert(output.end(), rest.begin(), rest.end());
+
+        CHECK(findFirstNonZeroFrame(output) == kStartFrame);
+    }
+
+    // Two players started and stopped at unrelated frames, the output is their exact sum outside
+    // the fade out of the stop
+    void testStartAndStop(int32_t framesPerBuffer) {
+        constexpr int64_t kStartFrame = 1237;
+        constexpr int64_t kStopFrame = kStartFrame + 333;
+        constexpr int64_t kOtherStartFrame = 777;
+        constexpr int32_t kOtherFrameCount = 2000;
+        OfflineRenderer renderer(kProperties, framesPerBuffer);
+        renderer.postCommand({.type = AudioCommandType::setLimiterEnabled, .boolValue = false});
+        Player *player = addConstantPlayer(renderer, kProperties, 4800, 0.5f);
+        Player *other = addConstantPlayer(renderer, kMonoProperties, kOtherFrameCount, 0.25f);
+
+        // Out of order on purpose, the player keeps its events sorted
+        renderer.postCommand({.type = AudioCommandType::schedulePlaying, .player = player, .boolValue = false, .intValue = kStopFrame});
+        renderer.postCommand({.type = AudioCommandType::schedulePlaying, .player = player, .boolValue = true, .intValue = kStartFrame});
+        renderer.postCommand({.type = AudioCommandType::schedulePlaying, .player = other, .boolValue = true, .intValue = kOtherStartFrame});
+        const auto output = renderer.renderToBuffer(4000);
+
+        int64_t mismatchedFrameCount = 0;
+        for (int64_t frame = 0; frame < 4000; ++frame) {
+            if (frame >= kStopFrame && frame < kStopFrame + kDeclickFrames) continue;
+            float expected = 0;
+            if (frame >= kStartFrame && frame < kStopFrame) expected += 0.5f;
+            if (frame >= kOtherStartFrame && frame < kOtherStartFrame + kOtherFrameCount) expected += 0.25f;
+            for (int32_t channel = 0; channel < kProperties.channelCount; ++channel) {
+                if (std::fabs(output[frame * kProperties.channelCount + channel] - expected) > 1e-6f) mismatchedFrameCount++;
+            }
+        }
+        CHECK(mismatchedFrameCount == 0);
+    }
+}
+
+int main() {
+    for (const int32_t framesPerBuffer: {64, 192, 256, 1000}) {
+        testOnsetIsSampleExact(framesPerBuffer);
+        testOnsetScheduledWhileRunning(framesPerBuffer);
+        testStartAndStop(framesPerBuffer);
+    }
+    return testResult();
+}
@@ -0,0 +1,40 @@
+#ifndef AUDIOPLAYBACK_TESTUTILS_H
+#define AUDIOPLAYBACK_TESTUTILS_H
+
+#include <cmath>
+#include <cstdio>
+
+/**
+ * The host tests are plain executables run by ctest. A failed check prints where it failed and
+ * makes testResult() return non-zero, the test keeps running so that one run reports every failure.
+ */
+inline int gFailedCheckCount = 0;
+
+#define CHECK(condition)                                                                      \
+    do {                                                                                      \
+        if (!(condition)) {                                                                   \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            gFailedCheckCount++;                                                              \
+        }                                                                                     \
+    } while (false)
+
+#define CHECK_NEAR(actual, expected, tolerance)                                               \
+    do {                                                                                      \
+        const double checkActual = (actual);                                                  \
+        const double checkExpected = (expected);                                              \
+        if (!(std::fabs(checkActual - checkExpected) <= (tolerance))) {                       \
+            std::fprintf(stderr, "%s:%d: CHECK_NEAR(%s, %s) failed: %.9g vs %.9g\n",          \
+                         __FILE__, __LINE__, #actual, #expected, checkActual, checkExpected); \
+            gFailedCheckCount++;                                                              \
+        }                                                                                     \
+    } while (false)
+
+inline int testResult() {
+    if (gFailedCheckCount > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", gFailedCheckCount);
+        return 1;
+    }
+    return 0;
+}
+
+#endif //AUDIOPLAYBACK_TESTUTILS_H
@@ -0,0 +1,73 @@
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "OfflineRenderer.h"
+#include "audio/MemoryDataSource.h"
+
+#include "TestUtils.h"
+
+/**
+ * Triggers a player with a single voice to hand out while that voice is still playing, so the
+ * voice is stolen. The stolen voice has to fade out before it restarts, cutting it would jump from
+ * wherever its waveform was to the start of the sound.
+ */
+
+namespace {
+    constexpr AudioProperties kProperties = {.channelCount = 1, .sampleRate = 48000};
+    constexpr int32_t kFramesPerBuffer = 192;
+    // 5 ms, the declick ramp of Player
+    constexpr int32_t kDeclickFrames = kProperties.sampleRate / 200;
+    constexpr int32_t kStealFrame = 25 * kFramesPerBuffer;
+
+    // A rising ramp, so the start of the sound is far from wherever the stolen voice is
+    float sourceSample(int64_t frame) {
+        return static_cast<float>(frame) / static_cast<float>(kProperties.sampleRate);
+    }
+
+    void testStolenVoiceFadesOut(float playbackRate) {
+        std::vector<float> samples(kProperties.sampleRate);
+        for (size_t i = 0; i < samples.size(); ++i) {
+            samples[i] = sourceSample(static_cast<int64_t>(i));
+        }
+
+        OfflineRenderer renderer(kProperties, kFramesPerBuffer);
+        renderer.postCommand({.type = AudioCommandType::setLimiterEnabled, .boolValue = false});
+        // The primary voice is never stolen, so this leaves one voice for triggering
+        Player *player = renderer.addPlayer(std::make_unique<Player>(new MemoryDataSource(std::move(samples), kProperties),
+                                                                     kProperties.channelCount, 2, VoiceStealingPolicy::oldest,
+                                                                     Interpolation::linear));
+        const AudioCommand trigger = {.type = AudioCommandType::trigger, .player = player, .floatValue = 1, .pan = 0,
+                                      .playbackRate = playbackRate};
+
+        renderer.postCommand(trigger);
+        auto output = renderer.renderToBuffer(kStealFrame);
+        renderer.postCommand(trigger);
+        const auto afterSteal = renderer.renderToBuffer(kDeclickFrames * 4);
+        output.insert(output.end(), afterSteal.begin(), afterSteal.end());
+        // A command posted between renders lands the limiter's delay into the next output
+        const int32_t stealFrame = kStealFrame + renderer.getLatencyFrames();
+
+        // The sound moves by playbackRate / sampleRate per frame, the fade by at most its level
+        // over the declick ramp
+        const float stolenLevel = sourceSample(static_cast<int64_t>(stealFrame * playbackRate));
+        const float maxStep = stolenLevel / static_cast<float>(kDeclickFrames) + 2 * playbackRate / kProperties.sampleRate;
+        float largestStep = 0;
+        for (size_t i = 1; i < output.size(); ++i) {
+            largestStep = std::max(largestStep, std::fabs(output[i] - output[i - 1]));
+        }
+        CHECK(largestStep <= maxStep);
+
+        // Silent once faded out, then the sound starts over
+        CHECK_NEAR(output[stealFrame + kDeclickFrames], 0, 1e-6);
+        const int32_t restartedFrames = kDeclickFrames * 2;
+        CHECK_NEAR(output[stealFrame + kDeclickFrames + restartedFrames],
+                   sourceSample(static_cast<int64_t>(restartedFrames * playbackRate)), 1e-4);
+    }
+}
+
+int main() {
+    testStolenVoiceFadesOut(1);
+    testStolenVoiceFadesOut(1.5f);
+    return testResult();
+}
@@ -1,7 +1,11 @@
 import { StyleSheet, ScrollView, SafeAreaView } from 'react-native';
 
 import { usePlayers } from './hooks';
-import { PlayerControl, StreamControl } from './components';
+import {
+  ControlCallBenchmark,
+  PlayerControl,
+  StreamControl,
+} from './components';
 import { MultiPlayersControl } from './components/MultiPlayersControl';
 
 export default function App() {
@@ -18,6 +22,7 @@ export default function App() {
           players={playerObjects}
           onPlayerPress={onPlayerPressed}
         />
+        <ControlCallBenchmark />
       </ScrollView>
     </SafeAreaView>
   );
@@ -0,0 +1,132 @@
+import { useState } from 'react';
+import {
+  NativeModules,
+  StyleSheet,
+  Text,
+  TurboModuleRegistry,
+  View,
+} from 'react-native';
+
+import { Button } from './Button';
+import { Section } from './Section';
+
+// setSoundsVolume returns as soon as the module has queued it, getSoundsPosition waits for the
+// engine on both paths
+type ControlCalls = {
+  setSoundsVolume: (arg: Array<[number, number]>) => void;
+  getSoundsPosition: (ids: Array<number>) => Array<number>;
+};
+
+type Path = 'jsi' | 'module';
+
+interface BenchmarkResult {
+  call: keyof ControlCalls;
+  path: Path;
+  batchSize: number;
+  perCallUs: number;
+  perCommandUs: number;
+}
+
+const BATCH_SIZES = [1, 10, 100];
+const ITERATIONS = 1000;
+const WARMUP_ITERATIONS = 50;
+// Handles are always positive, so the engine finds no sound and only the call itself is timed
+const SOUND_ID = 0;
+
+// Both paths are reached directly, AudioManager always takes the JSI one when it is there
+function getPaths(): Partial<Record<Path, ControlCalls>> {
+  const module =
+    TurboModuleRegistry.get<any>('AudioPlayback') ?? NativeModules.AudioPlayback;
+  if (!module) {
+    return {};
+  }
+  if (!module.installJsiBindings()) {
+    return { module };
+  }
+  // @ts-expect-error
+  const hostObject = global.__AudioPlayback;
+  return {
+    module,
+    jsi: {
+      setSoundsVolume: hostObject.setSoundsVolume,
+      getSoundsPosition: hostObject.getSoundsPosition,
+    },
+  };
+}
+
+function timeCalls(call: () => void): number {
+  for (let i = 0; i < WARMUP_ITERATIONS; i++) {
+    call();
+  }
+  const start = performance.now();
+  for (let i = 0; i < ITERATIONS; i++) {
+    call();
+  }
+  return ((performance.now() - start) * 1000) / ITERATIONS;
+}
+
+function runBenchmark(): Array<BenchmarkResult> {
+  const results: Array<BenchmarkResult> = [];
+  const paths = getPaths();
+
+  for (const batchSize of BATCH_SIZES) {
+    const volumes = Array.from(
+      { length: batchSize },
+      () => [SOUND_ID, 1] as [number, number]
+    );
+    const ids = Array.from({ length: batchSize }, () => SOUND_ID);
+
+    for (const path of ['jsi', 'module'] as const) {
+      const calls = paths[path];
+      if (!calls) {
+        continue;
+      }
+      const measurements: Array<[keyof ControlCalls, number]> = [
+        ['setSoundsVolume', timeCalls(() => calls.setSoundsVolume(volumes))],
+        ['getSoundsPosition', timeCalls(() => calls.getSoundsPosition(ids))],
+      ];
+      for (const [call, perCallUs] of measurements) {
+        results.push({
+          call,
+          path,
+          batchSize,
+          perCallUs,
+          perCommandUs: perCallUs / batchSize,
+        });
+      }
+    }
+  }
+  return results;
+}
+
+export function ControlCallBenchmark() {
+  const [results, setResults] = useState<Array<BenchmarkResult>>([]);
+
+  return (
+    <Section title="Control Call Benchmark">
+      <Button title="Run" onPress={() => setResults(runBenchmark())} />
+      <View style={styles.results}>
+        {results.map((result) => (
+          <Text
+            key={`${result.call}-${result.path}-${result.batchSize}`}
+            style={styles.result}
+          >
+            {`${result.call} ${result.path} x${result.batchSize}: ` +
+              `${result.perCallUs.toFixed(1)}µs/call, ` +
+              `${result.perCommandUs.toFixed(2)}µs/command`}
+          </Text>
+        ))}
+      </View>
+    </Section>
+  );
+}
+
+const styles = StyleSheet.create({
+  results: {
+    width: '100%',
+  },
+  result: {
+    fontFamily: 'monospace',
+    fontSize: 12,
+  },
+});
@@ -2,3 +2,4 @@ export * from './Button';
 export * from './Section';
 export * from './PlayerControl';
 export * from './StreamControl';
+export * from './ControlCallBenchmark';
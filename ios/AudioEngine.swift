@@ -54,7 +54,9 @@ class AudioEngine {
   private let desiredCommonFormat: AVAudioCommonFormat = .pcmFormatFloat32
   private let desiredInterleaved: Bool = true
   private var audioUnit: AudioUnit?
-  private var players = [String: Player]()
+  private var players = [Int: Player]()
+  // Sound ids are never reused, so a stale id can't reach a newer sound
+  private var nextPlayerId = 1
   private var audioStreamState: AudioStreamState = .closed
   private var interruptionState: InterruptionState?
 
@@ -224,7 +226,7 @@ class AudioEngine {
     }
   }
 
-  @objc public func loadAudioWith(localFileUrl: URL) throws -> String  {
+  @objc public func loadAudioWith(localFileUrl: URL) throws -> Int  {
     let audioFile: AVAudioFile
     do {
       audioFile = try AVAudioFile(forReading: localFileUrl)
@@ -289,48 +291,66 @@ class AudioEngine {
       }
     }
 
-    let uuid = UUID()
+    let id = nextPlayerId
+    nextPlayerId += 1
 
 
     let player = Player(source: DataSource(sampleCount: Int(audioFile.length * 2), data: audioBuffer, sampleRate: desiredSampleRate, channelCount: desiredChannelCount))
-    self.players[uuid.uuidString] = player
-    return uuid.uuidString
+    self.players[id] = player
+    return id
   }
 
-  @objc public func unloadSound(id: String) throws {
+  @objc public func unloadSound(id: Int) throws {
     guard players.removeValue(forKey: id) != nil else {
       throw AudioEngineError.failedToUnloadSound
     }
   }
 
-  public func playSounds(_ args: [(String, Bool)]) {
+  public func playSounds(_ args: [(Int, Bool)]) {
     for (id, isPlaying) in args {
       guard let player = players[id] else { continue }
       player.setIsPlaying(isPlaying)
     }
   }
 
-  public func loopSounds(_ args: [(String, Bool)]) {
+  public func loopSounds(_ args: [(Int, Bool)]) {
     for (id, isLooping) in args {
       guard let player = players[id] else { continue }
       player.setIsLooping(isLooping)
     }
   }
 
-  public func seekSoundsTo(_ args: [(String, Double)]) {
+  public func seekSoundsTo(_ args: [(Int, Double)]) {
     for (id, timeInMs) in args {
       guard let player = players[id] else { continue }
       player.seekTo(timeInMs)
     }
   }
 
-  public func setSoundsVolume(_ args: [(String, Double)]) {
+  public func setSoundsVolume(_ args: [(Int, Double)]) {
     for (id, volume) in args {
       guard let player = players[id] else { continue }
       player.setVolume(Float(volume))
     }
   }
 
+  public func fadeSounds(_ args: [(Int, Float, Double, Bool)]) {
+    for (id, volume, durationMs, stopAtEnd) in args {
+      guard let player = players[id] else { continue }
+      player.fade(to: volume, durationMs: durationMs, stopAtEnd: stopAtEnd)
+    }
+  }
+
+  // Only a single voice per sound on iOS, triggering restarts it
+  public func triggerSounds(_ args: [(Int, Double)]) {
+    for (id, volume) in args {
+      guard let player = players[id] else { continue }
+      player.seekTo(0)
+      player.setVolume(Float(volume))
+      player.setIsPlaying(true)
+    }
+  }
+
   public func pauseAudioStream() throws {
     guard let audioUnit else {
       throw AudioEngineError.failedToPauseAudioStream(reason: "No stream to pause found.")
@@ -64,13 +64,53 @@ RCT_EXPORT_SYNCHRONOUS_TYPED_METHOD(NSDictionary *, closeAudioStream) {
   return @{@"error":error?: [NSNull null]};
 }
 
-RCT_EXPORT_METHOD(loadSound:(NSString *)uri resolve:(RCTPromiseResolveBlock)resolve reject:(RCTPromiseRejectBlock)reject) {
-  [moduleImpl loadSoundWithUri:uri completion:^(NSString * _Nullable soundId, NSString * _Nullable error) {
+RCT_EXPORT_METHOD(reconfigureStream:(double)sampleRate channelCount:(double)channelCount resolve:(RCTPromiseResolveBlock)resolve reject:(RCTPromiseRejectBlock)reject) {
+  resolve(@{@"error": @"Reconfiguring the stream is only implemented on Android", @"unloadedSoundIds": @[]});
+}
+
+// Streaming is not implemented on iOS yet, sounds are always fully loaded into memory
+#ifdef RCT_NEW_ARCH_ENABLED
+RCT_EXPORT_METHOD(loadSound:(NSString *)uri options:(JS::NativeAudioPlayback::SpecLoadSoundOptions &)options resolve:(RCTPromiseResolveBlock)resolve reject:(RCTPromiseRejectBlock)reject) {
+  [moduleImpl loadSoundWithUri:uri completion:^(NSNumber * _Nullable soundId, NSString * _Nullable error) {
+    resolve(@{@"error": error?: [NSNull null], @"id": soundId?: [NSNull null]});
+  }];
+}
+#else
+RCT_EXPORT_METHOD(loadSound:(NSString *)uri options:(NSDictionary *)options resolve:(RCTPromiseResolveBlock)resolve reject:(RCTPromiseRejectBlock)reject) {
+  [moduleImpl loadSoundWithUri:uri completion:^(NSNumber * _Nullable soundId, NSString * _Nullable error) {
     resolve(@{@"error": error?: [NSNull null], @"id": soundId?: [NSNull null]});
   }];
 }
+#endif
+
+RCT_EXPORT_METHOD(loadSounds:(double)requestId sounds:(NSArray *)sounds resolve:(RCTPromiseResolveBlock)resolve reject:(RCTPromiseRejectBlock)reject) {
+  [moduleImpl loadSoundsWithSounds:sounds completion:^(NSArray * _Nonnull results) {
+    resolve(results);
+  }];
+}
 
-RCT_EXPORT_SYNCHRONOUS_TYPED_METHOD(NSDictionary *, unloadSound:(NSString *)id) {
+RCT_EXPORT_METHOD(cancelLoadSounds:(double)requestId) {
+}
+
+// Decoded sounds are not cached on iOS
+RCT_EXPORT_METHOD(setDecodedCacheOptions:(double)maxBytes storeFloat:(BOOL)storeFloat) {
+}
+
+// Sounds are never evicted on iOS, there is nothing to limit or prefetch
+RCT_EXPORT_METHOD(setMemoryBudget:(double)bytes) {
+}
+
+RCT_EXPORT_METHOD(prefetchSounds:(NSArray *)ids) {
+}
+
+// Load progress and playback events are only emitted on Android
+RCT_EXPORT_METHOD(addListener:(NSString *)eventName) {
+}
+
+RCT_EXPORT_METHOD(removeListeners:(double)count) {
+}
+
+RCT_EXPORT_SYNCHRONOUS_TYPED_METHOD(NSDictionary *, unloadSound:(double)id) {
   NSString *error = [moduleImpl unloadSoundWithId:id];
 
   return @{@"error":error?: [NSNull null]};
@@ -94,10 +134,72 @@ RCT_EXPORT_METHOD(setSoundsVolume:(NSArray *)arg) {
   [moduleImpl setSoundsVolumeWithArg:arg];
 }
 
+RCT_EXPORT_METHOD(triggerSounds:(NSArray *)arg) {
+  [moduleImpl triggerSoundsWithArg:arg];
+}
+
+// Pan and playback rate are only implemented on Android
+RCT_EXPORT_METHOD(setSoundsPan:(NSArray *)arg) {
+}
+
+RCT_EXPORT_METHOD(setSoundsPlaybackRate:(NSArray *)arg) {
+}
+
 RCT_EXPORT_SYNCHRONOUS_TYPED_METHOD(NSNumber *, getStreamState) {
   return @([moduleImpl getAudioStreamState]);
 }
 
+RCT_EXPORT_METHOD(fadeSounds:(NSArray *)arg) {
+  [moduleImpl fadeSoundsWithArg:arg];
+}
+
+// Mix buses and the master limiter are only implemented on Android
+RCT_EXPORT_METHOD(setSoundsBus:(NSArray *)arg) {
+}
+
+RCT_EXPORT_METHOD(setBusesGain:(NSArray *)arg) {
+}
+
+RCT_EXPORT_METHOD(setBusesMuted:(NSArray *)arg) {
+}
+
+RCT_EXPORT_METHOD(setLimiterEnabled:(BOOL)enabled) {
+}
+
+RCT_EXPORT_METHOD(setLatencyTuning:(BOOL)enabled
+                  aggressiveness:(double)aggressiveness
+                  maxLatencyMs:(double)maxLatencyMs) {
+}
+
+// Markers and positions are only implemented on Android, positions are always unknown here
+RCT_EXPORT_METHOD(setSoundsMarkers:(NSArray *)arg) {
+}
+
+RCT_EXPORT_SYNCHRONOUS_TYPED_METHOD(NSArray *, getSoundsPosition:(NSArray *)ids) {
+  NSMutableArray *positions = [NSMutableArray arrayWithCapacity:ids.count];
+  for (NSUInteger i = 0; i < ids.count; i++) {
+    [positions addObject:@(-1)];
+  }
+  return positions;
+}
+
+RCT_EXPORT_METHOD(scheduleSounds:(NSArray *)arg) {
+  [moduleImpl scheduleSoundsWithArg:arg];
+}
+
+RCT_EXPORT_SYNCHRONOUS_TYPED_METHOD(NSDictionary *, getStreamPosition) {
+  return [moduleImpl getStreamPosition];
+}
+
+RCT_EXPORT_SYNCHRONOUS_TYPED_METHOD(NSDictionary *, getEngineStats) {
+  return [moduleImpl getEngineStats];
+}
+
+// The control calls go through the module on iOS, JS falls back to it when this returns NO
+RCT_EXPORT_SYNCHRONOUS_TYPED_METHOD(NSNumber *, installJsiBindings) {
+  return @NO;
+}
+
 
 // Don't compile this code when we build for the old architecture.
 #ifdef RCT_NEW_ARCH_ENABLED
@@ -10,6 +10,45 @@ import AudioToolbox
     return Double(audioEngine.getStreamState().rawValue)
   }
 
+  // The render callback is not instrumented on iOS yet, report empty stats with the same shape
+  @objc public func getEngineStats() -> NSDictionary {
+    return [
+      "callbackCount": 0,
+      "lastCallbackDurationUs": 0,
+      "maxCallbackDurationUs": 0,
+      "averageCallbackDurationUs": 0,
+      "lastFrameCount": 0,
+      "activePlayerCount": 0,
+      "callbackLoadHistogram": [Int](repeating: 0, count: 11),
+      "overrunCount": 0,
+      "xRunCount": -1,
+      "pendingReclamationCount": 0,
+      "reclaimedCount": 0,
+      "decodedCacheHitCount": 0,
+      "decodedCacheMissCount": 0,
+      "decodedCacheBytesSaved": 0,
+      "soundHeapBytes": 0,
+      "soundMappedBytes": 0,
+      "memoryBudgetBytes": 0,
+      "residentSoundBytes": 0,
+      "evictedSoundCount": 0,
+      "evictionCount": 0,
+      "reloadCount": 0,
+      "lastReloadDurationMs": 0,
+      "maxReloadDurationMs": 0,
+      "limiterGainReductionDb": 0,
+      "bufferSizeFrames": 0,
+      "framesPerBurst": 0,
+      "bufferCapacityFrames": 0,
+      "bufferLatencyMs": 0,
+      "outputLatencyMs": -1,
+      "limiterLatencyMs": 0,
+      "bufferSizeIncreaseCount": 0,
+      "bufferSizeDecreaseCount": 0,
+      "bufferSizeHistory": [],
+    ]
+  }
+
   @objc public func setupAudioStream(
     sampleRate: Double,
     channelCount: Double,
@@ -45,22 +84,62 @@ import AudioToolbox
   }
 
   @objc public func loopSounds(arg: NSArray) {
-    audioEngine.loopSounds(convertNSArrayToArrayOfStringBoolTuples(arg))
+    audioEngine.loopSounds(convertNSArrayToArrayOfIntBoolTuples(arg))
   }
 
   @objc public func playSounds(arg: NSArray) {
-    audioEngine.playSounds(convertNSArrayToArrayOfStringBoolTuples(arg))
+    audioEngine.playSounds(convertNSArrayToArrayOfIntBoolTuples(arg))
   }
 
   @objc public func seekSoundsTo(arg: NSArray) {
-    audioEngine.seekSoundsTo(convertNSArrayToArrayOfStringDoubleTuples(arg))
+    audioEngine.seekSoundsTo(convertNSArrayToArrayOfIntDoubleTuples(arg))
   }
 
   @objc public func setSoundsVolume(arg: NSArray) {
-    audioEngine.setSoundsVolume(convertNSArrayToArrayOfStringDoubleTuples(arg))
+    audioEngine.setSoundsVolume(convertNSArrayToArrayOfIntDoubleTuples(arg))
+  }
+
+  // Pan and playback rate are not supported on iOS yet
+  @objc public func triggerSounds(arg: NSArray) {
+    let pairs = arg.compactMap { element -> (Int, Double)? in
+      guard let request = element as? NSDictionary,
+            let id = request["id"] as? Int,
+            let volume = request["volume"] as? Double else { return nil }
+      return (id, volume)
+    }
+    audioEngine.triggerSounds(pairs)
+  }
+
+  @objc public func fadeSounds(arg: NSArray) {
+    let requests = arg.compactMap { element -> (Int, Float, Double, Bool)? in
+      guard let request = element as? NSDictionary,
+            let id = request["id"] as? Int,
+            let targetVolume = request["targetVolume"] as? Double,
+            let durationMs = request["durationMs"] as? Double else { return nil }
+      return (id, Float(targetVolume), durationMs, request["stopAtEnd"] as? Bool ?? false)
+    }
+    audioEngine.fadeSounds(requests)
+  }
+
+  // The render callback doesn't split buffers on iOS yet, scheduled sounds start right away
+  @objc public func scheduleSounds(arg: NSArray) {
+    let pairs = arg.compactMap { element -> (Int, Bool)? in
+      guard let request = element as? NSDictionary,
+            let id = request["id"] as? Int,
+            let play = request["play"] as? Bool else { return nil }
+      return (id, play)
+    }
+    audioEngine.playSounds(pairs)
   }
 
-  @objc public func loadSound(uri: String, completion: @escaping (_ id:String?, _ error: String?) -> Void) {
+  @objc public func getStreamPosition() -> NSDictionary {
+    return [
+      "framePosition": 0,
+      "hostTimeNs": Double(DispatchTime.now().uptimeNanoseconds),
+    ]
+  }
+
+  @objc public func loadSound(uri: String, completion: @escaping (_ id:NSNumber?, _ error: String?) -> Void) {
     let isLocalFile = uri.hasPrefix("file://")
     let url = URL(string: uri)
 
@@ -72,7 +151,7 @@ import AudioToolbox
     let cb = {(_ localFileUrl: URL) in
       do {
         let id = try self.audioEngine.loadAudioWith(localFileUrl: localFileUrl)
-        completion(id, nil)
+        completion(NSNumber(value: id), nil)
       } catch let error as AudioEngineError {
         completion(nil, error.localizedDescription)
       } catch {
@@ -94,9 +173,35 @@ import AudioToolbox
     }
   }
 
-  @objc public func unloadSound(id: String) -> String? {
+  // Sounds are loaded one after the other, progress events and cancellation are Android only for now
+  @objc public func loadSounds(sounds: NSArray, completion: @escaping (_ results: NSArray) -> Void) {
+    let uris = sounds.map { ($0 as? NSDictionary)?["uri"] as? String }
+    var results = [NSDictionary](repeating: [:], count: uris.count)
+    let group = DispatchGroup()
+
+    for (index, uri) in uris.enumerated() {
+      guard let uri else {
+        results[index] = ["id": NSNull(), "error": "Invalid sound at index \(index)"]
+        continue
+      }
+
+      group.enter()
+      loadSound(uri: uri) { id, error in
+        DispatchQueue.main.async {
+          results[index] = ["id": id ?? NSNull(), "error": error ?? NSNull()]
+          group.leave()
+        }
+      }
+    }
+
+    group.notify(queue: .main) {
+      completion(results as NSArray)
+    }
+  }
+
+  @objc public func unloadSound(id: Double) -> String? {
     do {
-      try audioEngine.unloadSound(id: id)
+      try audioEngine.unloadSound(id: Int(id))
       return nil
     } catch let error as AudioEngineError {
       return error.localizedDescription
@@ -142,12 +247,12 @@ import AudioToolbox
     }.resume()
   }
 
-  private func convertNSArrayToArrayOfStringBoolTuples(_ array: NSArray) -> [(String, Bool)] {
-    var result: [(String, Bool)] = []
+  private func convertNSArrayToArrayOfIntBoolTuples(_ array: NSArray) -> [(Int, Bool)] {
+    var result: [(Int, Bool)] = []
     for item in array {
       if let  subArray = item as? NSArray,
          subArray.count == 2,
-         let key = subArray[0] as? String,
+         let key = subArray[0] as? Int,
          let value = subArray[1] as? Bool {
         result.append((key, value))
       }
@@ -155,12 +260,12 @@ import AudioToolbox
     return result
   }
 
-  private func convertNSArrayToArrayOfStringDoubleTuples(_ array: NSArray) -> [(String, Double)] {
-    var result: [(String, Double)] = []
+  private func convertNSArrayToArrayOfIntDoubleTuples(_ array: NSArray) -> [(Int, Double)] {
+    var result: [(Int, Double)] = []
     for item in array {
       if let  subArray = item as? NSArray,
          subArray.count == 2,
-         let key = subArray[0] as? String,
+         let key = subArray[0] as? Int,
          let value = subArray[1] as? Double {
         result.append((key, value))
       }
@@ -15,6 +15,10 @@ class Player: RenderableAudio {
   private var mIsLooping: Bool = false
   private var mSource: DataSource
   private var mReadFrameIndex: Int = 0
+  private var mFadeTarget: Float = 1
+  private var mFadeStep: Float = 0
+  private var mFadeFramesRemaining: Int = 0
+  private var mStopAtFadeEnd: Bool = false
 
   public func setIsPlaying(_ isPlaying: Bool) {
     mIsPlaying = isPlaying
@@ -26,6 +30,30 @@ class Player: RenderableAudio {
 
   public func setVolume(_ volume: Float) {
     mVolume = volume
+    mFadeFramesRemaining = 0
+    mStopAtFadeEnd = false
+  }
+
+  // Always linear on iOS
+  public func fade(to volume: Float, durationMs: Double, stopAtEnd: Bool) {
+    let frames = Int(durationMs / 1000 * mSource.sampleRate)
+    guard mIsPlaying, frames > 0 else {
+      mVolume = volume
+      mFadeFramesRemaining = 0
+      if stopAtEnd { stop() }
+      return
+    }
+
+    mFadeTarget = volume
+    mFadeStep = (volume - mVolume) / Float(frames)
+    mFadeFramesRemaining = frames
+    mStopAtFadeEnd = stopAtEnd
+  }
+
+  private func stop() {
+    mIsPlaying = false
+    mReadFrameIndex = 0
+    mStopAtFadeEnd = false
   }
 
   public func seekTo(_ timeInMs: Double) {
@@ -52,6 +80,15 @@ class Player: RenderableAudio {
       }
 
       for i in 0..<framesToRenderFromData {
+        if mFadeFramesRemaining > 0 {
+          mFadeFramesRemaining -= 1
+          mVolume = mFadeFramesRemaining == 0 ? mFadeTarget : mVolume + mFadeStep
+          if mFadeFramesRemaining == 0 && mStopAtFadeEnd {
+            stop()
+            break
+          }
+        }
+
         for j in 0..<mSource.channelCount {
           audioData[i * mSource.channelCount + j] += (mVolume * data[Int(mReadFrameIndex) * mSource.channelCount + j])
         }
@@ -15,15 +15,126 @@ export interface Spec extends TurboModule {
   openAudioStream: () => { error: string | null };
   pauseAudioStream: () => { error: string | null };
   closeAudioStream: () => { error: string | null };
-  loopSounds: (arg: Array<[string, boolean]>) => void;
-  playSounds: (arg: Array<[string, boolean]>) => void;
-  seekSoundsTo: (arg: Array<[string, number]>) => void;
-  setSoundsVolume: (arg: Array<[string, number]>) => void;
-  unloadSound: (id: string) => void;
+  reconfigureStream: (
+    sampleRate: number,
+    channelCount: number
+  ) => Promise<{ error: string | null; unloadedSoundIds: Array<number> }>;
+  loopSounds: (arg: Array<[number, boolean]>) => void;
+  playSounds: (arg: Array<[number, boolean]>) => void;
+  seekSoundsTo: (arg: Array<[number, number]>) => void;
+  setSoundsVolume: (arg: Array<[number, number]>) => void;
+  triggerSounds: (
+    arg: Array<{
+      id: number;
+      volume: number;
+      pan: number;
+      playbackRate: number;
+    }>
+  ) => void;
+  setSoundsPan: (arg: Array<[number, number]>) => void;
+  setSoundsPlaybackRate: (arg: Array<[number, number]>) => void;
+  fadeSounds: (
+    arg: Array<{
+      id: number;
+      targetVolume: number;
+      durationMs: number;
+      stopAtEnd: boolean;
+      curve: number;
+    }>
+  ) => void;
+  setSoundsMarkers: (arg: Array<[number, Array<number>]>) => void;
+  getSoundsPosition: (ids: Array<number>) => Array<number>;
+  setSoundsBus: (arg: Array<[number, string]>) => void;
+  setBusesGain: (arg: Array<[string, number]>) => void;
+  setBusesMuted: (arg: Array<[string, boolean]>) => void;
+  setLimiterEnabled: (enabled: boolean) => void;
+  setLatencyTuning: (
+    enabled: boolean,
+    aggressiveness: number,
+    maxLatencyMs: number
+  ) => void;
+  scheduleSounds: (
+    arg: Array<{
+      id: number;
+      play: boolean;
+      atFrame: number | null;
+      atHostTimeNs: number | null;
+    }>
+  ) => void;
+  unloadSound: (id: number) => void;
   loadSound: (
-    uri: string
-  ) => Promise<{ id: string | null; error: string | null }>;
+    uri: string,
+    options: {
+      streaming: boolean;
+      readAheadMs: number;
+      resamplerQuality: number;
+      maxVoices: number;
+      voiceStealing: number;
+      storageFormat: number;
+    }
+  ) => Promise<{ id: number | null; error: string | null }>;
+  loadSounds: (
+    requestId: number,
+    sounds: Array<{
+      uri: string;
+      options: {
+        streaming: boolean;
+        readAheadMs: number;
+        resamplerQuality: number;
+        maxVoices: number;
+        voiceStealing: number;
+        storageFormat: number;
+      };
+    }>
+  ) => Promise<Array<{ id: number | null; error: string | null }>>;
+  cancelLoadSounds: (requestId: number) => void;
+  setDecodedCacheOptions: (maxBytes: number, storeFloat: boolean) => void;
+  setMemoryBudget: (bytes: number) => void;
+  prefetchSounds: (ids: Array<number>) => void;
+  addListener: (eventName: string) => void;
+  removeListeners: (count: number) => void;
   getStreamState: () => number;
+  getStreamPosition: () => { framePosition: number; hostTimeNs: number };
+  getEngineStats: () => {
+    callbackCount: number;
+    lastCallbackDurationUs: number;
+    maxCallbackDurationUs: number;
+    averageCallbackDurationUs: number;
+    lastFrameCount: number;
+    activePlayerCount: number;
+    callbackLoadHistogram: Array<number>;
+    overrunCount: number;
+    xRunCount: number;
+    pendingReclamationCount: number;
+    reclaimedCount: number;
+    decodedCacheHitCount: number;
+    decodedCacheMissCount: number;
+    decodedCacheBytesSaved: number;
+    soundHeapBytes: number;
+    soundMappedBytes: number;
+    memoryBudgetBytes: number;
+    residentSoundBytes: number;
+    evictedSoundCount: number;
+    evictionCount: number;
+    reloadCount: number;
+    lastReloadDurationMs: number;
+    maxReloadDurationMs: number;
+    limiterGainReductionDb: number;
+    bufferSizeFrames: number;
+    framesPerBurst: number;
+    bufferCapacityFrames: number;
+    bufferLatencyMs: number;
+    outputLatencyMs: number;
+    limiterLatencyMs: number;
+    bufferSizeIncreaseCount: number;
+    bufferSizeDecreaseCount: number;
+    bufferSizeHistory: Array<{
+      framePosition: number;
+      bufferSizeFrames: number;
+      xRunCount: number;
+    }>;
+  };
+  installJsiBindings: () => boolean;
 }
 
 export default TurboModuleRegistry.getEnforcing<Spec>('AudioPlayback');
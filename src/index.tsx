@@ -3,4 +3,16 @@ export {
   IosAudioSessionCategory,
   AndroidAudioStreamUsage,
   StreamState,
+  ResamplerQuality,
+  FadeCurve,
+  SampleStorageFormat,
+  VoiceStealingPolicy,
+  type BufferSizeChange,
+  type DecodedCacheOptions,
+  type EngineStats,
+  type LatencyTuningOptions,
+  type PlaybackEvent,
+  type ScheduleTime,
+  type TriggerOptions,
+  type StreamPosition,
 } from './types';
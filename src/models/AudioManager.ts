@@ -1,23 +1,74 @@
 import {
+  addPlaybackEventListener,
   closeAudioStream,
+  fadeSounds,
+  loadSounds,
+  getEngineStats,
+  getSoundsPosition,
+  getStreamPosition,
   getStreamState,
   loadSound,
   loopSounds,
   openAudioStream,
   pauseAudioStream,
   playSounds,
+  prefetchSounds,
+  reconfigureStream,
+  scheduleSounds,
   seekSoundsTo,
+  setBusesGain,
+  setBusesMuted,
+  setDecodedCacheOptions,
+  setLatencyTuning,
+  setLimiterEnabled,
+  setMemoryBudget,
+  setSoundsBus,
+  setSoundsMarkers,
+  setSoundsPan,
+  setSoundsPlaybackRate,
   setSoundsVolume,
   setupAudioStream,
+  triggerSounds,
 } from '../module';
 
 import {
   AndroidAudioStreamUsage,
+  type DecodedCacheOptions,
+  type EngineStats,
+  type LatencyTuningOptions,
+  type PlaybackEvent,
+  FadeCurve,
+  type ScheduleTime,
+  type StreamPosition,
   IosAudioSessionCategory,
+  ResamplerQuality,
   StreamState,
+  SampleStorageFormat,
+  type TriggerOptions,
+  VoiceStealingPolicy,
 } from '../types';
 import { Player } from './Player';
 
+type LoadSoundOptions = {
+  streaming?: boolean;
+  readAheadMs?: number;
+  resamplerQuality?: ResamplerQuality;
+  maxVoices?: number;
+  voiceStealing?: VoiceStealingPolicy;
+  storageFormat?: SampleStorageFormat;
+};
+
+function withDefaultLoadSoundOptions(options?: LoadSoundOptions) {
+  return {
+    streaming: options?.streaming ?? false,
+    readAheadMs: options?.readAheadMs ?? 500,
+    resamplerQuality: options?.resamplerQuality ?? ResamplerQuality.Medium,
+    maxVoices: options?.maxVoices ?? 1,
+    voiceStealing: options?.voiceStealing ?? VoiceStealingPolicy.Oldest,
+    storageFormat: options?.storageFormat ?? SampleStorageFormat.Float32,
+  };
+}
+
 export class AudioManager {
   public static shared = new AudioManager();
 
@@ -64,11 +115,61 @@ export class AudioManager {
     closeAudioStream();
   }
 
-  public async loadSound(asset: number) {
-    const id = await loadSound(asset);
+  /**
+   * Switches the open stream to another sample rate or channel count, for example when the output
+   * route changes, without reloading any sound. Loaded sounds are converted in the background
+   * while the current stream keeps playing, then continue on the new stream where they were.
+   * Resolves with the ids of streamed sounds that can't follow a sample rate change and were
+   * unloaded. Only implemented on Android.
+   */
+  public async reconfigureStream(options: {
+    sampleRate?: number;
+    channelCount?: number;
+  }): Promise<Array<number>> {
+    return reconfigureStream(
+      options.sampleRate ?? 44100,
+      options.channelCount ?? 2
+    );
+  }
+
+  public async loadSound(asset: number, options?: LoadSoundOptions) {
+    const id = await loadSound(asset, withDefaultLoadSoundOptions(options));
     return id ? new Player(id) : null;
   }
 
+  /**
+   * Loads several sounds in parallel. Resolves with a Player per sound, in order, or null for the
+   * ones that failed to load or were cancelled through the signal.
+   */
+  public async loadSounds(
+    sounds: ReadonlyArray<{ asset: number; options?: LoadSoundOptions }>,
+    options?: {
+      onProgress?: (progress: {
+        index: number;
+        loaded: number;
+        total: number;
+        error: string | null;
+      }) => void;
+      signal?: AbortSignal;
+    }
+  ): Promise<Array<Player | null>> {
+    let loaded = 0;
+    const onProgress = options?.onProgress;
+
+    const results = await loadSounds(
+      sounds.map(({ asset, options: soundOptions }) => ({
+        requiredAsset: asset,
+        options: withDefaultLoadSoundOptions(soundOptions),
+      })),
+      onProgress
+        ? ({ index, error }) =>
+            onProgress({ index, loaded: ++loaded, total: sounds.length, error })
+        : undefined,
+      options?.signal
+    );
+    return results.map(({ id }) => (id ? new Player(id) : null));
+  }
+
   public loopSounds(args: ReadonlyArray<[Player, boolean]>): void {
     loopSounds(args.map(([player, loop]) => [player.id, loop]));
   }
@@ -85,7 +186,177 @@ export class AudioManager {
     setSoundsVolume(args.map(([player, volume]) => [player.id, volume]));
   }
 
+  /**
+   * Plays a new instance of multiple sounds on top of the ones already playing, each with its own
+   * pan and playback rate, for example a slightly different pitch every time the same sound plays.
+   */
+  public triggerSounds(
+    args: ReadonlyArray<[Player, number] | [Player, number, TriggerOptions]>
+  ): void {
+    triggerSounds(
+      args.map(([player, volume, options]) => ({
+        id: player.id,
+        volume,
+        pan: options?.pan ?? 0,
+        playbackRate: options?.playbackRate ?? 1,
+      }))
+    );
+  }
+
+  /** Pans multiple sounds from -1 (left) to 1 (right), only when the stream is stereo */
+  public setSoundsPan(args: ReadonlyArray<[Player, number]>): void {
+    setSoundsPan(args.map(([player, pan]) => [player.id, pan]));
+  }
+
+  /**
+   * Changes the speed, and with it the pitch, of multiple sounds. 2 plays twice as fast and an
+   * octave higher. Changes are smoothed, so it can follow a value like the RPM of an engine.
+   */
+  public setSoundsPlaybackRate(args: ReadonlyArray<[Player, number]>): void {
+    setSoundsPlaybackRate(
+      args.map(([player, playbackRate]) => [player.id, playbackRate])
+    );
+  }
+
+  /**
+   * Limit the memory taken by loaded sounds. Sounds that are not playing are dropped from memory,
+   * least recently played first, and loaded again when they are next played. Pass 0 to remove the
+   * limit. Only sounds loaded while a budget is set can be dropped.
+   */
+  public setMemoryBudget(bytes: number): void {
+    setMemoryBudget(bytes);
+  }
+
+  /**
+   * Sets how much disk space the decoded sound cache may take and whether float sounds are cached
+   * as float. WAV files and streamed sounds are never cached.
+   */
+  public setDecodedCacheOptions(options: DecodedCacheOptions): void {
+    setDecodedCacheOptions(options);
+  }
+
+  /** Load dropped sounds again ahead of time so that playing them doesn't wait for it */
+  public prefetchSounds(players: ReadonlyArray<Player>): void {
+    prefetchSounds(players.map((player) => player.id));
+  }
+
+  /**
+   * Moves the volume of multiple sounds to `targetVolume` over `durationMs` on the audio thread,
+   * without steps. With `stopAtEnd` the sounds stop and rewind once the fade is done.
+   */
+  public fadeSounds(
+    args: ReadonlyArray<{
+      player: Player;
+      targetVolume: number;
+      durationMs: number;
+      stopAtEnd?: boolean;
+      curve?: FadeCurve;
+    }>
+  ): void {
+    fadeSounds(
+      args.map(({ player, targetVolume, durationMs, stopAtEnd, curve }) => ({
+        id: player.id,
+        targetVolume,
+        durationMs,
+        stopAtEnd: stopAtEnd ?? false,
+        curve: curve ?? FadeCurve.Linear,
+      }))
+    );
+  }
+
+  /**
+   * Routes multiple sounds to a named mix bus, which is created on first use. Sounds start on the
+   * `'default'` bus. Up to 16 buses can exist, including the default one.
+   */
+  public setSoundsBus(args: ReadonlyArray<[Player, string]>): void {
+    setSoundsBus(args.map(([player, bus]) => [player.id, bus]));
+  }
+
+  /** Sets the gain applied to everything on a bus, changes are smoothed so they don't click */
+  public setBusesGain(args: ReadonlyArray<[string, number]>): void {
+    setBusesGain([...args]);
+  }
+
+  public setBusesMuted(args: ReadonlyArray<[string, boolean]>): void {
+    setBusesMuted([...args]);
+  }
+
+  /**
+   * The master limiter keeps the sum of all buses from clipping by turning it down where it would
+   * go over full scale. It is enabled by default and delays the output by 1.5 ms.
+   */
+  public setLimiterEnabled(enabled: boolean): void {
+    setLimiterEnabled(enabled);
+  }
+
+  /**
+   * The engine starts the stream at its smallest buffer size, grows it whenever the device
+   * reports a glitch and shrinks it again after a while without glitches. `getEngineStats` shows
+   * the latency it settled on. When disabled, the buffer keeps its current size.
+   */
+  public setLatencyTuning(options: LatencyTuningOptions): void {
+    setLatencyTuning(options);
+  }
+
+  /**
+   * Plays (or pauses, with `play: false`) multiple sounds at an exact frame instead of at the start
+   * of the next audio buffer. Times are either frames of `getStreamPosition().framePosition` or
+   * monotonic clock times in nanoseconds, see `getStreamPosition().hostTimeNs`. Each sound can
+   * have up to 16 of them pending, further ones are ignored until earlier ones are due.
+   */
+  public scheduleSounds(
+    args: ReadonlyArray<{ player: Player; play?: boolean } & ScheduleTime>
+  ): void {
+    scheduleSounds(
+      args.map(({ player, play, ...time }) => ({
+        id: player.id,
+        play: play ?? true,
+        ...time,
+      }))
+    );
+  }
+
+  /**
+   * Where multiple sounds are in milliseconds, as of the last audio buffer. Reading it never waits
+   * for the audio thread, so it is cheap enough to call every frame. -1 for unloaded sounds, and
+   * always on iOS for now.
+   */
+  public getSoundsPosition(players: ReadonlyArray<Player>): Array<number> {
+    return getSoundsPosition(players.map((player) => player.id));
+  }
+
+  /**
+   * Replaces the markers of multiple sounds, times in milliseconds that emit a `markerReached`
+   * event when playback passes them. Up to 16 markers per sound.
+   */
+  public setSoundsMarkers(
+    args: ReadonlyArray<[Player, ReadonlyArray<number>]>
+  ): void {
+    setSoundsMarkers(
+      args.map(([player, markers]) => [player.id, [...markers]])
+    );
+  }
+
+  /**
+   * Listens for the `ended`, `looped` and `markerReached` events of every sound. The audio thread
+   * queues them without blocking and they arrive in batches every few milliseconds, so there is
+   * no need to poll. Android only for now.
+   */
+  public addPlaybackEventListener(
+    listener: (events: Array<PlaybackEvent>) => void
+  ): { remove: () => void } {
+    return addPlaybackEventListener(listener);
+  }
+
+  public getStreamPosition(): StreamPosition {
+    return getStreamPosition();
+  }
+
   public getStreamState(): StreamState {
     return getStreamState();
   }
+
+  public getEngineStats(): EngineStats {
+    return getEngineStats();
+  }
 }
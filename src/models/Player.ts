@@ -1,15 +1,23 @@
 import {
+  addPlaybackEventListener,
+  getSoundsPosition,
   loopSounds,
   playSounds,
   seekSoundsTo,
+  setSoundsBus,
+  setSoundsPan,
+  setSoundsMarkers,
+  setSoundsPlaybackRate,
   setSoundsVolume,
+  triggerSounds,
   unloadSound,
 } from '../module';
+import type { PlaybackEvent, TriggerOptions } from '../types';
 
 export class Player {
-  public readonly id: string;
+  public readonly id: number;
 
-  constructor(id: string) {
+  constructor(id: number) {
     this.id = id;
   }
 
@@ -33,7 +41,53 @@ export class Player {
     seekSoundsTo([[this.id, timeInMs]]);
   }
 
+  /** Where the sound is in milliseconds, read without waiting for the audio thread */
+  public getPosition(): number {
+    return getSoundsPosition([this.id])[0] ?? -1;
+  }
+
+  /** Replaces the times in milliseconds at which the sound emits `markerReached` events */
+  public setMarkers(markers: ReadonlyArray<number>): void {
+    setSoundsMarkers([[this.id, [...markers]]]);
+  }
+
+  /** Calls listener with every event of this sound, see `AudioManager.addPlaybackEventListener` */
+  public addEventListener(listener: (event: PlaybackEvent) => void): {
+    remove: () => void;
+  } {
+    return addPlaybackEventListener((events) => {
+      for (const event of events) {
+        if (event.soundId === this.id) {
+          listener(event);
+        }
+      }
+    });
+  }
+
   public setVolume(volume: number): void {
     setSoundsVolume([[this.id, volume]]);
   }
+
+  public setBus(bus: string): void {
+    setSoundsBus([[this.id, bus]]);
+  }
+
+  public setPan(pan: number): void {
+    setSoundsPan([[this.id, pan]]);
+  }
+
+  public setPlaybackRate(playbackRate: number): void {
+    setSoundsPlaybackRate([[this.id, playbackRate]]);
+  }
+
+  public triggerSound(volume: number = 1, options?: TriggerOptions): void {
+    triggerSounds([
+      {
+        id: this.id,
+        volume,
+        pan: options?.pan ?? 0,
+        playbackRate: options?.playbackRate ?? 1,
+      },
+    ]);
+  }
 }
@@ -1,10 +1,25 @@
-import { Image, NativeModules, Platform } from 'react-native';
+import {
+  Image,
+  NativeEventEmitter,
+  NativeModules,
+  Platform,
+} from 'react-native';
 
 import type { Spec } from './NativeAudioPlayback';
 import {
   StreamState,
+  type DecodedCacheOptions,
+  type EngineStats,
+  type FadeCurve,
+  type LatencyTuningOptions,
+  type PlaybackEvent,
+  type ScheduleTime,
+  type StreamPosition,
   type AndroidAudioStreamUsage,
   type IosAudioSessionCategory,
+  type ResamplerQuality,
+  type SampleStorageFormat,
+  type VoiceStealingPolicy,
 } from './types';
 
 const LINKING_ERROR =
@@ -31,6 +46,74 @@ const AudioPlayback: Spec = AudioPlaybackModule
       }
     );
 
+// The per-sound and bus control calls, AudioPlaybackHostObject exposes them as JSI functions on
+// Android. They all take the same path, so they apply in the order they are made: JSI runs them
+// right away while the module queues them.
+type ControlCalls = Pick<
+  Spec,
+  | 'playSounds'
+  | 'loopSounds'
+  | 'seekSoundsTo'
+  | 'setSoundsVolume'
+  | 'setSoundsPan'
+  | 'setSoundsPlaybackRate'
+  | 'triggerSounds'
+  | 'fadeSounds'
+  | 'scheduleSounds'
+  | 'setSoundsMarkers'
+  | 'setSoundsBus'
+  | 'setBusesGain'
+  | 'setBusesMuted'
+  | 'setLimiterEnabled'
+  | 'setLatencyTuning'
+  | 'unloadSound'
+  | 'setMemoryBudget'
+  | 'prefetchSounds'
+  | 'getSoundsPosition'
+  | 'getStreamPosition'
+>;
+
+let controlCalls: ControlCalls | undefined;
+
+// Installed on first use. Every lookup on the host object creates a new function, so they are
+// looked up once here.
+function controls(): ControlCalls {
+  if (controlCalls === undefined) {
+    controlCalls = jsiControlCalls() ?? AudioPlayback;
+  }
+  return controlCalls;
+}
+
+function jsiControlCalls(): ControlCalls | null {
+  if (!AudioPlayback.installJsiBindings()) {
+    return null;
+  }
+  // @ts-expect-error
+  const hostObject: ControlCalls = global.__AudioPlayback;
+  return {
+    playSounds: hostObject.playSounds,
+    loopSounds: hostObject.loopSounds,
+    seekSoundsTo: hostObject.seekSoundsTo,
+    setSoundsVolume: hostObject.setSoundsVolume,
+    setSoundsPan: hostObject.setSoundsPan,
+    setSoundsPlaybackRate: hostObject.setSoundsPlaybackRate,
+    triggerSounds: hostObject.triggerSounds,
+    fadeSounds: hostObject.fadeSounds,
+    scheduleSounds: hostObject.scheduleSounds,
+    setSoundsMarkers: hostObject.setSoundsMarkers,
+    setSoundsBus: hostObject.setSoundsBus,
+    setBusesGain: hostObject.setBusesGain,
+    setBusesMuted: hostObject.setBusesMuted,
+    setLimiterEnabled: hostObject.setLimiterEnabled,
+    setLatencyTuning: hostObject.setLatencyTuning,
+    unloadSound: hostObject.unloadSound,
+    setMemoryBudget: hostObject.setMemoryBudget,
+    prefetchSounds: hostObject.prefetchSounds,
+    getSoundsPosition: hostObject.getSoundsPosition,
+    getStreamPosition: hostObject.getStreamPosition,
+  };
+}
+
 export function setupAudioStream(options: {
   sampleRate: number;
   channelCount: number;
@@ -77,35 +160,187 @@ export function closeAudioStream(): void {
   }
 }
 
-export function playSounds(arg: Array<[string, boolean]>): void {
-  AudioPlayback.playSounds(arg);
+export async function reconfigureStream(
+  sampleRate: number,
+  channelCount: number
+): Promise<Array<number>> {
+  const res = await AudioPlayback.reconfigureStream(sampleRate, channelCount);
+  if (res.error) {
+    throw new Error(res.error);
+  }
+  return res.unloadedSoundIds;
 }
 
-export function seekSoundsTo(arg: Array<[string, number]>): void {
-  AudioPlayback.seekSoundsTo(arg);
+export function playSounds(arg: Array<[number, boolean]>): void {
+  controls().playSounds(arg);
 }
 
-export function loopSounds(arg: Array<[string, boolean]>): void {
-  AudioPlayback.loopSounds(arg);
+export function seekSoundsTo(arg: Array<[number, number]>): void {
+  controls().seekSoundsTo(arg);
 }
 
-export function setSoundsVolume(arg: Array<[string, number]>): void {
+export function loopSounds(arg: Array<[number, boolean]>): void {
+  controls().loopSounds(arg);
+}
+
+export function setSoundsVolume(arg: Array<[number, number]>): void {
   for (const [_, volume] of arg) {
     if (volume < 0 || volume > 1) {
       throw new Error('Volume must be between 0 and 1');
     }
   }
 
-  AudioPlayback.setSoundsVolume(arg);
+  controls().setSoundsVolume(arg);
+}
+
+export function triggerSounds(
+  arg: Array<{ id: number; volume: number; pan: number; playbackRate: number }>
+): void {
+  for (const { volume, pan, playbackRate } of arg) {
+    if (volume < 0 || volume > 1) {
+      throw new Error('Volume must be between 0 and 1');
+    }
+    validatePan(pan);
+    validatePlaybackRate(playbackRate);
+  }
+
+  controls().triggerSounds(arg);
+}
+
+export function setSoundsPan(arg: Array<[number, number]>): void {
+  for (const [_, pan] of arg) {
+    validatePan(pan);
+  }
+
+  controls().setSoundsPan(arg);
+}
+
+export function setSoundsPlaybackRate(arg: Array<[number, number]>): void {
+  for (const [_, playbackRate] of arg) {
+    validatePlaybackRate(playbackRate);
+  }
+
+  controls().setSoundsPlaybackRate(arg);
+}
+
+function validatePan(pan: number) {
+  if (pan < -1 || pan > 1) {
+    throw new Error('Pan must be between -1 and 1');
+  }
+}
+
+function validatePlaybackRate(playbackRate: number) {
+  if (playbackRate < 0.125 || playbackRate > 8) {
+    throw new Error('Playback rate must be between 0.125 and 8');
+  }
+}
+
+export function fadeSounds(
+  arg: Array<{
+    id: number;
+    targetVolume: number;
+    durationMs: number;
+    stopAtEnd: boolean;
+    curve: FadeCurve;
+  }>
+): void {
+  for (const { targetVolume } of arg) {
+    if (targetVolume < 0 || targetVolume > 1) {
+      throw new Error('Volume must be between 0 and 1');
+    }
+  }
+
+  controls().fadeSounds(arg);
+}
+
+export function setSoundsBus(arg: Array<[number, string]>): void {
+  controls().setSoundsBus(arg);
+}
+
+export function setBusesGain(arg: Array<[string, number]>): void {
+  for (const [_, gain] of arg) {
+    if (gain < 0) {
+      throw new Error('Bus gain must not be negative');
+    }
+  }
+
+  controls().setBusesGain(arg);
 }
 
-export async function loadSound(requiredAsset: number): Promise<string> {
+export function setBusesMuted(arg: Array<[string, boolean]>): void {
+  controls().setBusesMuted(arg);
+}
+
+export function setLimiterEnabled(enabled: boolean): void {
+  controls().setLimiterEnabled(enabled);
+}
+
+export function setLatencyTuning(options: LatencyTuningOptions): void {
+  controls().setLatencyTuning(
+    options.enabled ?? true,
+    options.aggressiveness ?? 0.5,
+    options.maxLatencyMs ?? 0
+  );
+}
+
+export function scheduleSounds(
+  arg: Array<{ id: number; play: boolean } & ScheduleTime>
+): void {
+  controls().scheduleSounds(
+    arg.map((request) => ({
+      id: request.id,
+      play: request.play,
+      atFrame: 'atFrame' in request ? request.atFrame : null,
+      atHostTimeNs: 'atHostTimeNs' in request ? request.atHostTimeNs : null,
+    }))
+  );
+}
+
+export function setSoundsMarkers(arg: Array<[number, Array<number>]>): void {
+  for (const [_, markers] of arg) {
+    if (markers.some((timeInMs) => timeInMs < 0)) {
+      throw new Error('Markers must not be negative');
+    }
+  }
+
+  controls().setSoundsMarkers(arg);
+}
+
+export function getSoundsPosition(ids: Array<number>): Array<number> {
+  return controls().getSoundsPosition(ids);
+}
+
+export function getStreamPosition(): StreamPosition {
+  return controls().getStreamPosition();
+}
+
+type LoadSoundOptions = {
+  streaming: boolean;
+  readAheadMs: number;
+  resamplerQuality: ResamplerQuality;
+  maxVoices: number;
+  voiceStealing: VoiceStealingPolicy;
+  storageFormat: SampleStorageFormat;
+};
+
+export async function loadSound(
+  requiredAsset: number,
+  options: LoadSoundOptions
+): Promise<number> {
   const res = await AudioPlayback.loadSound(
-    Image.resolveAssetSource(requiredAsset).uri
+    Image.resolveAssetSource(requiredAsset).uri,
+    {
+      streaming: options.streaming,
+      readAheadMs: options.readAheadMs,
+      resamplerQuality: options.resamplerQuality,
+      maxVoices: options.maxVoices,
+      voiceStealing: options.voiceStealing,
+      storageFormat: options.storageFormat,
+    }
   );
   if (res.error) {
     throw new Error(res.error);
-  } else if (typeof res.id !== 'string') {
+  } else if (typeof res.id !== 'number') {
     throw new Error(
       'An unknown error occurred while loading the audio file. Please create an issue with a reproducible'
     );
@@ -113,8 +348,94 @@ export async function loadSound(requiredAsset: number): Promise<string> {
   return res.id;
 }
 
-export function unloadSound(playerId: string) {
-  AudioPlayback.unloadSound(playerId);
+const LOAD_SOUNDS_PROGRESS_EVENT = 'AudioPlaybackLoadSoundsProgress';
+
+let eventEmitter: NativeEventEmitter | null = null;
+function getEventEmitter(): NativeEventEmitter {
+  if (!eventEmitter) {
+    // iOS doesn't emit events yet and its module is not an event emitter
+    eventEmitter = new NativeEventEmitter(
+      Platform.OS === 'ios' ? undefined : AudioPlaybackModule
+    );
+  }
+  return eventEmitter;
+}
+
+const PLAYBACK_EVENTS_EVENT = 'AudioPlaybackPlaybackEvents';
+
+export function addPlaybackEventListener(
+  listener: (events: Array<PlaybackEvent>) => void
+): { remove: () => void } {
+  return getEventEmitter().addListener(
+    PLAYBACK_EVENTS_EVENT,
+    (event: { events: Array<PlaybackEvent> }) => listener(event.events)
+  );
+}
+
+let nextLoadSoundsRequestId = 1;
+
+export async function loadSounds(
+  sounds: Array<{ requiredAsset: number; options: LoadSoundOptions }>,
+  onProgress?: (progress: { index: number; error: string | null }) => void,
+  signal?: AbortSignal
+): Promise<Array<{ id: number | null; error: string | null }>> {
+  const requestId = nextLoadSoundsRequestId++;
+
+  const subscription = onProgress
+    ? getEventEmitter().addListener(
+        LOAD_SOUNDS_PROGRESS_EVENT,
+        (event: { requestId: number; index: number; error: string | null }) => {
+          if (event.requestId === requestId) {
+            onProgress({ index: event.index, error: event.error });
+          }
+        }
+      )
+    : null;
+  const onAbort = () => AudioPlayback.cancelLoadSounds(requestId);
+  signal?.addEventListener('abort', onAbort);
+
+  try {
+    const promise = AudioPlayback.loadSounds(
+      requestId,
+      sounds.map(({ requiredAsset, options }) => ({
+        uri: Image.resolveAssetSource(requiredAsset).uri,
+        options: {
+          streaming: options.streaming,
+          readAheadMs: options.readAheadMs,
+          resamplerQuality: options.resamplerQuality,
+          maxVoices: options.maxVoices,
+          voiceStealing: options.voiceStealing,
+          storageFormat: options.storageFormat,
+        },
+      }))
+    );
+    if (signal?.aborted) {
+      onAbort();
+    }
+    return await promise;
+  } finally {
+    subscription?.remove();
+    signal?.removeEventListener('abort', onAbort);
+  }
+}
+
+export function unloadSound(playerId: number) {
+  controls().unloadSound(playerId);
+}
+
+export function setDecodedCacheOptions(options: DecodedCacheOptions): void {
+  AudioPlayback.setDecodedCacheOptions(
+    options.maxBytes ?? 128 * 1024 * 1024,
+    options.storeFloat ?? false
+  );
+}
+
+export function setMemoryBudget(bytes: number) {
+  controls().setMemoryBudget(bytes);
+}
+
+export function prefetchSounds(ids: Array<number>) {
+  controls().prefetchSounds(ids);
 }
 
 export function getStreamState(): StreamState {
@@ -134,3 +455,7 @@ export function getStreamState(): StreamState {
       );
   }
 }
+
+export function getEngineStats(): EngineStats {
+  return AudioPlayback.getEngineStats();
+}
@@ -22,9 +22,174 @@ export enum AndroidAudioStreamUsage {
   Assistant,
 }
 
+export interface StreamPosition {
+  /** The next frame the engine will render, counted since the engine was created */
+  framePosition: number;
+  /** The monotonic clock in nanoseconds when `framePosition` was read */
+  hostTimeNs: number;
+}
+
+export interface TriggerOptions {
+  /** From -1 (left) to 1 (right), 0 by default */
+  pan?: number;
+  /** Speed and pitch, from 0.125 to 8. 2 plays an octave higher, 1 by default. */
+  playbackRate?: number;
+}
+
+export interface PlaybackEvent {
+  /**
+   * `ended` when a sound that doesn't loop played to its end, `looped` when a looping sound
+   * started over and `markerReached` when playback passed one of the sound's markers. Sounds
+   * played with `triggerSound` don't produce events.
+   */
+  type: 'ended' | 'looped' | 'markerReached';
+  soundId: number;
+  /** Index of the marker in the list given to `setSoundsMarkers`, 0 for other events */
+  markerIndex: number;
+  /** The frame the event happened at, on the timeline of `StreamPosition.framePosition` */
+  framePosition: number;
+}
+
+/** Exactly one of `atFrame` and `atHostTimeNs` should be set */
+export type ScheduleTime = { atFrame: number } | { atHostTimeNs: number };
+
+export interface EngineStats {
+  /** Number of audio callbacks since the engine was created */
+  callbackCount: number;
+  lastCallbackDurationUs: number;
+  maxCallbackDurationUs: number;
+  averageCallbackDurationUs: number;
+  /** Frames rendered by the last callback */
+  lastFrameCount: number;
+  /** Sounds the last callback had to go through */
+  activePlayerCount: number;
+  /**
+   * Bucket i counts callbacks that took between i * 10% and (i + 1) * 10% of the buffer duration,
+   * the last bucket counts the ones that took longer than the whole buffer
+   */
+  callbackLoadHistogram: number[];
+  /** Callbacks that took longer than the buffer they rendered */
+  overrunCount: number;
+  /** Underruns and overruns reported by the device, -1 when not available */
+  xRunCount: number;
+  /** Unloaded sounds waiting to be freed */
+  pendingReclamationCount: number;
+  /** Unloaded sounds freed so far */
+  reclaimedCount: number;
+  /** Sounds loaded from the decoded sound cache instead of being decoded */
+  decodedCacheHitCount: number;
+  /** Sounds that had to be decoded because they were not in the cache yet */
+  decodedCacheMissCount: number;
+  /** Bytes of decoded audio read from the cache instead of being decoded */
+  decodedCacheBytesSaved: number;
+  /** Memory used by the samples of the loaded sounds, streamed sounds are not counted */
+  soundHeapBytes: number;
+  /**
+   * Memory used by the samples of sounds played straight from files, which the system can page out
+   * and share between processes
+   */
+  soundMappedBytes: number;
+  /** Limit set with `setMemoryBudget`, 0 when there is none */
+  memoryBudgetBytes: number;
+  /** Memory counted against the budget, the sum of `soundHeapBytes` and `soundMappedBytes` */
+  residentSoundBytes: number;
+  /** Loaded sounds whose samples were dropped to stay within the budget */
+  evictedSoundCount: number;
+  /** Times a sound was evicted */
+  evictionCount: number;
+  /** Times an evicted sound was loaded again */
+  reloadCount: number;
+  /** Time between playing an evicted sound and it being loaded again, for the last reload */
+  lastReloadDurationMs: number;
+  maxReloadDurationMs: number;
+  /**
+   * Deepest gain reduction applied by the master limiter since the last call, in dB. 0 when the
+   * mix never went over the limiter threshold.
+   */
+  limiterGainReductionDb: number;
+  /** Frames the stream buffers ahead of the device, 0 when there is no stream */
+  bufferSizeFrames: number;
+  /** The stream's minimum buffer size step */
+  framesPerBurst: number;
+  /** Largest buffer size the stream allows */
+  bufferCapacityFrames: number;
+  /** The latency added by `bufferSizeFrames` */
+  bufferLatencyMs: number;
+  /** Latency from the engine to the speaker as estimated by the device, -1 when not available */
+  outputLatencyMs: number;
+  /**
+   * The master limiter's lookahead, which delays the mix whether the limiter is enabled or not.
+   * Scheduling by host time and sound positions already account for it.
+   */
+  limiterLatencyMs: number;
+  /** Times the latency tuner grew the buffer */
+  bufferSizeIncreaseCount: number;
+  /** Times the latency tuner shrank the buffer */
+  bufferSizeDecreaseCount: number;
+  /** The last 32 buffer sizes set by the latency tuner, oldest first */
+  bufferSizeHistory: BufferSizeChange[];
+}
+
+export interface BufferSizeChange {
+  /** When the size changed, on the timeline of `StreamPosition.framePosition` */
+  framePosition: number;
+  bufferSizeFrames: number;
+  /** The `xRunCount` of the stream when the size changed */
+  xRunCount: number;
+}
+
+export interface LatencyTuningOptions {
+  /** `true` by default */
+  enabled?: boolean;
+  /**
+   * From 0 to 1, 0.5 by default. Higher values try a smaller buffer again sooner after glitches
+   * stop, and grow it by less when they happen.
+   */
+  aggressiveness?: number;
+  /** Largest latency the tuner may set, 0 (the default) for no limit */
+  maxLatencyMs?: number;
+}
+
+export interface DecodedCacheOptions {
+  /**
+   * Disk space the cache may take, 128 MB by default. The least recently used sounds are removed
+   * to stay within it.
+   */
+  maxBytes?: number;
+  /**
+   * Cache sounds kept in memory as `SampleStorageFormat.Float32` as float too, bit exact at twice
+   * the size. `false` by default, which caches them as 16 bit.
+   */
+  storeFloat?: boolean;
+}
+
 export enum StreamState {
   closed,
   initialized,
   open,
   paused,
 }
+
+export enum ResamplerQuality {
+  Low,
+  Medium,
+  High,
+}
+
+export enum FadeCurve {
+  /** Changes the amplitude evenly, fading out this way seems to drop off at the very end */
+  Linear,
+  /** Changes the level in decibels evenly, which sounds like an even fade */
+  Exponential,
+}
+
+export enum VoiceStealingPolicy {
+  Oldest,
+  Quietest,
+}
+
+export enum SampleStorageFormat {
+  Float32,
+  Int16,
+  Int8,
+}